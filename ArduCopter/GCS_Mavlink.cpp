@@ -1312,6 +1312,7 @@ void GCS_MAVLINK_Copter::handleMessage(mavlink_message_t* msg)
             if (is_equal(packet.param1,1.0f) || is_equal(packet.param1,3.0f)) {
                 AP_Notify::flags.firmware_update = 1;
                 copter.update_notify();
+                AP_Param::flush();
                 hal.scheduler->delay(200);
                 // when packet.param1 == 3 we reboot to hold in bootloader
                 hal.scheduler->reboot(is_equal(packet.param1,3.0f));
@@ -378,7 +378,9 @@ void Plane::log_perf_info()
 
     if (should_log(MASK_LOG_PM)) {
         Log_Write_Performance();
+        DataFlash.Log_Write_Scheduler(scheduler);
     }
+    scheduler.reset_task_stats();
 
     resetPerfData();
 }
@@ -0,0 +1,160 @@
+#!/usr/bin/env python
+'''
+run Replay over a set of logs and a grid of parameter overrides in
+parallel, producing a single CSV and JSON report
+
+each Replay run is a separate process in its own working directory,
+so every run has its own AP_Param and EKF state
+
+example:
+  ./BatchReplay.py --param EK2_GPS_DELAY=100,220 --param EK2_ALT_NOISE=0.5,1,2 testlogs/*.bin
+'''
+
+import optparse, os, sys, glob, json, time, shutil, tempfile, itertools, multiprocessing
+
+parser = optparse.OptionParser("BatchReplay [options] <LOGFILE|LOGDIR...>")
+parser.add_option("--replay", type='string', default='./Replay.elf', help='Replay executable to use')
+parser.add_option("--param", type='string', action='append', default=[], help="parameter sweep as NAME=VALUE1,VALUE2,... (may be repeated)")
+parser.add_option("--param-file", type='string', default=None, help="parameter file to apply to every run")
+parser.add_option("--jobs", type=int, default=multiprocessing.cpu_count(), help="number of Replay processes to run at once")
+parser.add_option("--check", action='store_true', default=False, help="check solution against CHEK messages")
+parser.add_option("--tolerance-euler", type=float, default=3, help="tolerance for euler angles in degrees")
+parser.add_option("--tolerance-pos", type=float, default=2, help="tolerance for position in meters")
+parser.add_option("--tolerance-vel", type=float, default=2, help="tolerance for velocity in meters/second")
+parser.add_option("--output", type='string', default='batch_results', help="basename for the .csv and .json reports")
+parser.add_option("--keep", action='store_true', default=False, help="keep the working directory of each run")
+
+opts, args = parser.parse_args()
+
+INNOV_NAMES = ['vel', 'pos', 'hgt', 'mag', 'tas']
+CHECK_NAMES = ['roll', 'pitch', 'yaw', 'pos', 'vel']
+
+def get_log_list():
+    '''get a list of log files to process'''
+    file_list = []
+    for a in args:
+        if os.path.isdir(a):
+            file_list.extend(glob.glob(os.path.join(a, "*.bin")))
+            file_list.extend(glob.glob(os.path.join(a, "*.BIN")))
+        else:
+            file_list.append(a)
+    file_list = sorted(set([os.path.abspath(f) for f in file_list]))
+    if len(file_list) == 0:
+        print("No logs to process")
+        sys.exit(1)
+    return file_list
+
+def get_param_grid():
+    '''expand the --param options into a list of parameter dictionaries'''
+    names = []
+    values = []
+    for p in opts.param:
+        if p.find('=') == -1:
+            print("Bad parameter sweep %s, expected NAME=VALUE1,VALUE2" % p)
+            sys.exit(1)
+        (name, vlist) = p.split('=', 1)
+        names.append(name)
+        values.append([float(v) for v in vlist.split(',')])
+    grid = []
+    for combination in itertools.product(*values):
+        grid.append(dict(zip(names, combination)))
+    return grid
+
+def run_replay(job):
+    '''run Replay on one log with one parameter set'''
+    (logfile, params) = job
+    from subprocess import call
+    workdir = tempfile.mkdtemp(prefix='replay-')
+    report = os.path.join(workdir, 'report.json')
+    cmd = [os.path.abspath(opts.replay), '--', '--report', report]
+    if opts.check:
+        cmd.extend(['--check',
+                    '--tolerance-euler=%f' % opts.tolerance_euler,
+                    '--tolerance-pos=%f' % opts.tolerance_pos,
+                    '--tolerance-vel=%f' % opts.tolerance_vel])
+    if opts.param_file is not None:
+        cmd.extend(['--param-file', os.path.abspath(opts.param_file)])
+    for name in sorted(params.keys()):
+        # repr() keeps every digit, %f would round small values to zero
+        cmd.extend(['--param', '%s=%s' % (name, repr(params[name]))])
+    cmd.append(logfile)
+
+    t0 = time.time()
+    devnull = open(os.devnull, 'w')
+    ret = call(cmd, cwd=workdir, stdout=devnull, stderr=devnull)
+    devnull.close()
+    runtime = time.time() - t0
+
+    try:
+        result = json.loads(open(report).read().strip())
+    except Exception:
+        # Replay crashed or hit a FPE before writing its report
+        result = { 'log' : logfile, 'passed' : False }
+    result['log'] = logfile
+    result['parameters'] = params
+    result['exit_code'] = ret
+    result['wall_time'] = runtime
+    if ret != 0:
+        result['passed'] = False
+    if opts.keep:
+        result['workdir'] = workdir
+    else:
+        shutil.rmtree(workdir, ignore_errors=True)
+    return result
+
+def write_results(results, param_names):
+    '''write the aggregated CSV and JSON reports'''
+    f = open(opts.output + ".json", "w")
+    json.dump(results, f, indent=1, sort_keys=True)
+    f.close()
+
+    columns = ['log'] + param_names + ['passed', 'exit_code', 'wall_time', 'runtime', 'log_time']
+    for n in INNOV_NAMES:
+        columns.extend(['%s_max' % n, '%s_mean' % n])
+    if opts.check:
+        columns.extend(['check_%s' % n for n in CHECK_NAMES])
+
+    f = open(opts.output + ".csv", "w")
+    f.write(",".join(columns) + "\n")
+    for r in results:
+        row = dict(r.get('innovations', {}))
+        row.update(r['parameters'])
+        for n in CHECK_NAMES:
+            if 'checks' in r:
+                row['check_%s' % n] = r['checks'][n]
+        for k in ['log', 'passed', 'exit_code', 'wall_time', 'runtime', 'log_time']:
+            if k in r:
+                row[k] = r[k]
+        f.write(",".join([str(row.get(c, '')) for c in columns]) + "\n")
+    f.close()
+
+def batch_replay():
+    '''run all logs against all parameter sets'''
+    log_list = get_log_list()
+    grid = get_param_grid()
+    jobs = [(logfile, params) for logfile in log_list for params in grid]
+    print("Running %u jobs (%u logs, %u parameter sets) on %u processes" % (
+        len(jobs), len(log_list), len(grid), opts.jobs))
+
+    t0 = time.time()
+    pool = multiprocessing.Pool(opts.jobs)
+    results = []
+    for r in pool.imap_unordered(run_replay, jobs):
+        results.append(r)
+        print("%u/%u %s %s %s" % (len(results), len(jobs),
+                                  os.path.basename(r['log']),
+                                  r['parameters'],
+                                  "PASSED" if r['passed'] else "FAILED"))
+    pool.close()
+    pool.join()
+
+    results.sort(key=lambda r: (r['log'], sorted(r['parameters'].items())))
+    write_results(results, sorted(grid[0].keys()))
+
+    failed = len([r for r in results if not r['passed']])
+    print("Processed %u runs in %.1f seconds, %u failed" % (len(results), time.time() - t0, failed))
+    print("Results in %s.csv and %s.json" % (opts.output, opts.output))
+    if failed != 0:
+        sys.exit(1)
+
+batch_replay()
@@ -2,37 +2,107 @@
 
 #include <fcntl.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <stdio.h>
 #include <unistd.h>
 
+DataFlashFileReader::~DataFlashFileReader()
+{
+    if (map != nullptr) {
+        munmap(map, map_length);
+    }
+    if (fd != -1) {
+        ::close(fd);
+    }
+}
+
 bool DataFlashFileReader::open_log(const char *logfile)
 {
     fd = ::open(logfile, O_RDONLY|O_CLOEXEC);
     if (fd == -1) {
         return false;
     }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        return false;
+    }
+    if (st.st_size == 0) {
+        // an empty log has no messages
+        return true;
+    }
+    if ((uint64_t)st.st_size > SIZE_MAX) {
+        ::printf("Log too large to map\n");
+        return false;
+    }
+    map_length = st.st_size;
+
+    void *p = mmap(nullptr, map_length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+        return false;
+    }
+    map = (uint8_t *)p;
+    madvise(map, map_length, MADV_SEQUENTIAL);
+
+    build_index();
     return true;
 }
 
+/*
+  walk the log once recording the offset of each message. The walk
+  stops at the first corrupt or unknown message, which update() then
+  reports as before
+ */
+void DataFlashFileReader::build_index(void)
+{
+    struct log_Format fmts[256] {};
+    size_t scan = 0;
+
+    while (scan + 3 <= map_length) {
+        const uint8_t *hdr = &map[scan];
+        if (hdr[0] != HEAD_BYTE1 || hdr[1] != HEAD_BYTE2) {
+            break;
+        }
+        uint8_t length;
+        if (hdr[2] == LOG_FORMAT_MSG) {
+            length = sizeof(struct log_Format);
+            if (scan + length > map_length) {
+                break;
+            }
+            const struct log_Format *f = (const struct log_Format *)hdr;
+            memcpy(&fmts[f->type], f, sizeof(fmts[f->type]));
+        } else {
+            length = fmts[hdr[2]].length;
+            if (length == 0 || scan + length > map_length) {
+                break;
+            }
+        }
+        offsets[hdr[2]].push_back(scan);
+        scan += length;
+    }
+
+    ofs = 0;
+}
+
 bool DataFlashFileReader::update(char type[5])
 {
-    uint8_t hdr[3];
-    if (::read(fd, hdr, 3) != 3) {
+    if (ofs + 3 > map_length) {
         return false;
     }
+    uint8_t *hdr = &map[ofs];
     if (hdr[0] != HEAD_BYTE1 || hdr[1] != HEAD_BYTE2) {
         printf("bad log header\n");
         return false;
     }
 
     if (hdr[2] == LOG_FORMAT_MSG) {
-        struct log_Format f;
-        memcpy(&f, hdr, 3);
-        if (::read(fd, &f.type, sizeof(f)-3) != sizeof(f)-3) {
+        if (ofs + sizeof(struct log_Format) > map_length) {
             return false;
         }
+        const struct log_Format &f = *(const struct log_Format *)hdr;
         memcpy(&formats[f.type], &f, sizeof(formats[f.type]));
+        ofs += sizeof(struct log_Format);
         strncpy(type, "FMT", 3);
         type[3] = 0;
 
@@ -44,23 +114,22 @@ bool DataFlashFileReader::update(char type[5])
         end_format_msgs();
     }
 
-    const struct log_Format &f = formats[hdr[2]];
+    const uint8_t msgid = hdr[2];
+    const struct log_Format &f = formats[msgid];
     if (f.length == 0) {
         // can't just throw these away as the format specifies the
         // number of bytes in the message
-        ::printf("No format defined for type (%d)\n", hdr[2]);
+        ::printf("No format defined for type (%d)\n", msgid);
         exit(1);
     }
 
-    uint8_t msg[f.length];
-
-    memcpy(msg, hdr, 3);
-    if (::read(fd, &msg[3], f.length-3) != f.length-3) {
+    if (ofs + f.length > map_length) {
         return false;
     }
+    ofs += f.length;
 
     strncpy(type, f.name, 4);
     type[4] = 0;
 
-    return handle_msg(f,msg);
+    return handle_msg(f, hdr);
 }
@@ -1,21 +1,48 @@
 #pragma once
 
+#include <vector>
+
 #include <DataFlash/DataFlash.h>
 
+/*
+  log reader working on a read only memory mapping of the log
+  file. Messages are handed to handle_msg() directly from the mapping,
+  so handlers must not modify them. An index of message offsets is
+  built for each message type when the log is opened
+ */
 class DataFlashFileReader
 {
 public:
+    virtual ~DataFlashFileReader();
+
     bool open_log(const char *logfile);
     bool update(char type[5]);
 
     virtual bool handle_log_format_msg(const struct log_Format &f) = 0;
     virtual bool handle_msg(const struct log_Format &f, uint8_t *msg) = 0;
 
+    // number of messages of the given type in the log
+    uint32_t num_messages(uint8_t type) const { return offsets[type].size(); }
+
 protected:
     int fd = -1;
     bool done_format_msgs = false;
     virtual void end_format_msgs(void) {}
 
 #define LOGREADER_MAX_FORMATS 255 // must be >= highest MESSAGE
-    struct log_Format formats[LOGREADER_MAX_FORMATS] {};
+    // indexed by message type, which can be up to 255
+    struct log_Format formats[256] {};
+
+private:
+    // scan the whole log once, recording message offsets
+    void build_index(void);
+
+    uint8_t *map = nullptr;
+    size_t map_length = 0;
+
+    // offset of the next message to be returned by update()
+    size_t ofs = 0;
+
+    // offsets of all messages of each type
+    std::vector<size_t> offsets[256];
 };
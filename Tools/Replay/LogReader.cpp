@@ -96,7 +96,7 @@ static const char *generated_names[] = { "EKF1", "EKF2", "EKF3", "EKF4", "EKF5",
                                          "IMT", "IMT2",
                                          "MAG", "MAG2",
                                          "BARO", "BAR2",
-                                         "GPS","GPA",
+                                         "GPS","GPA","GPSB",
                                          "NKA", "NKV", NULL };
 
 /*
@@ -281,12 +281,17 @@ bool LogReader::handle_msg(const struct log_Format &f, uint8_t *msg) {
     memset(name, '\0', 5);
     memcpy(name, f.name, 4);
 
+    // msg points into the read only log mapping. Messages written to
+    // the output log get their id remapped in a copy
+    uint8_t msg_copy[256];
     if (save_message_type(name)) {
         if (mapped_msgid[msg[2]] == 0) {
             printf("Unknown msgid %u\n", (unsigned)msg[2]);
             exit(1);
         }
-        msg[2] = mapped_msgid[msg[2]];
+        memcpy(msg_copy, msg, f.length);
+        msg_copy[2] = mapped_msgid[msg[2]];
+        msg = msg_copy;
         if (!in_list(name, nottypes)) {
             dataflash.WriteBlock(msg, f.length);        
         }
@@ -79,6 +79,10 @@ const AP_Param::Info ReplayVehicle::var_info[] = {
     // @Group: LOG
     // @Path: ../libraries/DataFlash/DataFlash.cpp
     GOBJECT(dataflash, "LOG", DataFlash_Class),
+
+    // @Group: GPS_
+    // @Path: ../libraries/AP_GPS/AP_GPS.cpp
+    GOBJECT(gps, "GPS_", AP_GPS),
     
     AP_VAREND
 };
@@ -131,6 +135,9 @@ void ReplayVehicle::setup(void)
     barometer.update();
     compass.init();
     ins.set_hil_mode();
+
+    // the blended GPS solution is recalculated and logged
+    gps._DataFlash = &dataflash;
 }
 
 Replay replay(replayvehicle);
@@ -153,6 +160,7 @@ void Replay::usage(void)
     ::printf("\t--logmatch         match logging rate to source\n");
     ::printf("\t--no-params        don't use parameters from the log\n");
     ::printf("\t--no-fpe           do not generate floating point exceptions\n");
+    ::printf("\t--report FILE      append a JSON summary of the run to FILE\n");
 }
 
 
@@ -168,6 +176,7 @@ enum {
     OPT_NOPARAMS,
     OPT_PARAM_FILE,
     OPT_NO_FPE,
+    OPT_REPORT,
 };
 
 void Replay::flush_dataflash(void) {
@@ -224,6 +233,7 @@ void Replay::_parse_command_line(uint8_t argc, char * const argv[])
         {"logmatch",        false,  0, OPT_LOGMATCH},
         {"no-params",       false,  0, OPT_NOPARAMS},
         {"no-fpe",          false,  0, OPT_NO_FPE},
+        {"report",          true,   0, OPT_REPORT},
         {0, false, 0, 0}
     };
 
@@ -307,6 +317,10 @@ void Replay::_parse_command_line(uint8_t argc, char * const argv[])
             generate_fpe = false;
             break;
 
+        case OPT_REPORT:
+            report_filename = gopt.optarg;
+            break;
+
         case 'h':
         default:
             usage();
@@ -496,6 +510,8 @@ void Replay::setup()
 {
     ::printf("Starting\n");
 
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+
     uint8_t argc;
     char * const *argv;
 
@@ -660,12 +676,22 @@ void Replay::read_sensors(const char *type)
         }
     }
 
-    if (streq(type,"GPS")) {
+    // the GPS and accuracy messages of all receivers are logged
+    // together, so update once they have all been read. This gives
+    // the blended solution the same inputs it had in flight
+    const bool gps_msg = streq(type,"GPS") || streq(type,"GPS2") ||
+        streq(type,"GPA") || streq(type,"GPA2");
+    if (gps_msg) {
+        gps_update_pending = true;
+    } else if (gps_update_pending) {
+        gps_update_pending = false;
         _vehicle.gps.update();
         if (_vehicle.gps.status() >= AP_GPS::GPS_OK_FIX_3D) {
             _vehicle.ahrs.estimate_wind();
         }
-    } else if (streq(type,"MAG")) {
+    }
+
+    if (streq(type,"MAG")) {
         _vehicle.compass.read();
     } else if (streq(type,"ARSP")) {
         _vehicle.ahrs.set_airspeed(&_vehicle.airspeed);
@@ -706,6 +732,9 @@ void Replay::read_sensors(const char *type)
         if ((downsample == 0 || ++output_counter % downsample == 0) && !logmatch) {
             write_ekf_logs();
         }
+        if (report_filename != NULL) {
+            update_innov_stats();
+        }
         if (_vehicle.ahrs.healthy() != ahrs_healthy) {
             ahrs_healthy = _vehicle.ahrs.healthy();
             printf("AHRS health: %u at %lu\n", 
@@ -783,15 +812,132 @@ void Replay::log_check_solution(void)
     check_result.max_pos_error   = MAX(check_result.max_pos_error,   pos_error);
 }
 
+/*
+  accumulate EKF2 innovation test ratios for the batch report
+ */
+void Replay::update_innov_stats(void)
+{
+    int8_t primary = _vehicle.EKF2.getPrimaryCoreIndex();
+    if (primary < 0) {
+        return;
+    }
+    float velVar, posVar, hgtVar, tasVar;
+    Vector3f magVar;
+    Vector2f offset;
+    _vehicle.EKF2.getVariances(primary, velVar, posVar, hgtVar, magVar, tasVar, offset);
+
+    const float ratio[INNOV_NUM] = { velVar, posVar, hgtVar, magVar.length(), tasVar };
+    for (uint8_t i=0; i<INNOV_NUM; i++) {
+        if (isnan(ratio[i])) {
+            continue;
+        }
+        innov_stats.max[i] = MAX(innov_stats.max[i], ratio[i]);
+        innov_stats.sum[i] += ratio[i];
+    }
+    innov_stats.count++;
+}
+
+/*
+  write a string as a quoted JSON string
+ */
+static void fprint_json_string(FILE *f, const char *str)
+{
+    fputc('"', f);
+    for (const char *p=str; *p; p++) {
+        const uint8_t c = *p;
+        if (c == '"' || c == '\\') {
+            fprintf(f, "\\%c", c);
+        } else if (c < 0x20) {
+            fprintf(f, "\\u%04x", c);
+        } else {
+            fputc(c, f);
+        }
+    }
+    fputc('"', f);
+}
+
+/*
+  write a float as a JSON number with enough digits to read back the
+  same value. JSON has no NaN or infinity, so those are written as null
+ */
+static void fprint_json_float(FILE *f, float v)
+{
+    if (isinf(v) || isnan(v)) {
+        fprintf(f, "null");
+    } else {
+        fprintf(f, "%.9g", (double)v);
+    }
+}
+
+/*
+  append a one line JSON summary of this run to the --report file, for
+  aggregation by BatchReplay.py
+ */
+void Replay::write_report(bool failed)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double runtime = (now.tv_sec - start_time.tv_sec) + (now.tv_nsec - start_time.tv_nsec)*1.0e-9;
+
+    FILE *f = fopen(report_filename, "a");
+    if (f == NULL) {
+        perror(report_filename);
+        return;
+    }
+
+    static const char *innov_names[INNOV_NUM] = { "vel", "pos", "hgt", "mag", "tas" };
+
+    fprintf(f, "{\"log\": ");
+    fprint_json_string(f, log_filename);
+    fprintf(f, ", \"runtime\": %.3f, \"log_time\": %.3f, \"parameters\": {",
+            runtime, AP_HAL::millis()*0.001f);
+    for (struct user_parameter *u=user_parameters; u; u=u->next) {
+        fprint_json_string(f, u->name);
+        fprintf(f, ": ");
+        fprint_json_float(f, u->value);
+        fprintf(f, "%s", u->next?", ":"");
+    }
+    fprintf(f, "}, \"innovations\": {");
+    for (uint8_t i=0; i<INNOV_NUM; i++) {
+        float mean = innov_stats.count?innov_stats.sum[i]/innov_stats.count:0;
+        fprintf(f, "\"%s_max\": ", innov_names[i]);
+        fprint_json_float(f, innov_stats.max[i]);
+        fprintf(f, ", \"%s_mean\": ", innov_names[i]);
+        fprint_json_float(f, mean);
+        fprintf(f, "%s", i<INNOV_NUM-1?", ":"");
+    }
+    fprintf(f, "}");
+    if (check_solution) {
+        fprintf(f, ", \"checks\": {\"roll\": ");
+        fprint_json_float(f, check_result.max_roll_error);
+        fprintf(f, ", \"pitch\": ");
+        fprint_json_float(f, check_result.max_pitch_error);
+        fprintf(f, ", \"yaw\": ");
+        fprint_json_float(f, check_result.max_yaw_error);
+        fprintf(f, ", \"pos\": ");
+        fprint_json_float(f, check_result.max_pos_error);
+        fprintf(f, ", \"vel\": ");
+        fprint_json_float(f, check_result.max_vel_error);
+        fprintf(f, "}");
+    }
+    fprintf(f, ", \"passed\": %s}\n", failed?"false":"true");
+    fclose(f);
+}
+
 void Replay::flush_and_exit()
 {
     flush_dataflash();
 
+    bool failed = false;
     if (check_solution) {
-        report_checks();
+        failed = report_checks();
     }
 
-    exit(0);
+    if (report_filename != NULL) {
+        write_report(failed);
+    }
+
+    exit(failed?1:0);
 }
 
 void Replay::loop()
@@ -1047,9 +1193,9 @@ bool Replay::show_error(const char *text, float max_error, float tolerance)
 }
 
 /*
-  report results of --check
+  report results of --check, returning true if any check failed
  */
-void Replay::report_checks(void)
+bool Replay::report_checks(void)
 {
     bool failed = false;
     if (tolerance_euler < 0.01f) {
@@ -1073,10 +1219,10 @@ void Replay::report_checks(void)
     failed |= show_error("Velocity error", check_result.max_vel_error, tolerance_vel);
     if (failed) {
         printf("Checks failed\n");
-        exit(1);
     } else {
         printf("Checks passed\n");
     }
+    return failed;
 }
 
 /*
@@ -50,6 +50,7 @@
 #include <errno.h>
 #include <signal.h>
 #include <unistd.h>
+#include <time.h>
 #include <AP_HAL/utility/getopt_cpp.h>
 
 class ReplayVehicle {
@@ -130,6 +131,7 @@ private:
     bool done_parameters;
     bool done_baro_init;
     bool done_home_init;
+    bool gps_update_pending;
     int32_t arm_time_ms = -1;
     bool ahrs_healthy;
     bool use_imt = true;
@@ -152,6 +154,28 @@ private:
         float max_vel_error;
     } check_result {};
 
+    // file to append a one line JSON summary of the run to
+    const char *report_filename = NULL;
+    struct timespec start_time;
+
+    /*
+      EKF2 innovation test ratio statistics for the primary core,
+      accumulated each time the AHRS is run
+     */
+    enum {
+        INNOV_VEL = 0,
+        INNOV_POS,
+        INNOV_HGT,
+        INNOV_MAG,
+        INNOV_TAS,
+        INNOV_NUM
+    };
+    struct {
+        uint32_t count;
+        float max[INNOV_NUM];
+        double sum[INNOV_NUM];
+    } innov_stats {};
+
     void _parse_command_line(uint8_t argc, char * const argv[]);
 
     struct user_parameter {
@@ -170,7 +194,9 @@ private:
     void log_check_generate();
     void log_check_solution();
     bool show_error(const char *text, float max_error, float tolerance);
-    void report_checks();
+    bool report_checks();
+    void update_innov_stats();
+    void write_report(bool failed);
     bool find_log_info(struct log_information &info);
     const char **parse_list_from_string(const char *str);
     bool parse_param_line(char *line, char **vname, float &value);
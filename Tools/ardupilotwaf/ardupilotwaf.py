@@ -164,6 +164,10 @@ def ap_stlib(bld, **kw):
     for l in kw['ap_libraries']:
         bld.ap_library(l, kw['ap_vehicle'])
 
+    # objects the board builds outside of the libraries, e.g. with
+    # different flags
+    kw['use'] = Utils.to_list(kw.get('use', [])) + bld.env.AP_STLIB_OBJECTS
+
     kw['features'] = kw.get('features', []) + ['cxx', 'cxxstlib']
     kw['target'] = kw['name']
     kw['source'] = []
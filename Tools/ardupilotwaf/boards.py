@@ -245,6 +245,24 @@ class linux(Board):
             'AP_HAL_Linux',
         ]
 
+        # NEON is optional on ARMv7, so only the NEON kernels are built
+        # for it, see build(). Compilers defaulting to Thumb-2 report
+        # thumb rather than arm
+        if cfg.env.DEST_CPU in ('arm', 'thumb'):
+            env.NEON_CXXFLAGS = ['-mfpu=neon']
+
+    def build(self, bld):
+        super(linux, self).build(bld)
+
+        kw = dict(bld.env.AP_LIBRARIES_OBJECTS_KW)
+        kw.update(
+            name='objs/AP_HAL_Linux_neon',
+            source=['libraries/AP_HAL_Linux/neon/Flow_PX4_Kernels_NEON.cpp'],
+            cxxflags=kw.get('cxxflags', []) + bld.env.NEON_CXXFLAGS,
+        )
+        bld.objects(**kw)
+        bld.env.AP_STLIB_OBJECTS += ['objs/AP_HAL_Linux_neon']
+
 
 class minlure(linux):
     def configure_env(self, cfg, env):
@@ -963,7 +963,7 @@ def fly_ArduCopter(binary, viewerip=None, use_map=False, valgrind=False, gdb=Fal
 
     home = "%f,%f,%u,%u" % (HOME.lat, HOME.lng, HOME.alt, HOME.heading)
     sitl = util.start_SITL(binary, wipe=True, model=frame, home=home, speedup=speedup_default)
-    mavproxy = util.start_MAVProxy_SITL('ArduCopter', options='--sitl=127.0.0.1:5501 --out=127.0.0.1:19550 --quadcopter')
+    mavproxy = util.start_MAVProxy_SITL('ArduCopter', options='--sitl=127.0.0.1:%u --out=127.0.0.1:%u --quadcopter' % (util.instance_port(5501), util.instance_port(19550)))
     mavproxy.expect('Received [0-9]+ parameters')
 
     # setup test parameters
@@ -980,7 +980,7 @@ def fly_ArduCopter(binary, viewerip=None, use_map=False, valgrind=False, gdb=Fal
     util.pexpect_close(sitl)
 
     sitl = util.start_SITL(binary, model=frame, home=home, speedup=speedup_default, valgrind=valgrind, gdb=gdb)
-    options = '--sitl=127.0.0.1:5501 --out=127.0.0.1:19550 --quadcopter --streamrate=5'
+    options = '--sitl=127.0.0.1:%u --out=127.0.0.1:%u --quadcopter --streamrate=5' % (util.instance_port(5501), util.instance_port(19550))
     if viewerip:
         options += ' --out=%s:14550' % viewerip
     if use_map:
@@ -1012,7 +1012,7 @@ def fly_ArduCopter(binary, viewerip=None, use_map=False, valgrind=False, gdb=Fal
 
     # get a mavlink connection going
     try:
-        mav = mavutil.mavlink_connection('127.0.0.1:19550', robust_parsing=True)
+        mav = mavutil.mavlink_connection('127.0.0.1:%u' % util.instance_port(19550), robust_parsing=True)
     except Exception as msg:
         print("Failed to start mavlink connection on 127.0.0.1:19550" % msg)
         raise
@@ -1311,7 +1311,7 @@ def fly_CopterAVC(binary, viewerip=None, use_map=False, valgrind=False, gdb=Fals
 
     home = "%f,%f,%u,%u" % (AVCHOME.lat, AVCHOME.lng, AVCHOME.alt, AVCHOME.heading)
     sitl = util.start_SITL(binary, wipe=True, model='heli', home=home, speedup=speedup_default)
-    mavproxy = util.start_MAVProxy_SITL('ArduCopter', options='--sitl=127.0.0.1:5501 --out=127.0.0.1:19550')
+    mavproxy = util.start_MAVProxy_SITL('ArduCopter', options='--sitl=127.0.0.1:%u --out=127.0.0.1:%u' % (util.instance_port(5501), util.instance_port(19550)))
     mavproxy.expect('Received [0-9]+ parameters')
 
     # setup test parameters
@@ -1326,7 +1326,7 @@ def fly_CopterAVC(binary, viewerip=None, use_map=False, valgrind=False, gdb=Fals
     util.pexpect_close(sitl)
 
     sitl = util.start_SITL(binary, model='heli', home=home, speedup=speedup_default, valgrind=valgrind, gdb=gdb)
-    options = '--sitl=127.0.0.1:5501 --out=127.0.0.1:19550 --streamrate=5'
+    options = '--sitl=127.0.0.1:%u --out=127.0.0.1:%u --streamrate=5' % (util.instance_port(5501), util.instance_port(19550))
     if viewerip:
         options += ' --out=%s:14550' % viewerip
     if use_map:
@@ -1360,7 +1360,7 @@ def fly_CopterAVC(binary, viewerip=None, use_map=False, valgrind=False, gdb=Fals
 
     # get a mavlink connection going
     try:
-        mav = mavutil.mavlink_connection('127.0.0.1:19550', robust_parsing=True)
+        mav = mavutil.mavlink_connection('127.0.0.1:%u' % util.instance_port(19550), robust_parsing=True)
     except Exception as msg:
         print("Failed to start mavlink connection on 127.0.0.1:19550" % msg)
         raise
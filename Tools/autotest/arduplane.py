@@ -445,7 +445,7 @@ def fly_ArduPlane(binary, viewerip=None, use_map=False, valgrind=False, gdb=Fals
     """
     global homeloc
 
-    options = '--sitl=127.0.0.1:5501 --out=127.0.0.1:19550 --streamrate=10'
+    options = '--sitl=127.0.0.1:%u --out=127.0.0.1:%u --streamrate=10' % (util.instance_port(5501), util.instance_port(19550))
     if viewerip:
         options += " --out=%s:14550" % viewerip
     if use_map:
@@ -479,7 +479,7 @@ def fly_ArduPlane(binary, viewerip=None, use_map=False, valgrind=False, gdb=Fals
 
     # get a mavlink connection going
     try:
-        mav = mavutil.mavlink_connection('127.0.0.1:19550', robust_parsing=True)
+        mav = mavutil.mavlink_connection('127.0.0.1:%u' % util.instance_port(19550), robust_parsing=True)
     except Exception as msg:
         print("Failed to start mavlink connection on 127.0.0.1:19550" % msg)
         raise
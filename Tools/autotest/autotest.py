@@ -167,9 +167,12 @@ parser.add_option("--valgrind", default=False, action='store_true', help='run Ar
 parser.add_option("--gdb", default=False, action='store_true', help='run ArduPilot binaries under gdb')
 parser.add_option("--debug", default=False, action='store_true', help='make built binaries debug binaries')
 parser.add_option("-j", default=None, type='int', help='build CPUs')
+parser.add_option("--lockstep", default=False, action='store_true', help='run SITL as fast as possible rather than at a fixed speedup')
 
 opts, args = parser.parse_args()
 
+util.set_SITL_options(lockstep=opts.lockstep)
+
 
 steps = [
     'prerequisites',
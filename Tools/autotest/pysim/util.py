@@ -187,6 +187,24 @@ def valgrind_log_filepath(binary, model):
     return make_safe_filename('%s-%s-valgrind.log' % (os.path.basename(binary), model,))
 
 
+# SITL instance number and clock mode for start_SITL(). Each instance
+# offsets its ports by 10, so several vehicles can run side by side
+sitl_instance = 0
+sitl_lockstep = False
+
+
+def set_SITL_options(instance=0, lockstep=False):
+    """Set the instance and clock mode of SITL processes started from now on."""
+    global sitl_instance, sitl_lockstep
+    sitl_instance = instance
+    sitl_lockstep = lockstep
+
+
+def instance_port(port):
+    """Return a default SITL or MAVProxy port offset for the current instance."""
+    return port + 10 * sitl_instance
+
+
 def start_SITL(binary, valgrind=False, gdb=False, wipe=False, synthetic_clock=True, home=None, model=None, speedup=1, defaults_file=None, unhide_parameters=False):
     """Launch a SITL instance."""
     cmd = []
@@ -209,6 +227,10 @@ def start_SITL(binary, valgrind=False, gdb=False, wipe=False, synthetic_clock=Tr
         cmd.extend(['--model', model])
     if speedup != 1:
         cmd.extend(['--speedup', str(speedup)])
+    if sitl_lockstep:
+        cmd.append('--lockstep')
+    if sitl_instance != 0:
+        cmd.extend(['--instance', str(sitl_instance)])
     if defaults_file is not None:
         cmd.extend(['--defaults', defaults_file])
     if unhide_parameters:
@@ -233,13 +255,15 @@ def start_SITL(binary, valgrind=False, gdb=False, wipe=False, synthetic_clock=Tr
     return child
 
 
-def start_MAVProxy_SITL(atype, aircraft=None, setup=False, master='tcp:127.0.0.1:5760',
+def start_MAVProxy_SITL(atype, aircraft=None, setup=False, master=None,
                         options=None, logfile=sys.stdout):
     """Launch mavproxy connected to a SITL instance."""
     import pexpect
     global close_list
     MAVPROXY = os.getenv('MAVPROXY_CMD', 'mavproxy.py')
-    cmd = MAVPROXY + ' --master=%s --out=127.0.0.1:14550' % master
+    if master is None:
+        master = 'tcp:127.0.0.1:%u' % instance_port(5760)
+    cmd = MAVPROXY + ' --master=%s --out=127.0.0.1:%u' % (master, instance_port(14550))
     if setup:
         cmd += ' --setup'
     if aircraft is None:
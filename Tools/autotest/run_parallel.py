@@ -0,0 +1,146 @@
+#!/usr/bin/env python
+'''
+run autotest vehicle steps in parallel, one SITL vehicle per process
+
+each step runs in its own working directory with its own SITL
+instance number, so the eeprom, logs and ports of the vehicles don't
+collide. By default SITL runs in lockstep, stepping as fast as the
+vehicle code allows rather than at a fixed speedup, so a step takes as
+long as the CPU needs to fly it. The binaries must already have been
+built, eg. with "./waf configure --board sitl && ./waf copter plane rover"
+
+example:
+  ./run_parallel.py --jobs 4 'fly.*' drive.APMrover2
+'''
+from __future__ import print_function
+
+import fnmatch, json, multiprocessing, optparse, os, shutil, sys, tempfile, time, traceback
+
+import apmrover2
+import arducopter
+import arduplane
+import quadplane
+from pysim import util
+
+parser = optparse.OptionParser("run_parallel [options] <STEP...>")
+parser.add_option("--jobs", type=int, default=multiprocessing.cpu_count(), help="number of vehicles to run at once")
+parser.add_option("--no-lockstep", action='store_true', default=False, help="run SITL at the speedup of each step rather than in lockstep")
+parser.add_option("--debug", action='store_true', default=False, help="use the sitl-debug binaries")
+parser.add_option("--output", type='string', default='parallel_results.json', help="JSON report of the results")
+parser.add_option("--keep", action='store_true', default=False, help="keep the working directory of each step")
+
+opts, args = parser.parse_args()
+
+# step name, vehicle test function and binary
+STEPS = [
+    ('fly.ArduCopter',  arducopter.fly_ArduCopter, 'arducopter-quad'),
+    ('fly.CopterAVC',   arducopter.fly_CopterAVC,  'arducopter-heli'),
+    ('fly.ArduPlane',   arduplane.fly_ArduPlane,   'arduplane'),
+    ('fly.QuadPlane',   quadplane.fly_QuadPlane,   'arduplane'),
+    ('drive.APMrover2', apmrover2.drive_APMrover2, 'ardurover'),
+]
+
+def get_step_list():
+    '''match the arguments against the available steps'''
+    if len(args) == 0:
+        return [s[0] for s in STEPS]
+    matched = []
+    for a in args:
+        arg_matched = False
+        for s in STEPS:
+            if fnmatch.fnmatch(s[0].lower(), a.lower()):
+                if s[0] not in matched:
+                    matched.append(s[0])
+                arg_matched = True
+        if not arg_matched:
+            print("No steps matched argument (%s)" % a)
+            sys.exit(1)
+    return matched
+
+def binary_path(binary_name):
+    '''path of a SITL binary'''
+    if opts.debug:
+        binary_basedir = "sitl-debug"
+    else:
+        binary_basedir = "sitl"
+    binary = util.reltopdir(os.path.join('build', binary_basedir, 'bin', binary_name))
+    if not os.path.exists(binary) and os.path.exists(binary + ".exe"):
+        binary += ".exe"
+    return binary
+
+def run_step(job):
+    '''run one step as the given SITL instance'''
+    (step, instance) = job
+    (name, function, binary_name) = [s for s in STEPS if s[0] == step][0]
+
+    workdir = tempfile.mkdtemp(prefix='autotest-%s-' % step)
+    output = os.path.join(workdir, 'output.txt')
+
+    # the vehicle tests log to stdout through pexpect, so keep each
+    # step's output in its own file
+    stdout_fd = os.dup(1)
+    f = open(output, 'w')
+    os.dup2(f.fileno(), 1)
+    olddir = os.getcwd()
+    os.chdir(workdir)
+
+    util.set_SITL_options(instance=instance, lockstep=not opts.no_lockstep)
+    t0 = time.time()
+    try:
+        passed = bool(function(binary_path(binary_name)))
+    except Exception:
+        traceback.print_exc(file=sys.stdout)
+        passed = False
+    runtime = time.time() - t0
+    util.pexpect_close_all()
+
+    sys.stdout.flush()
+    os.chdir(olddir)
+    os.dup2(stdout_fd, 1)
+    os.close(stdout_fd)
+    f.close()
+
+    result = { 'step' : step, 'instance' : instance, 'passed' : passed, 'wall_time' : runtime }
+    if opts.keep or not passed:
+        result['workdir'] = workdir
+    else:
+        shutil.rmtree(workdir, ignore_errors=True)
+    return result
+
+def run_parallel():
+    '''run all matched steps'''
+    step_list = get_step_list()
+    # give every step its own instance, so ports are never reused
+    # while an earlier vehicle may still be shutting down
+    jobs = [(step, i) for (i, step) in enumerate(step_list)]
+    print("Running %u steps on %u processes" % (len(jobs), opts.jobs))
+
+    util.mkdir_p(util.reltopdir('../buildlogs'))
+
+    t0 = time.time()
+    pool = multiprocessing.Pool(opts.jobs, maxtasksperchild=1)
+    results = []
+    for r in pool.imap_unordered(run_step, jobs):
+        results.append(r)
+        print("%u/%u %s %s in %.1f seconds" % (len(results), len(jobs), r['step'],
+                                               "PASSED" if r['passed'] else "FAILED",
+                                               r['wall_time']))
+        if not r['passed']:
+            print("  output in %s" % os.path.join(r['workdir'], 'output.txt'))
+    pool.close()
+    pool.join()
+
+    results.sort(key=lambda r: r['step'])
+    f = open(opts.output, "w")
+    json.dump(results, f, indent=1, sort_keys=True)
+    f.close()
+
+    wall_time = time.time() - t0
+    step_time = sum([r['wall_time'] for r in results])
+    failed = [r['step'] for r in results if not r['passed']]
+    print("Ran %u steps in %.1f seconds (%.1f seconds run one at a time)" % (len(results), wall_time, step_time))
+    if len(failed) != 0:
+        print("FAILED %u steps: %s" % (len(failed), failed))
+        sys.exit(1)
+
+run_parallel()
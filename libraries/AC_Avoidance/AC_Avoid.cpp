@@ -131,8 +131,24 @@ void AC_Avoid::adjust_velocity_poly(const float kP, const float accel_cmss, Vect
     // e.g. if we are exactly on the boundary.
     Vector2f safe_vel(desired_vel);
 
+    // limiting never increases speed, so only edges closer than our
+    // stopping distance plus the margin can limit the velocity. Use the
+    // fence's grid to skip the others.  Grid edge i-1 is the edge
+    // ending at boundary point i
+    const AP_PolygonGrid *grid = _fence.get_polygon_grid();
+    AP_PolygonGrid::EdgeSet near_edges;
+    bool use_grid = false;
+    if (grid != nullptr && grid->points() == &boundary[1] && grid->num_points() + 1 == num_points &&
+        kP > 0.0f && accel_cmss > 0.0f) {
+        const float radius = get_stopping_distance(kP, accel_cmss, desired_vel.length()) * 1.01f + get_margin() + 1.0f;
+        use_grid = grid->edges_near(position_xy, radius, near_edges);
+    }
+
     uint16_t i, j;
     for (i = 1, j = num_points-1; i < num_points; j = i++) {
+        if (use_grid && !near_edges.get(i-1)) {
+            continue;
+        }
         // end points of current edge
         Vector2f start = boundary[j];
         Vector2f end = boundary[i];
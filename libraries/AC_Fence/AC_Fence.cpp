@@ -212,7 +212,7 @@ uint8_t AC_Fence::check_fence(float curr_alt)
         } else if (_boundary_valid) {
             // check if vehicle is outside the polygon fence
             const Vector3f& position = _inav.get_position();
-            if (_poly_loader.boundary_breached(Vector2f(position.x, position.y), _boundary_num_points, _boundary, true)) {
+            if (boundary_breached(Vector2f(position.x, position.y), _boundary_num_points, _boundary)) {
                 // check if this is a new breach
                 if ((_breached_fences & AC_FENCE_TYPE_POLYGON) == 0) {
                     // record that we have breached the polygon
@@ -259,7 +259,7 @@ bool AC_Fence::check_destination_within_fence(const Location_Class& loc)
         if (_inav.get_location(temp_loc)) {
             const struct Location &ekf_origin = _inav.get_origin();
             Vector2f position = location_diff(ekf_origin, loc) * 100.0f;
-            if (_poly_loader.boundary_breached(position, _boundary_num_points, _boundary, true)) {
+            if (boundary_breached(position, _boundary_num_points, _boundary)) {
                 return false;
             }
         }
@@ -335,12 +335,26 @@ Vector2f* AC_Fence::get_polygon_points(uint16_t& num_points) const
     return _boundary;
 }
 
-/// returns true if we've breached the polygon boundary.  simple passthrough to underlying _poly_loader object
+/// returns true if we've breached the polygon boundary.  uses the boundary grid when checking our own points
 bool AC_Fence::boundary_breached(const Vector2f& location, uint16_t num_points, const Vector2f* points) const
 {
+    // the grid skips the return point at the start of the array
+    if (_boundary_grid.valid() && points != nullptr &&
+        _boundary_grid.points() == &points[1] && _boundary_grid.num_points() + 1 == num_points) {
+        return _boundary_grid.outside(location);
+    }
     return _poly_loader.boundary_breached(location, num_points, points, true);
 }
 
+/// returns the grid built over the polygon points (excluding the return point) or nullptr if not available
+const AP_PolygonGrid* AC_Fence::get_polygon_grid() const
+{
+    if (!_boundary_grid.valid()) {
+        return nullptr;
+    }
+    return &_boundary_grid;
+}
+
 /// handler for polygon fence messages with GCS
 void AC_Fence::handle_msg(mavlink_channel_t chan, mavlink_message_t* msg)
 {
@@ -419,6 +433,9 @@ bool AC_Fence::load_polygon_from_eeprom(bool force_reload)
     // sanity check total
     _total = constrain_int16(_total, 0, _poly_loader.max_points());
 
+    // the grid refers to the points we are about to overwrite
+    _boundary_grid.clear();
+
     // load each point from eeprom
     Vector2l temp_latlon;
     for (uint16_t index=0; index<_total; index++) {
@@ -435,5 +452,10 @@ bool AC_Fence::load_polygon_from_eeprom(bool force_reload)
     // update validity of polygon
     _boundary_valid = _poly_loader.boundary_valid(_boundary_num_points, _boundary, true);
 
+    // build grid for fast breach checks. On failure we fall back to checking every point
+    if (_boundary_valid) {
+        _boundary_grid.build(&_boundary[1], _boundary_num_points - 1);
+    }
+
     return true;
 }
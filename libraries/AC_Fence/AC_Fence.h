@@ -8,6 +8,7 @@
 #include <AP_AHRS/AP_AHRS.h>
 #include <AP_InertialNav/AP_InertialNav.h>     // Inertial Navigation library
 #include <AC_Fence/AC_PolyFence_loader.h>
+#include <AP_Math/AP_PolygonGrid.h>
 #include <AP_Common/Location.h>
 
 // bit masks for enabled fence types.  Used for TYPE parameter
@@ -104,9 +105,12 @@ public:
     /// returns pointer to array of polygon points and num_points is filled in with the total number
     Vector2f* get_polygon_points(uint16_t& num_points) const;
 
-    /// returns true if we've breached the polygon boundary.  simple passthrough to underlying _poly_loader object
+    /// returns true if we've breached the polygon boundary.  uses the boundary grid when checking our own points
     bool boundary_breached(const Vector2f& location, uint16_t num_points, const Vector2f* points) const;
 
+    /// returns the grid built over the polygon points (excluding the return point) or nullptr if not available
+    const AP_PolygonGrid* get_polygon_grid() const;
+
     /// handler for polygon fence messages with GCS
     void handle_msg(mavlink_channel_t chan, mavlink_message_t* msg);
 
@@ -161,4 +165,5 @@ private:
     bool            _boundary_create_attempted = false; // true if we have attempted to create the boundary array
     bool            _boundary_loaded = false;       // true if boundary array has been loaded from eeprom
     bool            _boundary_valid = false;        // true if boundary forms a closed polygon
+    AP_PolygonGrid  _boundary_grid;                 // grid over boundary points 1..n-1, rebuilt whenever the boundary is loaded
 };
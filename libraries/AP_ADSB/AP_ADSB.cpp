@@ -30,7 +30,11 @@
 
 #define VEHICLE_TIMEOUT_MS              5000   // if no updates in this time, drop it from the list
 #define ADSB_VEHICLE_LIST_SIZE_DEFAULT  25
+#if HAL_CPU_CLASS >= HAL_CPU_CLASS_1000
+#define ADSB_VEHICLE_LIST_SIZE_MAX      500
+#else
 #define ADSB_VEHICLE_LIST_SIZE_MAX      100
+#endif
 #define ADSB_CHAN_TIMEOUT_MS            15000
 
 #if APM_BUILD_TYPE(APM_BUILD_ArduPlane)
@@ -54,8 +58,8 @@ const AP_Param::GroupInfo AP_ADSB::var_info[] = {
 
     // @Param: LIST_MAX
     // @DisplayName: ADSB vehicle list size
-    // @Description: ADSB list size of nearest vehicles. Longer lists take longer to refresh with lower SRx_ADSB values.
-    // @Range: 1 100
+    // @Description: ADSB list size of nearest vehicles. Longer lists take longer to refresh with lower SRx_ADSB values. Boards with more memory, such as Linux boards, allow up to 500.
+    // @Range: 1 500
     // @User: Advanced
     AP_GROUPINFO("LIST_MAX",   2, AP_ADSB, in_state.list_size_param, ADSB_VEHICLE_LIST_SIZE_DEFAULT),
 
@@ -129,10 +133,24 @@ void AP_ADSB::init(void)
         in_state.list_size = in_state.list_size_param;
         in_state.vehicle_list = new adsb_vehicle_t[in_state.list_size];
 
-        if (in_state.vehicle_list == nullptr) {
+        uint16_t index_size = 1;
+        while (index_size < 2*in_state.list_size) {
+            index_size <<= 1;
+        }
+        in_state.icao_index = new uint16_t[index_size];
+
+        if (in_state.vehicle_list == nullptr || in_state.icao_index == nullptr) {
             // dynamic RAM allocation of _vehicle_list[] failed, disable gracefully
             hal.console->printf("Unable to initialize ADS-B vehicle list\n");
+            deinit();
             _enabled.set_and_notify(0);
+        } else {
+            in_state.icao_index_mask = index_size - 1;
+        }
+    }
+    if (in_state.icao_index != nullptr) {
+        for (uint16_t i = 0; i <= in_state.icao_index_mask; i++) {
+            in_state.icao_index[i] = ADSB_ICAO_INDEX_EMPTY;
         }
     }
 
@@ -153,6 +171,10 @@ void AP_ADSB::deinit(void)
         delete [] in_state.vehicle_list;
         in_state.vehicle_list = nullptr;
     }
+    if (in_state.icao_index != nullptr) {
+        delete [] in_state.icao_index;
+        in_state.icao_index = nullptr;
+    }
 }
 
 /*
@@ -295,8 +317,10 @@ void AP_ADSB::delete_vehicle(const uint16_t index)
             furthest_vehicle_distance = 0;
             furthest_vehicle_index = 0;
         }
+        icao_index_remove(in_state.vehicle_list[index].info.ICAO_address);
         if (index != (in_state.vehicle_count-1)) {
             in_state.vehicle_list[index] = in_state.vehicle_list[in_state.vehicle_count-1];
+            icao_index_move(in_state.vehicle_list[index].info.ICAO_address, in_state.vehicle_count-1, index);
         }
         // TODO: is memset needed? When we decrement the index we essentially forget about it
         memset(&in_state.vehicle_list[in_state.vehicle_count-1], 0, sizeof(adsb_vehicle_t));
@@ -311,15 +335,83 @@ void AP_ADSB::delete_vehicle(const uint16_t index)
  */
 bool AP_ADSB::find_index(const adsb_vehicle_t &vehicle, uint16_t *index) const
 {
-    for (uint16_t i = 0; i < in_state.vehicle_count; i++) {
-        if (in_state.vehicle_list[i].info.ICAO_address == vehicle.info.ICAO_address) {
-            *index = i;
+    if (in_state.icao_index == nullptr) {
+        return false;
+    }
+    const uint32_t icao = vehicle.info.ICAO_address;
+    for (uint16_t slot = icao_hash(icao);
+         in_state.icao_index[slot] != ADSB_ICAO_INDEX_EMPTY;
+         slot = (slot+1) & in_state.icao_index_mask) {
+        if (in_state.vehicle_list[in_state.icao_index[slot]].info.ICAO_address == icao) {
+            *index = in_state.icao_index[slot];
             return true;
         }
     }
     return false;
 }
 
+/*
+ * hash an ICAO address to a slot in the ICAO index
+ */
+uint16_t AP_ADSB::icao_hash(uint32_t icao) const
+{
+    return ((icao * 2654435761U) >> 16) & in_state.icao_index_mask;
+}
+
+/*
+ * add the vehicle at index to the ICAO index
+ */
+void AP_ADSB::icao_index_insert(uint16_t index)
+{
+    uint16_t slot = icao_hash(in_state.vehicle_list[index].info.ICAO_address);
+    while (in_state.icao_index[slot] != ADSB_ICAO_INDEX_EMPTY) {
+        slot = (slot+1) & in_state.icao_index_mask;
+    }
+    in_state.icao_index[slot] = index;
+}
+
+/*
+ * remove an ICAO address from the index. Later entries in the probe
+ * sequence are shifted back so no tombstones are needed
+ */
+void AP_ADSB::icao_index_remove(uint32_t icao)
+{
+    uint16_t slot = icao_hash(icao);
+    while (in_state.icao_index[slot] != ADSB_ICAO_INDEX_EMPTY &&
+           in_state.vehicle_list[in_state.icao_index[slot]].info.ICAO_address != icao) {
+        slot = (slot+1) & in_state.icao_index_mask;
+    }
+    if (in_state.icao_index[slot] == ADSB_ICAO_INDEX_EMPTY) {
+        return;
+    }
+    uint16_t next = (slot+1) & in_state.icao_index_mask;
+    while (in_state.icao_index[next] != ADSB_ICAO_INDEX_EMPTY) {
+        const uint16_t home = icao_hash(in_state.vehicle_list[in_state.icao_index[next]].info.ICAO_address);
+        if (((next - home) & in_state.icao_index_mask) >= ((next - slot) & in_state.icao_index_mask)) {
+            in_state.icao_index[slot] = in_state.icao_index[next];
+            slot = next;
+        }
+        next = (next+1) & in_state.icao_index_mask;
+    }
+    in_state.icao_index[slot] = ADSB_ICAO_INDEX_EMPTY;
+}
+
+/*
+ * point the index entry for an ICAO address at a new list index,
+ * used when a vehicle is moved within the list
+ */
+void AP_ADSB::icao_index_move(uint32_t icao, uint16_t from_index, uint16_t to_index)
+{
+    for (uint16_t slot = icao_hash(icao);
+         in_state.icao_index[slot] != ADSB_ICAO_INDEX_EMPTY;
+         slot = (slot+1) & in_state.icao_index_mask) {
+        if (in_state.icao_index[slot] == from_index) {
+            in_state.icao_index[slot] = to_index;
+            return;
+        }
+    }
+}
+
 /*
  * Update the vehicle list. If the vehicle is already in the
  * list then it will update it, otherwise it will be added.
@@ -413,9 +505,21 @@ void AP_ADSB::handle_vehicle(const mavlink_message_t* packet)
  */
 void AP_ADSB::set_vehicle(const uint16_t index, const adsb_vehicle_t &vehicle)
 {
-    if (index < in_state.list_size) {
+    if (index >= in_state.list_size) {
+        return;
+    }
+    if (index < in_state.vehicle_count &&
+        in_state.vehicle_list[index].info.ICAO_address == vehicle.info.ICAO_address) {
+        // updating a tracked vehicle, the index is unchanged
         in_state.vehicle_list[index] = vehicle;
+        return;
+    }
+    if (index < in_state.vehicle_count) {
+        // replacing a tracked vehicle with a new one
+        icao_index_remove(in_state.vehicle_list[index].info.ICAO_address);
     }
+    in_state.vehicle_list[index] = vehicle;
+    icao_index_insert(index);
 }
 
 void AP_ADSB::send_adsb_vehicle(const mavlink_channel_t chan)
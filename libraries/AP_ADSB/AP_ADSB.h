@@ -29,8 +29,12 @@
 
 #include <AP_Buffer/AP_Buffer.h>
 
+#define ADSB_ICAO_INDEX_EMPTY 0xFFFF
+
 class AP_ADSB
 {
+    friend class AP_Avoidance_Bench;
+
 public:
     struct adsb_vehicle_t {
         mavlink_adsb_vehicle_t info; // the whole mavlink struct with all the juicy details. sizeof() == 38
@@ -93,6 +97,12 @@ private:
 
     void set_vehicle(const uint16_t index, const adsb_vehicle_t &vehicle);
 
+    // hash index from ICAO address to vehicle_list index
+    uint16_t icao_hash(uint32_t icao) const;
+    void icao_index_insert(uint16_t index);
+    void icao_index_remove(uint32_t icao);
+    void icao_index_move(uint32_t icao, uint16_t from_index, uint16_t to_index);
+
     // Generates pseudorandom ICAO from gps time, lat, and lon
     uint32_t genICAO(const Location_Class &loc);
 
@@ -127,6 +137,11 @@ private:
         uint16_t    vehicle_count;
         AP_Int32    list_radius;
 
+        // open addressed hash of ICAO addresses, with at least twice
+        // as many slots as list_size
+        uint16_t    *icao_index = nullptr;
+        uint16_t    icao_index_mask;
+
         // streamrate stuff
         uint32_t    send_start_ms[MAVLINK_COMM_NUM_BUFFERS];
         uint16_t    send_index[MAVLINK_COMM_NUM_BUFFERS];
@@ -127,10 +127,15 @@ void AP_Avoidance::init(void)
     debug("ADSB initialisation: %d obstacles", _obstacles_max.get());
     if (_obstacles == nullptr) {
         _obstacles = new AP_Avoidance::Obstacle[_obstacles_max];
+        _grid = new grid_entry[_obstacles_max];
 
-        if (_obstacles == nullptr) {
+        if (_obstacles == nullptr || _grid == nullptr) {
             // dynamic RAM allocation of _obstacles[] failed, disable gracefully
             hal.console->printf("Unable to initialize Avoidance obstacle list\n");
+            delete [] _obstacles;
+            delete [] _grid;
+            _obstacles = nullptr;
+            _grid = nullptr;
             // disable ourselves to avoid repeated allocation attempts
             _enabled.set(0);
             return;
@@ -138,6 +143,7 @@ void AP_Avoidance::init(void)
         _obstacles_allocated = _obstacles_max;
     }
     _obstacle_count = 0;
+    _grid_valid = false;
     _last_state_change_ms = 0;
     _threat_level = MAV_COLLISION_THREAT_LEVEL_NONE;
     _gcs_cleared_messages_first_sent = std::numeric_limits<uint32_t>::max();
@@ -151,11 +157,14 @@ void AP_Avoidance::deinit(void)
 {
     if (_obstacles != nullptr) {
         delete [] _obstacles;
+        delete [] _grid;
         _obstacles = nullptr;
+        _grid = nullptr;
         _obstacles_allocated = 0;
         handle_recovery(AP_AVOIDANCE_RECOVERY_RTL);
     }
     _obstacle_count = 0;
+    _grid_valid = false;
 }
 
 bool AP_Avoidance::check_startup()
@@ -199,26 +208,34 @@ void AP_Avoidance::add_obstacle(const uint32_t obstacle_timestamp_ms,
             oldest_index = i;
         }
     }
+    bool added = false;
     if (index == -1) {
         // existing obstacle not found.  See if we can store it anyway:
         if (i <_obstacles_allocated) {
             // have room to store more vehicles...
             index = _obstacle_count++;
+            added = true;
         } else if (oldest_timestamp < obstacle_timestamp_ms) {
             // replace this very old entry with this new data
             index = oldest_index;
         }
+        if (index == -1) {
+            // no room for this (old?!) data
+            return;
+        }
         _obstacles[index].src = src;
         _obstacles[index].src_id = src_id;
     }
 
-    if (index == -1) {
-        // no room for this (old?!) data
-        return;
-    }
     _obstacles[index]._location = loc;
     _obstacles[index]._velocity = vel_ned;
     _obstacles[index].timestamp_ms = obstacle_timestamp_ms;
+
+    if (added) {
+        grid_link(index);
+    } else {
+        grid_update(index);
+    }
 }
 
 void AP_Avoidance::add_obstacle(const uint32_t obstacle_timestamp_ms,
@@ -435,37 +452,243 @@ void AP_Avoidance::check_for_threats()
         return;
     }
 
-    // we always check all obstacles to see if they are threats since it
-    // is most likely our own position and/or velocity have changed
-    // determine the current most-serious-threat
+    check_for_threats(my_loc, my_vel);
+}
+
+/*
+  update the threat level of one obstacle and see if it is the most
+  serious threat so far
+ */
+void AP_Avoidance::check_obstacle(uint8_t i, const Location &my_loc, const Vector3f &my_vel, uint32_t now)
+{
+    AP_Avoidance::Obstacle &obstacle = _obstacles[i];
+    const uint32_t obstacle_age = now - obstacle.timestamp_ms;
+    debug("i=%d src_id=%d timestamp=%u age=%d", i, obstacle.src_id, obstacle.timestamp_ms, obstacle_age);
+
+    update_threat_level(my_loc, my_vel, obstacle);
+    _grid[i].checked = true;
+    debug("   threat-level=%d", obstacle.threat_level);
+
+    // ignore any really old data:
+    if (obstacle_age > MAX_OBSTACLE_AGE_MS) {
+        return;
+    }
+
+    if (obstacle_is_more_serious_threat(obstacle)) {
+        _current_most_serious_threat = i;
+        return;
+    }
+
+    // obstacles aren't checked in index order, so break ties the way
+    // a scan in index order would
+    const AP_Avoidance::Obstacle &current = _obstacles[_current_most_serious_threat];
+    if (i < _current_most_serious_threat &&
+        obstacle.threat_level == current.threat_level &&
+        !(current.time_to_closest_approach < obstacle.time_to_closest_approach)) {
+        _current_most_serious_threat = i;
+    }
+}
+
+/*
+  determine the current most serious threat. Only obstacles in grid
+  cells within threat_search_radius() of us are evaluated, as no
+  obstacle further away can come within the warning distance inside
+  the time horizon; the rest are set to MAV_COLLISION_THREAT_LEVEL_NONE.
+  The previous most serious threat is always evaluated so the GCS is
+  told when it clears.
+
+  If nothing nearby is a threat then the obstacle reported to the GCS
+  is the NONE level one closest to its closest approach, which needs
+  every obstacle evaluated. That is only done while the GCS is still
+  being sent cleared messages, see handle_threat_gcs_notify()
+ */
+void AP_Avoidance::check_for_threats(const Location &my_loc, const Vector3f &my_vel)
+{
+    const uint32_t now = AP_HAL::millis();
+
+    if (!_grid_valid ||
+        now - _grid_rebuild_ms > AP_AVOIDANCE_GRID_REBUILD_MS ||
+        get_distance(_grid_origin, my_loc) > AP_AVOIDANCE_GRID_RECENTER_M) {
+        // size cells so the search normally covers a 3x3 block of cells
+        grid_rebuild(my_loc, MAX(threat_search_radius(my_vel), AP_AVOIDANCE_GRID_MIN_CELL_M));
+        _grid_rebuild_ms = now;
+    }
+
+    const int16_t previous_threat = _current_most_serious_threat;
     _current_most_serious_threat = -1;
-    for (uint8_t i=0; i<_obstacle_count; i++) {
 
-        AP_Avoidance::Obstacle &obstacle = _obstacles[i];
-        const uint32_t obstacle_age = AP_HAL::millis() - obstacle.timestamp_ms;
-        debug("i=%d src_id=%d timestamp=%u age=%d", i, obstacle.src_id, obstacle.timestamp_ms, obstacle_age);
+    for (uint8_t i=0; i<_obstacle_count; i++) {
+        _obstacles[i].threat_level = MAV_COLLISION_THREAT_LEVEL_NONE;
+        _grid[i].checked = false;
+    }
 
-        update_threat_level(my_loc, my_vel, obstacle);
-        debug("   threat-level=%d", obstacle.threat_level);
+    if (previous_threat >= 0 && previous_threat < _obstacle_count) {
+        check_obstacle(previous_threat, my_loc, my_vel, now);
+    }
 
-        // ignore any really old data:
-        if (obstacle_age > MAX_OBSTACLE_AGE_MS) {
-            // shrink list if this is the last entry:
-            if (i == _obstacle_count-1) {
-                _obstacle_count -= 1;
+    const float cells_f = ceilf(threat_search_radius(my_vel) / _grid_cell_size);
+    if (sq(2*cells_f+1) >= AP_AVOIDANCE_GRID_BUCKETS) {
+        // the search covers every bucket, check all obstacles
+        for (uint8_t i=0; i<_obstacle_count; i++) {
+            if (i != previous_threat) {
+                check_obstacle(i, my_loc, my_vel, now);
             }
-            continue;
         }
+    } else {
+        const int16_t cells = cells_f;
+        int16_t my_n, my_e;
+        grid_cell(my_loc, my_n, my_e);
+        uint64_t visited = 0;
+        for (int16_t dn = -cells; dn <= cells; dn++) {
+            for (int16_t de = -cells; de <= cells; de++) {
+                const uint8_t bucket = grid_bucket(my_n + dn, my_e + de);
+                if (visited & (1ULL << bucket)) {
+                    continue;
+                }
+                visited |= (1ULL << bucket);
+                for (uint8_t i = _grid_head[bucket]; i != AP_AVOIDANCE_GRID_NONE; i = _grid[i].next) {
+                    if (i == previous_threat ||
+                        abs(_grid[i].n - my_n) > cells ||
+                        abs(_grid[i].e - my_e) > cells) {
+                        continue;
+                    }
+                    check_obstacle(i, my_loc, my_vel, now);
+                }
+            }
+        }
+    }
 
-        if (obstacle_is_more_serious_threat(obstacle)) {
-            _current_most_serious_threat = i;
+    if ((_current_most_serious_threat == -1 ||
+         _obstacles[_current_most_serious_threat].threat_level == MAV_COLLISION_THREAT_LEVEL_NONE) &&
+        (_gcs_cleared_messages_first_sent == 0 ||
+         now - _gcs_cleared_messages_first_sent <= _gcs_cleared_messages_duration * 1000)) {
+        for (uint8_t i=0; i<_obstacle_count; i++) {
+            if (!_grid[i].checked) {
+                check_obstacle(i, my_loc, my_vel, now);
+            }
         }
     }
+
+    // shrink the list past any really old entries at the end
+    while (_obstacle_count > 0 &&
+           now - _obstacles[_obstacle_count-1].timestamp_ms > MAX_OBSTACLE_AGE_MS &&
+           _current_most_serious_threat != _obstacle_count-1) {
+        grid_unlink(_obstacle_count-1);
+        _obstacle_count -= 1;
+    }
+
     if (_current_most_serious_threat != -1) {
         debug("Current most serious threat: %d level=%d", _current_most_serious_threat, _obstacles[_current_most_serious_threat].threat_level);
     }
 }
 
+/*
+  distance beyond which an obstacle can't become a threat within the
+  time horizon, given our speed and that of the fastest obstacle
+ */
+float AP_Avoidance::threat_search_radius(const Vector3f &my_vel) const
+{
+    const float horizon = MAX(MAX(_warn_time_horizon.get(), _fail_time_horizon.get()), 0) +
+        MAX_OBSTACLE_AGE_MS / 1000;
+    const float distance = MAX(_warn_distance_xy.get(), (float)_fail_distance_xy.get());
+    return distance + (norm(my_vel.x, my_vel.y) + _grid_max_speed) * horizon;
+}
+
+/*
+  hash a grid cell to a bucket
+ */
+uint8_t AP_Avoidance::grid_bucket(int16_t n, int16_t e) const
+{
+    const uint32_t h = ((uint32_t)n * 73856093U) ^ ((uint32_t)e * 19349663U);
+    return (h ^ (h >> 16)) & (AP_AVOIDANCE_GRID_BUCKETS-1);
+}
+
+/*
+  get the grid cell holding a location
+ */
+void AP_Avoidance::grid_cell(const Location &loc, int16_t &n, int16_t &e) const
+{
+    const Vector2f ne = location_diff(_grid_origin, loc);
+    n = constrain_float(floorf(ne.x / _grid_cell_size), INT16_MIN, INT16_MAX);
+    e = constrain_float(floorf(ne.y / _grid_cell_size), INT16_MIN, INT16_MAX);
+}
+
+/*
+  add an obstacle to the grid
+ */
+void AP_Avoidance::grid_link(uint8_t index)
+{
+    if (!_grid_valid) {
+        return;
+    }
+    grid_entry &g = _grid[index];
+    grid_cell(_obstacles[index]._location, g.n, g.e);
+    const uint8_t bucket = grid_bucket(g.n, g.e);
+    g.prev = AP_AVOIDANCE_GRID_NONE;
+    g.next = _grid_head[bucket];
+    if (g.next != AP_AVOIDANCE_GRID_NONE) {
+        _grid[g.next].prev = index;
+    }
+    _grid_head[bucket] = index;
+
+    const Vector3f &vel = _obstacles[index]._velocity;
+    _grid_max_speed = MAX(_grid_max_speed, norm(vel.x, vel.y));
+}
+
+/*
+  remove an obstacle from the grid
+ */
+void AP_Avoidance::grid_unlink(uint8_t index)
+{
+    if (!_grid_valid) {
+        return;
+    }
+    grid_entry &g = _grid[index];
+    if (g.prev != AP_AVOIDANCE_GRID_NONE) {
+        _grid[g.prev].next = g.next;
+    } else {
+        _grid_head[grid_bucket(g.n, g.e)] = g.next;
+    }
+    if (g.next != AP_AVOIDANCE_GRID_NONE) {
+        _grid[g.next].prev = g.prev;
+    }
+}
+
+/*
+  move an obstacle to the right cell after its location has changed
+ */
+void AP_Avoidance::grid_update(uint8_t index)
+{
+    if (!_grid_valid) {
+        return;
+    }
+    int16_t n, e;
+    grid_cell(_obstacles[index]._location, n, e);
+    if (n == _grid[index].n && e == _grid[index].e) {
+        const Vector3f &vel = _obstacles[index]._velocity;
+        _grid_max_speed = MAX(_grid_max_speed, norm(vel.x, vel.y));
+        return;
+    }
+    grid_unlink(index);
+    grid_link(index);
+}
+
+/*
+  rebuild the grid around a new origin with a new cell size. This
+  also recalculates the fastest obstacle speed
+ */
+void AP_Avoidance::grid_rebuild(const Location &origin, float cell_size)
+{
+    _grid_origin = origin;
+    _grid_cell_size = cell_size;
+    _grid_max_speed = 0;
+    memset(_grid_head, AP_AVOIDANCE_GRID_NONE, sizeof(_grid_head));
+    _grid_valid = true;
+    for (uint8_t i=0; i<_obstacle_count; i++) {
+        grid_link(i);
+    }
+}
+
 
 AP_Avoidance::Obstacle *AP_Avoidance::most_serious_threat()
 {
@@ -38,7 +38,16 @@
 
 #define AP_AVOIDANCE_ESCAPE_TIME_SEC                        2       // vehicle runs from thread for 2 seconds
 
+// obstacle grid, see check_for_threats()
+#define AP_AVOIDANCE_GRID_BUCKETS                           64      // must be a power of 2, at most 64
+#define AP_AVOIDANCE_GRID_NONE                              255
+#define AP_AVOIDANCE_GRID_MIN_CELL_M                        100     // smallest grid cell size
+#define AP_AVOIDANCE_GRID_RECENTER_M                        20000   // rebuild grid if we move this far from its origin
+#define AP_AVOIDANCE_GRID_REBUILD_MS                        10000   // rebuild grid this often to resize cells
+
 class AP_Avoidance {
+    friend class AP_Avoidance_Bench;
+    friend class AP_Avoidance_Test;
 
 public:
 
@@ -161,6 +170,8 @@ private:
     uint32_t src_id_for_adsb_vehicle(AP_ADSB::adsb_vehicle_t vehicle) const;
 
     void check_for_threats();
+    void check_for_threats(const Location &my_loc, const Vector3f &my_vel);
+    void check_obstacle(uint8_t index, const Location &my_loc, const Vector3f &my_vel, uint32_t now);
     void update_threat_level(const Location &my_loc,
                              const Vector3f &my_vel,
                              AP_Avoidance::Obstacle &obstacle);
@@ -176,6 +187,31 @@ private:
     AP_Avoidance::Obstacle *_obstacles;
     uint8_t _obstacles_allocated;
     uint8_t _obstacle_count;
+
+    // coarse north/east grid of obstacles relative to an origin near
+    // the vehicle. Cells are hashed into buckets, each holding a
+    // doubly linked list of obstacle indexes
+    struct grid_entry {
+        int16_t n;
+        int16_t e;
+        uint8_t prev;
+        uint8_t next;
+        bool checked;               // evaluated in this check_for_threats()
+    } *_grid;
+    uint8_t _grid_head[AP_AVOIDANCE_GRID_BUCKETS];
+    Location _grid_origin;
+    bool _grid_valid;
+    float _grid_cell_size;
+    float _grid_max_speed;          // fastest obstacle in the grid, m/s
+    uint32_t _grid_rebuild_ms;
+
+    uint8_t grid_bucket(int16_t n, int16_t e) const;
+    void grid_cell(const Location &loc, int16_t &n, int16_t &e) const;
+    void grid_link(uint8_t index);
+    void grid_unlink(uint8_t index);
+    void grid_update(uint8_t index);
+    void grid_rebuild(const Location &origin, float cell_size);
+    float threat_search_radius(const Vector3f &my_vel) const;
     int8_t _current_most_serious_threat;
     MAV_COLLISION_ACTION _latest_action = MAV_COLLISION_ACTION_NONE;
 
@@ -0,0 +1,174 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_ADSB/AP_ADSB.h>
+#include <AP_Avoidance/AP_Avoidance.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+#define BENCH_AIRCRAFT 500
+
+// AP_Avoidance holds at most 127 obstacles (AVD_OBS_MAX is an int8)
+#define BENCH_OBSTACLES 127
+
+/*
+ * A synthetic traffic feed of BENCH_AIRCRAFT aircraft spread over
+ * 10km around the vehicle, most of them slow and a few airliners,
+ * fed through AP_ADSB. The first BENCH_OBSTACLES of them are fed
+ * into AP_Avoidance
+ */
+class AP_Avoidance_Bench
+{
+public:
+    AP_Avoidance_Bench()
+    {
+        home.lat = -353632620;
+        home.lng = 1491652370;
+        home.alt = 58400;
+
+        for (uint16_t i = 0; i < BENCH_AIRCRAFT; i++) {
+            Location loc = home;
+            location_update(loc, (i * 137) % 360, 200 + (i * 7919) % 9800);
+
+            mavlink_adsb_vehicle_t info {};
+            info.ICAO_address = 0x400000 + i * 97;
+            info.lat = loc.lat;
+            info.lon = loc.lng;
+            info.altitude = (home.alt + (i * 31) % 2000) * 10;
+            info.heading = ((i * 53) % 360) * 100;
+            info.hor_velocity = (i % 50 == 0) ? 25000 : 1000 + (i * 13) % 3000;
+            info.flags = ADSB_FLAGS_VALID_COORDS | ADSB_FLAGS_VALID_ALTITUDE |
+                ADSB_FLAGS_VALID_HEADING | ADSB_FLAGS_VALID_VELOCITY;
+            mavlink_msg_adsb_vehicle_encode(1, 1, &feed[i], &info);
+        }
+    }
+
+    // track every aircraft in the feed
+    void setup_adsb()
+    {
+        adsb._enabled.set(1);
+        adsb.in_state.list_size_param.set(BENCH_AIRCRAFT);
+        adsb.in_state.list_radius.set(0);
+        adsb.init();
+        adsb._my_loc = Location_Class(home);
+    }
+
+    // fill the obstacle list from the ADS-B samples
+    void setup_avoidance()
+    {
+        avoidance._enabled.set(1);
+        avoidance._obstacles_max.set(BENCH_OBSTACLES);
+        avoidance.init();
+        const uint32_t now = AP_HAL::millis();
+        for (uint16_t i = 0; i < BENCH_OBSTACLES; i++) {
+            mavlink_adsb_vehicle_t info;
+            mavlink_msg_adsb_vehicle_decode(&feed[i], &info);
+            Location loc = home;
+            loc.lat = info.lat;
+            loc.lng = info.lon;
+            loc.alt = info.altitude / 10;
+            avoidance.add_obstacle(now, MAV_COLLISION_SRC_ADSB, info.ICAO_address, loc,
+                                   info.heading / 100.0f, info.hor_velocity / 100.0f, 0);
+        }
+    }
+
+    void feed_adsb()
+    {
+        for (uint16_t i = 0; i < BENCH_AIRCRAFT; i++) {
+            adsb.handle_vehicle(&feed[i]);
+        }
+        AP_ADSB::adsb_vehicle_t sample;
+        while (adsb.next_sample(sample)) {
+        }
+    }
+
+    void check_for_threats()
+    {
+        avoidance.check_for_threats(home, my_vel);
+    }
+
+    // evaluate every obstacle, as was done before the grid was added
+    void check_all_obstacles()
+    {
+        const uint32_t now = AP_HAL::millis();
+        avoidance._current_most_serious_threat = -1;
+        for (uint8_t i = 0; i < avoidance._obstacle_count; i++) {
+            avoidance.check_obstacle(i, home, my_vel, now);
+        }
+    }
+
+    AP_Avoidance &get_avoidance() { return avoidance; }
+
+private:
+    class Avoidance : public AP_Avoidance {
+    public:
+        using AP_Avoidance::AP_Avoidance;
+    protected:
+        MAV_COLLISION_ACTION handle_avoidance(const AP_Avoidance::Obstacle *obstacle,
+                                              MAV_COLLISION_ACTION requested_action) override {
+            return requested_action;
+        }
+        void handle_recovery(uint8_t recovery_action) override {}
+    };
+
+    AP_InertialSensor ins;
+    AP_Baro baro;
+    AP_GPS gps;
+    AP_AHRS_DCM ahrs{ins, baro, gps};
+    AP_ADSB adsb{ahrs};
+    Avoidance avoidance{ahrs, adsb};
+
+    Location home {};
+    Vector3f my_vel{5, 3, 0};
+    mavlink_message_t feed[BENCH_AIRCRAFT];
+};
+
+// the vehicle libraries expect to be statically allocated, so keep
+// one bench object for all benchmarks
+static AP_Avoidance_Bench &get_bench()
+{
+    static AP_Avoidance_Bench bench;
+    return bench;
+}
+
+static void BM_ADSBTrafficFeed(benchmark::State& state)
+{
+    AP_Avoidance_Bench &bench = get_bench();
+    bench.setup_adsb();
+
+    while (state.KeepRunning()) {
+        bench.feed_adsb();
+    }
+}
+
+BENCHMARK(BM_ADSBTrafficFeed);
+
+static void BM_AvoidanceThreatsGrid(benchmark::State& state)
+{
+    AP_Avoidance_Bench &bench = get_bench();
+    bench.setup_avoidance();
+
+    while (state.KeepRunning()) {
+        bench.check_for_threats();
+        gbenchmark_escape(&bench.get_avoidance());
+    }
+}
+
+BENCHMARK(BM_AvoidanceThreatsGrid);
+
+static void BM_AvoidanceThreatsAll(benchmark::State& state)
+{
+    AP_Avoidance_Bench &bench = get_bench();
+    bench.setup_avoidance();
+
+    while (state.KeepRunning()) {
+        bench.check_all_obstacles();
+        gbenchmark_escape(&bench.get_avoidance());
+    }
+}
+
+BENCHMARK(BM_AvoidanceThreatsAll);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,199 @@
+#include <AP_gtest.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_ADSB/AP_ADSB.h>
+#include <AP_Avoidance/AP_Avoidance.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+#define TEST_OBSTACLES 100
+
+// simple deterministic generator so failures are reproducible
+static uint32_t rand_state = 1;
+static float rand_float(float low, float high)
+{
+    rand_state = rand_state * 1103515245U + 12345U;
+    return low + (high - low) * ((rand_state >> 8) & 0xFFFF) / 65535.0f;
+}
+
+/*
+ * compare the grid based threat check against evaluating every
+ * obstacle in index order, as was done before the grid was added
+ */
+class AP_Avoidance_Test
+{
+public:
+    AP_Avoidance_Test()
+    {
+        home.lat = -353632620;
+        home.lng = 1491652370;
+        home.alt = 58400;
+    }
+
+    // obstacles from 100m to 20km away, some of them close enough to
+    // be threats
+    void setup()
+    {
+        avoidance._enabled.set(1);
+        avoidance._obstacles_max.set(TEST_OBSTACLES);
+        avoidance.deinit();
+        avoidance.init();
+        const uint32_t now = AP_HAL::millis();
+
+        // one obstacle heading straight for home
+        Location loc = home;
+        location_offset(loc, 300, 0);
+        avoidance.add_obstacle(now, MAV_COLLISION_SRC_ADSB, 0x3fffff, loc, 180, 20, 0);
+
+        for (uint16_t i = 1; i < TEST_OBSTACLES; i++) {
+            loc = home;
+            location_update(loc, rand_float(0, 360), rand_float(100, 20000));
+            loc.alt += rand_float(-500, 500);
+            avoidance.add_obstacle(now, MAV_COLLISION_SRC_ADSB, 0x400000 + i, loc,
+                                   rand_float(0, 360), rand_float(0, 60), 0);
+        }
+    }
+
+    // always pick the NONE level obstacle to report, as happens while
+    // the GCS is sent cleared messages
+    void report_cleared()
+    {
+        avoidance._gcs_cleared_messages_first_sent = 0;
+    }
+
+    void check_for_threats(const Location &my_loc, const Vector3f &my_vel)
+    {
+        avoidance.check_for_threats(my_loc, my_vel);
+        for (uint8_t i = 0; i < avoidance._obstacle_count; i++) {
+            grid_levels[i] = avoidance._obstacles[i].threat_level;
+        }
+        grid_threat = avoidance._current_most_serious_threat;
+    }
+
+    void check_all_obstacles(const Location &my_loc, const Vector3f &my_vel)
+    {
+        const uint32_t now = AP_HAL::millis();
+        avoidance._current_most_serious_threat = -1;
+        for (uint8_t i = 0; i < avoidance._obstacle_count; i++) {
+            AP_Avoidance::Obstacle &obstacle = avoidance._obstacles[i];
+            avoidance.update_threat_level(my_loc, my_vel, obstacle);
+            if (now - obstacle.timestamp_ms > MAX_OBSTACLE_AGE_MS) {
+                continue;
+            }
+            if (avoidance.obstacle_is_more_serious_threat(obstacle)) {
+                avoidance._current_most_serious_threat = i;
+            }
+        }
+    }
+
+    void compare(const char *what)
+    {
+        uint8_t threats = 0;
+        for (uint8_t i = 0; i < avoidance._obstacle_count; i++) {
+            EXPECT_EQ(avoidance._obstacles[i].threat_level, grid_levels[i]) << what << " obstacle " << (int)i;
+            if (grid_levels[i] != MAV_COLLISION_THREAT_LEVEL_NONE) {
+                threats++;
+            }
+        }
+        EXPECT_EQ(avoidance._current_most_serious_threat, grid_threat) << what;
+        total_threats += threats;
+    }
+
+    MAV_COLLISION_THREAT_LEVEL threat_level(uint8_t i) const
+    {
+        return avoidance._obstacles[i].threat_level;
+    }
+
+    int8_t most_serious_threat() const
+    {
+        return avoidance._current_most_serious_threat;
+    }
+
+    Location home {};
+    uint16_t total_threats;
+
+private:
+    class Avoidance : public AP_Avoidance {
+    public:
+        using AP_Avoidance::AP_Avoidance;
+    protected:
+        MAV_COLLISION_ACTION handle_avoidance(const AP_Avoidance::Obstacle *obstacle,
+                                              MAV_COLLISION_ACTION requested_action) override {
+            return requested_action;
+        }
+        void handle_recovery(uint8_t recovery_action) override {}
+    };
+
+    AP_InertialSensor ins;
+    AP_Baro baro;
+    AP_GPS gps;
+    AP_AHRS_DCM ahrs{ins, baro, gps};
+    AP_ADSB adsb{ahrs};
+    Avoidance avoidance{ahrs, adsb};
+
+    MAV_COLLISION_THREAT_LEVEL grid_levels[TEST_OBSTACLES];
+    int8_t grid_threat;
+};
+
+// the vehicle libraries expect to be statically allocated
+static AP_Avoidance_Test test;
+
+TEST(AvoidanceGrid, MatchesFullScan)
+{
+    test.setup();
+    test.report_cleared();
+    test.total_threats = 0;
+
+    // fly across the obstacle field so obstacles enter and leave the
+    // search radius and the grid gets recentred
+    Location my_loc = test.home;
+    const Vector3f my_vel{30, 20, 0};
+    for (uint16_t step = 0; step < 60; step++) {
+        test.check_for_threats(my_loc, my_vel);
+        test.check_all_obstacles(my_loc, my_vel);
+        test.compare("moving");
+        location_offset(my_loc, 500, 300);
+    }
+
+    // make sure the comparison wasn't only of NONE levels
+    EXPECT_GT(test.total_threats, 0);
+}
+
+TEST(AvoidanceGrid, NoneLevelPickMatchesFullScan)
+{
+    test.setup();
+    test.report_cleared();
+
+    // far from every obstacle, so nothing is a threat
+    Location my_loc = test.home;
+    location_offset(my_loc, 60000, 0);
+    const Vector3f my_vel{1, 0, 0};
+    test.check_for_threats(my_loc, my_vel);
+    EXPECT_NE(-1, test.most_serious_threat());
+    test.check_all_obstacles(my_loc, my_vel);
+    test.compare("far");
+}
+
+TEST(AvoidanceGrid, ThreatClearsOutsideRadius)
+{
+    test.setup();
+
+    // the obstacle heading for home is a threat while we stand still there
+    const Vector3f still{0, 0, 0};
+    test.check_for_threats(test.home, still);
+    const int8_t threat = test.most_serious_threat();
+    ASSERT_NE(-1, threat);
+    ASSERT_NE(MAV_COLLISION_THREAT_LEVEL_NONE, test.threat_level(threat));
+
+    // once far away no obstacle may keep a stale threat level
+    Location my_loc = test.home;
+    location_offset(my_loc, 60000, 0);
+    test.check_for_threats(my_loc, still);
+    for (uint8_t i = 0; i < TEST_OBSTACLES; i++) {
+        EXPECT_EQ(MAV_COLLISION_THREAT_LEVEL_NONE, test.threat_level(i)) << "obstacle " << (int)i;
+    }
+}
+
+AP_GTEST_MAIN()
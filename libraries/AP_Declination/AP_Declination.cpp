@@ -29,6 +29,8 @@
 #include <AP_Common/AP_Common.h>
 #include <AP_Math/AP_Math.h>
 
+#include "AP_Declination_tables.h"
+
 // 1 byte - 4 bits for value + 1 bit for sign + 3 bits for repeats => 8 bits
 struct row_value {
 
@@ -109,32 +111,147 @@ static const row_value declination_values[] = {
     {0,0,0},{3,0,5},{2,0,1},{1,0,0},{0,0,0},{1,1,0},{2,1,0},{5,1,0},{8,1,0},{12,1,0},{14,1,0},{13,1,0},{9,1,0},{6,1,0},{3,1,0},{1,1,0},{0,0,0},{2,0,0},{1,0,0},{3,0,0},{2,0,0},{3,0,0},{4,0,0},{3,0,1},{4,0,0},{3,0,0},{4,0,1},{3,0,0},{4,0,0},{3,0,2},{4,0,0},{3,0,1},{4,0,0},{3,0,0},{2,0,0},{3,0,0},{2,0,2},{0,0,1},{1,1,0},{2,1,0},{4,1,0},{5,1,0},{7,1,0},{8,1,0},{6,1,1},{5,1,0},{3,1,0},{1,1,1},{1,0,1},{2,0,0},{3,0,0},{2,0,0},{3,0,1},{2,0,0},{3,0,0},
 };
 
-float
-AP_Declination::get_declination(float lat, float lon)
+void
+AP_Declination::get_cell(float lat, float lon, uint8_t &lat_index, uint8_t &lon_index, float &lat_frac, float &lon_frac)
 {
-    int16_t decSW, decSE, decNW, decNE, lonmin, latmin;
-    uint8_t latmin_index,lonmin_index;
-    float decmin, decmax;
+    int16_t lonmin, latmin;
 
     // Constrain to valid inputs
     lat = constrain_float(lat, -90, 90);
     lon = constrain_float(lon, -180, 180);
 
-    latmin = floorf(lat/5)*5;
-    lonmin = floorf(lon/5)*5;
+    // the last row and column are only ever the far corners of a cell
+    latmin = MIN(floorf(lat/5)*5, 85);
+    lonmin = MIN(floorf(lon/5)*5, 175);
+
+    lat_index = (90+latmin)/5;
+    lon_index = (180+lonmin)/5;
+
+    lat_frac = (lat - latmin) / 5;
+    lon_frac = (lon - lonmin) / 5;
+}
+
+float
+AP_Declination::get_declination(float lat, float lon)
+{
+    uint8_t latmin_index, lonmin_index;
+    float lat_frac, lon_frac;
 
-    latmin_index= (90+latmin)/5;
-    lonmin_index= (180+lonmin)/5;
+    get_cell(lat, lon, latmin_index, lonmin_index, lat_frac, lon_frac);
 
-    decSW = get_lookup_value(latmin_index, lonmin_index);
-    decSE = get_lookup_value(latmin_index, lonmin_index+1);
-    decNE = get_lookup_value(latmin_index+1, lonmin_index+1);
-    decNW = get_lookup_value(latmin_index+1, lonmin_index);
+    const float dec[4] = {
+        (float)get_lookup_value(latmin_index, lonmin_index),
+        (float)get_lookup_value(latmin_index, lonmin_index+1),
+        (float)get_lookup_value(latmin_index+1, lonmin_index),
+        (float)get_lookup_value(latmin_index+1, lonmin_index+1)
+    };
 
     /* approximate declination within the grid using bilinear interpolation */
-    decmin = (lon - lonmin) / 5 * (decSE - decSW) + decSW;
-    decmax = (lon - lonmin) / 5 * (decNE - decNW) + decNW;
-    return (lat - latmin) / 5 * (decmax - decmin) + decmin;
+    return interpolate(dec, lat_frac, lon_frac);
+}
+
+bool
+AP_Declination::get_mag_field_ef(float lat, float lon, float &intensity, float &declination, float &inclination)
+{
+    FieldCache cache;
+    return cache.get_mag_field_ef(lat, lon, intensity, declination, inclination);
+}
+
+void
+AP_Declination::FieldCache::load(uint8_t lat_index, uint8_t lon_index)
+{
+    if (lat_index == _lat_index && lon_index == _lon_index) {
+        return;
+    }
+
+    const uint8_t lat_corner[4] = { lat_index, lat_index, (uint8_t)(lat_index+1), (uint8_t)(lat_index+1) };
+    const uint8_t lon_corner[4] = { lon_index, (uint8_t)(lon_index+1), lon_index, (uint8_t)(lon_index+1) };
+
+    for (uint8_t i = 0; i < 4; i++) {
+        _declination[i] = get_lookup_value(lat_corner[i], lon_corner[i]);
+        _inclination[i] = inclination_table[lat_corner[i]][lon_corner[i]];
+        _intensity[i] = intensity_table[lat_corner[i]][lon_corner[i]] * AP_DECLINATION_INTENSITY_SCALE;
+    }
+
+    _lat_index = lat_index;
+    _lon_index = lon_index;
+}
+
+float
+AP_Declination::FieldCache::get_declination(float lat, float lon)
+{
+    uint8_t lat_index, lon_index;
+    float lat_frac, lon_frac;
+
+    get_cell(lat, lon, lat_index, lon_index, lat_frac, lon_frac);
+    load(lat_index, lon_index);
+
+    return interpolate(_declination, lat_frac, lon_frac);
+}
+
+bool
+AP_Declination::FieldCache::get_mag_field_ef(float lat, float lon, float &intensity, float &declination, float &inclination)
+{
+    if (isnan(lat) || isnan(lon)) {
+        return false;
+    }
+
+    uint8_t lat_index, lon_index;
+    float lat_frac, lon_frac;
+
+    get_cell(lat, lon, lat_index, lon_index, lat_frac, lon_frac);
+    load(lat_index, lon_index);
+
+    intensity = interpolate(_intensity, lat_frac, lon_frac);
+    declination = interpolate(_declination, lat_frac, lon_frac);
+    inclination = interpolate(_inclination, lat_frac, lon_frac);
+    return true;
+}
+
+void
+AP_Declination::FieldCache::get_mag_field_ef(uint16_t count, const float *lat, const float *lon,
+                                             float *intensity, float *declination, float *inclination)
+{
+    for (uint16_t i = 0; i < count; i++) {
+        if (isnan(lat[i]) || isnan(lon[i])) {
+            if (intensity) {
+                intensity[i] = NAN;
+            }
+            if (declination) {
+                declination[i] = NAN;
+            }
+            if (inclination) {
+                inclination[i] = NAN;
+            }
+            continue;
+        }
+
+        uint8_t lat_index, lon_index;
+        float lat_frac, lon_frac;
+
+        const float latmin = _lat_index * 5 - 90;
+        const float lonmin = _lon_index * 5 - 180;
+        if (_lat_index >= 0 && lat[i] >= latmin && lat[i] < latmin + 5 &&
+            lon[i] >= lonmin && lon[i] < lonmin + 5) {
+            // inside the cached cell, so get_cell() would give the same
+            // cell and the same fractions
+            lat_frac = (lat[i] - latmin) / 5;
+            lon_frac = (lon[i] - lonmin) / 5;
+        } else {
+            get_cell(lat[i], lon[i], lat_index, lon_index, lat_frac, lon_frac);
+            load(lat_index, lon_index);
+        }
+
+        if (intensity) {
+            intensity[i] = interpolate(_intensity, lat_frac, lon_frac);
+        }
+        if (declination) {
+            declination[i] = interpolate(_declination, lat_frac, lon_frac);
+        }
+        if (inclination) {
+            inclination[i] = interpolate(_inclination, lat_frac, lon_frac);
+        }
+    }
 }
 
 int16_t
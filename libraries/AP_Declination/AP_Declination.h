@@ -15,6 +15,56 @@ class AP_Declination
 {
 public:
     static float            get_declination(float lat, float lon);
+
+    /*
+      earth's magnetic field at a location. Intensity is in gauss,
+      declination and inclination in degrees. Returns false for an
+      invalid location
+     */
+    static bool             get_mag_field_ef(float lat, float lon, float &intensity, float &declination, float &inclination);
+
+    /*
+      Lookups cached on the current 5 degree grid cell. The field at the
+      corners of the cell is decoded once, so repeated queries near the
+      vehicle only cost the interpolation. Each user should have its
+      own cache
+     */
+    class FieldCache {
+    public:
+        float get_declination(float lat, float lon);
+        bool get_mag_field_ef(float lat, float lon, float &intensity, float &declination, float &inclination);
+
+        /*
+          look up count points at once. Runs of points in the same cell
+          share one decode. Invalid locations give NaN outputs. Any of
+          the output arrays may be null
+         */
+        void get_mag_field_ef(uint16_t count, const float *lat, const float *lon,
+                              float *intensity, float *declination, float *inclination);
+
+    private:
+        // decode the corners of a cell if it isn't the cached one
+        void load(uint8_t lat_index, uint8_t lon_index);
+
+        int8_t _lat_index = -1;
+        int8_t _lon_index = -1;
+
+        // corner values in the order SW, SE, NW, NE
+        float _declination[4];
+        float _inclination[4];
+        float _intensity[4];
+    };
+
 private:
     static int16_t          get_lookup_value(uint8_t x, uint8_t y);
+
+    // grid cell containing a location and the position within it, 0 to 1
+    static void             get_cell(float lat, float lon, uint8_t &lat_index, uint8_t &lon_index, float &lat_frac, float &lon_frac);
+
+    // bilinear interpolation of corners in the order SW, SE, NW, NE
+    static float            interpolate(const float corners[4], float lat_frac, float lon_frac) {
+        const float min = lon_frac * (corners[1] - corners[0]) + corners[0];
+        const float max = lon_frac * (corners[3] - corners[2]) + corners[2];
+        return lat_frac * (max - min) + min;
+    }
 };
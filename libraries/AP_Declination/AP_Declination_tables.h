@@ -0,0 +1,88 @@
+// generated by generate/generate_field_tables.py - do not edit
+#pragma once
+
+// units of intensity_table in gauss
+#define AP_DECLINATION_INTENSITY_SCALE 0.005f
+
+// inclination in degrees, latitude -90 to 90 by rows and longitude -180 to 180 by columns
+static const int8_t inclination_table[37][73] = {
+    {-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71,-71},
+    {-74,-74,-74,-74,-74,-74,-73,-73,-73,-72,-72,-72,-72,-71,-71,-71,-70,-70,-70,-69,-69,-69,-69,-69,-68,-68,-68,-68,-68,-68,-68,-68,-68,-68,-68,-68,-68,-68,-68,-68,-68,-69,-69,-69,-69,-70,-70,-70,-70,-71,-71,-71,-72,-72,-72,-73,-73,-73,-73,-74,-74,-74,-74,-74,-75,-75,-75,-75,-75,-75,-75,-75,-74},
+    {-78,-77,-77,-76,-76,-76,-75,-74,-74,-73,-73,-72,-72,-71,-70,-70,-69,-69,-68,-68,-67,-67,-66,-66,-66,-65,-65,-65,-65,-65,-64,-64,-64,-64,-65,-65,-65,-65,-65,-66,-66,-66,-67,-67,-67,-68,-68,-69,-70,-70,-71,-71,-72,-73,-73,-74,-75,-75,-76,-76,-77,-77,-78,-78,-78,-78,-78,-78,-78,-78,-78,-78,-78},
+    {-80,-80,-79,-78,-78,-77,-76,-75,-74,-73,-73,-72,-71,-70,-69,-69,-68,-67,-66,-66,-65,-64,-64,-63,-63,-63,-62,-62,-62,-62,-62,-62,-62,-62,-62,-62,-62,-62,-63,-63,-64,-64,-65,-65,-66,-66,-67,-68,-69,-70,-71,-71,-72,-73,-74,-75,-76,-77,-78,-79,-79,-80,-81,-81,-82,-82,-82,-82,-82,-82,-81,-81,-80},
+    {-82,-81,-80,-79,-78,-77,-76,-75,-74,-73,-72,-71,-70,-69,-68,-67,-66,-65,-64,-63,-63,-62,-61,-61,-60,-60,-60,-60,-59,-59,-59,-59,-59,-60,-60,-60,-60,-61,-61,-61,-62,-62,-63,-64,-64,-65,-66,-67,-68,-69,-70,-71,-73,-74,-75,-76,-77,-79,-80,-81,-82,-83,-84,-85,-85,-86,-86,-85,-85,-84,-83,-82,-82},
+    {-81,-80,-79,-78,-77,-76,-75,-74,-73,-71,-70,-69,-68,-67,-66,-65,-64,-63,-62,-61,-60,-59,-59,-58,-58,-58,-57,-57,-57,-58,-58,-58,-58,-58,-59,-59,-59,-60,-60,-60,-61,-61,-62,-63,-64,-64,-65,-67,-68,-69,-70,-71,-73,-74,-76,-77,-79,-80,-81,-83,-84,-85,-87,-88,-89,-89,-88,-87,-85,-84,-83,-82,-81},
+    {-79,-78,-77,-76,-75,-74,-73,-71,-70,-69,-68,-67,-66,-65,-63,-62,-61,-60,-59,-58,-57,-57,-56,-56,-55,-55,-55,-56,-56,-56,-57,-57,-58,-58,-59,-59,-59,-60,-60,-60,-61,-61,-62,-62,-63,-64,-65,-66,-67,-69,-70,-72,-73,-75,-76,-78,-79,-81,-82,-84,-85,-86,-87,-88,-87,-86,-85,-84,-83,-82,-81,-80,-79},
+    {-75,-74,-73,-72,-72,-71,-70,-69,-68,-67,-66,-64,-63,-62,-61,-59,-58,-57,-56,-55,-54,-53,-53,-53,-53,-53,-54,-54,-55,-56,-57,-58,-59,-59,-60,-60,-61,-61,-61,-61,-61,-62,-62,-63,-63,-64,-65,-66,-67,-69,-70,-72,-73,-75,-76,-78,-79,-81,-82,-83,-84,-84,-84,-84,-83,-83,-82,-81,-80,-78,-77,-76,-75},
+    {-71,-71,-70,-69,-68,-67,-66,-65,-64,-63,-62,-61,-60,-59,-57,-56,-55,-53,-52,-51,-50,-50,-50,-50,-50,-51,-52,-53,-55,-56,-57,-59,-60,-61,-62,-62,-63,-63,-63,-63,-63,-63,-63,-63,-64,-64,-65,-66,-67,-69,-70,-71,-73,-74,-76,-77,-78,-79,-80,-81,-81,-81,-81,-80,-80,-79,-78,-77,-76,-75,-74,-72,-71},
+    {-67,-66,-65,-65,-64,-63,-62,-61,-60,-60,-59,-57,-56,-55,-54,-52,-51,-49,-48,-47,-46,-46,-46,-46,-47,-48,-50,-52,-54,-56,-58,-60,-62,-63,-64,-65,-65,-65,-65,-65,-64,-64,-64,-64,-64,-64,-65,-66,-67,-68,-69,-71,-72,-73,-74,-76,-76,-77,-78,-78,-78,-78,-77,-76,-76,-75,-74,-73,-71,-70,-69,-68,-67},
+    {-63,-62,-61,-60,-59,-58,-58,-57,-56,-55,-54,-53,-52,-51,-49,-48,-46,-45,-43,-42,-42,-41,-41,-42,-44,-45,-48,-50,-53,-56,-58,-61,-63,-64,-66,-66,-67,-67,-66,-66,-65,-65,-64,-64,-64,-64,-65,-65,-66,-67,-68,-69,-71,-72,-72,-73,-74,-74,-74,-74,-74,-74,-73,-72,-71,-70,-69,-68,-67,-66,-65,-64,-63},
+    {-58,-57,-56,-55,-54,-53,-53,-52,-51,-50,-49,-48,-47,-46,-44,-43,-41,-39,-38,-37,-36,-36,-36,-37,-39,-42,-45,-48,-51,-54,-57,-60,-63,-65,-66,-67,-67,-67,-67,-66,-65,-65,-64,-63,-63,-63,-63,-64,-65,-66,-66,-67,-68,-69,-70,-70,-70,-70,-70,-70,-70,-69,-68,-68,-67,-66,-65,-64,-62,-61,-60,-59,-58},
+    {-53,-51,-50,-49,-49,-48,-47,-46,-46,-45,-44,-43,-42,-40,-39,-37,-35,-33,-32,-31,-30,-30,-30,-32,-34,-37,-41,-44,-48,-52,-56,-59,-61,-64,-65,-66,-66,-66,-66,-65,-64,-63,-62,-62,-61,-61,-61,-62,-62,-63,-63,-64,-65,-65,-66,-66,-66,-66,-66,-65,-65,-64,-63,-63,-62,-61,-60,-59,-57,-56,-55,-54,-53},
+    {-47,-46,-44,-43,-43,-42,-41,-40,-39,-39,-38,-37,-35,-34,-32,-30,-28,-26,-25,-23,-23,-23,-23,-25,-28,-32,-36,-40,-44,-49,-53,-56,-59,-61,-63,-64,-64,-64,-63,-62,-61,-60,-59,-58,-58,-58,-58,-58,-58,-59,-59,-60,-60,-61,-61,-61,-61,-61,-60,-60,-59,-59,-58,-57,-56,-55,-54,-53,-52,-51,-49,-48,-47},
+    {-41,-39,-38,-37,-36,-35,-34,-33,-32,-32,-31,-29,-28,-26,-24,-22,-20,-18,-16,-15,-14,-15,-16,-18,-21,-25,-30,-35,-39,-44,-48,-52,-55,-57,-59,-59,-60,-59,-58,-57,-56,-55,-54,-53,-53,-53,-53,-53,-53,-53,-54,-54,-55,-55,-55,-55,-55,-54,-54,-53,-53,-52,-52,-51,-50,-49,-48,-47,-46,-45,-43,-42,-41},
+    {-34,-32,-31,-29,-28,-27,-26,-25,-24,-24,-22,-21,-20,-18,-16,-14,-12,-9,-8,-6,-6,-6,-7,-10,-13,-18,-23,-28,-33,-38,-43,-46,-49,-52,-53,-54,-54,-53,-52,-51,-50,-49,-48,-47,-46,-46,-46,-46,-46,-47,-47,-47,-48,-48,-48,-47,-47,-47,-47,-46,-46,-45,-45,-44,-43,-42,-41,-40,-39,-38,-37,-35,-34},
+    {-26,-24,-23,-21,-20,-19,-18,-17,-16,-15,-13,-12,-10,-9,-7,-4,-2,0,2,3,3,3,1,-1,-5,-10,-15,-20,-26,-31,-36,-39,-43,-45,-46,-47,-47,-46,-45,-44,-42,-41,-40,-39,-38,-38,-38,-38,-38,-39,-39,-39,-39,-39,-39,-39,-39,-38,-38,-38,-37,-37,-36,-36,-35,-35,-34,-33,-32,-31,-29,-28,-26},
+    {-18,-16,-14,-13,-11,-10,-9,-8,-6,-5,-4,-2,-1,1,3,5,7,9,11,12,12,12,10,7,4,-1,-6,-12,-17,-22,-27,-31,-34,-36,-38,-38,-38,-37,-36,-35,-33,-32,-31,-30,-29,-29,-29,-29,-29,-29,-29,-30,-30,-30,-29,-29,-29,-29,-28,-28,-28,-27,-27,-27,-26,-26,-25,-24,-23,-22,-21,-19,-18},
+    {-9,-7,-5,-4,-2,-1,1,2,3,5,6,7,9,11,13,15,17,18,20,21,21,20,18,16,12,8,3,-2,-8,-13,-18,-21,-25,-27,-28,-28,-28,-27,-26,-25,-23,-22,-20,-19,-18,-18,-18,-18,-18,-18,-18,-19,-19,-18,-18,-18,-18,-18,-17,-17,-17,-17,-17,-16,-16,-16,-16,-15,-14,-13,-12,-11,-9},
+    {0,2,4,6,7,9,10,12,13,14,16,17,19,20,22,24,25,27,28,29,29,28,26,24,21,17,12,7,2,-3,-7,-11,-14,-16,-17,-18,-17,-16,-15,-13,-12,-10,-9,-8,-7,-7,-6,-6,-6,-7,-7,-7,-7,-6,-6,-6,-6,-6,-5,-5,-5,-5,-5,-5,-6,-6,-5,-5,-5,-4,-3,-1,0},
+    {10,11,13,15,16,18,19,21,22,23,25,26,28,29,31,32,34,35,36,36,36,35,34,32,29,25,21,17,12,8,4,0,-2,-4,-5,-6,-5,-5,-3,-2,0,1,3,4,5,5,5,5,6,6,6,6,6,6,6,6,7,7,7,7,7,6,6,6,5,5,5,5,5,6,7,8,10},
+    {19,20,22,23,25,26,28,29,31,32,33,34,36,37,38,40,41,42,43,43,43,42,41,39,36,33,30,26,22,18,14,11,9,7,6,6,6,7,8,10,11,13,14,15,16,16,17,17,17,17,17,17,18,18,18,18,18,19,19,18,18,18,17,17,16,16,15,15,15,16,16,17,19},
+    {27,28,30,31,33,34,35,37,38,39,41,42,43,44,45,47,48,48,49,49,49,48,47,45,43,40,37,34,31,28,25,22,20,19,18,17,18,18,19,21,22,23,24,25,26,27,27,28,28,28,28,28,29,29,29,29,29,29,29,29,29,28,28,27,26,26,25,25,25,25,25,26,27},
+    {35,36,37,38,40,41,42,44,45,46,47,48,50,51,52,53,53,54,55,55,54,54,53,51,49,47,44,42,39,36,34,32,30,29,28,28,28,29,30,31,32,33,34,35,36,36,37,37,38,38,38,38,39,39,39,39,39,39,39,39,38,38,37,36,35,35,34,34,33,33,34,34,35},
+    {42,43,44,45,46,47,49,50,51,52,53,54,55,56,57,58,59,59,60,60,59,59,58,56,55,53,51,48,46,44,42,40,39,38,37,37,37,38,39,40,40,41,42,43,44,45,45,46,46,46,47,47,47,47,48,48,48,48,47,47,46,46,45,44,43,43,42,41,41,41,41,41,42},
+    {49,49,50,51,52,53,54,55,56,58,59,60,61,61,62,63,64,64,64,64,64,63,62,61,60,58,56,54,53,51,49,48,47,46,46,45,46,46,47,47,48,49,50,50,51,52,52,53,53,54,54,54,55,55,55,55,55,55,54,54,53,53,52,51,50,50,49,48,48,48,48,48,49},
+    {54,55,56,56,57,58,59,60,61,62,63,64,65,66,67,67,68,68,68,68,68,67,67,65,64,63,61,60,58,57,56,54,54,53,53,52,53,53,53,54,55,55,56,57,57,58,59,59,60,60,60,61,61,61,61,61,61,61,61,60,60,59,58,57,57,56,55,55,54,54,54,54,54},
+    {60,60,61,61,62,63,64,65,66,67,68,69,69,70,71,71,72,72,72,72,72,71,70,69,68,67,66,65,63,62,61,60,59,59,59,59,59,59,59,60,60,61,62,62,63,64,64,65,65,66,66,66,66,67,67,67,67,66,66,65,65,64,63,63,62,61,61,60,60,59,59,59,60},
+    {64,65,65,66,66,67,68,69,70,71,71,72,73,74,74,75,75,76,76,75,75,74,74,73,72,71,70,69,68,67,66,65,65,64,64,64,64,64,64,65,65,66,66,67,68,68,69,69,70,70,71,71,71,71,71,71,71,71,71,70,69,69,68,67,67,66,65,65,64,64,64,64,64},
+    {69,69,69,70,70,71,72,72,73,74,75,76,76,77,78,78,78,79,79,78,78,77,77,76,75,74,73,72,72,71,70,69,69,69,68,68,68,69,69,69,70,70,71,71,72,72,73,73,74,74,75,75,75,75,75,75,75,75,75,74,73,73,72,71,71,70,70,69,69,69,68,68,69},
+    {73,73,73,73,74,75,75,76,77,77,78,79,79,80,81,81,81,81,81,81,81,80,79,79,78,77,76,76,75,74,74,73,73,73,72,72,72,73,73,73,73,74,74,75,75,76,76,77,77,78,78,78,79,79,79,79,79,78,78,77,77,76,76,75,74,74,73,73,73,73,72,72,73},
+    {76,76,77,77,77,78,78,79,79,80,81,81,82,82,83,83,84,84,84,83,83,82,82,81,80,80,79,79,78,77,77,77,76,76,76,76,76,76,76,76,77,77,77,78,78,79,79,80,80,81,81,81,82,82,82,82,81,81,81,80,80,79,79,78,78,77,77,77,76,76,76,76,76},
+    {79,80,80,80,80,81,81,82,82,83,83,84,84,85,85,85,86,86,85,85,85,84,84,83,83,82,82,81,81,80,80,80,79,79,79,79,79,79,79,79,80,80,80,81,81,81,82,82,83,83,83,84,84,84,84,84,84,84,83,83,82,82,82,81,81,80,80,80,80,79,79,79,79},
+    {82,83,83,83,83,83,84,84,84,85,85,86,86,86,87,87,87,87,87,87,86,86,86,85,85,84,84,83,83,83,83,82,82,82,82,82,82,82,82,82,82,83,83,83,83,84,84,84,85,85,85,85,86,86,86,86,86,85,85,85,85,84,84,84,83,83,83,83,83,82,82,82,82},
+    {85,85,85,86,86,86,86,86,87,87,87,88,88,88,88,88,88,88,88,88,88,87,87,87,86,86,86,86,85,85,85,85,85,85,85,84,84,84,85,85,85,85,85,85,85,86,86,86,86,87,87,87,87,87,87,87,87,87,87,87,87,86,86,86,86,86,86,85,85,85,85,85,85},
+    {88,88,88,88,88,88,88,89,89,89,89,89,89,89,90,90,89,89,89,89,89,89,88,88,88,88,88,88,87,87,87,87,87,87,87,87,87,87,87,87,87,87,87,87,87,88,88,88,88,88,88,88,88,88,88,88,88,88,88,88,88,88,88,88,88,88,88,88,88,88,88,88,88},
+    {89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89},
+};
+
+// intensity in units of AP_DECLINATION_INTENSITY_SCALE, on the same grid
+static const uint8_t intensity_table[37][73] = {
+    {107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107},
+    {115,114,114,114,113,113,112,112,111,110,110,109,108,108,107,106,106,105,104,104,103,102,102,101,101,100,100,99,99,99,99,99,98,98,99,99,99,99,99,100,100,101,101,102,102,103,104,104,105,106,107,107,108,109,109,110,111,111,112,113,113,114,114,114,115,115,115,115,115,115,115,115,115},
+    {121,120,119,119,118,117,116,115,114,113,111,110,109,107,106,105,103,102,101,99,98,97,96,95,94,93,92,91,91,90,90,90,89,89,89,90,90,91,91,92,93,94,95,96,97,98,100,101,103,104,105,107,108,110,111,113,114,115,116,117,118,119,120,121,121,121,122,122,122,122,121,121,121},
+    {125,124,123,122,121,120,118,117,115,114,112,110,108,106,104,102,100,99,97,95,93,91,90,88,87,85,84,83,82,82,81,81,80,80,80,81,81,82,83,84,85,86,88,90,91,93,95,97,100,102,104,106,108,111,113,115,117,118,120,121,123,124,125,126,126,127,127,127,127,127,127,126,125},
+    {128,127,126,124,123,121,119,117,115,113,111,109,106,104,102,99,97,95,92,90,88,86,83,82,80,78,77,75,74,73,73,72,72,72,72,72,73,74,75,76,78,79,81,84,86,88,91,94,97,99,102,105,108,111,114,116,119,121,123,125,126,128,129,130,130,131,131,131,131,131,130,129,128},
+    {129,128,126,124,123,121,119,116,114,112,109,106,104,101,98,96,93,90,87,85,82,80,77,75,73,71,70,68,67,66,65,64,64,64,64,65,65,66,68,69,71,73,75,78,81,84,87,90,94,97,101,104,108,111,114,117,120,123,125,127,129,130,132,132,133,133,134,133,133,132,131,130,129},
+    {128,127,125,123,121,119,116,114,111,109,106,103,100,97,94,91,88,85,82,79,77,74,71,69,67,65,63,62,60,59,59,58,58,58,58,58,59,60,62,63,65,68,70,73,76,80,83,87,91,95,99,103,107,111,114,118,121,124,126,128,130,132,133,134,134,134,134,134,133,132,131,130,128},
+    {126,124,122,120,117,115,113,110,108,105,102,99,96,93,90,87,83,80,77,74,71,68,66,63,61,59,58,56,55,54,53,53,53,53,53,54,54,56,57,59,61,63,66,69,73,76,80,85,89,93,98,102,106,110,114,118,121,124,127,129,131,132,133,134,134,134,133,133,132,130,129,127,126},
+    {122,119,117,115,113,110,108,105,103,100,97,94,91,88,85,82,78,75,72,69,66,63,61,58,56,54,53,52,51,50,50,50,50,50,50,51,52,53,54,56,58,60,63,66,70,74,78,83,87,92,97,101,106,110,114,118,121,124,126,128,130,131,132,132,132,132,131,130,129,127,125,124,122},
+    {116,114,112,109,107,105,102,100,97,95,92,89,86,83,80,77,74,70,67,64,61,59,56,54,52,51,50,49,48,48,48,48,48,49,49,50,50,51,53,54,56,59,61,65,68,72,76,81,86,91,95,100,105,109,113,117,120,123,125,127,128,129,129,129,129,128,127,126,124,122,120,118,116},
+    {110,108,105,103,101,98,96,94,91,89,86,84,81,78,75,72,69,66,63,60,57,55,53,51,49,48,47,47,47,47,47,48,48,49,50,50,51,52,53,54,56,58,61,64,67,71,75,80,85,89,94,99,103,108,112,115,118,121,123,124,125,126,126,125,125,124,122,121,119,117,114,112,110},
+    {103,101,98,96,94,92,90,88,85,83,81,78,76,73,70,68,65,62,59,56,54,52,50,48,47,46,46,46,46,47,48,49,50,50,51,52,52,53,54,55,56,58,61,63,67,70,75,79,84,88,93,98,102,106,109,113,115,118,119,121,121,122,121,121,120,118,116,114,112,110,108,105,103},
+    {96,93,91,89,87,85,83,81,79,78,75,73,71,69,66,64,61,58,56,53,51,49,48,46,46,45,45,46,47,48,49,50,51,52,53,54,54,55,55,56,57,59,61,63,67,70,74,78,83,87,91,96,100,103,107,110,112,114,115,116,117,116,116,115,114,112,110,108,105,103,101,98,96},
+    {89,86,84,82,81,79,77,76,74,72,71,69,67,65,63,60,58,56,54,51,50,48,47,46,45,45,45,46,47,49,50,52,53,54,55,56,56,57,57,58,59,60,61,64,66,70,73,77,81,85,89,93,97,100,103,106,108,110,111,111,111,111,110,109,107,105,103,101,98,96,94,91,89},
+    {82,80,78,76,75,73,72,70,69,68,66,65,63,62,60,58,56,54,52,51,49,48,46,46,45,45,46,47,48,50,52,53,55,56,57,58,58,58,59,59,59,60,62,64,66,69,72,76,80,83,87,91,94,97,99,102,103,104,105,105,105,105,103,102,100,98,96,94,92,89,87,84,82},
+    {76,74,73,71,70,68,67,66,65,64,63,62,61,59,58,57,55,54,52,51,49,48,47,47,46,47,47,48,50,51,53,55,56,57,58,59,59,59,59,60,60,61,62,64,66,68,71,74,78,81,84,87,90,93,95,97,98,99,99,99,99,98,97,96,94,92,90,87,85,83,80,78,76},
+    {71,70,68,67,66,65,64,63,63,62,61,60,59,59,58,56,55,54,53,52,51,50,49,49,48,48,49,50,51,52,54,56,57,58,59,60,60,60,60,60,60,61,62,63,65,68,70,73,76,79,82,84,87,89,91,92,93,94,94,94,93,92,91,89,88,86,84,82,79,77,75,73,71},
+    {68,66,65,64,63,63,62,62,61,61,60,60,60,59,58,58,57,56,56,55,54,53,52,52,51,51,51,51,52,54,55,56,57,58,59,60,60,60,60,60,61,61,62,63,65,67,69,72,74,77,79,81,84,85,87,88,89,89,89,89,88,87,86,84,83,81,79,77,75,73,71,69,68},
+    {65,64,63,63,62,62,62,61,61,61,61,61,61,61,61,60,60,60,59,59,58,57,56,56,55,54,54,54,54,55,56,57,58,59,60,60,60,60,61,61,61,62,63,64,65,67,69,71,73,75,78,80,81,83,84,85,85,86,85,85,84,83,82,80,79,77,75,73,71,69,68,66,65},
+    {64,63,63,63,62,62,63,63,63,63,64,64,64,64,64,64,64,64,64,64,63,62,61,60,59,58,58,57,57,57,58,58,59,60,60,61,61,61,61,62,62,63,64,65,67,68,70,72,74,76,77,79,80,82,83,83,84,84,84,83,82,81,80,78,76,75,73,71,69,68,66,65,64},
+    {65,64,64,64,64,64,65,65,66,67,67,68,68,69,69,69,70,70,70,69,69,68,67,66,65,63,62,61,61,60,60,60,61,61,61,62,62,63,63,64,65,65,67,68,69,71,72,74,76,77,79,80,82,83,83,84,84,84,84,83,82,81,79,78,76,74,72,71,69,68,66,65,65},
+    {67,66,66,67,67,68,68,69,70,71,72,73,73,74,75,75,76,76,76,75,75,74,73,72,70,69,68,66,65,65,64,64,64,64,64,64,65,65,66,67,68,69,70,72,73,74,76,78,79,81,82,83,85,85,86,87,87,86,86,85,84,83,81,79,77,75,74,72,70,69,68,67,67},
+    {70,70,70,70,71,72,73,74,75,76,77,78,79,80,81,81,82,82,82,82,81,80,79,78,77,75,73,72,70,69,68,68,68,67,68,68,68,69,70,71,72,73,75,76,78,79,81,82,84,85,87,88,89,90,90,91,91,90,90,89,87,86,84,82,80,78,76,75,73,72,71,70,70},
+    {74,74,74,75,76,77,78,79,80,82,83,84,85,86,87,88,88,88,89,88,88,87,86,84,83,81,79,78,76,75,74,73,72,72,72,73,73,74,75,76,77,79,80,82,83,85,87,88,90,91,92,93,94,95,96,96,96,95,95,93,92,90,88,86,84,82,80,78,77,75,75,74,74},
+    {78,79,79,80,81,82,83,85,86,87,89,90,91,92,93,94,94,95,95,94,94,93,92,90,89,87,85,84,82,80,79,78,78,77,77,78,78,79,80,81,83,84,86,87,89,91,92,94,95,97,98,99,100,101,101,101,101,101,100,99,97,95,93,91,89,87,85,83,81,80,79,79,78},
+    {84,84,84,85,86,87,89,90,91,93,94,96,97,98,99,99,100,100,100,100,99,98,97,96,94,93,91,89,88,86,85,84,83,83,83,83,84,85,86,87,88,90,91,93,95,96,98,100,101,102,104,105,106,106,107,107,106,106,105,103,102,100,98,96,94,92,90,88,86,85,84,84,84},
+    {89,89,89,90,91,92,94,95,97,98,99,101,102,103,104,104,105,105,105,104,104,103,102,100,99,97,96,94,93,91,90,89,89,88,88,88,89,90,91,92,93,95,97,98,100,101,103,105,106,107,108,109,110,111,111,111,111,110,109,108,106,105,103,101,98,96,95,93,91,90,89,89,89},
+    {94,94,94,95,96,97,98,100,101,102,104,105,106,107,108,108,109,109,109,108,108,107,106,104,103,102,100,99,97,96,95,94,94,93,93,93,94,95,96,97,98,99,101,102,104,106,107,109,110,111,112,113,114,114,115,115,114,114,113,111,110,108,107,105,103,101,99,98,96,95,94,94,94},
+    {98,99,99,100,101,101,103,104,105,106,107,108,109,110,111,111,111,111,111,111,110,110,109,107,106,105,104,102,101,100,99,98,98,98,97,98,98,99,100,101,102,103,105,106,107,109,110,112,113,114,115,116,116,117,117,117,117,116,115,114,113,111,110,108,106,105,103,102,101,100,99,99,98},
+    {103,103,103,104,104,105,106,107,108,109,110,111,112,112,113,113,113,113,113,113,112,111,111,110,109,107,106,105,104,103,103,102,101,101,101,101,102,102,103,104,105,106,107,109,110,111,112,113,115,116,116,117,118,118,118,118,118,117,117,116,115,113,112,111,109,108,106,105,104,104,103,103,103},
+    {106,106,106,107,107,108,109,109,110,111,112,112,113,113,114,114,114,114,114,114,113,113,112,111,110,109,108,107,107,106,105,105,104,104,104,104,105,105,106,106,107,108,109,110,111,112,113,114,115,116,117,118,118,118,118,118,118,118,117,116,115,114,113,112,111,110,109,108,107,107,106,106,106},
+    {109,109,109,109,110,110,111,111,112,112,113,113,114,114,114,114,114,114,114,114,113,113,112,112,111,110,110,109,108,108,107,107,107,107,107,107,107,107,108,108,109,110,111,111,112,113,114,115,115,116,117,117,118,118,118,118,118,117,117,116,116,115,114,113,113,112,111,110,110,109,109,109,109},
+    {111,111,111,111,111,111,112,112,112,113,113,113,114,114,114,114,114,114,114,114,113,113,113,112,112,111,111,110,110,109,109,109,109,108,108,109,109,109,109,110,110,111,111,112,113,113,114,114,115,115,116,116,116,117,117,117,117,116,116,116,115,115,114,114,113,113,112,112,111,111,111,111,111},
+    {112,112,112,112,112,112,112,113,113,113,113,113,113,113,113,114,113,113,113,113,113,113,112,112,112,112,111,111,111,110,110,110,110,110,110,110,110,110,111,111,111,111,112,112,113,113,113,114,114,114,115,115,115,115,115,115,115,115,115,115,115,114,114,114,114,113,113,113,112,112,112,112,112},
+    {113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,112,112,112,112,112,112,112,111,111,111,111,111,111,111,111,111,111,111,112,112,112,112,112,113,113,113,113,113,114,114,114,114,114,114,114,114,114,114,114,114,114,114,114,113,113,113,113,113,113,113,113,113},
+    {113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,112,112,112,112,112,112,112,112,112,112,112,112,112,112,112,112,112,112,112,112,112,112,112,112,112,112,112,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113},
+    {113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113,113},
+};
+
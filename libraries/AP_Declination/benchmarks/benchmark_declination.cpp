@@ -0,0 +1,70 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Declination/AP_Declination.h>
+
+#define TEST_POINTS 256
+
+// points within a few km of a vehicle, as seen by the calibrator and EKF
+static float lat[TEST_POINTS], lon[TEST_POINTS];
+static float intensity[TEST_POINTS], declination[TEST_POINTS], inclination[TEST_POINTS];
+
+static void setup_points()
+{
+    for (uint16_t i = 0; i < TEST_POINTS; i++) {
+        lat[i] = -35.36f + 0.02f * sinf(i * 0.37f);
+        lon[i] = 149.16f + 0.02f * cosf(i * 0.53f);
+    }
+}
+
+static void BM_GetDeclination(benchmark::State& state)
+{
+    setup_points();
+    uint16_t i = 0;
+    while (state.KeepRunning()) {
+        float d = AP_Declination::get_declination(lat[i], lon[i]);
+        gbenchmark_escape(&d);
+        i = (i + 1) % TEST_POINTS;
+    }
+}
+
+static void BM_GetMagFieldUncached(benchmark::State& state)
+{
+    setup_points();
+    uint16_t i = 0;
+    while (state.KeepRunning()) {
+        AP_Declination::get_mag_field_ef(lat[i], lon[i], intensity[0], declination[0], inclination[0]);
+        gbenchmark_escape(declination);
+        i = (i + 1) % TEST_POINTS;
+    }
+}
+
+static void BM_GetMagFieldCached(benchmark::State& state)
+{
+    setup_points();
+    AP_Declination::FieldCache cache;
+    uint16_t i = 0;
+    while (state.KeepRunning()) {
+        cache.get_mag_field_ef(lat[i], lon[i], intensity[0], declination[0], inclination[0]);
+        gbenchmark_escape(declination);
+        i = (i + 1) % TEST_POINTS;
+    }
+}
+
+static void BM_GetMagFieldBatch(benchmark::State& state)
+{
+    setup_points();
+    AP_Declination::FieldCache cache;
+    while (state.KeepRunning()) {
+        cache.get_mag_field_ef(TEST_POINTS, lat, lon, intensity, declination, inclination);
+        gbenchmark_escape(declination);
+    }
+    state.SetItemsProcessed(state.iterations() * TEST_POINTS);
+}
+
+BENCHMARK(BM_GetDeclination);
+BENCHMARK(BM_GetMagFieldUncached);
+BENCHMARK(BM_GetMagFieldCached);
+BENCHMARK(BM_GetMagFieldBatch);
+
+BENCHMARK_MAIN()
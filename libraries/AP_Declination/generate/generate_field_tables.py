@@ -0,0 +1,103 @@
+#!/usr/bin/env python
+'''
+generate the inclination and intensity tables in AP_Declination_tables.h
+
+The field is evaluated from the IGRF-12 main field model at epoch 2015.0,
+truncated to degree 4, on the same 5 degree grid as the declination
+table. The truncation gives intensity within a few percent and
+inclination within a couple of degrees of the full model, which is
+ample for sanity checking compass readings.
+
+usage: ./generate_field_tables.py > ../AP_Declination_tables.h
+'''
+
+import math
+
+# IGRF-12 Gauss coefficients at epoch 2015.0 in nT: (n, m, g, h)
+COEFFS = [
+    (1, 0, -29442.0, 0.0), (1, 1, -1501.0, 4797.1),
+    (2, 0, -2445.1, 0.0), (2, 1, 3012.9, -2845.6), (2, 2, 1676.7, -641.9),
+    (3, 0, 1350.7, 0.0), (3, 1, -2352.3, -115.3), (3, 2, 1225.6, 244.9), (3, 3, 582.0, -538.4),
+    (4, 0, 907.6, 0.0), (4, 1, 813.7, 283.3), (4, 2, 120.4, -188.7), (4, 3, -334.9, 180.9), (4, 4, 70.4, -329.5),
+]
+NMAX = 4
+
+# units of the intensity table in gauss
+INTENSITY_SCALE = 0.005
+
+def field(lat, lon):
+    '''return (intensity nT, declination deg, inclination deg) at the surface of a spherical earth'''
+    theta = math.radians(90 - lat)
+    phi = math.radians(lon)
+    ct = math.cos(theta)
+    st = max(math.sin(theta), 1.0e-9)
+
+    # Gauss normalised associated Legendre functions and their derivatives
+    P = [[0.0] * (NMAX + 1) for _ in range(NMAX + 1)]
+    dP = [[0.0] * (NMAX + 1) for _ in range(NMAX + 1)]
+    P[0][0] = 1.0
+    for n in range(1, NMAX + 1):
+        for m in range(0, n + 1):
+            if n == m:
+                P[n][m] = st * P[n-1][m-1]
+                dP[n][m] = st * dP[n-1][m-1] + ct * P[n-1][m-1]
+            elif n == 1:
+                P[n][m] = ct * P[n-1][m]
+                dP[n][m] = ct * dP[n-1][m] - st * P[n-1][m]
+            else:
+                K = ((n - 1) ** 2 - m ** 2) / float((2 * n - 1) * (2 * n - 3))
+                P[n][m] = ct * P[n-1][m] - K * P[n-2][m]
+                dP[n][m] = ct * dP[n-1][m] - st * P[n-1][m] - K * dP[n-2][m]
+
+    # factors converting to Schmidt semi-normalisation
+    S = [[0.0] * (NMAX + 1) for _ in range(NMAX + 1)]
+    S[0][0] = 1.0
+    for n in range(1, NMAX + 1):
+        S[n][0] = S[n-1][0] * (2 * n - 1) / float(n)
+        for m in range(1, n + 1):
+            S[n][m] = S[n][m-1] * math.sqrt((n - m + 1) * (2 if m == 1 else 1) / float(n + m))
+
+    X = Y = Z = 0.0
+    for (n, m, g, h) in COEFFS:
+        c = math.cos(m * phi)
+        s = math.sin(m * phi)
+        p = S[n][m] * P[n][m]
+        dp = S[n][m] * dP[n][m]
+        X += (g * c + h * s) * dp
+        Y += m * (g * s - h * c) * p / st
+        Z -= (n + 1) * (g * c + h * s) * p
+
+    H = math.hypot(X, Y)
+    return (math.hypot(H, Z), math.degrees(math.atan2(Y, X)), math.degrees(math.atan2(Z, H)))
+
+def write_table(name, ctype, values, fmt):
+    print("static const %s %s[37][73] = {" % (ctype, name))
+    for row in values:
+        print("    {" + ",".join([fmt % v for v in row]) + "},")
+    print("};")
+    print("")
+
+inclination = []
+intensity = []
+for i in range(37):
+    lat = -90 + 5 * i
+    inc_row = []
+    int_row = []
+    for j in range(73):
+        lon = -180 + 5 * j
+        (F, D, I) = field(lat, lon)
+        inc_row.append(int(round(I)))
+        int_row.append(int(round(F * 1.0e-5 / INTENSITY_SCALE)))
+    inclination.append(inc_row)
+    intensity.append(int_row)
+
+print("// generated by generate/generate_field_tables.py - do not edit")
+print("#pragma once")
+print("")
+print("// units of intensity_table in gauss")
+print("#define AP_DECLINATION_INTENSITY_SCALE %.3ff" % INTENSITY_SCALE)
+print("")
+print("// inclination in degrees, latitude -90 to 90 by rows and longitude -180 to 180 by columns")
+write_table("inclination_table", "int8_t", inclination, "%d")
+print("// intensity in units of AP_DECLINATION_INTENSITY_SCALE, on the same grid")
+write_table("intensity_table", "uint8_t", intensity, "%u")
@@ -0,0 +1,110 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Declination/AP_Declination.h>
+
+// simple deterministic generator so failures are reproducible
+static uint32_t rand_state = 1;
+static float rand_float(float low, float high)
+{
+    rand_state = rand_state * 1103515245U + 12345U;
+    return low + (high - low) * ((rand_state >> 8) & 0xFFFF) / 65535.0f;
+}
+
+TEST(AP_Declination, GridPoints)
+{
+    // values straight from the declination table
+    EXPECT_FLOAT_EQ(12.0f, AP_Declination::get_declination(-35, 150));
+    EXPECT_FLOAT_EQ(-1.0f, AP_Declination::get_declination(50, 0));
+    EXPECT_FLOAT_EQ(-18.0f, AP_Declination::get_declination(50, -70));
+}
+
+TEST(AP_Declination, Edges)
+{
+    // the north pole and the antimeridian are the far corners of the
+    // last cell rather than the start of one past the table
+    EXPECT_FLOAT_EQ(168.0f, AP_Declination::get_declination(90, -180));
+    EXPECT_FLOAT_EQ(168.0f, AP_Declination::get_declination(90, 180));
+    EXPECT_FLOAT_EQ(AP_Declination::get_declination(-10, -180),
+                    AP_Declination::get_declination(-10, 180));
+
+    float intensity, declination, inclination;
+    EXPECT_TRUE(AP_Declination::get_mag_field_ef(90, 180, intensity, declination, inclination));
+    EXPECT_FALSE(AP_Declination::get_mag_field_ef(NAN, 10, intensity, declination, inclination));
+}
+
+TEST(AP_Declination, KnownField)
+{
+    float intensity, declination, inclination;
+
+    // Canberra
+    ASSERT_TRUE(AP_Declination::get_mag_field_ef(-35.3f, 149.1f, intensity, declination, inclination));
+    EXPECT_NEAR(0.575f, intensity, 0.03f);
+    EXPECT_NEAR(12.0f, declination, 2.0f);
+    EXPECT_NEAR(-66.0f, inclination, 3.0f);
+
+    // London
+    ASSERT_TRUE(AP_Declination::get_mag_field_ef(51.5f, 0.0f, intensity, declination, inclination));
+    EXPECT_NEAR(0.49f, intensity, 0.03f);
+    EXPECT_NEAR(66.0f, inclination, 3.0f);
+
+    // South Atlantic anomaly
+    ASSERT_TRUE(AP_Declination::get_mag_field_ef(-26.0f, -50.0f, intensity, declination, inclination));
+    EXPECT_NEAR(0.23f, intensity, 0.03f);
+}
+
+TEST(AP_Declination, CacheMatchesLookup)
+{
+    AP_Declination::FieldCache cache;
+    for (uint16_t i = 0; i < 5000; i++) {
+        // mostly small steps so the cache is hit, with jumps between cells
+        const float lat = (i % 50 == 0) ? rand_float(-90, 90) : rand_float(-37, -35);
+        const float lon = (i % 50 == 0) ? rand_float(-180, 180) : rand_float(148, 151);
+
+        float intensity, declination, inclination;
+        float c_intensity, c_declination, c_inclination;
+        ASSERT_TRUE(AP_Declination::get_mag_field_ef(lat, lon, intensity, declination, inclination));
+        ASSERT_TRUE(cache.get_mag_field_ef(lat, lon, c_intensity, c_declination, c_inclination));
+        EXPECT_EQ(intensity, c_intensity);
+        EXPECT_EQ(declination, c_declination);
+        EXPECT_EQ(inclination, c_inclination);
+        EXPECT_EQ(AP_Declination::get_declination(lat, lon), declination);
+        EXPECT_EQ(declination, cache.get_declination(lat, lon));
+    }
+}
+
+TEST(AP_Declination, Batch)
+{
+    const uint16_t count = 200;
+    float lat[count], lon[count];
+    float intensity[count], declination[count], inclination[count];
+
+    for (uint16_t i = 0; i < count; i++) {
+        lat[i] = rand_float(-90, 90);
+        lon[i] = rand_float(-180, 180);
+    }
+    lat[7] = NAN;
+
+    AP_Declination::FieldCache cache;
+    cache.get_mag_field_ef(count, lat, lon, intensity, declination, inclination);
+
+    for (uint16_t i = 0; i < count; i++) {
+        float s_intensity, s_declination, s_inclination;
+        if (i == 7) {
+            EXPECT_TRUE(isnan(intensity[i]));
+            EXPECT_TRUE(isnan(declination[i]));
+            EXPECT_TRUE(isnan(inclination[i]));
+            continue;
+        }
+        ASSERT_TRUE(AP_Declination::get_mag_field_ef(lat[i], lon[i], s_intensity, s_declination, s_inclination));
+        EXPECT_EQ(s_intensity, intensity[i]);
+        EXPECT_EQ(s_declination, declination[i]);
+        EXPECT_EQ(s_inclination, inclination[i]);
+    }
+
+    // outputs are optional
+    cache.get_mag_field_ef(count, lat, lon, nullptr, declination, nullptr);
+    EXPECT_EQ(AP_Declination::get_declination(lat[0], lon[0]), declination[0]);
+}
+
+AP_GTEST_MAIN()
@@ -18,6 +18,7 @@
 #include <AP_HAL/AP_HAL.h>
 #include <AP_Math/AP_Math.h>
 #include <AP_Notify/AP_Notify.h>
+#include <DataFlash/DataFlash.h>
 #include <GCS_MAVLink/GCS.h>
 
 #include "AP_GPS_NOVA.h"
@@ -37,6 +38,10 @@
 
 extern const AP_HAL::HAL &hal;
 
+// longest time a receiver's solution is moved along its velocity to
+// reach the epoch of the blend
+#define GPS_BLEND_MAX_SHIFT_MS 300
+
 // table of user settable parameters
 const AP_Param::GroupInfo AP_GPS::var_info[] = {
     // @Param: TYPE
@@ -64,10 +69,10 @@ const AP_Param::GroupInfo AP_GPS::var_info[] = {
 
     // @Param: AUTO_SWITCH
     // @DisplayName: Automatic Switchover Setting
-    // @Description: Automatic switchover to GPS reporting best lock
-    // @Values: 0:Disabled,1:Enabled
+    // @Description: Automatic switchover to GPS reporting best lock. When set to blend, the solutions of all receivers with a 3D fix are combined into a virtual instance weighted by their reported accuracy, see GPS_BLEND_MASK, which is then used for navigation.
+    // @Values: 0:Disabled,1:UseBest,2:Blend
     // @User: Advanced
-    AP_GROUPINFO("AUTO_SWITCH", 3, AP_GPS, _auto_switch, 1),
+    AP_GROUPINFO("AUTO_SWITCH", 3, AP_GPS, _auto_switch, GPS_SWITCH_BEST),
 
     // @Param: MIN_DGPS
     // @DisplayName: Minimum Lock Type Accepted for DGPS
@@ -196,6 +201,21 @@ const AP_Param::GroupInfo AP_GPS::var_info[] = {
     // @User: Advanced
     AP_GROUPINFO("POS2", 17, AP_GPS, _antenna_offset[1], 0.0f),
 
+    // @Param: BLEND_MASK
+    // @DisplayName: Multi GPS Blending Mask
+    // @Description: Determines which of the accuracy measures reported by the receivers are used to weight them when GPS_AUTO_SWITCH is set to blend. Receivers are only blended when all of them report at least one of the selected measures.
+    // @Bitmask: 0:Horiz Pos,1:Vert Pos,2:Speed
+    // @User: Advanced
+    AP_GROUPINFO("BLEND_MASK", 18, AP_GPS, _blend_mask, GPS_BLEND_MASK_HPOS | GPS_BLEND_MASK_SPD),
+
+    // @Param: BLEND_TC
+    // @DisplayName: Blending time constant
+    // @Description: Time constant of the filter tracking the offset of each receiver from the blended solution. When blending stops the output converges from the blended position onto the remaining receiver at this rate.
+    // @Units: seconds
+    // @Range: 5.0 30.0
+    // @User: Advanced
+    AP_GROUPINFO("BLEND_TC", 19, AP_GPS, _blend_tc, 10.0f),
+
     AP_GROUPEND
 };
 
@@ -204,6 +224,7 @@ void AP_GPS::init(DataFlash_Class *dataflash, const AP_SerialManager& serial_man
 {
     _DataFlash = dataflash;
     primary_instance = 0;
+    primary_receiver = 0;
 
     // search for serial ports with gps protocol
     _port[0] = serial_manager.find_serial(AP_SerialManager::SerialProtocol_GPS, 0);
@@ -405,6 +426,16 @@ found_gps:
 AP_GPS::GPS_Status 
 AP_GPS::highest_supported_status(uint8_t instance) const
 {
+    if (instance == GPS_BLENDED_INSTANCE) {
+        // the best of the receivers making up the blend
+        GPS_Status highest = NO_GPS;
+        for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+            if (_blend.weights[i] > 0 || i == primary_receiver) {
+                highest = MAX(highest, highest_supported_status(i));
+            }
+        }
+        return highest;
+    }
     if (drivers[instance] != nullptr)
         return drivers[instance]->highest_supported_status();
     return AP_GPS::GPS_OK_FIX_3D;
@@ -413,9 +444,23 @@ AP_GPS::highest_supported_status(uint8_t instance) const
 AP_GPS::GPS_Status 
 AP_GPS::highest_supported_status(void) const
 {
-    if (drivers[primary_instance] != nullptr)
-        return drivers[primary_instance]->highest_supported_status();
-    return AP_GPS::GPS_OK_FIX_3D;
+    return highest_supported_status(primary_instance);
+}
+
+float
+AP_GPS::get_lag(uint8_t instance) const
+{
+    if (instance == GPS_BLENDED_INSTANCE) {
+        if (_blend.last_update_ms == 0) {
+            // nothing blended yet, use the lag of the receiver
+            return get_lag(primary_receiver);
+        }
+        return _blend.lag;
+    }
+    if (drivers[instance] != nullptr) {
+        return drivers[instance]->get_lag();
+    }
+    return 0.2f;
 }
 
 
@@ -484,31 +529,31 @@ AP_GPS::update_instance(uint8_t instance)
 void
 AP_GPS::update(void)
 {
-    for (uint8_t i=0; i<GPS_MAX_INSTANCES; i++) {
+    for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
         update_instance(i);
     }
 
     // work out which GPS is the primary, and how many sensors we have
-    for (uint8_t i=0; i<GPS_MAX_INSTANCES; i++) {
+    for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
         if (state[i].status != NO_GPS) {
             num_instances = i+1;
         }
         if (_auto_switch) {            
-            if (i == primary_instance) {
+            if (i == primary_receiver) {
                 continue;
             }
-            if (state[i].status > state[primary_instance].status) {
+            if (state[i].status > state[primary_receiver].status) {
                 // we have a higher status lock, change GPS
-                primary_instance = i;
+                primary_receiver = i;
                 continue;
             }
 
-            bool another_gps_has_1_or_more_sats = (state[i].num_sats >= state[primary_instance].num_sats + 1);
+            bool another_gps_has_1_or_more_sats = (state[i].num_sats >= state[primary_receiver].num_sats + 1);
 
-            if (state[i].status == state[primary_instance].status && another_gps_has_1_or_more_sats) {
+            if (state[i].status == state[primary_receiver].status && another_gps_has_1_or_more_sats) {
 
                 uint32_t now = AP_HAL::millis();
-                bool another_gps_has_2_or_more_sats = (state[i].num_sats >= state[primary_instance].num_sats + 2);
+                bool another_gps_has_2_or_more_sats = (state[i].num_sats >= state[primary_receiver].num_sats + 2);
 
                 if ( (another_gps_has_1_or_more_sats && (now - _last_instance_swap_ms) >= 20000) ||
                      (another_gps_has_2_or_more_sats && (now - _last_instance_swap_ms) >= 5000 ) ) {
@@ -517,20 +562,367 @@ AP_GPS::update(void)
                 // then tend to stick to the new GPS as primary. We don't
                 // want to switch too often as it will look like a
                 // position shift to the controllers.
-                primary_instance = i;
+                primary_receiver = i;
                 _last_instance_swap_ms = now;
                 }
             }
         } else {
-            primary_instance = 0;
+            primary_receiver = 0;
         }
     }
 
+    if (_auto_switch == GPS_SWITCH_BLEND) {
+        update_blend();
+        primary_instance = GPS_BLENDED_INSTANCE;
+    } else {
+        _blend.active = false;
+        primary_instance = primary_receiver;
+    }
+
 	// update notify with gps status. We always base this on the primary_instance
     AP_Notify::flags.gps_status = state[primary_instance].status;
     AP_Notify::flags.gps_num_sats = state[primary_instance].num_sats;
 }
 
+/*
+  update the blended instance. This only does any work when a receiver
+  has produced a new solution, so runs at most at the rate of the
+  fastest receiver
+ */
+void
+AP_GPS::update_blend(void)
+{
+    bool have_new_sample = false;
+    uint32_t sample_time_ms = _blend.last_update_ms;
+    for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+        const uint32_t message_ms = timing[i].last_message_time_ms;
+        if (message_ms != _blend.last_message_ms[i]) {
+            _blend.last_message_ms[i] = message_ms;
+            have_new_sample = true;
+            if ((int32_t)(message_ms - sample_time_ms) > 0) {
+                sample_time_ms = message_ms;
+            }
+        }
+    }
+    if (!have_new_sample) {
+        return;
+    }
+
+    // coefficient of the filters tracking each receiver's offset. This
+    // is timed by the receivers rather than the system clock so that
+    // Replay produces the same blend
+    const float dt = constrain_float((sample_time_ms - _blend.last_update_ms) * 0.001f, 0.0f, 1.0f);
+    const float alpha = dt / (dt + MAX(_blend_tc.get(), 1.0f));
+    _blend.last_update_ms = sample_time_ms;
+
+    _blend.active = calc_blend_weights();
+    if (_blend.active) {
+        calc_blended_state(alpha);
+    } else {
+        use_single_receiver(primary_receiver, alpha);
+    }
+
+    Write_DataFlash_Log_Blend();
+}
+
+/*
+  accuracy reported by a receiver for one GPS_BLEND_MASK bit
+ */
+static bool blend_accuracy(const AP_GPS::GPS_State &s, uint8_t mask_bit, float &acc)
+{
+    switch (mask_bit) {
+    case AP_GPS::GPS_BLEND_MASK_HPOS:
+        acc = s.horizontal_accuracy;
+        return s.have_horizontal_accuracy && acc > 0;
+    case AP_GPS::GPS_BLEND_MASK_VPOS:
+        acc = s.vertical_accuracy;
+        return s.have_vertical_accuracy && acc > 0;
+    case AP_GPS::GPS_BLEND_MASK_SPD:
+        acc = s.speed_accuracy;
+        return s.have_speed_accuracy && acc > 0;
+    }
+    return false;
+}
+
+/*
+  work out the weight of each receiver in the blend, and how far each
+  solution must be moved to reach the epoch of the blend, which is the
+  time of the newest solution. Returns false if fewer than two
+  receivers can be blended
+ */
+bool
+AP_GPS::calc_blend_weights(void)
+{
+    memset(_blend.weights, 0, sizeof(_blend.weights));
+    memset(_blend.sample_shift_ms, 0, sizeof(_blend.sample_shift_ms));
+
+    // time each solution was valid, allowing for the receiver lag
+    uint32_t sample_ms[GPS_MAX_RECEIVERS] {};
+    bool usable[GPS_MAX_RECEIVERS];
+    bool have_epoch = false;
+    uint32_t epoch_ms = 0;
+    for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+        usable[i] = state[i].status >= GPS_OK_FIX_3D;
+        if (!usable[i]) {
+            continue;
+        }
+        sample_ms[i] = timing[i].last_message_time_ms - (uint32_t)(get_lag(i) * 1000);
+        if (!have_epoch || (int32_t)(sample_ms[i] - epoch_ms) > 0) {
+            epoch_ms = sample_ms[i];
+            have_epoch = true;
+        }
+    }
+
+    // a receiver which has fallen too far behind is left out rather
+    // than extrapolated over a long time
+    uint8_t count = 0;
+    for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+        if (!usable[i]) {
+            continue;
+        }
+        const uint32_t shift_ms = epoch_ms - sample_ms[i];
+        if (shift_ms > GPS_BLEND_MAX_SHIFT_MS) {
+            usable[i] = false;
+            continue;
+        }
+        _blend.sample_shift_ms[i] = shift_ms;
+        count++;
+    }
+    if (count < 2) {
+        return false;
+    }
+
+    // each accuracy measure reported by all receivers gives a set of
+    // inverse variance weights, which are averaged
+    float total[GPS_MAX_RECEIVERS] {};
+    bool have_measure = false;
+    for (uint8_t bit=GPS_BLEND_MASK_HPOS; bit<=GPS_BLEND_MASK_SPD; bit<<=1) {
+        if (!(_blend_mask.get() & bit)) {
+            continue;
+        }
+        float inv_var[GPS_MAX_RECEIVERS] {};
+        float sum = 0;
+        bool reported = true;
+        for (uint8_t i=0; i<GPS_MAX_RECEIVERS && reported; i++) {
+            float acc;
+            if (!usable[i]) {
+                continue;
+            }
+            reported = blend_accuracy(state[i], bit, acc);
+            if (reported) {
+                inv_var[i] = 1.0f / sq(acc);
+                sum += inv_var[i];
+            }
+        }
+        if (!reported) {
+            continue;
+        }
+        for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+            total[i] += inv_var[i] / sum;
+        }
+        have_measure = true;
+    }
+    if (!have_measure) {
+        return false;
+    }
+
+    float sum = 0;
+    for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+        sum += total[i];
+    }
+    for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+        _blend.weights[i] = total[i] / sum;
+    }
+    return true;
+}
+
+/*
+  fill in the blended instance from the weighted receivers, each moved
+  along its velocity to the epoch
+ */
+void
+AP_GPS::calc_blended_state(float alpha)
+{
+    // the most heavily weighted receiver is the reference for position
+    // offsets and provides the GPS time
+    uint8_t ref = 0;
+    for (uint8_t i=1; i<GPS_MAX_RECEIVERS; i++) {
+        if (_blend.weights[i] > _blend.weights[ref]) {
+            ref = i;
+        }
+    }
+
+    GPS_State &blend = state[GPS_BLENDED_INSTANCE];
+    const Location &ref_loc = state[ref].location;
+
+    Vector2f NE_pos[GPS_MAX_RECEIVERS];
+    float alt_cm[GPS_MAX_RECEIVERS] {};
+    Vector2f blend_NE;
+    float blend_alt_cm = 0;
+    Vector3f velocity;
+    float vel_z_weight = 0;
+    float hacc = 0, vacc = 0, sacc = 0;
+    float hdop = 0, vdop = 0;
+    float lag = 0;
+    Vector3f antenna_offset;
+    GPS_Status status = NO_FIX;
+    uint8_t num_sats = 0;
+    bool have_hacc = true, have_vacc = true, have_sacc = true;
+    uint32_t last_message_ms = timing[ref].last_message_time_ms;
+
+    for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+        const float w = _blend.weights[i];
+        if (w <= 0) {
+            continue;
+        }
+        const GPS_State &s = state[i];
+        const float shift = _blend.sample_shift_ms[i] * 0.001f;
+
+        NE_pos[i] = location_diff(ref_loc, s.location) + Vector2f(s.velocity.x, s.velocity.y) * shift;
+        alt_cm[i] = (s.location.alt - ref_loc.alt) - s.velocity.z * shift * 100;
+        blend_NE += NE_pos[i] * w;
+        blend_alt_cm += alt_cm[i] * w;
+
+        velocity.x += s.velocity.x * w;
+        velocity.y += s.velocity.y * w;
+        if (s.have_vertical_velocity) {
+            velocity.z += s.velocity.z * w;
+            vel_z_weight += w;
+        }
+
+        hacc += s.horizontal_accuracy * w;
+        vacc += s.vertical_accuracy * w;
+        sacc += s.speed_accuracy * w;
+        have_hacc = have_hacc && s.have_horizontal_accuracy;
+        have_vacc = have_vacc && s.have_vertical_accuracy;
+        have_sacc = have_sacc && s.have_speed_accuracy;
+        hdop += s.hdop * w;
+        vdop += s.vdop * w;
+        lag += get_lag(i) * w;
+        antenna_offset += _antenna_offset[i].get() * w;
+        status = MAX(status, s.status);
+        num_sats = MAX(num_sats, s.num_sats);
+        if ((int32_t)(timing[i].last_message_time_ms - last_message_ms) > 0) {
+            last_message_ms = timing[i].last_message_time_ms;
+        }
+    }
+    if (vel_z_weight > 0) {
+        velocity.z /= vel_z_weight;
+    }
+
+    // start from the reference for the fields which aren't blended
+    blend = state[ref];
+    blend.instance = GPS_BLENDED_INSTANCE;
+    blend.status = status;
+    blend.num_sats = num_sats;
+    location_offset(blend.location, blend_NE.x, blend_NE.y);
+    blend.location.alt = ref_loc.alt + (int32_t)blend_alt_cm;
+    blend.velocity = velocity;
+    blend.ground_speed = norm(velocity.x, velocity.y);
+    blend.ground_course = wrap_360(degrees(atan2f(velocity.y, velocity.x)));
+    blend.hdop = (uint16_t)hdop;
+    blend.vdop = (uint16_t)vdop;
+    blend.horizontal_accuracy = hacc;
+    blend.vertical_accuracy = vacc;
+    blend.speed_accuracy = sacc;
+    blend.have_horizontal_accuracy = have_hacc;
+    blend.have_vertical_accuracy = have_vacc;
+    blend.have_speed_accuracy = have_sacc;
+    blend.have_vertical_velocity = vel_z_weight > 0;
+
+    // the GPS time of the epoch
+    const uint32_t ms_per_week = 86400*7*1000UL;
+    blend.time_week_ms = state[ref].time_week_ms + _blend.sample_shift_ms[ref];
+    if (blend.time_week_ms >= ms_per_week) {
+        blend.time_week_ms -= ms_per_week;
+        blend.time_week++;
+    }
+    blend.last_gps_time_ms = state[ref].last_gps_time_ms + _blend.sample_shift_ms[ref];
+
+    // the blend is new data when its latest input arrived
+    timing[GPS_BLENDED_INSTANCE].last_message_time_ms = last_message_ms;
+    timing[GPS_BLENDED_INSTANCE].last_fix_time_ms = last_message_ms;
+
+    _blend.lag = lag;
+    _blend.antenna_offset = antenna_offset;
+
+    // follow the offset of the blend from each receiver, used when a
+    // receiver is left on its own
+    for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+        if (_blend.weights[i] <= 0) {
+            continue;
+        }
+        _blend.NE_offset_m[i] += ((blend_NE - NE_pos[i]) - _blend.NE_offset_m[i]) * alpha;
+        _blend.alt_offset_cm[i] += ((blend_alt_cm - alt_cm[i]) - _blend.alt_offset_cm[i]) * alpha;
+    }
+}
+
+/*
+  use one receiver as the blended instance, shifted by its offset from
+  the last blend. The offset decays so the output converges onto the
+  receiver over GPS_BLEND_TC
+ */
+void
+AP_GPS::use_single_receiver(uint8_t instance, float alpha)
+{
+    memset(_blend.weights, 0, sizeof(_blend.weights));
+    memset(_blend.sample_shift_ms, 0, sizeof(_blend.sample_shift_ms));
+    _blend.weights[instance] = 1;
+
+    GPS_State &blend = state[GPS_BLENDED_INSTANCE];
+    blend = state[instance];
+    blend.instance = GPS_BLENDED_INSTANCE;
+    timing[GPS_BLENDED_INSTANCE] = timing[instance];
+    _blend.lag = get_lag(instance);
+    _blend.antenna_offset = _antenna_offset[instance];
+
+    for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+        if (i != instance) {
+            _blend.NE_offset_m[i].zero();
+            _blend.alt_offset_cm[i] = 0;
+        }
+    }
+    if (blend.status < GPS_OK_FIX_2D) {
+        return;
+    }
+    location_offset(blend.location, _blend.NE_offset_m[instance].x, _blend.NE_offset_m[instance].y);
+    blend.location.alt += (int32_t)_blend.alt_offset_cm[instance];
+    _blend.NE_offset_m[instance] *= (1.0f - alpha);
+    _blend.alt_offset_cm[instance] *= (1.0f - alpha);
+}
+
+/*
+  log the blended solution and the weights it was made with. Replay
+  recalculates the blend from the receivers, so these are regenerated
+  rather than copied when replaying a log
+ */
+void
+AP_GPS::Write_DataFlash_Log_Blend(void) const
+{
+    if (_DataFlash == nullptr || !_DataFlash->logging_started()) {
+        return;
+    }
+    const GPS_State &blend = state[GPS_BLENDED_INSTANCE];
+    struct log_GPS_Blend pkt = {
+        LOG_PACKET_HEADER_INIT(LOG_GPS_BLEND_MSG),
+        time_us       : AP_HAL::micros64(),
+        status        : (uint8_t)blend.status,
+        num_sats      : blend.num_sats,
+        latitude      : blend.location.lat,
+        longitude     : blend.location.lng,
+        altitude      : blend.location.alt,
+        ground_speed  : blend.ground_speed,
+        ground_course : blend.ground_course,
+        vel_z         : blend.velocity.z,
+        weight1       : _blend.weights[0],
+        weight2       : _blend.weights[1],
+        shift1_ms     : _blend.sample_shift_ms[0],
+        shift2_ms     : _blend.sample_shift_ms[1],
+        active        : _blend.active
+    };
+    _DataFlash->WriteBlock(&pkt, sizeof(pkt));
+}
+
 /*
   pass along a mavlink message (for MAV type)
  */
@@ -558,7 +950,7 @@ AP_GPS::setHIL(uint8_t instance, GPS_Status _status, uint64_t time_epoch_ms,
                const Location &_location, const Vector3f &_velocity, uint8_t _num_sats, 
                uint16_t hdop)
 {
-    if (instance >= GPS_MAX_INSTANCES) {
+    if (instance >= GPS_MAX_RECEIVERS) {
         return;
     }
     uint32_t tnow = AP_HAL::millis();
@@ -583,6 +975,9 @@ AP_GPS::setHIL(uint8_t instance, GPS_Status _status, uint64_t time_epoch_ms,
 // set accuracy for HIL
 void AP_GPS::setHIL_Accuracy(uint8_t instance, float vdop, float hacc, float vacc, float sacc, bool _have_vertical_velocity, uint32_t sample_ms)
 {
+    if (instance >= GPS_MAX_RECEIVERS) {
+        return;
+    }
     GPS_State &istate = state[instance];
     istate.vdop = vdop * 100;
     istate.horizontal_accuracy = hacc;
@@ -607,7 +1002,7 @@ void
 AP_GPS::lock_port(uint8_t instance, bool lock)
 {
 
-    if (instance >= GPS_MAX_INSTANCES) {
+    if (instance >= GPS_MAX_RECEIVERS) {
         return;
     }
     if (lock) {
@@ -623,7 +1018,7 @@ AP_GPS::inject_data(uint8_t *data, uint8_t len)
 {
     //Support broadcasting to all GPSes.
     if (_inject_to == GPS_RTK_INJECT_TO_ALL) {
-        for (uint8_t i=0; i<GPS_MAX_INSTANCES; i++) {
+        for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
             inject_data(i, data, len);
         }
     } else {
@@ -634,7 +1029,7 @@ AP_GPS::inject_data(uint8_t *data, uint8_t len)
 void 
 AP_GPS::inject_data(uint8_t instance, uint8_t *data, uint8_t len)
 {
-    if (instance < GPS_MAX_INSTANCES && drivers[instance] != nullptr)
+    if (instance < GPS_MAX_RECEIVERS && drivers[instance] != nullptr)
         drivers[instance]->inject_data(data, len);
 }  
 
@@ -720,7 +1115,7 @@ AP_GPS::send_mavlink_gps2_rtk(mavlink_channel_t chan)
 uint8_t
 AP_GPS::first_unconfigured_gps(void) const
 {
-    for(int i = 0; i < GPS_MAX_INSTANCES; i++) {
+    for(int i = 0; i < GPS_MAX_RECEIVERS; i++) {
         if(_type[i] != GPS_TYPE_NONE && (drivers[i] == nullptr || !drivers[i]->is_configured())) {
             return i;
         }
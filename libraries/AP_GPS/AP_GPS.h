@@ -25,10 +25,17 @@
 #include <AP_SerialManager/AP_SerialManager.h>
 
 /**
-   maximum number of GPS instances available on this platform. If more
+   maximum number of GPS receivers available on this platform. If more
    than 1 then redundent sensors may be available
  */
-#define GPS_MAX_INSTANCES 2
+#define GPS_MAX_RECEIVERS 2
+
+/**
+   the receivers plus a virtual instance holding their blended
+   solution, see GPS_AUTO_SWITCH
+ */
+#define GPS_MAX_INSTANCES (GPS_MAX_RECEIVERS + 1)
+#define GPS_BLENDED_INSTANCE GPS_MAX_RECEIVERS
 #define GPS_RTK_INJECT_TO_ALL 127
 
 class DataFlash_Class;
@@ -100,6 +107,20 @@ public:
        GPS_ALL_CONFIGURED = 255
    };
 
+    // values of GPS_AUTO_SWITCH
+    enum GPS_Switch {
+        GPS_SWITCH_NONE  = 0,
+        GPS_SWITCH_BEST  = 1,
+        GPS_SWITCH_BLEND = 2,
+    };
+
+    // bits of GPS_BLEND_MASK, the accuracies used to weight receivers
+    enum GPS_Blend_Mask {
+        GPS_BLEND_MASK_HPOS = (1U<<0),
+        GPS_BLEND_MASK_VPOS = (1U<<1),
+        GPS_BLEND_MASK_SPD  = (1U<<2),
+    };
+
     /*
       The GPS_State structure is filled in by the backend driver as it
       parses each message from the GPS.
@@ -134,15 +155,24 @@ public:
     // Accessor functions
 
     // return number of active GPS sensors. Note that if the first GPS
-    // is not present but the 2nd is then we return 2
+    // is not present but the 2nd is then we return 2. The blended
+    // instance is not counted
     uint8_t num_sensors(void) const {
         return num_instances;
     }
 
+    // the instance used for navigation, GPS_BLENDED_INSTANCE when
+    // blending is enabled
     uint8_t primary_sensor(void) const {
         return primary_instance;
     }
 
+    // weight given to a receiver in the blended solution, zero if it
+    // isn't contributing
+    float get_blend_weight(uint8_t instance) const {
+        return instance < GPS_MAX_RECEIVERS ? _blend.weights[instance] : 0;
+    }
+
     /// Query GPS status
     GPS_Status status(uint8_t instance) const {
         return state[instance].status;
@@ -310,14 +340,21 @@ public:
     }
 
     // the expected lag (in seconds) in the position and velocity readings from the gps
-    float get_lag() const { return 0.2f; }
+    float get_lag(uint8_t instance) const;
+    float get_lag() const { return get_lag(primary_instance); }
 
     // return a 3D vector defining the offset of the GPS antenna in metres relative to the body frame origin
     const Vector3f &get_antenna_offset(uint8_t instance) const {
+        if (instance == GPS_BLENDED_INSTANCE) {
+            if (_blend.last_update_ms == 0) {
+                return _antenna_offset[primary_receiver];
+            }
+            return _blend.antenna_offset;
+        }
         return _antenna_offset[instance];
     }
     const Vector3f &get_antenna_offset(void) const {
-        return _antenna_offset[primary_instance];
+        return get_antenna_offset(primary_instance);
     }
 
     // set position for HIL
@@ -334,7 +371,7 @@ public:
     DataFlash_Class *_DataFlash;
 
     // configuration parameters
-    AP_Int8 _type[GPS_MAX_INSTANCES];
+    AP_Int8 _type[GPS_MAX_RECEIVERS];
     AP_Int8 _navfilter;
     AP_Int8 _auto_switch;
     AP_Int8 _min_dgps;
@@ -349,6 +386,8 @@ public:
     AP_Int8 _save_config;
     AP_Int8 _auto_config;
     AP_Vector3f _antenna_offset[2];
+    AP_Int8 _blend_mask;
+    AP_Float _blend_tc;
 
     // handle sending of initialisation strings to the GPS
     void send_blob_start(uint8_t instance, const char *_blob, uint16_t size);
@@ -382,12 +421,15 @@ private:
     };
     GPS_timing timing[GPS_MAX_INSTANCES];
     GPS_State state[GPS_MAX_INSTANCES];
-    AP_GPS_Backend *drivers[GPS_MAX_INSTANCES];
-    AP_HAL::UARTDriver *_port[GPS_MAX_INSTANCES];
+    AP_GPS_Backend *drivers[GPS_MAX_RECEIVERS];
+    AP_HAL::UARTDriver *_port[GPS_MAX_RECEIVERS];
 
     /// primary GPS instance
     uint8_t primary_instance:2;
 
+    /// receiver chosen by GPS_AUTO_SWITCH, used directly unless blending
+    uint8_t primary_receiver:2;
+
     /// number of GPS instances present
     uint8_t num_instances:2;
 
@@ -406,12 +448,36 @@ private:
         struct NMEA_detect_state nmea_detect_state;
         struct SBP_detect_state sbp_detect_state;
         struct ERB_detect_state erb_detect_state;
-    } detect_state[GPS_MAX_INSTANCES];
+    } detect_state[GPS_MAX_RECEIVERS];
 
     struct {
         const char *blob;
         uint16_t remaining;
-    } initblob_state[GPS_MAX_INSTANCES];
+    } initblob_state[GPS_MAX_RECEIVERS];
+
+    /*
+      state of the blended instance. Receivers are weighted by the
+      inverse square of their reported accuracies, after moving each
+      solution to a common epoch along its own velocity. The offset of
+      each receiver from the blend is tracked so that when blending
+      stops the output moves slowly onto the remaining receiver rather
+      than stepping
+     */
+    struct {
+        float weights[GPS_MAX_RECEIVERS];
+        // time each receiver's solution was moved forward to reach the epoch
+        uint16_t sample_shift_ms[GPS_MAX_RECEIVERS];
+        // last_message_time_ms of each receiver when last blended
+        uint32_t last_message_ms[GPS_MAX_RECEIVERS];
+        // filtered offset of the blend from each receiver
+        Vector2f NE_offset_m[GPS_MAX_RECEIVERS];
+        float alt_offset_cm[GPS_MAX_RECEIVERS];
+        // newest receiver message time when the blend was last updated
+        uint32_t last_update_ms;
+        float lag;
+        Vector3f antenna_offset;
+        bool active;
+    } _blend;
 
     static const uint32_t  _baudrates[];
     static const char _initialisation_blob[];
@@ -419,6 +485,13 @@ private:
 
     void detect_instance(uint8_t instance);
     void update_instance(uint8_t instance);
+
+    // maintain the blended instance
+    void update_blend(void);
+    bool calc_blend_weights(void);
+    void calc_blended_state(float alpha);
+    void use_single_receiver(uint8_t instance, float alpha);
+    void Write_DataFlash_Log_Blend(void) const;
     void _broadcast_gps_type(const char *type, uint8_t instance, int8_t baud_index);
 
     /*
@@ -45,6 +45,35 @@ extern const AP_HAL::HAL& hal;
 #include <stdio.h>
 #endif
 
+// the characters _decode() treats specially, as a bitmask indexed by
+// character. They are all below 64 so one word covers them
+#define NMEA_DELIMITERS ((1ULL << ',') | (1ULL << '\r') | (1ULL << '\n') | (1ULL << '*') | (1ULL << '$'))
+
+static inline bool nmea_is_delimiter(char c)
+{
+    return (uint8_t)c < 64 && ((NMEA_DELIMITERS >> (uint8_t)c) & 1);
+}
+
+// exclusive or of count characters, taken a word at a time
+static uint8_t nmea_parity(const char *buf, uint16_t count)
+{
+    uint32_t x = 0;
+    while (count >= sizeof(x)) {
+        uint32_t w;
+        memcpy(&w, buf, sizeof(w));
+        x ^= w;
+        buf += sizeof(w);
+        count -= sizeof(w);
+    }
+    x ^= x >> 16;
+    x ^= x >> 8;
+    uint8_t parity = x;
+    while (count--) {
+        parity ^= *buf++;
+    }
+    return parity;
+}
+
 // SiRF init messages //////////////////////////////////////////////////////////
 //
 // Note that we will only see a SiRF in NMEA mode if we are explicitly configured
@@ -111,22 +140,57 @@ AP_GPS_NMEA::AP_GPS_NMEA(AP_GPS &_gps, AP_GPS::GPS_State &_state, AP_HAL::UARTDr
 
 bool AP_GPS_NMEA::read(void)
 {
-    int16_t numc;
     bool parsed = false;
 
-    numc = port->available();
-    while (numc--) {
-        char c = port->read();
+    uint32_t numc = port->available();
+    while (numc > 0) {
+        char buf[GPS_BACKEND_READ_SIZE];
+        const uint32_t n = port->read((uint8_t *)buf, MIN(numc, sizeof(buf)));
+        if (n == 0) {
+            break;
+        }
 #ifdef NMEA_LOG_PATH
         static FILE *logf = nullptr;
         if (logf == nullptr) {
             logf = fopen(NMEA_LOG_PATH, "wb");
         }
         if (logf != nullptr) {
-            ::fwrite(&c, 1, 1, logf);
+            ::fwrite(buf, 1, n, logf);
         }
 #endif
-        if (_decode(c)) {
+        if (_decode_bytes(buf, n)) {
+            parsed = true;
+        }
+        numc -= MIN(n, numc);
+    }
+    return parsed;
+}
+
+bool AP_GPS_NMEA::_decode_bytes(const char *buf, uint16_t count)
+{
+    bool parsed = false;
+    uint16_t i = 0;
+
+    while (i < count) {
+        // ordinary characters up to the next delimiter are added to
+        // the term and parity together, as _decode() would one by one
+        uint16_t run = 0;
+        while (i + run < count && !nmea_is_delimiter(buf[i + run])) {
+            run++;
+        }
+        if (run > 0) {
+            if (_term_offset < sizeof(_term) - 1) {
+                const uint8_t n = MIN(run, (uint16_t)(sizeof(_term) - 1 - _term_offset));
+                memcpy(&_term[_term_offset], &buf[i], n);
+                _term_offset += n;
+            }
+            if (!_is_checksum_term) {
+                _parity ^= nmea_parity(&buf[i], run);
+            }
+            i += run;
+        }
+
+        if (i < count && _decode(buf[i++])) {
             parsed = true;
         }
     }
@@ -79,6 +79,14 @@ private:
     ///
     bool                        _decode(char c);
 
+    /// Update the decode state machine with a buffer of characters,
+    /// handling the characters between delimiters in one go
+    ///
+    /// @returns		True if any sentence resulted in an update to
+    ///					the GPS state
+    ///
+    bool                        _decode_bytes(const char *buf, uint16_t count);
+
     /// Return the numeric value of an ascii hex character
     ///
     /// @param	a		The character to be converted
@@ -102,21 +102,53 @@ void
 AP_GPS_SBP::_sbp_process() 
 {
 
-    while (port->available() > 0) {
-        uint8_t temp = port->read();
+    uint8_t bytes[GPS_BACKEND_READ_SIZE];
+    uint32_t n;
+    while ((n = port->read(bytes, sizeof(bytes))) > 0) {
+        _sbp_process_bytes(bytes, n);
+    }
+}
+
+//Runs a buffer of bytes from the port through the parser, dispatching
+//every complete message.
+void
+AP_GPS_SBP::_sbp_process_bytes(const uint8_t *bytes, uint16_t count)
+{
+    uint16_t i = 0;
+
+    while (i < count) {
+        uint8_t temp;
         uint16_t crc;
 
+        //Between messages skip straight to the next preamble, and take
+        //as much of a message body as the buffer holds in one go.
+        if (parser_state.state == sbp_parser_state_t::WAITING) {
+            const uint8_t *p = (const uint8_t *)memchr(&bytes[i], SBP_PREAMBLE, count - i);
+            if (p == nullptr) {
+                break;
+            }
+            i = (p - bytes) + 1;
+            parser_state.n_read = 0;
+            parser_state.state = sbp_parser_state_t::GET_TYPE;
+            continue;
+        }
+        if (parser_state.state == sbp_parser_state_t::GET_MSG) {
+            const uint16_t n = MIN((uint16_t)(count - i), (uint16_t)(parser_state.msg_len - parser_state.n_read));
+            memcpy(&parser_state.msg_buff[parser_state.n_read], &bytes[i], n);
+            parser_state.n_read += n;
+            i += n;
+            if (parser_state.n_read >= parser_state.msg_len) {
+                parser_state.n_read = 0;
+                parser_state.state = sbp_parser_state_t::GET_CRC;
+            }
+            continue;
+        }
+
+        temp = bytes[i++];
 
-        //This switch reads one character at a time,
+        //This switch reads the header and CRC one character at a time,
         //parsing it into buffers until a full message is dispatched
         switch(parser_state.state) {
-            case sbp_parser_state_t::WAITING:
-                if (temp == SBP_PREAMBLE) {
-                    parser_state.n_read = 0;
-                    parser_state.state = sbp_parser_state_t::GET_TYPE;
-                }
-                break;
-
             case sbp_parser_state_t::GET_TYPE:
                 *((uint8_t*)&(parser_state.msg_type) + parser_state.n_read) = temp;
                 parser_state.n_read += 1;
@@ -141,15 +173,6 @@ AP_GPS_SBP::_sbp_process()
                 parser_state.state = sbp_parser_state_t::GET_MSG;
                 break;
 
-            case sbp_parser_state_t::GET_MSG:
-                *((uint8_t*)&(parser_state.msg_buff) + parser_state.n_read) = temp;
-                parser_state.n_read += 1;
-                if (parser_state.n_read >= parser_state.msg_len) {
-                    parser_state.n_read = 0;
-                    parser_state.state = sbp_parser_state_t::GET_CRC;
-                }
-                break;
-
             case sbp_parser_state_t::GET_CRC:
                 *((uint8_t*)&(parser_state.crc) + parser_state.n_read) = temp;
                 parser_state.n_read += 1;
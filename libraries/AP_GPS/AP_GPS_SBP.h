@@ -26,6 +26,8 @@
 
 class AP_GPS_SBP : public AP_GPS_Backend
 {
+    friend class AP_GPS_SBP_Test;
+
 public:
     AP_GPS_SBP(AP_GPS &_gps, AP_GPS::GPS_State &_state, AP_HAL::UARTDriver *_port);
 
@@ -133,6 +135,7 @@ private:
     };
 
     void _sbp_process();
+    void _sbp_process_bytes(const uint8_t *bytes, uint16_t count);
     void _sbp_process_message();
     bool _attempt_state_update();
 
@@ -326,8 +326,6 @@ AP_GPS_UBLOX::_request_port(void)
 bool
 AP_GPS_UBLOX::read(void)
 {
-    uint8_t data;
-    int16_t numc;
     bool parsed = false;
     uint32_t millis_now = AP_HAL::millis();
 
@@ -356,15 +354,63 @@ AP_GPS_UBLOX::read(void)
         }
     }
 
-    numc = port->available();
-    for (int16_t i = 0; i < numc; i++) {        // Process bytes received
+    // only take what is available now, so a fast stream can't keep
+    // us here
+    uint32_t numc = port->available();
+    while (numc > 0) {
+        uint8_t bytes[GPS_BACKEND_READ_SIZE];
+        const uint32_t n = port->read(bytes, MIN(numc, sizeof(bytes)));
+        if (n == 0) {
+            break;
+        }
+        if (_parse_bytes(bytes, n)) {
+            parsed = true;
+        }
+        numc -= MIN(n, numc);
+    }
+    return parsed;
+}
+
+bool
+AP_GPS_UBLOX::_parse_bytes(const uint8_t *bytes, uint16_t count)
+{
+    uint8_t data;
+    bool parsed = false;
+    uint16_t i = 0;
+
+    while (i < count) {
+        // between messages, skip straight to the next possible preamble
+        if (_step == 0) {
+            const uint8_t *p = (const uint8_t *)memchr(&bytes[i], PREAMBLE1, count - i);
+            if (p == nullptr) {
+                break;
+            }
+            i = (p - bytes) + 1;
+            _step++;
+            continue;
+        }
+
+        // Receive message data
+        //
+        // take as much of the payload as this buffer holds in one go.
+        // The length was checked against sizeof(_buffer) in the header
+        if (_step == 6) {
+            const uint16_t n = MIN((uint16_t)(count - i), (uint16_t)(_payload_length - _payload_counter));
+            _update_checksum(&bytes[i], n, _ck_a, _ck_b);
+            memcpy(&_buffer[_payload_counter], &bytes[i], n);
+            _payload_counter += n;
+            i += n;
+            if (_payload_counter == _payload_length) {
+                _step++;
+            }
+            continue;
+        }
 
         // read the next byte
-        data = port->read();
+        data = bytes[i++];
 
 	reset:
         switch(_step) {
-
         // Message preamble detection
         //
         // If we fail to match any of the expected bytes, we reset
@@ -426,17 +472,6 @@ AP_GPS_UBLOX::read(void)
             _payload_counter = 0;                               // prepare to receive payload
             break;
 
-        // Receive message data
-        //
-        case 6:
-            _ck_b += (_ck_a += data);                   // checksum byte
-            if (_payload_counter < sizeof(_buffer)) {
-                _buffer[_payload_counter] = data;
-            }
-            if (++_payload_counter == _payload_length)
-                _step++;
-            break;
-
         // Checksum and message processing
         //
         case 7:
@@ -982,15 +1017,30 @@ AP_GPS_UBLOX::_parse_gps(void)
 
 /*
  *  update checksum for a set of bytes
+ *
+ *  Four bytes are added at a time, using the sums they would have made
+ *  one at a time, which shortens the chain of dependent additions.
+ *  The wider accumulators wrap at a multiple of 256 so the truncated
+ *  result is exact
  */
 void
-AP_GPS_UBLOX::_update_checksum(uint8_t *data, uint16_t len, uint8_t &ck_a, uint8_t &ck_b)
+AP_GPS_UBLOX::_update_checksum(const uint8_t *data, uint16_t len, uint8_t &ck_a, uint8_t &ck_b)
 {
+    uint32_t a = ck_a;
+    uint32_t b = ck_b;
+    while (len >= 4) {
+        b += 4*a + 4*data[0] + 3*data[1] + 2*data[2] + data[3];
+        a += data[0] + data[1] + data[2] + data[3];
+        data += 4;
+        len -= 4;
+    }
     while (len--) {
-        ck_a += *data;
-        ck_b += ck_a;
+        a += *data;
+        b += a;
         data++;
     }
+    ck_a = a;
+    ck_b = b;
 }
 
 
@@ -88,6 +88,8 @@
 
 class AP_GPS_UBLOX : public AP_GPS_Backend
 {
+    friend class AP_GPS_UBLOX_Test;
+
 public:
 	AP_GPS_UBLOX(AP_GPS &_gps, AP_GPS::GPS_State &_state, AP_HAL::UARTDriver *_port);
 
@@ -502,6 +504,9 @@ private:
     // Buffer parse & GPS state update
     bool        _parse_gps();
 
+    // run bytes from the port through the state machine
+    bool        _parse_bytes(const uint8_t *bytes, uint16_t count);
+
     // used to update fix between status and position packets
     AP_GPS::GPS_Status next_fix;
 
@@ -512,7 +517,7 @@ private:
     bool        _configure_message_rate(uint8_t msg_class, uint8_t msg_id, uint8_t rate);
     void        _configure_rate(void);
     void        _configure_sbas(bool enable);
-    void        _update_checksum(uint8_t *data, uint16_t len, uint8_t &ck_a, uint8_t &ck_b);
+    void        _update_checksum(const uint8_t *data, uint16_t len, uint8_t &ck_a, uint8_t &ck_b);
     void        _send_message(uint8_t msg_class, uint8_t msg_id, void *msg, uint16_t size);
     void	send_next_rate_update(void);
     bool        _request_message_rate(uint8_t msg_class, uint8_t msg_id);
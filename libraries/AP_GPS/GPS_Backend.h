@@ -21,6 +21,9 @@
 #include <GCS_MAVLink/GCS_MAVLink.h>
 #include "AP_GPS.h"
 
+// bytes taken from the port at a time by backends which parse whole buffers
+#define GPS_BACKEND_READ_SIZE 128
+
 class AP_GPS_Backend
 {
 public:
@@ -41,6 +44,9 @@ public:
 
     virtual bool is_configured(void) { return true; }
 
+    // the expected lag (in seconds) in the position and velocity readings
+    virtual float get_lag(void) const { return 0.2f; }
+
     virtual void inject_data(const uint8_t *data, uint16_t len) { return; }
 
     //MAVLink methods
@@ -0,0 +1,213 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/AP_Common.h>
+#include <AP_GPS/AP_GPS.h>
+#include <AP_GPS/AP_GPS_NMEA.h>
+#include <AP_GPS/AP_GPS_SBP.h>
+#include <AP_GPS/AP_GPS_UBLOX.h>
+#include <AP_Math/edc.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+// bytes arriving between two calls to read(), about 100ms of a
+// receiver sending at 10Hz over 115200 baud
+#define BENCH_POLL_BYTES 1024
+
+/*
+ * A UART replaying a recorded stream in a loop. Each poll makes
+ * BENCH_POLL_BYTES available. Without bulk reads the bytes are taken
+ * through the default Stream::read(buffer, count), one virtual read()
+ * call per byte, as drivers without a receive buffer do.
+ */
+class BenchUART : public AP_HAL::UARTDriver {
+public:
+    BenchUART(const uint8_t *stream, uint32_t len, bool bulk) :
+        _stream(stream), _len(len), _ofs(0), _pending(0), _bulk(bulk) {}
+
+    void poll() { _pending = BENCH_POLL_BYTES; }
+
+    void begin(uint32_t baud) override {}
+    void begin(uint32_t baud, uint16_t rxSpace, uint16_t txSpace) override {}
+    void end() override {}
+    void flush() override {}
+    bool is_initialized() override { return true; }
+    void set_blocking_writes(bool blocking) override {}
+    bool tx_pending() override { return false; }
+
+    uint32_t available() override { return _pending; }
+    uint32_t txspace() override { return 4096; }
+
+    int16_t read() override {
+        if (_pending == 0) {
+            return -1;
+        }
+        _pending--;
+        const uint8_t c = _stream[_ofs++];
+        if (_ofs == _len) {
+            _ofs = 0;
+        }
+        return c;
+    }
+
+    uint32_t read(uint8_t *buffer, uint32_t count) override {
+        if (!_bulk) {
+            return AP_HAL::UARTDriver::read(buffer, count);
+        }
+        count = MIN(count, _pending);
+        uint32_t n = 0;
+        while (n < count) {
+            const uint32_t chunk = MIN(count - n, _len - _ofs);
+            memcpy(&buffer[n], &_stream[_ofs], chunk);
+            n += chunk;
+            _ofs = (_ofs + chunk) % _len;
+        }
+        _pending -= n;
+        return n;
+    }
+
+    size_t write(uint8_t c) override { return 1; }
+    size_t write(const uint8_t *buffer, size_t size) override { return size; }
+
+private:
+    const uint8_t *_stream;
+    const uint32_t _len;
+    uint32_t _ofs;
+    uint32_t _pending;
+    const bool _bulk;
+};
+
+/*
+ * One second of output from each kind of receiver at 10Hz
+ */
+#define STREAM_MAX 8192
+
+static uint8_t ubx_stream[STREAM_MAX];
+static uint32_t ubx_len;
+static uint8_t nmea_stream[STREAM_MAX];
+static uint32_t nmea_len;
+static uint8_t sbp_stream[STREAM_MAX];
+static uint32_t sbp_len;
+
+static void ubx_message(uint8_t msg_class, uint8_t msg_id, uint16_t len)
+{
+    uint8_t *p = &ubx_stream[ubx_len];
+    p[0] = 0xb5;
+    p[1] = 0x62;
+    p[2] = msg_class;
+    p[3] = msg_id;
+    p[4] = len & 0xFF;
+    p[5] = len >> 8;
+    for (uint16_t i = 0; i < len; i++) {
+        p[6 + i] = (i * 37 + msg_id) & 0xFF;
+    }
+    uint8_t ck_a = 0, ck_b = 0;
+    for (uint16_t i = 2; i < 6 + len; i++) {
+        ck_a += p[i];
+        ck_b += ck_a;
+    }
+    p[6 + len] = ck_a;
+    p[7 + len] = ck_b;
+    ubx_len += len + 8;
+}
+
+static void nmea_sentence(const char *body)
+{
+    uint8_t parity = 0;
+    for (const char *c = body; *c; c++) {
+        parity ^= *c;
+    }
+    nmea_len += snprintf((char *)&nmea_stream[nmea_len], STREAM_MAX - nmea_len, "$%s*%02X\r\n", body, parity);
+}
+
+static void sbp_message(uint16_t msg_type, uint8_t len)
+{
+    uint8_t *p = &sbp_stream[sbp_len];
+    p[0] = 0x55;
+    p[1] = msg_type & 0xFF;
+    p[2] = msg_type >> 8;
+    p[3] = 0x42;
+    p[4] = 0x00;
+    p[5] = len;
+    for (uint8_t i = 0; i < len; i++) {
+        p[6 + i] = (i * 37 + msg_type) & 0xFF;
+    }
+    const uint16_t crc = crc16_ccitt(&p[1], 5 + len, 0);
+    p[6 + len] = crc & 0xFF;
+    p[7 + len] = crc >> 8;
+    sbp_len += len + 8;
+}
+
+static void setup_streams()
+{
+    if (ubx_len != 0) {
+        return;
+    }
+    for (uint8_t i = 0; i < 10; i++) {
+        ubx_message(0x01, 0x02, 28);  // NAV-POSLLH
+        ubx_message(0x01, 0x03, 16);  // NAV-STATUS
+        ubx_message(0x01, 0x04, 18);  // NAV-DOP
+        ubx_message(0x01, 0x06, 52);  // NAV-SOL
+        ubx_message(0x01, 0x12, 36);  // NAV-VELNED
+        ubx_message(0x0A, 0x09, 60);  // MON-HW
+
+        nmea_sentence("GPGGA,123519.00,4807.03812,N,01131.00046,E,4,12,0.9,545.4,M,46.9,M,1.0,0000");
+        nmea_sentence("GPRMC,123519.00,A,4807.03812,N,01131.00046,E,0.022,84.4,230394,,,R");
+        nmea_sentence("GPVTG,84.4,T,,M,0.022,N,0.041,K,R");
+        nmea_sentence("GPGSA,A,3,04,05,09,12,24,25,29,31,,,,,1.8,0.9,1.5");
+        nmea_sentence("GPGSV,3,1,12,04,40,083,46,05,17,308,41,09,07,044,39,12,13,242,44");
+        nmea_sentence("GPGSV,3,2,12,24,64,163,50,25,26,276,45,29,58,048,49,31,11,164,40");
+        nmea_sentence("GPGSV,3,3,12,02,05,190,33,10,02,300,30,14,08,125,35,26,41,220,47");
+
+        sbp_message(0x0100, 11);      // GPS_TIME
+        sbp_message(0x0201, 34);      // POS_LLH
+        sbp_message(0x0205, 22);      // VEL_NED
+        sbp_message(0x0206, 14);      // DOPS
+        sbp_message(0x0203, 22);      // BASELINE_NED
+        sbp_message(0x0016, 9 * 12);  // TRACKING_STATE, 12 channels
+        sbp_message(0x0019, 4);       // IAR_STATE
+    }
+    sbp_message(0xFFFF, 4);           // HEARTBEAT
+}
+
+static AP_GPS gps;
+
+template <typename Backend>
+static void run_parser(benchmark::State& state, const uint8_t *stream, uint32_t len, bool bulk)
+{
+    AP_GPS::GPS_State gps_state {};
+    BenchUART port(stream, len, bulk);
+    Backend backend(gps, gps_state, &port);
+
+    while (state.KeepRunning()) {
+        port.poll();
+        bool parsed = backend.read();
+        gbenchmark_escape(&parsed);
+    }
+    state.SetBytesProcessed(state.iterations() * BENCH_POLL_BYTES);
+}
+
+static void BM_UBX(benchmark::State& state)
+{
+    setup_streams();
+    run_parser<AP_GPS_UBLOX>(state, ubx_stream, ubx_len, state.range_x());
+}
+
+static void BM_NMEA(benchmark::State& state)
+{
+    setup_streams();
+    run_parser<AP_GPS_NMEA>(state, nmea_stream, nmea_len, state.range_x());
+}
+
+static void BM_SBP(benchmark::State& state)
+{
+    setup_streams();
+    run_parser<AP_GPS_SBP>(state, sbp_stream, sbp_len, state.range_x());
+}
+
+// argument 0 reads a byte at a time, 1 uses bulk reads
+BENCHMARK(BM_UBX)->Arg(0)->Arg(1);
+BENCHMARK(BM_NMEA)->Arg(0)->Arg(1);
+BENCHMARK(BM_SBP)->Arg(0)->Arg(1);
+
+BENCHMARK_MAIN()
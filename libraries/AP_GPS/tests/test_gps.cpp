@@ -17,6 +17,9 @@
 #include <AP_gtest.h>
 
 #include <AP_GPS/AP_GPS_NMEA.h>
+#include <AP_GPS/AP_GPS_SBP.h>
+#include <AP_GPS/AP_GPS_UBLOX.h>
+#include <AP_Math/edc.h>
 
 const AP_HAL::HAL &hal = AP_HAL::get_HAL();
 
@@ -27,6 +30,16 @@ public:
     {
         return AP_GPS_NMEA::_parse_decimal_100(p);
     }
+
+    static bool decode(AP_GPS_NMEA &nmea, char c)
+    {
+        return nmea._decode(c);
+    }
+
+    static bool decode_bytes(AP_GPS_NMEA &nmea, const char *buf, uint16_t count)
+    {
+        return nmea._decode_bytes(buf, count);
+    }
 };
 
 TEST(AP_GPS_NMEA, parse_decimal_100)
@@ -62,4 +75,319 @@ TEST(AP_GPS_NMEA, parse_decimal_100)
     ASSERT_EQ(-100, test.parse_decimal_100("-1"));
 }
 
+/* the last sentence has a bad checksum and must be ignored */
+static const char nmea_stream[] =
+    "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n"
+    "$GPGSV,2,1,08,01,40,083,46,02,17,308,41,12,07,344,39,14,22,228,45*75\r\n"
+    "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n"
+    "$GPGGA,123520,4807.040,N,01131.002,E,1,09,1.0,546.0,M,46.9,M,,*4F\r\n";
+
+TEST(AP_GPS_NMEA, decode_bytes)
+{
+    static AP_GPS gps;
+    const uint16_t len = sizeof(nmea_stream) - 1;
+
+    /* Buffers of any size decode the same as a character at a time */
+    for (uint16_t chunk = 1; chunk <= len; chunk++) {
+        AP_GPS::GPS_State bytewise_state {};
+        AP_GPS::GPS_State bulk_state {};
+        AP_GPS_NMEA bytewise(gps, bytewise_state, nullptr);
+        AP_GPS_NMEA bulk(gps, bulk_state, nullptr);
+
+        for (uint16_t i = 0; i < len; i++) {
+            AP_GPS_NMEA_Test::decode(bytewise, nmea_stream[i]);
+        }
+        for (uint16_t i = 0; i < len; i += chunk) {
+            AP_GPS_NMEA_Test::decode_bytes(bulk, &nmea_stream[i], MIN(chunk, (uint16_t)(len - i)));
+        }
+
+        ASSERT_EQ(bytewise_state.status, bulk_state.status);
+        ASSERT_EQ(bytewise_state.location.lat, bulk_state.location.lat);
+        ASSERT_EQ(bytewise_state.location.lng, bulk_state.location.lng);
+        ASSERT_EQ(bytewise_state.location.alt, bulk_state.location.alt);
+        ASSERT_EQ(bytewise_state.num_sats, bulk_state.num_sats);
+        ASSERT_EQ(bytewise_state.hdop, bulk_state.hdop);
+        ASSERT_FLOAT_EQ(bytewise_state.ground_speed, bulk_state.ground_speed);
+        ASSERT_FLOAT_EQ(bytewise_state.ground_course, bulk_state.ground_course);
+
+        EXPECT_EQ(AP_GPS::GPS_OK_FIX_3D, bulk_state.status);
+        EXPECT_NEAR(481173000, bulk_state.location.lat, 10);
+        EXPECT_NEAR(115166667, bulk_state.location.lng, 10);
+        EXPECT_EQ(8, bulk_state.num_sats);
+    }
+}
+
+#define TEST_STREAM_MAX 512
+
+struct test_stream {
+    uint8_t data[TEST_STREAM_MAX];
+    uint16_t len;
+
+    void add(const void *bytes, uint16_t n)
+    {
+        if (n > 0) {
+            memcpy(&data[len], bytes, n);
+            len += n;
+        }
+    }
+};
+
+/*
+ * A UART with nothing to read that accepts every write, for backends
+ * that send configuration from their constructor
+ */
+class NullUART : public AP_HAL::UARTDriver {
+public:
+    void begin(uint32_t baud) override {}
+    void begin(uint32_t baud, uint16_t rxSpace, uint16_t txSpace) override {}
+    void end() override {}
+    void flush() override {}
+    bool is_initialized() override { return true; }
+    void set_blocking_writes(bool blocking) override {}
+    bool tx_pending() override { return false; }
+    uint32_t available() override { return 0; }
+    uint32_t txspace() override { return 4096; }
+    int16_t read() override { return -1; }
+    size_t write(uint8_t c) override { return 1; }
+    size_t write(const uint8_t *buffer, size_t size) override { return size; }
+};
+
+class AP_GPS_UBLOX_Test
+{
+public:
+    static bool parse_bytes(AP_GPS_UBLOX &ublox, const uint8_t *bytes, uint16_t count)
+    {
+        return ublox._parse_bytes(bytes, count);
+    }
+};
+
+class AP_GPS_SBP_Test
+{
+public:
+    static void process_bytes(AP_GPS_SBP &sbp, const uint8_t *bytes, uint16_t count)
+    {
+        sbp._sbp_process_bytes(bytes, count);
+    }
+
+    static void expect_same(const AP_GPS_SBP &a, const AP_GPS_SBP &b)
+    {
+        EXPECT_EQ(0, memcmp(&a.last_gps_time, &b.last_gps_time, sizeof(a.last_gps_time)));
+        EXPECT_EQ(0, memcmp(&a.last_dops, &b.last_dops, sizeof(a.last_dops)));
+        EXPECT_EQ(0, memcmp(&a.last_pos_llh_spp, &b.last_pos_llh_spp, sizeof(a.last_pos_llh_spp)));
+        EXPECT_EQ(0, memcmp(&a.last_pos_llh_rtk, &b.last_pos_llh_rtk, sizeof(a.last_pos_llh_rtk)));
+        EXPECT_EQ(0, memcmp(&a.last_vel_ned, &b.last_vel_ned, sizeof(a.last_vel_ned)));
+        EXPECT_EQ(a.last_iar_num_hypotheses, b.last_iar_num_hypotheses);
+        EXPECT_EQ(a.crc_error_counter, b.crc_error_counter);
+        EXPECT_EQ(a.parser_state.state, b.parser_state.state);
+    }
+
+    static const AP_GPS_SBP::sbp_pos_llh_t &pos_llh_rtk(const AP_GPS_SBP &sbp) { return sbp.last_pos_llh_rtk; }
+    static const AP_GPS_SBP::sbp_vel_ned_t &vel_ned(const AP_GPS_SBP &sbp) { return sbp.last_vel_ned; }
+    static const AP_GPS_SBP::sbp_dops_t &dops(const AP_GPS_SBP &sbp) { return sbp.last_dops; }
+    static uint32_t iar_num_hypotheses(const AP_GPS_SBP &sbp) { return sbp.last_iar_num_hypotheses; }
+    static uint32_t crc_errors(const AP_GPS_SBP &sbp) { return sbp.crc_error_counter; }
+
+    static void sbp_message(test_stream &s, uint16_t msg_type, const void *payload, uint8_t len,
+                            bool good_crc = true)
+    {
+        const uint8_t header[] = { 0x55, (uint8_t)(msg_type & 0xFF), (uint8_t)(msg_type >> 8), 0x42, 0x00, len };
+        const uint16_t start = s.len;
+        s.add(header, sizeof(header));
+        s.add(payload, len);
+        uint16_t crc = crc16_ccitt(&s.data[start + 1], 5 + len, 0);
+        if (!good_crc) {
+            crc++;
+        }
+        const uint8_t crc_bytes[] = { (uint8_t)(crc & 0xFF), (uint8_t)(crc >> 8) };
+        s.add(crc_bytes, sizeof(crc_bytes));
+    }
+
+    /*
+     * noise, a full solution with a message with a bad CRC and messages
+     * with no payload between its parts
+     */
+    static void sbp_test_stream(test_stream &s)
+    {
+        const uint8_t noise[] = { 0x00, 0x12, 0x34 };
+        s.add(noise, sizeof(noise));
+
+        AP_GPS_SBP::sbp_gps_time_t gps_time { 1900, 100000, 0, 0 };
+        sbp_message(s, 0x0100, &gps_time, sizeof(gps_time));
+
+        AP_GPS_SBP::sbp_dops_t dops { 100000, 200, 180, 100, 120, 150 };
+        sbp_message(s, 0x0206, &dops, sizeof(dops), false);
+        sbp_message(s, 0xFF00, nullptr, 0);
+        dops.hdop = 110;
+        sbp_message(s, 0x0206, &dops, sizeof(dops));
+
+        AP_GPS_SBP::sbp_pos_llh_t pos_llh { 100000, -35.363262, 149.165237, 584.0, 20, 30, 12, 1 };
+        sbp_message(s, 0x0201, &pos_llh, sizeof(pos_llh));
+        sbp_message(s, 0x0042, nullptr, 0);
+
+        AP_GPS_SBP::sbp_vel_ned_t vel_ned { 100000, 3000, -4000, 100, 20, 30, 12, 0 };
+        sbp_message(s, 0x0205, &vel_ned, sizeof(vel_ned));
+
+        AP_GPS_SBP::sbp_iar_state_t iar { 7 };
+        sbp_message(s, 0x0019, &iar, sizeof(iar));
+    }
+};
+
+static void ubx_message(test_stream &s, uint8_t msg_class, uint8_t msg_id,
+                        const void *payload, uint16_t len, bool good_checksum = true)
+{
+    const uint8_t header[] = { 0xb5, 0x62, msg_class, msg_id, (uint8_t)(len & 0xFF), (uint8_t)(len >> 8) };
+    const uint16_t start = s.len;
+    s.add(header, sizeof(header));
+    s.add(payload, len);
+    uint8_t ck_a = 0, ck_b = 0;
+    for (uint16_t i = start + 2; i < s.len; i++) {
+        ck_a += s.data[i];
+        ck_b += ck_a;
+    }
+    if (!good_checksum) {
+        ck_b++;
+    }
+    const uint8_t ck[] = { ck_a, ck_b };
+    s.add(ck, sizeof(ck));
+}
+
+static void ubx_position(test_stream &s, uint32_t time, int32_t lat, int32_t lng, int32_t alt_mm,
+                         bool good_checksum = true)
+{
+    struct PACKED {
+        uint32_t time;
+        int32_t longitude;
+        int32_t latitude;
+        int32_t altitude_ellipsoid;
+        int32_t altitude_msl;
+        uint32_t horizontal_accuracy;
+        uint32_t vertical_accuracy;
+    } posllh { time, lng, lat, alt_mm, alt_mm, 1500, 2500 };
+    ubx_message(s, 0x01, 0x02, &posllh, sizeof(posllh), good_checksum);
+    if (!good_checksum) {
+        return;
+    }
+
+    struct PACKED {
+        uint32_t time;
+        int32_t ned_north;
+        int32_t ned_east;
+        int32_t ned_down;
+        uint32_t speed_3d;
+        uint32_t speed_2d;
+        int32_t heading_2d;
+        uint32_t speed_accuracy;
+        uint32_t heading_accuracy;
+    } velned { time, 300, 400, -10, 500, 500, 5313010, 20, 100000 };
+    ubx_message(s, 0x01, 0x12, &velned, sizeof(velned));
+}
+
+/*
+ * noise, a 3D fix status, a message with a bad checksum, messages
+ * with no payload and two position and velocity solutions
+ */
+static void ubx_test_stream(test_stream &s)
+{
+    const uint8_t noise[] = { 0x00, 0xb5, 0x00, 0xb5, 0xb5, 0x17 };
+    s.add(noise, sizeof(noise));
+
+    struct PACKED {
+        uint32_t time;
+        uint8_t fix_type;
+        uint8_t fix_status;
+        uint8_t differential_status;
+        uint8_t res;
+        uint32_t time_to_first_fix;
+        uint32_t uptime;
+    } status { 1000, 3, 1, 0, 0, 5000, 60000 };
+    ubx_message(s, 0x01, 0x03, &status, sizeof(status));
+
+    ubx_position(s, 1000, -353632620, 1491652370, 584000);
+    ubx_message(s, 0x0B, 0x01, nullptr, 0);
+    ubx_position(s, 1200, 10, 20, 30, false);
+    ubx_message(s, 0x0B, 0x01, nullptr, 0);
+    ubx_position(s, 1200, -353632000, 1491652000, 585000);
+}
+
+TEST(AP_GPS_UBLOX, parse_bytes)
+{
+    static AP_GPS gps;
+    test_stream stream {};
+    ubx_test_stream(stream);
+    const uint16_t len = stream.len;
+
+    /* Buffers of any size parse the same as a byte at a time */
+    for (uint16_t chunk = 1; chunk <= len; chunk++) {
+        SCOPED_TRACE(chunk);
+        NullUART bytewise_port;
+        NullUART bulk_port;
+        AP_GPS::GPS_State bytewise_state {};
+        AP_GPS::GPS_State bulk_state {};
+        AP_GPS_UBLOX bytewise(gps, bytewise_state, &bytewise_port);
+        AP_GPS_UBLOX bulk(gps, bulk_state, &bulk_port);
+
+        uint8_t bytewise_parsed = 0;
+        for (uint16_t i = 0; i < len; i++) {
+            bytewise_parsed += AP_GPS_UBLOX_Test::parse_bytes(bytewise, &stream.data[i], 1);
+        }
+        bool bulk_parsed = false;
+        for (uint16_t i = 0; i < len; i += chunk) {
+            bulk_parsed |= AP_GPS_UBLOX_Test::parse_bytes(bulk, &stream.data[i], MIN(chunk, (uint16_t)(len - i)));
+        }
+
+        ASSERT_EQ(2, bytewise_parsed);
+        ASSERT_TRUE(bulk_parsed);
+        ASSERT_EQ(bytewise_state.status, bulk_state.status);
+        ASSERT_EQ(bytewise_state.location.lat, bulk_state.location.lat);
+        ASSERT_EQ(bytewise_state.location.lng, bulk_state.location.lng);
+        ASSERT_EQ(bytewise_state.location.alt, bulk_state.location.alt);
+        ASSERT_FLOAT_EQ(bytewise_state.horizontal_accuracy, bulk_state.horizontal_accuracy);
+        ASSERT_FLOAT_EQ(bytewise_state.velocity.x, bulk_state.velocity.x);
+        ASSERT_FLOAT_EQ(bytewise_state.velocity.y, bulk_state.velocity.y);
+        ASSERT_FLOAT_EQ(bytewise_state.velocity.z, bulk_state.velocity.z);
+        ASSERT_FLOAT_EQ(bytewise_state.ground_speed, bulk_state.ground_speed);
+
+        EXPECT_EQ(AP_GPS::GPS_OK_FIX_3D, bulk_state.status);
+        EXPECT_EQ(-353632000, bulk_state.location.lat);
+        EXPECT_EQ(1491652000, bulk_state.location.lng);
+        EXPECT_EQ(58500, bulk_state.location.alt);
+        EXPECT_FLOAT_EQ(5.0f, bulk_state.ground_speed);
+    }
+}
+
+TEST(AP_GPS_SBP, process_bytes)
+{
+    static AP_GPS gps;
+    test_stream stream {};
+    AP_GPS_SBP_Test::sbp_test_stream(stream);
+    const uint16_t len = stream.len;
+
+    /* Buffers of any size parse the same as a byte at a time */
+    for (uint16_t chunk = 1; chunk <= len; chunk++) {
+        SCOPED_TRACE(chunk);
+        NullUART bytewise_port;
+        NullUART bulk_port;
+        AP_GPS::GPS_State bytewise_state {};
+        AP_GPS::GPS_State bulk_state {};
+        AP_GPS_SBP bytewise(gps, bytewise_state, &bytewise_port);
+        AP_GPS_SBP bulk(gps, bulk_state, &bulk_port);
+
+        for (uint16_t i = 0; i < len; i++) {
+            AP_GPS_SBP_Test::process_bytes(bytewise, &stream.data[i], 1);
+        }
+        for (uint16_t i = 0; i < len; i += chunk) {
+            AP_GPS_SBP_Test::process_bytes(bulk, &stream.data[i], MIN(chunk, (uint16_t)(len - i)));
+        }
+
+        AP_GPS_SBP_Test::expect_same(bytewise, bulk);
+
+        EXPECT_EQ(1U, AP_GPS_SBP_Test::crc_errors(bulk));
+        EXPECT_EQ(110, AP_GPS_SBP_Test::dops(bulk).hdop);
+        EXPECT_EQ(100000U, AP_GPS_SBP_Test::pos_llh_rtk(bulk).tow);
+        EXPECT_EQ(12, AP_GPS_SBP_Test::pos_llh_rtk(bulk).n_sats);
+        EXPECT_EQ(-4000, AP_GPS_SBP_Test::vel_ned(bulk).e);
+        EXPECT_EQ(7U, AP_GPS_SBP_Test::iar_num_hypotheses(bulk));
+    }
+}
+
 AP_GTEST_MAIN()
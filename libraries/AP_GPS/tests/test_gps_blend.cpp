@@ -0,0 +1,154 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gtest.h>
+
+#include <AP_GPS/AP_GPS.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+static const uint64_t base_epoch_ms = 1480000000000ULL;
+
+static Location base_location()
+{
+    Location loc {};
+    loc.lat = -353632620;
+    loc.lng = 1491652370;
+    loc.alt = 58400;
+    return loc;
+}
+
+/*
+  give a receiver a 3D fix north_m metres north of the base location,
+  valid at sample_ms
+ */
+static void set_fix(AP_GPS &gps, uint8_t instance, float north_m, const Vector3f &velocity,
+                    float hacc, uint32_t sample_ms)
+{
+    Location loc = base_location();
+    location_offset(loc, north_m, 0);
+    gps.setHIL(instance, AP_GPS::GPS_OK_FIX_3D, base_epoch_ms + sample_ms, loc, velocity, 12, 100);
+    gps.setHIL_Accuracy(instance, 1.0f, hacc, 2 * hacc, 0.5f, true, sample_ms);
+}
+
+static float blended_north(const AP_GPS &gps)
+{
+    return location_diff(base_location(), gps.location()).x;
+}
+
+TEST(AP_GPS_Blend, weights_from_accuracy)
+{
+    static AP_GPS gps;
+    gps._auto_switch.set(AP_GPS::GPS_SWITCH_BLEND);
+    gps._blend_mask.set(AP_GPS::GPS_BLEND_MASK_HPOS);
+
+    set_fix(gps, 0, 0, Vector3f(), 1.0f, 1000);
+    set_fix(gps, 1, 3, Vector3f(), 2.0f, 1000);
+    gps.update();
+
+    EXPECT_EQ(GPS_BLENDED_INSTANCE, gps.primary_sensor());
+    EXPECT_FLOAT_EQ(0.8f, gps.get_blend_weight(0));
+    EXPECT_FLOAT_EQ(0.2f, gps.get_blend_weight(1));
+    EXPECT_NEAR(0.6f, blended_north(gps), 0.05f);
+    EXPECT_EQ(AP_GPS::GPS_OK_FIX_3D, gps.status());
+}
+
+TEST(AP_GPS_Blend, time_alignment)
+{
+    static AP_GPS gps;
+    gps._auto_switch.set(AP_GPS::GPS_SWITCH_BLEND);
+    gps._blend_mask.set(AP_GPS::GPS_BLEND_MASK_HPOS);
+
+    // both receivers see the same track, the second 100ms later
+    const Vector3f velocity(5, 0, 0);
+    set_fix(gps, 0, 0.5f, velocity, 1.0f, 1100);
+    set_fix(gps, 1, 0, velocity, 1.0f, 1000);
+    gps.update();
+
+    EXPECT_NEAR(0.5f, blended_north(gps), 0.05f);
+    EXPECT_FLOAT_EQ(5.0f, gps.ground_speed());
+    EXPECT_EQ(1100U, gps.last_message_time_ms());
+}
+
+TEST(AP_GPS_Blend, no_step_when_receiver_lost)
+{
+    static AP_GPS gps;
+    gps._auto_switch.set(AP_GPS::GPS_SWITCH_BLEND);
+    gps._blend_mask.set(AP_GPS::GPS_BLEND_MASK_HPOS);
+
+    uint32_t t = 1000;
+    for (uint8_t i = 0; i < 150; i++, t += 200) {
+        set_fix(gps, 0, 0, Vector3f(), 1.0f, t);
+        set_fix(gps, 1, 4, Vector3f(), 1.0f, t);
+        gps.update();
+    }
+    EXPECT_NEAR(2.0f, blended_north(gps), 0.05f);
+
+    // the output starts from the blend and converges onto the
+    // remaining receiver
+    set_fix(gps, 0, 0, Vector3f(), 1.0f, t);
+    gps.setHIL(1, AP_GPS::NO_FIX, base_epoch_ms + t, base_location(), Vector3f(), 3, 9999);
+    gps.update();
+    EXPECT_EQ(GPS_BLENDED_INSTANCE, gps.primary_sensor());
+    EXPECT_FLOAT_EQ(1.0f, gps.get_blend_weight(0));
+    EXPECT_NEAR(2.0f, blended_north(gps), 0.25f);
+
+    for (uint8_t i = 0; i < 150; i++) {
+        t += 200;
+        set_fix(gps, 0, 0, Vector3f(), 1.0f, t);
+        gps.update();
+    }
+    EXPECT_NEAR(0.0f, blended_north(gps), 0.25f);
+}
+
+TEST(AP_GPS_Blend, needs_accuracy)
+{
+    static AP_GPS gps;
+    gps._auto_switch.set(AP_GPS::GPS_SWITCH_BLEND);
+    gps._blend_mask.set(AP_GPS::GPS_BLEND_MASK_HPOS);
+
+    Location loc = base_location();
+    gps.setHIL(0, AP_GPS::GPS_OK_FIX_3D, base_epoch_ms, loc, Vector3f(), 12, 100);
+    gps.setHIL(1, AP_GPS::GPS_OK_FIX_3D, base_epoch_ms, loc, Vector3f(), 12, 100);
+    gps.update();
+
+    // without accuracies the blend follows a single receiver
+    EXPECT_EQ(GPS_BLENDED_INSTANCE, gps.primary_sensor());
+    EXPECT_FLOAT_EQ(1.0f, gps.get_blend_weight(0) + gps.get_blend_weight(1));
+    EXPECT_EQ(0, gps.get_blend_weight(0) * gps.get_blend_weight(1));
+}
+
+TEST(AP_GPS_Blend, lag_before_first_blend)
+{
+    static AP_GPS gps;
+    gps._auto_switch.set(AP_GPS::GPS_SWITCH_BLEND);
+
+    // the blended instance has the receiver's lag until a sample arrives
+    EXPECT_FLOAT_EQ(gps.get_lag(0), gps.get_lag(GPS_BLENDED_INSTANCE));
+    EXPECT_GT(gps.get_lag(GPS_BLENDED_INSTANCE), 0);
+}
+
+TEST(AP_GPS_Blend, use_best)
+{
+    static AP_GPS gps;
+    gps._auto_switch.set(AP_GPS::GPS_SWITCH_BEST);
+
+    set_fix(gps, 0, 0, Vector3f(), 1.0f, 1000);
+    set_fix(gps, 1, 3, Vector3f(), 2.0f, 1000);
+    gps.update();
+
+    EXPECT_LT(gps.primary_sensor(), GPS_MAX_RECEIVERS);
+}
+
+AP_GTEST_MAIN()
@@ -41,6 +41,18 @@ public:
     FUNCTOR_TYPEDEF(PeriodicCb, bool);
     typedef void* PeriodicHandle;
 
+    /*
+     * One segment of #transfer_segments(). Either buffer may be null, in
+     * which case zeros are sent or the received bytes are discarded.
+     */
+    struct TransferSegment {
+        const uint8_t *send;
+        uint8_t *recv;
+        uint32_t len;
+        // deselect the device after this segment
+        bool cs_change;
+    };
+
     Device(enum BusType type)
     {
         _bus_id.devid_s.bus_type = type;
@@ -86,6 +98,17 @@ public:
     virtual bool transfer(const uint8_t *send, uint32_t send_len,
                           uint8_t *recv, uint32_t recv_len) = 0;
 
+    /*
+     * Perform count full duplex segments in a single bus transaction,
+     * deselecting the device between segments which ask for it. This
+     * lets a driver read several register blocks for the cost of one
+     * transfer.
+     *
+     * Return: true on a successful transfer, false on failure or if the
+     * bus doesn't support segmented transfers.
+     */
+    virtual bool transfer_segments(const TransferSegment *segments, uint8_t count) { return false; }
+
     /**
      * Wrapper function over #transfer() to read recv_len registers, starting
      * by first_reg, into the array pointed by recv. The read flag passed to
@@ -43,6 +43,15 @@ public:
     // register a low priority IO task
     virtual void     register_io_process(AP_HAL::MemberProc) = 0;
 
+    // register a low priority IO task that may run on its own thread,
+    // away from the other IO tasks, if the HAL has a worker of that
+    // name. Only use it for tasks that don't share state with other
+    // IO tasks
+    virtual void     register_io_process(AP_HAL::MemberProc proc, const char *worker)
+    {
+        register_io_process(proc);
+    }
+
     // suspend and resume both timer and IO processes
     virtual void     suspend_timer_procs() = 0;
     virtual void     resume_timer_procs() = 0;
@@ -60,4 +69,24 @@ public:
        optional function to stop clock at a given time, used by log replay
      */
     virtual void     stop_clock(uint64_t time_usec) {}
+
+    // HAL thread a new thread's priority is relative to
+    enum priority_base {
+        PRIORITY_MAIN,
+        PRIORITY_TIMER,
+        PRIORITY_UART,
+        PRIORITY_IO,
+    };
+
+    /*
+      optional function to create a thread running @proc until it
+      returns, with a priority of @priority relative to @base. Returns
+      false if the HAL doesn't support threads or it couldn't be started
+     */
+    virtual bool     thread_create(AP_HAL::MemberProc proc, const char *name,
+                                   uint32_t stack_size, priority_base base,
+                                   int8_t priority)
+    {
+        return false;
+    }
 };
@@ -45,6 +45,16 @@ public:
     virtual void set_flow_control(enum flow_control flow_control_setting) {};
     virtual enum flow_control get_flow_control(void) { return FLOW_CONTROL_DISABLE; }
 
+    /*
+      reserve size bytes of transmit buffer for a single message. The
+      following write() calls fill the reserved space directly, and
+      end_write() makes the whole message available for transmit at
+      once. Returns false if the driver doesn't support this or there
+      isn't enough space, in which case write() works as normal
+     */
+    virtual bool begin_write(uint32_t size) { return false; }
+    virtual void end_write(void) {}
+
     /* Implementations of BetterStream virtual methods. These are
      * provided by AP_HAL to ensure consistency between ports to
      * different boards
@@ -128,6 +128,32 @@ ssize_t SocketAPM::sendto(const void *buf, size_t size, const char *address, uin
     return ::sendto(fd, buf, size, 0, (struct sockaddr *)&sockaddr, sizeof(sockaddr));
 }
 
+/*
+  send some data from a list of buffers
+ */
+ssize_t SocketAPM::sendv(const struct iovec *iov, int iovcnt)
+{
+    struct msghdr msg {};
+    msg.msg_iov = const_cast<struct iovec *>(iov);
+    msg.msg_iovlen = iovcnt;
+    return ::sendmsg(fd, &msg, 0);
+}
+
+/*
+  send some data from a list of buffers to an address
+ */
+ssize_t SocketAPM::sendtov(const struct iovec *iov, int iovcnt, const char *address, uint16_t port)
+{
+    struct sockaddr_in sockaddr;
+    make_sockaddr(address, port, sockaddr);
+    struct msghdr msg {};
+    msg.msg_name = &sockaddr;
+    msg.msg_namelen = sizeof(sockaddr);
+    msg.msg_iov = const_cast<struct iovec *>(iov);
+    msg.msg_iovlen = iovcnt;
+    return ::sendmsg(fd, &msg, 0);
+}
+
 /*
   receive some data
  */
@@ -17,4 +17,18 @@ public:
      * -1 if nothing available, uint8_t value otherwise. */
     virtual int16_t read() = 0;
 
+    /* read up to count bytes into buffer, returning the number of bytes
+     * read. Drivers with a receive buffer override this to copy the
+     * bytes in one go instead of a read() call per byte */
+    virtual uint32_t read(uint8_t *buffer, uint32_t count) {
+        uint32_t n = 0;
+        while (n < count) {
+            const int16_t c = read();
+            if (c < 0) {
+                break;
+            }
+            buffer[n++] = c;
+        }
+        return n;
+    }
 };
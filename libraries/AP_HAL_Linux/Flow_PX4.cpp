@@ -59,7 +59,8 @@ Flow_PX4::Flow_PX4(uint32_t width, uint32_t bytesperline,
     _bytesperline(bytesperline),
     _search_size(max_flow_pixel),
     _bottom_flow_feature_threshold(bottom_flow_feature_threshold),
-    _bottom_flow_value_threshold(bottom_flow_value_threshold)
+    _bottom_flow_value_threshold(bottom_flow_value_threshold),
+    _kernels(&Flow_PX4_Kernels::get())
 {
     /* _pixlo is _search_size + 1 because if we need to evaluate
      * the subpixels up/left of the first pixel, the index
@@ -78,161 +79,6 @@ Flow_PX4::Flow_PX4(uint32_t width, uint32_t bytesperline,
     _pixstep = ceil(((float)(_pixhi - _pixlo)) / _num_blocks);
 }
 
-/**
- * @brief Compute the average pixel gradient of all horizontal and vertical
- *        steps
- *
- * @param image ...
- * @param offX x coordinate of upper left corner of 8x8 pattern in image
- * @param offY y coordinate of upper left corner of 8x8 pattern in image
- */
-static inline uint32_t compute_diff(uint8_t *image, uint16_t offx, uint16_t offy,
-                                    uint16_t row_size, uint8_t window_size)
-{
-    /* calculate position in image buffer */
-    /* we calc only the 4x4 pattern */
-    uint16_t off = (offy + 2) * row_size + (offx + 2);
-    uint32_t acc = 0;
-    unsigned int i;
-
-    for (i = 0; i < window_size; i++) {
-        /* accumulate differences between line1/2, 2/3, 3/4 for 4 pixels
-         * starting at offset off
-         */
-        acc += abs(image[off + i] - image[off + i + row_size]);
-        acc += abs(image[off + i + row_size] - image[off + i + 2 * row_size]);
-        acc += abs(image[off + i + 2 * row_size] -
-                   image[off + i + 3 * row_size]);
-
-        /* accumulate differences between col1/2, 2/3, 3/4 for 4 pixels starting
-         * at off
-         */
-        acc += abs(image[off + row_size * i] - image[off + row_size * i + 1]);
-        acc += abs(image[off + row_size * i + 1] -
-                   image[off + row_size * i + 2]);
-        acc += abs(image[off + row_size * i + 2] -
-                   image[off + row_size * i + 3]);
-    }
-
-    return acc;
-}
-
-/**
- * @brief Compute SAD of two pixel windows.
- *
- * @param image1 ...
- * @param image2 ...
- * @param off1X x coordinate of upper left corner of pattern in image1
- * @param off1Y y coordinate of upper left corner of pattern in image1
- * @param off2X x coordinate of upper left corner of pattern in image2
- * @param off2Y y coordinate of upper left corner of pattern in image2
- */
-static inline uint32_t compute_sad(uint8_t *image1, uint8_t *image2,
-                                   uint16_t off1x, uint16_t off1y,
-                                   uint16_t off2x, uint16_t off2y,
-                                   uint16_t row_size, uint16_t window_size)
-{
-    /* calculate position in image buffer
-     * off1 for image1 and off2 for image2
-     */
-    uint16_t off1 = off1y * row_size + off1x;
-    uint16_t off2 = off2y * row_size + off2x;
-    unsigned int i,j;
-    uint32_t acc = 0;
-
-    for (i = 0; i < window_size; i++) {
-        for (j = 0; j < window_size; j++) {
-            acc += abs(image1[off1 + i + j*row_size] -
-                       image2[off2 + i + j*row_size]);
-        }
-    }
-    return acc;
-}
-
-/**
- * @brief Compute SAD distances of subpixel shift of two pixel patterns.
- *
- * @param image1 ...
- * @param image2 ...
- * @param off1X x coordinate of upper left corner of pattern in image1
- * @param off1Y y coordinate of upper left corner of pattern in image1
- * @param off2X x coordinate of upper left corner of pattern in image2
- * @param off2Y y coordinate of upper left corner of pattern in image2
- * @param acc array to store SAD distances for shift in every direction
- */
-static inline uint32_t compute_subpixel(uint8_t *image1, uint8_t *image2,
-                                        uint16_t off1x, uint16_t off1y,
-                                        uint16_t off2x, uint16_t off2y,
-                                        uint32_t *acc, uint16_t row_size,
-                                        uint16_t window_size)
-{
-    /* calculate position in image buffer */
-    uint16_t off1 = off1y * row_size + off1x; // image1
-    uint16_t off2 = off2y * row_size + off2x; // image2
-    uint8_t sub[8];
-    uint16_t i, j, k;
-
-    memset(acc, 0, window_size * sizeof(uint32_t));
-
-    for (i = 0; i < window_size; i++) {
-        for (j = 0; j < window_size; j++) {
-            /* the 8 s values are from following positions for each pixel (X):
-             *  + - + - + - +
-             *  +   5   7   +
-             *  + - + 6 + - +
-             *  +   4 X 0   +
-             *  + - + 2 + - +
-             *  +   3   1   +
-             *  + - + - + - +
-             */
-
-            /* subpixel 0 is the mean value of base pixel and
-             * the pixel on the right, subpixel 1 is the mean
-             * value of base pixel, the pixel on the right,
-             * the pixel down from it, and the pixel down on
-             * the right. etc...
-             */
-            sub[0] = (image2[off2 + i + j*row_size] +
-                      image2[off2 + i + 1 + j*row_size])/2;
-
-            sub[1] = (image2[off2 + i + j*row_size] +
-                      image2[off2 + i + 1 + j*row_size] +
-                      image2[off2 + i + (j+1)*row_size] +
-                      image2[off2 + i + 1 + (j+1)*row_size])/4;
-
-            sub[2] = (image2[off2 + i + j*row_size] +
-                      image2[off2 + i + 1 + (j+1)*row_size])/2;
-
-            sub[3] = (image2[off2 + i + j*row_size] +
-                      image2[off2 + i - 1 + j*row_size] +
-                      image2[off2 + i - 1 + (j+1)*row_size] +
-                      image2[off2 + i + (j+1)*row_size])/4;
-
-            sub[4] = (image2[off2 + i + j*row_size] +
-                      image2[off2 + i - 1 + (j+1)*row_size])/2;
-
-            sub[5] = (image2[off2 + i + j*row_size] +
-                      image2[off2 + i - 1 + j*row_size] +
-                      image2[off2 + i - 1 + (j-1)*row_size] +
-                      image2[off2 + i + (j-1)*row_size])/4;
-
-            sub[6] = (image2[off2 + i + j*row_size] +
-                      image2[off2 + i + (j-1)*row_size])/2;
-
-            sub[7] = (image2[off2 + i + j*row_size] +
-                      image2[off2 + i + 1 + j*row_size] +
-                      image2[off2 + i + (j-1)*row_size] +
-                      image2[off2 + i + 1 + (j-1)*row_size])/4;
-
-            for (k = 0; k < 8; k++) {
-                acc[k] += abs(image1[off1 + i + j*row_size] - sub[k]);
-            }
-        }
-    }
-
-    return 0;
-}
-
 uint8_t Flow_PX4::compute_flow(uint8_t *image1, uint8_t *image2,
                                uint32_t delta_time, float *pixel_flow_x,
                                float *pixel_flow_y)
@@ -241,7 +87,8 @@ uint8_t Flow_PX4::compute_flow(uint8_t *image1, uint8_t *image2,
     const int16_t winmin = -_search_size;
     const int16_t winmax = _search_size;
     uint16_t i, j;
-    uint32_t acc[2*_search_size];
+    const uint32_t row_size = _bytesperline;
+    uint32_t acc[8];
     int8_t dirsx[_num_blocks*_num_blocks];
     int8_t dirsy[_num_blocks*_num_blocks];
     uint8_t subdirs[_num_blocks*_num_blocks];
@@ -255,9 +102,12 @@ uint8_t Flow_PX4::compute_flow(uint8_t *image1, uint8_t *image2,
      */
     for (j = _pixlo; j < _pixhi; j += _pixstep) {
         for (i = _pixlo; i < _pixhi; i += _pixstep) {
-            /* test pixel if it is suitable for flow tracking */
-            uint32_t diff = compute_diff(image1, i, j, (uint16_t) _bytesperline,
-                                         _search_size);
+            /* test pixel if it is suitable for flow tracking, we calc
+             * only the 4x4 pattern in the middle of the block
+             */
+            const uint8_t *pattern1 = &image1[j * row_size + i];
+            uint32_t diff = _kernels->diff(pattern1 + 2 * row_size + 2,
+                                           row_size, _search_size);
             if (diff < _bottom_flow_feature_threshold) {
                 continue;
             }
@@ -268,11 +118,10 @@ uint8_t Flow_PX4::compute_flow(uint8_t *image1, uint8_t *image2,
             int8_t ii, jj;
 
             for (jj = winmin; jj <= winmax; jj++) {
+                const uint8_t *line2 = &image2[(j + jj) * row_size + i];
                 for (ii = winmin; ii <= winmax; ii++) {
-                    uint32_t temp_dist = compute_sad(image1, image2, i, j,
-                                                     i + ii, j + jj,
-                                                     (uint16_t)_bytesperline,
-                                                     2 * _search_size);
+                    uint32_t temp_dist = _kernels->sad(pattern1, line2 + ii,
+                                                       row_size, 2 * _search_size);
                     if (temp_dist < dist) {
                         sumx = ii;
                         sumy = jj;
@@ -286,12 +135,11 @@ uint8_t Flow_PX4::compute_flow(uint8_t *image1, uint8_t *image2,
                 meanflowx += (float)sumx;
                 meanflowy += (float) sumy;
 
-                compute_subpixel(image1, image2, i, j, i + sumx, j + sumy,
-                                 acc, (uint16_t) _bytesperline,
-                                 2 * _search_size);
+                _kernels->subpixel(pattern1, &image2[(j + sumy) * row_size + i + sumx],
+                                   row_size, 2 * _search_size, acc);
                 uint32_t mindist = dist; // best SAD until now
                 uint8_t mindir = 8; // direction 8 for no direction
-                for (uint8_t k = 0; k < 2 * _search_size; k++) {
+                for (uint8_t k = 0; k < 8; k++) {
                     if (acc[k] < mindist) {
                         // SAD becomes better in direction k
                         mindist = acc[k];
@@ -15,6 +15,7 @@
 #pragma once
 
 #include "AP_HAL_Linux.h"
+#include "Flow_PX4_Kernels.h"
 
 namespace Linux {
 
@@ -26,6 +27,11 @@ public:
              float bottom_flow_value_threshold);
     uint8_t compute_flow(uint8_t *image1, uint8_t *image2, uint32_t delta_time,
                          float *pixel_flow_x, float *pixel_flow_y);
+
+    // kernels default to the fastest ones supported by the CPU
+    void set_kernels(const Flow_PX4_Kernels &kernels) { _kernels = &kernels; }
+    const Flow_PX4_Kernels &get_kernels() const { return *_kernels; }
+
 private:
     uint32_t _width;
     uint32_t _search_size;
@@ -36,6 +42,7 @@ private:
     uint16_t _pixhi;
     uint16_t _pixstep;
     uint8_t  _num_blocks;
+    const Flow_PX4_Kernels *_kernels;
 };
 
 }
@@ -0,0 +1,281 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Flow_PX4_Kernels.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define FLOW_KERNELS_SSE2 1
+#endif
+
+#if defined(__arm__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+
+using namespace Linux;
+
+static uint32_t diff_scalar(const uint8_t *image, uint32_t row_size, uint8_t window_size)
+{
+    /* we calc only the 4x4 pattern */
+    uint32_t acc = 0;
+
+    for (uint32_t i = 0; i < window_size; i++) {
+        /* accumulate differences between line1/2, 2/3, 3/4 for 4 pixels
+         * starting at image
+         */
+        acc += abs(image[i] - image[i + row_size]);
+        acc += abs(image[i + row_size] - image[i + 2 * row_size]);
+        acc += abs(image[i + 2 * row_size] - image[i + 3 * row_size]);
+
+        /* accumulate differences between col1/2, 2/3, 3/4 for 4 pixels
+         * starting at image
+         */
+        acc += abs(image[row_size * i] - image[row_size * i + 1]);
+        acc += abs(image[row_size * i + 1] - image[row_size * i + 2]);
+        acc += abs(image[row_size * i + 2] - image[row_size * i + 3]);
+    }
+
+    return acc;
+}
+
+static uint32_t sad_scalar(const uint8_t *image1, const uint8_t *image2,
+                           uint32_t row_size, uint8_t window_size)
+{
+    uint32_t acc = 0;
+
+    for (uint32_t i = 0; i < window_size; i++) {
+        for (uint32_t j = 0; j < window_size; j++) {
+            acc += abs(image1[i + j * row_size] - image2[i + j * row_size]);
+        }
+    }
+    return acc;
+}
+
+static void subpixel_scalar(const uint8_t *image1, const uint8_t *image2,
+                            uint32_t row_size, uint8_t window_size, uint32_t acc[8])
+{
+    uint8_t sub[8];
+
+    memset(acc, 0, 8 * sizeof(uint32_t));
+
+    for (uint32_t i = 0; i < window_size; i++) {
+        for (uint32_t j = 0; j < window_size; j++) {
+            /* the 8 s values are from following positions for each pixel (X):
+             *  + - + - + - +
+             *  +   5   7   +
+             *  + - + 6 + - +
+             *  +   4 X 0   +
+             *  + - + 2 + - +
+             *  +   3   1   +
+             *  + - + - + - +
+             */
+            const uint8_t *p = &image2[i + j * row_size];
+            const uint8_t *up = p - row_size;
+            const uint8_t *down = p + row_size;
+
+            /* subpixel 0 is the mean value of base pixel and
+             * the pixel on the right, subpixel 1 is the mean
+             * value of base pixel, the pixel on the right,
+             * the pixel down from it, and the pixel down on
+             * the right. etc...
+             */
+            sub[0] = (p[0] + p[1]) / 2;
+            sub[1] = (p[0] + p[1] + down[0] + down[1]) / 4;
+            sub[2] = (p[0] + down[1]) / 2;
+            sub[3] = (p[0] + p[-1] + down[-1] + down[0]) / 4;
+            sub[4] = (p[0] + down[-1]) / 2;
+            sub[5] = (p[0] + p[-1] + up[-1] + up[0]) / 4;
+            sub[6] = (p[0] + up[0]) / 2;
+            sub[7] = (p[0] + p[1] + up[0] + up[1]) / 4;
+
+            for (uint8_t k = 0; k < 8; k++) {
+                acc[k] += abs(image1[i + j * row_size] - sub[k]);
+            }
+        }
+    }
+}
+
+const Flow_PX4_Kernels Flow_PX4_Kernels::scalar = {
+    "scalar",
+    diff_scalar,
+    sad_scalar,
+    subpixel_scalar,
+};
+
+#if FLOW_KERNELS_SSE2
+// 4 pixels, first one in the low byte
+static inline uint32_t load_u32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+#endif
+
+#if FLOW_KERNELS_SSE2
+
+static uint32_t diff_sse2(const uint8_t *image, uint32_t row_size, uint8_t window_size)
+{
+    if (window_size != FLOW_DIFF_WINDOW) {
+        return diff_scalar(image, row_size, window_size);
+    }
+
+    const uint32_t r0 = load_u32(image);
+    const uint32_t r1 = load_u32(image + row_size);
+    const uint32_t r2 = load_u32(image + 2 * row_size);
+    const uint32_t r3 = load_u32(image + 3 * row_size);
+
+    // lines 0/1, 1/2 and 2/3 in one go, the last lane is zero in both
+    const __m128i vert = _mm_sad_epu8(_mm_set_epi32(0, r2, r1, r0),
+                                      _mm_set_epi32(0, r3, r2, r1));
+
+    // each line against itself moved one pixel left, with the last
+    // pixel of the line masked out
+    const __m128i rows = _mm_set_epi32(r3, r2, r1, r0);
+    const __m128i horiz = _mm_sad_epu8(_mm_and_si128(rows, _mm_set1_epi32(0x00FFFFFF)),
+                                       _mm_srli_epi32(rows, 8));
+
+    const __m128i sum = _mm_add_epi64(vert, horiz);
+    return _mm_cvtsi128_si32(sum) + _mm_extract_epi16(sum, 4);
+}
+
+static uint32_t sad_sse2(const uint8_t *image1, const uint8_t *image2,
+                         uint32_t row_size, uint8_t window_size)
+{
+    if (window_size != FLOW_SAD_WINDOW) {
+        return sad_scalar(image1, image2, row_size, window_size);
+    }
+
+    __m128i sum = _mm_setzero_si128();
+    for (uint8_t j = 0; j < FLOW_SAD_WINDOW; j += 2) {
+        const uint8_t *p1 = image1 + j * row_size;
+        const uint8_t *p2 = image2 + j * row_size;
+        const __m128i a = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)p1),
+                                             _mm_loadl_epi64((const __m128i *)(p1 + row_size)));
+        const __m128i b = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)p2),
+                                             _mm_loadl_epi64((const __m128i *)(p2 + row_size)));
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(a, b));
+    }
+    return _mm_cvtsi128_si32(sum) + _mm_extract_epi16(sum, 4);
+}
+
+// 8 pixels widened to 16 bits
+static inline __m128i load_u16x8(const uint8_t *p)
+{
+    return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)p), _mm_setzero_si128());
+}
+
+static inline __m128i absdiff_u16(__m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_subs_epu16(a, b), _mm_subs_epu16(b, a));
+}
+
+static inline __m128i mean2(__m128i a, __m128i b)
+{
+    return _mm_srli_epi16(_mm_add_epi16(a, b), 1);
+}
+
+static inline __m128i mean4(__m128i a, __m128i b, __m128i c, __m128i d)
+{
+    return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(a, b), _mm_add_epi16(c, d)), 2);
+}
+
+static inline uint32_t hsum_u16(__m128i v)
+{
+    __m128i s = _mm_madd_epi16(v, _mm_set1_epi16(1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(s);
+}
+
+static void subpixel_sse2(const uint8_t *image1, const uint8_t *image2,
+                          uint32_t row_size, uint8_t window_size, uint32_t acc[8])
+{
+    if (window_size != FLOW_SAD_WINDOW) {
+        subpixel_scalar(image1, image2, row_size, window_size, acc);
+        return;
+    }
+
+    /* one line of the pattern in each vector, with l and r holding the
+     * pixels left and right of each one and u and d the lines above and
+     * below. Sums of 4 pixels fit in 16 bits, as do the totals of the
+     * absolute differences over 8 lines
+     */
+    const uint8_t *p = image2 - row_size;
+    __m128i ul = load_u16x8(p - 1), uc = load_u16x8(p), ur = load_u16x8(p + 1);
+    p += row_size;
+    __m128i l = load_u16x8(p - 1), c = load_u16x8(p), r = load_u16x8(p + 1);
+
+    __m128i sum[8];
+    for (uint8_t k = 0; k < 8; k++) {
+        sum[k] = _mm_setzero_si128();
+    }
+
+    for (uint8_t j = 0; j < FLOW_SAD_WINDOW; j++) {
+        p += row_size;
+        const __m128i dl = load_u16x8(p - 1), dc = load_u16x8(p), dr = load_u16x8(p + 1);
+        const __m128i x = load_u16x8(image1 + j * row_size);
+
+        sum[0] = _mm_add_epi16(sum[0], absdiff_u16(x, mean2(c, r)));
+        sum[1] = _mm_add_epi16(sum[1], absdiff_u16(x, mean4(c, r, dc, dr)));
+        sum[2] = _mm_add_epi16(sum[2], absdiff_u16(x, mean2(c, dr)));
+        sum[3] = _mm_add_epi16(sum[3], absdiff_u16(x, mean4(c, l, dl, dc)));
+        sum[4] = _mm_add_epi16(sum[4], absdiff_u16(x, mean2(c, dl)));
+        sum[5] = _mm_add_epi16(sum[5], absdiff_u16(x, mean4(c, l, ul, uc)));
+        sum[6] = _mm_add_epi16(sum[6], absdiff_u16(x, mean2(c, uc)));
+        sum[7] = _mm_add_epi16(sum[7], absdiff_u16(x, mean4(c, r, uc, ur)));
+
+        ul = l; uc = c; ur = r;
+        l = dl; c = dc; r = dr;
+    }
+
+    for (uint8_t k = 0; k < 8; k++) {
+        acc[k] = hsum_u16(sum[k]);
+    }
+}
+
+static const Flow_PX4_Kernels sse2_kernels = {
+    "sse2",
+    diff_sse2,
+    sad_sse2,
+    subpixel_sse2,
+};
+
+#endif
+
+const Flow_PX4_Kernels *Flow_PX4_Kernels::simd()
+{
+#if FLOW_KERNELS_SSE2
+    // the compiler already assumes SSE2 for the whole program
+    return &sse2_kernels;
+#elif defined(__aarch64__)
+    return neon();
+#elif defined(__arm__)
+    // NEON is optional on ARMv7, e.g. Tegra 2 has none
+    static const bool has_neon = (getauxval(AT_HWCAP) & HWCAP_NEON) != 0;
+    return has_neon ? neon() : nullptr;
+#else
+    return nullptr;
+#endif
+}
+
+const Flow_PX4_Kernels &Flow_PX4_Kernels::get()
+{
+    const Flow_PX4_Kernels *kernels = simd();
+    return kernels != nullptr ? *kernels : scalar;
+}
@@ -0,0 +1,71 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stdint.h>
+
+// window sizes of the SIMD kernels, for a search size of 4
+#define FLOW_DIFF_WINDOW 4
+#define FLOW_SAD_WINDOW  8
+
+namespace Linux {
+
+/*
+  Block matching kernels used by Flow_PX4. Image pointers are to the
+  upper left corner of the pattern and row_size is the distance in
+  bytes between two lines of the image.
+
+  The scalar kernels are the reference, the SIMD ones are specialised
+  for the 4x4 diff and 8x8 SAD windows used with a search size of 4
+  and return exactly the same results. Other window sizes fall back to
+  the scalar code.
+ */
+struct Flow_PX4_Kernels {
+    const char *name;
+
+    /*
+      average pixel gradient of all horizontal and vertical steps in
+      the window_size x window_size pattern
+     */
+    uint32_t (*diff)(const uint8_t *image, uint32_t row_size, uint8_t window_size);
+
+    // SAD of two window_size x window_size patterns
+    uint32_t (*sad)(const uint8_t *image1, const uint8_t *image2,
+                    uint32_t row_size, uint8_t window_size);
+
+    /*
+      SAD of the pattern in image1 against the pattern in image2
+      shifted by half a pixel in each of 8 directions. The pattern in
+      image2 needs a one pixel border
+     */
+    void (*subpixel)(const uint8_t *image1, const uint8_t *image2,
+                     uint32_t row_size, uint8_t window_size, uint32_t acc[8]);
+
+    static const Flow_PX4_Kernels scalar;
+
+    // SIMD kernels supported by this CPU, nullptr if there are none
+    static const Flow_PX4_Kernels *simd();
+
+    /*
+      NEON kernels, nullptr if the build has none. These don't check
+      the CPU supports NEON, use simd() for that
+     */
+    static const Flow_PX4_Kernels *neon();
+
+    // fastest kernels supported by this CPU
+    static const Flow_PX4_Kernels &get();
+};
+
+}
@@ -267,6 +267,9 @@ void _usage(void)
     printf("\tcustom terrain path:\n");
     printf("\t                   --terrain-directory /var/APM/terrain\n");
     printf("\t                   -t /var/APM/terrain\n");
+    printf("\tIO worker threads (name:cpu:priority, cpu -1 to not pin):\n");
+    printf("\t                  --io-worker terrain:3:9\n");
+    printf("\t                  -w terrain:3:9\n");
     printf("\tmodule support:\n");
     printf("\t                   --module-directory %s\n", AP_MODULE_DEFAULT_DIRECTORY);
     printf("\t                   -M %s\n", AP_MODULE_DEFAULT_DIRECTORY);
@@ -293,11 +296,12 @@ void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
         {"log-directory",       true,  0, 'l'},
         {"terrain-directory",   true,  0, 't'},
         {"module-directory",    true,  0, 'M'},
+        {"io-worker",           true,  0, 'w'},
         {"help",                false,  0, 'h'},
         {0, false, 0, 0}
     };
 
-    GetOptLong gopt(argc, argv, "A:B:C:D:E:F:l:t:he:SM:",
+    GetOptLong gopt(argc, argv, "A:B:C:D:E:F:l:t:he:SM:w:",
                     options);
 
     /*
@@ -340,6 +344,17 @@ void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
         case 'M':
             module_path = gopt.optarg;
             break;
+        case 'w': {
+            char name[16] {};
+            int cpu = -1;
+            int prio = 10;
+            if (sscanf(gopt.optarg, "%15[^:]:%d:%d", name, &cpu, &prio) < 1 ||
+                !schedulerInstance.add_io_worker(name, cpu, prio)) {
+                printf("Invalid IO worker '%s'\n", gopt.optarg);
+                exit(1);
+            }
+            break;
+        }
         case 'h':
             _usage();
             exit(0);
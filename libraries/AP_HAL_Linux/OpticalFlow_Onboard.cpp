@@ -115,6 +115,7 @@ void OpticalFlow_Onboard::init(AP_HAL::OpticalFlow::Gyro_Cb get_gyro)
                               &_sizeimage)) {
         AP_HAL::panic("OpticalFlow_Onboard: couldn't set video format");
     }
+    _camera_output_bytesperline = _bytesperline;
 
     if (_format != V4L2_PIX_FMT_NV12 && _format != V4L2_PIX_FMT_GREY &&
         _format != V4L2_PIX_FMT_YUYV) {
@@ -157,6 +158,14 @@ void OpticalFlow_Onboard::init(AP_HAL::OpticalFlow::Gyro_Cb get_gyro)
         }
     }
 
+    /* frames which need converting are written to the frame pool with
+     * one byte per pixel */
+    _convert_by_software = _format == V4L2_PIX_FMT_YUYV ||
+        _shrink_by_software || _crop_by_software;
+    if (_convert_by_software) {
+        _bytesperline = _width;
+    }
+
     if (!_videoin->allocate_buffers(nbufs)) {
         AP_HAL::panic("OpticalFlow_Onboard: couldn't allocate video buffers");
     }
@@ -232,101 +241,77 @@ void OpticalFlow_Onboard::_run_optflow()
     Vector3f gyro_rate;
     Vector2f flow_rate;
     VideoIn::Frame video_frame;
-    uint32_t convert_buffer_size = 0, output_buffer_size = 0;
-    uint32_t crop_left = 0, crop_top = 0;
-    uint32_t shrink_scale = 0, shrink_width = 0, shrink_height = 0;
-    uint32_t shrink_width_offset = 0, shrink_height_offset = 0;
-    uint8_t *convert_buffer = nullptr, *output_buffer = nullptr;
+    uint32_t camera_width = _width, camera_height = _height;
+    uint32_t pixel_step = _format == V4L2_PIX_FMT_YUYV ? 2 : 1;
+    uint32_t selection_left = 0, selection_top = 0;
+    uint32_t selection_width = _width, selection_height = _height;
+    uint32_t shrink_scale = 1, camera_bytesperline;
+    const uint32_t frame_size = HAL_OPTFLOW_ONBOARD_OUTPUT_WIDTH *
+        HAL_OPTFLOW_ONBOARD_OUTPUT_HEIGHT;
+    uint8_t *frame_pool[2] = { nullptr, nullptr };
+    uint8_t next_frame = 0;
     uint8_t qual;
 
-    if (_format == V4L2_PIX_FMT_YUYV) {
-        if (_shrink_by_software || _crop_by_software) {
-            convert_buffer_size = _camera_output_width * _camera_output_height;
-        } else {
-            convert_buffer_size = _width * _height;
-        }
-
-        convert_buffer = (uint8_t *)malloc(convert_buffer_size);
-        if (!convert_buffer) {
-            AP_HAL::panic("OpticalFlow_Onboard: couldn't allocate conversion buffer\n");
-        }
-    }
-
     if (_shrink_by_software || _crop_by_software) {
-        output_buffer_size = HAL_OPTFLOW_ONBOARD_OUTPUT_WIDTH *
-            HAL_OPTFLOW_ONBOARD_OUTPUT_HEIGHT;
-
-        output_buffer = (uint8_t *)malloc(output_buffer_size);
-        if (!output_buffer) {
-            if (convert_buffer) {
-                free(convert_buffer);
-            }
-
-            AP_HAL::panic("OpticalFlow_Onboard: couldn't allocate crop buffer\n");
-        }
+        camera_width = _camera_output_width;
+        camera_height = _camera_output_height;
     }
 
     if (_shrink_by_software) {
-        if (_camera_output_width > _camera_output_height) {
-            shrink_scale = (uint32_t) _camera_output_height /
-                HAL_OPTFLOW_ONBOARD_OUTPUT_HEIGHT;
+        if (camera_width > camera_height) {
+            shrink_scale = camera_height / HAL_OPTFLOW_ONBOARD_OUTPUT_HEIGHT;
         } else {
-            shrink_scale = (uint32_t) _camera_output_width /
-                HAL_OPTFLOW_ONBOARD_OUTPUT_WIDTH;
+            shrink_scale = camera_width / HAL_OPTFLOW_ONBOARD_OUTPUT_WIDTH;
         }
 
-        shrink_width = HAL_OPTFLOW_ONBOARD_OUTPUT_WIDTH * shrink_scale;
-        shrink_height = HAL_OPTFLOW_ONBOARD_OUTPUT_HEIGHT * shrink_scale;
-
-        shrink_width_offset = (_camera_output_width - shrink_width) / 2;
-        shrink_height_offset = (_camera_output_height - shrink_height) / 2;
+        selection_width = HAL_OPTFLOW_ONBOARD_OUTPUT_WIDTH * shrink_scale;
+        selection_height = HAL_OPTFLOW_ONBOARD_OUTPUT_HEIGHT * shrink_scale;
+        selection_left = (camera_width - selection_width) / 2;
+        selection_top = (camera_height - selection_height) / 2;
     } else if (_crop_by_software) {
-        crop_left = _camera_output_width / 2 -
-           HAL_OPTFLOW_ONBOARD_OUTPUT_WIDTH / 2;
-        crop_top = _camera_output_height / 2 -
-           HAL_OPTFLOW_ONBOARD_OUTPUT_HEIGHT / 2;
+        selection_width = HAL_OPTFLOW_ONBOARD_OUTPUT_WIDTH;
+        selection_height = HAL_OPTFLOW_ONBOARD_OUTPUT_HEIGHT;
+        selection_left = camera_width / 2 - selection_width / 2;
+        selection_top = camera_height / 2 - selection_height / 2;
+    }
+
+    camera_bytesperline = MAX(_camera_output_bytesperline,
+                              camera_width * pixel_step);
+
+    if (_convert_by_software) {
+        /* the flow needs the last frame and the current one, so two
+         * buffers are used in turn */
+        for (uint8_t i = 0; i < 2; i++) {
+            frame_pool[i] = (uint8_t *)malloc(frame_size);
+            if (!frame_pool[i]) {
+                AP_HAL::panic("OpticalFlow_Onboard: couldn't allocate frame pool\n");
+            }
+        }
     }
 
     while(true) {
         /* wait for next frame to come */
         if (!_videoin->get_frame(video_frame)) {
-            if (convert_buffer) {
-               free(convert_buffer);
-            }
-
-            if (output_buffer) {
-               free(output_buffer);
-            }
+            free(frame_pool[0]);
+            free(frame_pool[1]);
 
             AP_HAL::panic("OpticalFlow_Onboard: couldn't get frame\n");
         }
 
-        if (_format == V4L2_PIX_FMT_YUYV) {
-            VideoIn::yuyv_to_grey((uint8_t *)video_frame.data,
-                convert_buffer_size * 2, convert_buffer);
+        if (_convert_by_software) {
+            uint8_t *frame = frame_pool[next_frame];
 
-            memset(video_frame.data, 0, convert_buffer_size * 2);
-            memcpy(video_frame.data, convert_buffer, convert_buffer_size);
-        }
+            VideoIn::crop_shrink_grey((uint8_t *)video_frame.data, frame,
+                                      camera_bytesperline, pixel_step,
+                                      selection_left, selection_width,
+                                      selection_top, selection_height,
+                                      shrink_scale, shrink_scale);
 
-        if (_shrink_by_software) {
-            /* shrink_8bpp() will shrink a selected area using the offsets,
-             * therefore, we don't need the crop. */
-            VideoIn::shrink_8bpp((uint8_t *)video_frame.data, output_buffer,
-                                 _camera_output_width, _camera_output_height,
-                                 shrink_width_offset, shrink_width,
-                                 shrink_height_offset, shrink_height,
-                                 shrink_scale, shrink_scale);
-            memset(video_frame.data, 0, _camera_output_width * _camera_output_height);
-            memcpy(video_frame.data, output_buffer, output_buffer_size);
-        } else if (_crop_by_software) {
-            VideoIn::crop_8bpp((uint8_t *)video_frame.data, output_buffer,
-                               _camera_output_width,
-                               crop_left, HAL_OPTFLOW_ONBOARD_OUTPUT_WIDTH,
-                               crop_top, HAL_OPTFLOW_ONBOARD_OUTPUT_HEIGHT);
-
-            memset(video_frame.data, 0, _camera_output_width * _camera_output_height);
-            memcpy(video_frame.data, output_buffer, output_buffer_size);
+            /* the capture buffer goes back to the video input driver
+             * straight away, the flow uses the converted frame */
+            _videoin->put_frame(video_frame);
+            video_frame.data = frame;
+            next_frame ^= 1;
         }
 
         /* if it is at least the second frame we receive
@@ -347,7 +332,8 @@ void OpticalFlow_Onboard::_run_optflow()
                 | O_APPEND, S_IRUSR | S_IWUSR | S_IRGRP |
                 S_IWGRP | S_IROTH | S_IWOTH);
 	    if (fd != -1) {
-	        write(fd, video_frame.data, _sizeimage);
+	        write(fd, video_frame.data,
+	              _convert_by_software ? frame_size : _sizeimage);
 #ifdef OPTICALFLOW_ONBOARD_RECORD_METADATAS
             struct PACKED {
                 uint32_t timestamp;
@@ -388,18 +374,16 @@ void OpticalFlow_Onboard::_run_optflow()
         _data_available = true;
         pthread_mutex_unlock(&_mutex);
 
-        /* give the last frame back to the video input driver */
-        _videoin->put_frame(_last_video_frame);
+        /* give the last frame back to the video input driver, unless it
+         * is in the frame pool and is overwritten by the next frame */
+        if (!_convert_by_software) {
+            _videoin->put_frame(_last_video_frame);
+        }
         _last_video_frame = video_frame;
         _last_gyro_rate = gyro_rate;
     }
 
-    if (convert_buffer) {
-        free(convert_buffer);
-    }
-
-    if (output_buffer) {
-        free(output_buffer);
-    }
+    free(frame_pool[0]);
+    free(frame_pool[1]);
 }
 #endif
@@ -46,8 +46,10 @@ private:
     bool _data_available;
     bool _crop_by_software;
     bool _shrink_by_software;
+    bool _convert_by_software;
     uint32_t _camera_output_width;
     uint32_t _camera_output_height;
+    uint32_t _camera_output_bytesperline;
     uint32_t _width;
     uint32_t _height;
     uint32_t _format;
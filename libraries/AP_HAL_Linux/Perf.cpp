@@ -14,9 +14,17 @@
  * You should have received a copy of the GNU General Public License along
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <errno.h>
+#include <fcntl.h>
 #include <inttypes.h>
+#include <new>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 #include <time.h>
+#include <unistd.h>
 #include <vector>
 
 #include <AP_HAL/AP_HAL.h>
@@ -37,6 +45,9 @@ static const AP_HAL::HAL &hal = AP_HAL::get_HAL();
 
 Perf *Perf::_instance;
 
+/* slots of the calling thread, allocated on first use */
+static thread_local Perf_Slot *_slots;
+
 static inline uint64_t now_nsec()
 {
     struct timespec ts;
@@ -44,6 +55,12 @@ static inline uint64_t now_nsec()
     return ts.tv_nsec + (ts.tv_sec * NSEC_PER_SEC);
 }
 
+/* only the owning thread writes to a slot, so no atomic RMW is needed */
+static inline void slot_add(std::atomic<uint64_t> &v, uint64_t inc)
+{
+    v.store(v.load(std::memory_order_relaxed) + inc, std::memory_order_relaxed);
+}
+
 Perf *Perf::get_instance()
 {
     if (!_instance) {
@@ -53,24 +70,172 @@ Perf *Perf::get_instance()
     return _instance;
 }
 
-void Perf::_debug_counters()
+uint8_t Perf::_hist_bucket(uint64_t val)
+{
+    if (val < (1U << PERF_HIST_SUB_BITS)) {
+        return val;
+    }
+
+    const unsigned int msb = 63 - __builtin_clzll(val);
+    const unsigned int sub = (val >> (msb - PERF_HIST_SUB_BITS)) & ((1U << PERF_HIST_SUB_BITS) - 1);
+    const unsigned int bucket = ((msb - PERF_HIST_SUB_BITS + 1) << PERF_HIST_SUB_BITS) + sub;
+
+    return MIN(bucket, PERF_HIST_BUCKETS - 1U);
+}
+
+uint64_t Perf::_hist_bucket_max(uint8_t bucket)
+{
+    if (bucket < (1U << PERF_HIST_SUB_BITS)) {
+        return bucket;
+    }
+
+    const unsigned int msb = (bucket >> PERF_HIST_SUB_BITS) + PERF_HIST_SUB_BITS - 1;
+    const unsigned int sub = bucket & ((1U << PERF_HIST_SUB_BITS) - 1);
+
+    return (((uint64_t)(sub + 1) + (1U << PERF_HIST_SUB_BITS)) << (msb - PERF_HIST_SUB_BITS)) - 1;
+}
+
+Perf_Slot *Perf::_get_thread_slots()
+{
+    static thread_local bool no_slots;
+
+    if (_slots || no_slots) {
+        return _slots;
+    }
+
+    unsigned int n = _num_threads.load();
+    do {
+        if (n >= PERF_MAX_THREADS) {
+            fprintf(stderr, "Perf: too many threads using perf counters\n");
+            no_slots = true;
+            return nullptr;
+        }
+    } while (!_num_threads.compare_exchange_weak(n, n + 1));
+
+    void *mem;
+    if (posix_memalign(&mem, 64, sizeof(Perf_Slot) * PERF_MAX_COUNTERS) != 0) {
+        no_slots = true;
+        return nullptr;
+    }
+
+    Perf_Slot *slots = (Perf_Slot *)mem;
+    for (unsigned int i = 0; i < PERF_MAX_COUNTERS; i++) {
+        Perf_Slot *s = new (&slots[i]) Perf_Slot;
+        s->count = 0;
+        s->start = 0;
+        s->total = 0;
+        s->min = ULLONG_MAX;
+        s->max = 0;
+        for (unsigned int b = 0; b < PERF_HIST_BUCKETS; b++) {
+            s->hist[b] = 0;
+        }
+    }
+
+    _slots = slots;
+    _thread_slots[n].store(slots, std::memory_order_release);
+
+    return slots;
+}
+
+/*
+ * Sum the slots of all threads and compute the percentiles. This runs on
+ * the IO thread so the cost is kept away from the threads being measured.
+ */
+void Perf::_aggregate()
 {
     uint64_t now = AP_HAL::millis64();
 
-    if (now - _last_debug_msec < 5000) {
+    if (now - _last_aggregate_msec < 1000) {
         return;
     }
+    _last_aggregate_msec = now;
+
+    const unsigned int n_counters = _num_counters.load(std::memory_order_acquire);
+    const unsigned int n_threads = MIN(_num_threads.load(), (unsigned int)PERF_MAX_THREADS);
+    uint64_t hist[PERF_HIST_BUCKETS];
+
+    for (unsigned int i = 0; i < n_counters; i++) {
+        Perf_Stats s {};
+        s.name = _perf_counters[i].name;
+        s.type = _perf_counters[i].type;
+        s.min = ULLONG_MAX;
+        memset(hist, 0, sizeof(hist));
+
+        for (unsigned int t = 0; t < n_threads; t++) {
+            const Perf_Slot *slots = _thread_slots[t].load(std::memory_order_acquire);
+            if (!slots) {
+                continue;
+            }
+            const Perf_Slot &slot = slots[i];
+            s.count += slot.count.load(std::memory_order_relaxed);
+            s.total += slot.total.load(std::memory_order_relaxed);
+            s.min = MIN(s.min, slot.min.load(std::memory_order_relaxed));
+            s.max = MAX(s.max, slot.max.load(std::memory_order_relaxed));
+            for (unsigned int b = 0; b < PERF_HIST_BUCKETS; b++) {
+                hist[b] += slot.hist[b].load(std::memory_order_relaxed);
+            }
+        }
+
+        if (s.type == Util::PC_ELAPSED && s.count > 0) {
+            /* histogram updates may trail count, so use the histogram total */
+            uint64_t hist_count = 0;
+            for (unsigned int b = 0; b < PERF_HIST_BUCKETS; b++) {
+                hist_count += hist[b];
+            }
+            const uint64_t rank50 = hist_count * 500 / 1000;
+            const uint64_t rank99 = hist_count * 990 / 1000;
+            const uint64_t rank999 = hist_count * 999 / 1000;
+            const uint64_t ranks[] = { rank50, rank99, rank999 };
+            uint64_t *percentiles[] = { &s.p50, &s.p99, &s.p999 };
+            unsigned int p = 0;
+            uint64_t cumulative = 0;
+            for (unsigned int b = 0; b < PERF_HIST_BUCKETS && p < ARRAY_SIZE(ranks); b++) {
+                cumulative += hist[b];
+                while (p < ARRAY_SIZE(ranks) && cumulative > ranks[p]) {
+                    *percentiles[p++] = MIN(_hist_bucket_max(b), s.max);
+                }
+            }
+        } else {
+            s.min = 0;
+        }
+
+        pthread_mutex_lock(&_stats_mtx);
+        _stats[i] = s;
+        pthread_mutex_unlock(&_stats_mtx);
+    }
+
+    _stats_seq++;
+
+#ifdef DEBUG_PERF
+    _debug_counters();
+#endif
+
+    _socket_dump();
+}
+
+bool Perf::get_stats(unsigned int idx, Perf_Stats &stats)
+{
+    if (idx >= _num_counters) {
+        return false;
+    }
+
+    pthread_mutex_lock(&_stats_mtx);
+    stats = _stats[idx];
+    pthread_mutex_unlock(&_stats_mtx);
+
+    return stats.name != nullptr;
+}
 
-    pthread_rwlock_rdlock(&_perf_counters_lock);
-    unsigned int uc = _update_count;
-    auto v = _perf_counters;
-    pthread_rwlock_unlock(&_perf_counters_lock);
+void Perf::_debug_counters()
+{
+    uint64_t now = AP_HAL::millis64();
 
-    if (uc != _update_count) {
-        fprintf(stderr, "WARNING!! potentially wrong counters!!!");
+    if (now - _last_debug_msec < 5000) {
+        return;
     }
 
-    for (auto &c : v) {
+    Perf_Stats c;
+    for (unsigned int i = 0; get_stats(i, c); i++) {
         if (!c.count) {
             fprintf(stderr, "%-30s\t"
                     "(no events)\n", c.name);
@@ -80,8 +245,11 @@ void Perf::_debug_counters()
                     "min: %" PRIu64 "\t"
                     "max: %" PRIu64 "\t"
                     "avg: %.4f\t"
-                    "stddev: %.4f\n",
-                    c.name, c.count, c.min, c.max, c.avg, sqrt(c.m2));
+                    "p50: %" PRIu64 "\t"
+                    "p99: %" PRIu64 "\t"
+                    "p99.9: %" PRIu64 "\n",
+                    c.name, c.count, c.min, c.max, (double)c.total / c.count,
+                    c.p50, c.p99, c.p999);
         } else {
             fprintf(stderr, "%-30s\t"
                     "count: %" PRIu64 "\n",
@@ -92,27 +260,111 @@ void Perf::_debug_counters()
     _last_debug_msec = now;
 }
 
+/*
+ * Listen on a local socket: every connected client gets one dump of the
+ * counters at the next aggregation, e.g.
+ *     socat - UNIX-CONNECT:/tmp/ardupilot-perf.sock
+ */
+void Perf::_socket_init()
+{
+    struct sockaddr_un addr {};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, PERF_SOCKET_PATH, sizeof(addr.sun_path) - 1);
+
+    _socket_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (_socket_fd < 0) {
+        return;
+    }
+
+    if (bind(_socket_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        /*
+         * only take over the path if nobody is listening on it, so
+         * several processes (e.g. parallel Replay runs) don't fight
+         * over it. The first one keeps the socket
+         */
+        const int bind_errno = errno;
+        int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        bool stale = probe >= 0 && bind_errno == EADDRINUSE &&
+            connect(probe, (struct sockaddr *)&addr, sizeof(addr)) < 0 &&
+            errno == ECONNREFUSED;
+        if (probe >= 0) {
+            close(probe);
+        }
+        if (!stale) {
+            close(_socket_fd);
+            _socket_fd = -1;
+            return;
+        }
+        unlink(addr.sun_path);
+        if (bind(_socket_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+            close(_socket_fd);
+            _socket_fd = -1;
+            return;
+        }
+    }
+    if (listen(_socket_fd, 4) < 0) {
+        fprintf(stderr, "Perf: failed to listen on %s: %s\n",
+                PERF_SOCKET_PATH, strerror(errno));
+        close(_socket_fd);
+        _socket_fd = -1;
+    }
+}
+
+void Perf::_socket_dump()
+{
+    if (_socket_fd < 0) {
+        return;
+    }
+
+    int fd;
+    while ((fd = accept4(_socket_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+        /*
+         * format the whole dump first and hand it to the socket in one
+         * non-blocking send, so a slow client can't stall the IO thread.
+         * A client that doesn't have room for it gets a truncated dump
+         */
+        std::vector<char> buf;
+        char line[256];
+        int n = snprintf(line, sizeof(line),
+                         "name,type,count,min_ns,max_ns,avg_ns,p50_ns,p99_ns,p999_ns\n");
+        buf.insert(buf.end(), line, line + n);
+        Perf_Stats c;
+        for (unsigned int i = 0; get_stats(i, c); i++) {
+            n = snprintf(line, sizeof(line),
+                         "%s,%s,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64
+                         ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n",
+                         c.name, c.type == Util::PC_ELAPSED ? "elapsed" : "count",
+                         c.count, c.min, c.max, c.count ? c.total / c.count : 0,
+                         c.p50, c.p99, c.p999);
+            if (n > 0) {
+                buf.insert(buf.end(), line, line + MIN(n, (int)sizeof(line) - 1));
+            }
+        }
+        send(fd, buf.data(), buf.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+        close(fd);
+    }
+}
+
 Perf::Perf()
 {
-    if (pthread_rwlock_init(&_perf_counters_lock, nullptr) != 0) {
-        AP_HAL::panic("Perf: fail to initialize rw lock");
+    if (pthread_mutex_init(&_perf_counters_mtx, nullptr) != 0 ||
+        pthread_mutex_init(&_stats_mtx, nullptr) != 0) {
+        AP_HAL::panic("Perf: fail to initialize mutex");
     }
 
-    /* TODO: this number should come from vehicle code - just estimate the
-     * number of perf counters for now; if we grow more, it will just
-     * reallocate the memory pool */
-    _perf_counters.reserve(50);
+    /* the pool is never reallocated so readers don't need to take a lock */
+    _perf_counters.reserve(PERF_MAX_COUNTERS);
 
-#ifdef DEBUG_PERF
-    hal.scheduler->register_timer_process(FUNCTOR_BIND_MEMBER(&Perf::_debug_counters, void));
-#endif
+    _socket_init();
+
+    hal.scheduler->register_io_process(FUNCTOR_BIND_MEMBER(&Perf::_aggregate, void));
 }
 
 void Perf::begin(Util::perf_counter_t pc)
 {
     uintptr_t idx = (uintptr_t)pc;
 
-    if (idx >= _perf_counters.size()) {
+    if (idx >= _num_counters.load(std::memory_order_acquire)) {
         return;
     }
 
@@ -124,15 +376,19 @@ void Perf::begin(Util::perf_counter_t pc)
         return;
     }
 
-    if (perf.start != 0) {
+    Perf_Slot *slots = _get_thread_slots();
+    if (!slots) {
+        return;
+    }
+    Perf_Slot &slot = slots[idx];
+
+    if (slot.start.load(std::memory_order_relaxed) != 0) {
         hal.console->printf("perf_begin() called twice on perf_counter_t(%s)\n",
                             perf.name);
         return;
     }
 
-    _update_count++;
-
-    perf.start = now_nsec();
+    slot.start.store(now_nsec(), std::memory_order_relaxed);
 
     perf.lttng.begin(perf.name);
 }
@@ -141,7 +397,7 @@ void Perf::end(Util::perf_counter_t pc)
 {
     uintptr_t idx = (uintptr_t)pc;
 
-    if (idx >= _perf_counters.size()) {
+    if (idx >= _num_counters.load(std::memory_order_acquire)) {
         return;
     }
 
@@ -153,35 +409,35 @@ void Perf::end(Util::perf_counter_t pc)
         return;
     }
 
-    if (perf.start == 0) {
+    Perf_Slot *slots = _get_thread_slots();
+    if (!slots) {
+        return;
+    }
+    Perf_Slot &slot = slots[idx];
+
+    const uint64_t start = slot.start.load(std::memory_order_relaxed);
+    if (start == 0) {
         hal.console->printf("perf_begin() called before begin() on perf_counter_t(%s)\n",
                             perf.name);
         return;
     }
 
-    _update_count++;
+    const uint64_t elapsed = now_nsec() - start;
+    slot_add(slot.count, 1);
+    slot_add(slot.total, elapsed);
 
-    const uint64_t elapsed = now_nsec() - perf.start;
-    perf.count++;
-    perf.total += elapsed;
-
-    if (perf.min > elapsed) {
-        perf.min = elapsed;
+    if (slot.min.load(std::memory_order_relaxed) > elapsed) {
+        slot.min.store(elapsed, std::memory_order_relaxed);
     }
 
-    if (perf.max < elapsed) {
-        perf.max = elapsed;
+    if (slot.max.load(std::memory_order_relaxed) < elapsed) {
+        slot.max.store(elapsed, std::memory_order_relaxed);
     }
 
-    /*
-     * Maintain avg and variance of interval in nanoseconds
-     * Knuth/Welford recursive avg and variance of update intervals (via Wikipedia)
-     * Same implementation of PX4.
-     */
-    const double delta_intvl = elapsed - perf.avg;
-    perf.avg += (delta_intvl / perf.count);
-    perf.m2 += (delta_intvl * (elapsed - perf.avg));
-    perf.start = 0;
+    std::atomic<uint32_t> &bucket = slot.hist[_hist_bucket(elapsed)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    slot.start.store(0, std::memory_order_relaxed);
 
     perf.lttng.end(perf.name);
 }
@@ -190,7 +446,7 @@ void Perf::count(Util::perf_counter_t pc)
 {
     uintptr_t idx = (uintptr_t)pc;
 
-    if (idx >= _perf_counters.size()) {
+    if (idx >= _num_counters.load(std::memory_order_acquire)) {
         return;
     }
 
@@ -202,10 +458,15 @@ void Perf::count(Util::perf_counter_t pc)
         return;
     }
 
-    _update_count++;
-    perf.count++;
+    Perf_Slot *slots = _get_thread_slots();
+    if (!slots) {
+        return;
+    }
+    Perf_Slot &slot = slots[idx];
+
+    slot_add(slot.count, 1);
 
-    perf.lttng.count(perf.name, perf.count);
+    perf.lttng.count(perf.name, slot.count.load(std::memory_order_relaxed));
 }
 
 Util::perf_counter_t Perf::add(Util::perf_counter_type type, const char *name)
@@ -218,10 +479,17 @@ Util::perf_counter_t Perf::add(Util::perf_counter_type type, const char *name)
         return (Util::perf_counter_t)(uintptr_t) -1;
     }
 
-    pthread_rwlock_wrlock(&_perf_counters_lock);
+    pthread_mutex_lock(&_perf_counters_mtx);
+    if (_perf_counters.size() >= PERF_MAX_COUNTERS) {
+        pthread_mutex_unlock(&_perf_counters_mtx);
+        hal.console->printf("Perf: out of perf counters for %s\n", name);
+        return (Util::perf_counter_t)(uintptr_t) -1;
+    }
     Util::perf_counter_t pc = (Util::perf_counter_t) _perf_counters.size();
     _perf_counters.emplace_back(type, name);
-    pthread_rwlock_unlock(&_perf_counters_lock);
+    _num_counters.store(_perf_counters.size(), std::memory_order_release);
+    _update_count++;
+    pthread_mutex_unlock(&_perf_counters_mtx);
 
     return pc;
 }
@@ -26,6 +26,22 @@
 #include "Thread.h"
 #include "Util.h"
 
+/* maximum number of perf counters and of threads updating them */
+#define PERF_MAX_COUNTERS 128
+#define PERF_MAX_THREADS 16
+
+/*
+ * Log-linear latency histogram: values below 4ns get a bucket each, then
+ * each power of two is split in 4 sub-buckets. The last bucket holds
+ * everything above ~7.5s.
+ */
+#define PERF_HIST_SUB_BITS 2
+#define PERF_HIST_BUCKETS 128
+
+#ifndef PERF_SOCKET_PATH
+#define PERF_SOCKET_PATH "/tmp/ardupilot-perf.sock"
+#endif
+
 namespace Linux {
 
 class Perf_Counter {
@@ -36,7 +52,6 @@ public:
     Perf_Counter(perf_counter_type type_, const char *name_)
         : name{name_}
         , type{type_}
-        , min{ULONG_MAX}
     {
     }
 
@@ -44,17 +59,37 @@ public:
     Perf_Lttng lttng;
 
     perf_counter_type type;
+};
 
-    uint64_t count;
+/*
+ * Per-thread state of a counter. Only the owning thread writes to it, so
+ * updates are plain relaxed loads and stores; the aggregator may read a
+ * slightly stale value but never needs a lock. Each slot is on its own
+ * cache line so threads don't bounce lines between them.
+ */
+struct alignas(64) Perf_Slot {
+    std::atomic<uint64_t> count;
 
     /* Everything below is in nanoseconds */
-    uint64_t start;
+    std::atomic<uint64_t> start;
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> min;
+    std::atomic<uint64_t> max;
+
+    std::atomic<uint32_t> hist[PERF_HIST_BUCKETS];
+};
+
+/* Aggregated view of a counter over all threads, times in nanoseconds */
+struct Perf_Stats {
+    const char *name;
+    AP_HAL::Util::perf_counter_type type;
+    uint64_t count;
     uint64_t total;
     uint64_t min;
     uint64_t max;
-
-    double avg;
-    double m2;
+    uint64_t p50;
+    uint64_t p99;
+    uint64_t p999;
 };
 
 class Perf {
@@ -74,19 +109,50 @@ public:
 
     unsigned int get_update_count() { return _update_count; }
 
+    /*
+     * Aggregated statistics, refreshed once a second from the IO thread.
+     * get_stats_seq() changes every time a new set is available.
+     */
+    unsigned int get_num_counters() const { return _num_counters; }
+    unsigned int get_stats_seq() const { return _stats_seq; }
+    bool get_stats(unsigned int idx, Perf_Stats &stats);
+
 private:
     static Perf *_instance;
 
     Perf();
 
+    Perf_Slot *_get_thread_slots();
+
+    void _aggregate();
     void _debug_counters();
+    void _socket_init();
+    void _socket_dump();
 
+    static uint8_t _hist_bucket(uint64_t val);
+    static uint64_t _hist_bucket_max(uint8_t bucket);
+
+    uint64_t _last_aggregate_msec = 0;
     uint64_t _last_debug_msec;
 
     std::vector<Perf_Counter> _perf_counters;
 
+    /* number of counters in _perf_counters safe to be used by readers */
+    std::atomic<unsigned int> _num_counters{0};
+
     /* synchronize addition of new perf counters */
-    pthread_rwlock_t _perf_counters_lock;
+    pthread_mutex_t _perf_counters_mtx;
+
+    /* slots of each thread that has used a counter, indexed by counter */
+    std::atomic<Perf_Slot *> _thread_slots[PERF_MAX_THREADS] {};
+    std::atomic<unsigned int> _num_threads{0};
+
+    /* result of the last aggregation, protected by _stats_mtx */
+    Perf_Stats _stats[PERF_MAX_COUNTERS] {};
+    pthread_mutex_t _stats_mtx;
+    std::atomic<unsigned int> _stats_seq{0};
+
+    int _socket_fd = -1;
 
     /* allow to check if memory pool has changed */
     std::atomic<unsigned int> _update_count;
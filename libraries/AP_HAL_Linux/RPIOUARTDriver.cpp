@@ -88,6 +88,15 @@ int RPIOUARTDriver::_write_fd(const uint8_t *buf, uint16_t n)
     return -1;
 }
 
+int RPIOUARTDriver::_write_fdv(const ByteBuffer::IoVec *vec, uint8_t n_vec)
+{
+    if (_external) {
+        return UARTDriver::_write_fdv(vec, n_vec);
+    }
+
+    return -1;
+}
+
 int RPIOUARTDriver::_read_fd(uint8_t *buf, uint16_t n)
 {
     if (_external) {
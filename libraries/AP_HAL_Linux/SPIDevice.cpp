@@ -45,6 +45,9 @@ static const AP_HAL::HAL &hal = AP_HAL::get_HAL();
 #define KHZ (1000U)
 #define SPI_CS_KERNEL -1
 
+// maximum number of segments in transfer_segments()
+#define SPI_MAX_SEGMENTS 4
+
 struct SPIDesc {
     SPIDesc(const char *name_, uint16_t bus_, uint16_t subdev_, uint8_t mode_,
             uint8_t bits_per_word_, int16_t cs_pin_, uint32_t lowspeed_,
@@ -243,6 +246,40 @@ bool SPIDevice::set_speed(AP_HAL::Device::Speed speed)
     return true;
 }
 
+bool SPIDevice::_set_mode()
+{
+    if (_bus.last_mode == _desc.mode) {
+        /*
+          the mode in the kernel is not tied to the file descriptor,
+          so there is a chance some other process has changed it since
+          we last used the bus. We want to report when this happens so
+          the user has a chance of figuring out when there is
+          conflicted use of the SPI bus. Unfortunately this costs us
+          an extra syscall per transfer.
+         */
+        uint8_t current_mode;
+        if (ioctl(_bus.fd, SPI_IOC_RD_MODE, &current_mode) < 0) {
+            hal.console->printf("SPIDevice: error on getting mode fd=%d (%s)\n",
+                                _bus.fd, strerror(errno));
+            _bus.last_mode = -1;
+        } else if (current_mode != _bus.last_mode) {
+            hal.console->printf("SPIDevice: bus mode conflict fd=%d mode=%u/%u\n",
+                                _bus.fd, (unsigned)_bus.last_mode, (unsigned)current_mode);
+            _bus.last_mode = -1;
+        }
+    }
+    if (_desc.mode != _bus.last_mode) {
+        if (ioctl(_bus.fd, SPI_IOC_WR_MODE, &_desc.mode) < 0) {
+            hal.console->printf("SPIDevice: error on setting mode fd=%d (%s)\n",
+                                _bus.fd, strerror(errno));
+            return false;
+        }
+        _bus.last_mode = _desc.mode;
+    }
+
+    return true;
+}
+
 bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
                          uint8_t *recv, uint32_t recv_len)
 {
@@ -277,39 +314,12 @@ bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
         return false;
     }
 
-    int r;
-    if (_bus.last_mode == _desc.mode) {
-        /*
-          the mode in the kernel is not tied to the file descriptor,
-          so there is a chance some other process has changed it since
-          we last used the bus. We want to report when this happens so
-          the user has a chance of figuring out when there is
-          conflicted use of the SPI bus. Unfortunately this costs us
-          an extra syscall per transfer.
-         */
-        uint8_t current_mode;
-        if (ioctl(_bus.fd, SPI_IOC_RD_MODE, &current_mode) < 0) {
-            hal.console->printf("SPIDevice: error on getting mode fd=%d (%s)\n",
-                                _bus.fd, strerror(errno));
-            _bus.last_mode = -1;
-        } else if (current_mode != _bus.last_mode) {
-            hal.console->printf("SPIDevice: bus mode conflict fd=%d mode=%u/%u\n",
-                                _bus.fd, (unsigned)_bus.last_mode, (unsigned)current_mode);
-            _bus.last_mode = -1;
-        }
-    }
-    if (_desc.mode != _bus.last_mode) {
-        r = ioctl(_bus.fd, SPI_IOC_WR_MODE, &_desc.mode);
-        if (r < 0) {
-            hal.console->printf("SPIDevice: error on setting mode fd=%d (%s)\n",
-                                _bus.fd, strerror(errno));
-            return false;
-        }
-        _bus.last_mode = _desc.mode;
+    if (!_set_mode()) {
+        return false;
     }
 
     _cs_assert();
-    r = ioctl(_bus.fd, SPI_IOC_MESSAGE(nmsgs), &msgs);
+    int r = ioctl(_bus.fd, SPI_IOC_MESSAGE(nmsgs), &msgs);
     _cs_release();
 
     if (r == -1) {
@@ -360,6 +370,61 @@ bool SPIDevice::transfer_fullduplex(const uint8_t *send, uint8_t *recv,
     return true;
 }
 
+bool SPIDevice::transfer_segments(const TransferSegment *segments, uint8_t count)
+{
+    struct spi_ioc_transfer msgs[SPI_MAX_SEGMENTS] = { };
+
+    assert(_bus.fd >= 0);
+
+    if (count == 0 || count > SPI_MAX_SEGMENTS) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        msgs[i].tx_buf = (uint64_t) segments[i].send;
+        msgs[i].rx_buf = (uint64_t) segments[i].recv;
+        msgs[i].len = segments[i].len;
+        msgs[i].speed_hz = _speed;
+        msgs[i].delay_usecs = 0;
+        msgs[i].bits_per_word = _desc.bits_per_word;
+        msgs[i].cs_change = segments[i].cs_change && i + 1 < count;
+    }
+
+    if (!_set_mode()) {
+        return false;
+    }
+
+    /*
+      with kernel chip select the whole transaction is one
+      SPI_IOC_MESSAGE. A userspace chip select can't be toggled by the
+      kernel between segments, so split the message wherever the
+      device has to be deselected
+     */
+    uint8_t first = 0;
+    while (first < count) {
+        uint8_t n = count - first;
+        if (_desc.cs_pin != SPI_CS_KERNEL) {
+            n = 1;
+            while (first + n < count && !msgs[first + n - 1].cs_change) {
+                n++;
+            }
+            msgs[first + n - 1].cs_change = 0;
+        }
+
+        _cs_assert();
+        int r = ioctl(_bus.fd, SPI_IOC_MESSAGE(n), &msgs[first]);
+        _cs_release();
+
+        if (r == -1) {
+            hal.console->printf("SPIDevice: error transferring data fd=%d (%s)\n",
+                                _bus.fd, strerror(errno));
+            return false;
+        }
+        first += n;
+    }
+
+    return true;
+}
 
 void SPIDevice::_cs_assert()
 {
@@ -46,6 +46,9 @@ public:
     bool transfer_fullduplex(const uint8_t *send, uint8_t *recv,
                              uint32_t len) override;
 
+    /* See AP_HAL::Device::transfer_segments() */
+    bool transfer_segments(const TransferSegment *segments, uint8_t count) override;
+
     /* See AP_HAL::Device::get_semaphore() */
     AP_HAL::Semaphore *get_semaphore() override;
 
@@ -63,6 +66,11 @@ protected:
     AP_HAL::DigitalSource *_cs;
     uint32_t _speed;
 
+    /*
+     * Set the bus mode for this device if another device changed it
+     */
+    bool _set_mode();
+
     /*
      * Select device if using userspace CS
      */
@@ -111,6 +111,16 @@ int SPIUARTDriver::_write_fd(const uint8_t *buf, uint16_t size)
     return ret;
 }
 
+int SPIUARTDriver::_write_fdv(const ByteBuffer::IoVec *vec, uint8_t n_vec)
+{
+    if (_external) {
+        return UARTDriver::_write_fdv(vec, n_vec);
+    }
+
+    // one SPI transfer per call, the rest is sent on the next one
+    return _write_fd(vec[0].data, vec[0].len);
+}
+
 int SPIUARTDriver::_read_fd(uint8_t *buf, uint16_t n)
 {
     static uint8_t ff_stub[100] = {0xff};
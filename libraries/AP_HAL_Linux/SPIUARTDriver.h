@@ -14,6 +14,7 @@ public:
 
 protected:
     int _write_fd(const uint8_t *buf, uint16_t n);
+    int _write_fdv(const ByteBuffer::IoVec *vec, uint8_t n_vec);
     int _read_fd(uint8_t *buf, uint16_t n);
 
     AP_HAL::OwnPtr<AP_HAL::SPIDevice> _dev;
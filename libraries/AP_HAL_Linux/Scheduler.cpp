@@ -5,6 +5,7 @@
 #include <poll.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/mman.h>
 #include <sys/time.h>
 #include <unistd.h>
@@ -37,6 +38,10 @@ extern const AP_HAL::HAL& hal;
 #define APM_LINUX_TONEALARM_PRIORITY    11
 #define APM_LINUX_IO_PRIORITY           10
 
+/* IO workers are kept below every other thread */
+#define APM_LINUX_IO_WORKER_PRIORITY_MIN 1
+#define APM_LINUX_IO_WORKER_PRIORITY_MAX APM_LINUX_IO_PRIORITY
+
 #define APM_LINUX_TIMER_RATE            1000
 #define APM_LINUX_UART_RATE             100
 #if CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_NAVIO ||    \
@@ -94,8 +99,11 @@ void Scheduler::init()
     }
 #endif
 
+    _perf_timers = hal.util->perf_alloc(AP_HAL::Util::PC_ELAPSED, "APM_timers");
+    _perf_io_timers = hal.util->perf_alloc(AP_HAL::Util::PC_ELAPSED, "APM_IO_timers");
+
     /* set barrier to N + 1 threads: worker threads + main */
-    unsigned n_threads = ARRAY_SIZE(sched_table) + 1;
+    unsigned n_threads = ARRAY_SIZE(sched_table) + _num_io_workers + 1;
     ret = pthread_barrier_init(&_initialized_barrier, nullptr, n_threads);
     if (ret) {
         AP_HAL::panic("Scheduler: Failed to initialise barrier object: %s",
@@ -110,9 +118,123 @@ void Scheduler::init()
         t->thread->start(t->name, t->policy, t->prio);
     }
 
+    for (uint8_t i = 0; i < _num_io_workers; i++) {
+        IOWorker *w = _io_workers[i];
+
+        w->thread.set_rate(APM_LINUX_IO_RATE);
+        w->thread.set_stack_size(256 * 1024);
+        w->thread.start(w->thread_name, SCHED_FIFO, w->prio);
+    }
+
 #if defined(DEBUG_STACK) && DEBUG_STACK
     register_timer_process(FUNCTOR_BIND_MEMBER(&Scheduler::_debug_stack, void));
 #endif
+#if defined(DEBUG_WORKERS) && DEBUG_WORKERS
+    register_timer_process(FUNCTOR_BIND_MEMBER(&Scheduler::_debug_workers, void));
+#endif
+}
+
+Scheduler::IOWorker::IOWorker(Scheduler &sched, const char *name_, int cpu_, int prio_)
+    : cpu(cpu_)
+    , prio(prio_)
+    , num_procs(0)
+    , thread(FUNCTOR_BIND_MEMBER(&Scheduler::IOWorker::run, void), sched)
+    , busy_usec(0)
+    , window_start_usec(0)
+    , utilization(0)
+{
+    strncpy(name, name_, sizeof(name) - 1);
+    name[sizeof(name) - 1] = '\0';
+    snprintf(thread_name, sizeof(thread_name), "ap-%s", name);
+
+    char perf_name[32];
+    snprintf(perf_name, sizeof(perf_name), "APM_IO_worker_%s", name);
+    perf = hal.util->perf_alloc(AP_HAL::Util::PC_ELAPSED, strdup(perf_name));
+}
+
+void Scheduler::IOWorker::run()
+{
+    if (!sem.take(0)) {
+        return;
+    }
+
+    const uint64_t start = AP_HAL::micros64();
+
+    hal.util->perf_begin(perf);
+
+    for (uint8_t i = 0; i < num_procs; i++) {
+        if (procs[i]) {
+            procs[i]();
+        }
+    }
+
+    hal.util->perf_end(perf);
+
+    const uint64_t now = AP_HAL::micros64();
+    busy_usec += now - start;
+
+    if (window_start_usec == 0) {
+        window_start_usec = start;
+    } else if (now - window_start_usec >= 5000000) {
+        utilization = (float)busy_usec / (now - window_start_usec);
+        busy_usec = 0;
+        window_start_usec = now;
+    }
+
+    sem.give();
+}
+
+bool Scheduler::add_io_worker(const char *name, int cpu, int prio)
+{
+    if (_num_io_workers >= LINUX_SCHEDULER_MAX_IO_WORKERS) {
+        fprintf(stderr, "Out of IO workers\n");
+        return false;
+    }
+
+    if (prio < APM_LINUX_IO_WORKER_PRIORITY_MIN ||
+        prio > APM_LINUX_IO_WORKER_PRIORITY_MAX) {
+        fprintf(stderr, "IO worker '%s' priority %d outside band %d-%d\n",
+                name, prio, APM_LINUX_IO_WORKER_PRIORITY_MIN,
+                APM_LINUX_IO_WORKER_PRIORITY_MAX);
+        return false;
+    }
+
+    const long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpu < -1 || (num_cpus > 0 && cpu >= num_cpus)) {
+        fprintf(stderr, "IO worker '%s' cpu %d not in 0-%ld\n",
+                name, cpu, num_cpus - 1);
+        return false;
+    }
+
+    /* the constructor allocates a perf counter, which may register IO
+     * processes, so only publish the worker once it's complete */
+    IOWorker *w = new IOWorker(*this, name, cpu, prio);
+    if (!w->thread.set_cpu_affinity(cpu)) {
+        fprintf(stderr, "IO worker '%s' can't be pinned to cpu %d\n",
+                name, cpu);
+        delete w;
+        return false;
+    }
+    _io_workers[_num_io_workers] = w;
+    _num_io_workers++;
+
+    return true;
+}
+
+void Scheduler::_debug_workers()
+{
+    uint64_t now = AP_HAL::millis64();
+
+    if (now - _last_workers_debug_msec > 5000) {
+        fprintf(stderr, "IO worker utilization:\n");
+        for (uint8_t i = 0; i < _num_io_workers; i++) {
+            const IOWorker *w = _io_workers[i];
+            fprintf(stderr, "\t%-10s cpu=%d prio=%d procs=%u util=%.1f%%\n",
+                    w->name, w->cpu, w->prio, w->num_procs,
+                    (double)(w->utilization * 100));
+        }
+        _last_workers_debug_msec = now;
+    }
 }
 
 void Scheduler::_debug_stack()
@@ -255,20 +377,42 @@ bool Scheduler::_register_timesliced_proc(AP_HAL::MemberProc proc,
     return true;
 }
 
+bool Scheduler::_add_io_proc(AP_HAL::MemberProc *procs, uint8_t &num_procs,
+                             AP_HAL::MemberProc proc)
+{
+    for (uint8_t i = 0; i < num_procs; i++) {
+        if (procs[i] == proc) {
+            return true;
+        }
+    }
+
+    if (num_procs < LINUX_SCHEDULER_MAX_IO_PROCS) {
+        procs[num_procs] = proc;
+        num_procs++;
+        return true;
+    }
+
+    hal.console->printf("Out of IO processes\n");
+    return false;
+}
+
 void Scheduler::register_io_process(AP_HAL::MemberProc proc)
 {
-    for (uint8_t i = 0; i < _num_io_procs; i++) {
-        if (_io_proc[i] == proc) {
+    _add_io_proc(_io_proc, _num_io_procs, proc);
+}
+
+void Scheduler::register_io_process(AP_HAL::MemberProc proc, const char *worker)
+{
+    for (uint8_t i = 0; i < _num_io_workers; i++) {
+        IOWorker *w = _io_workers[i];
+        if (strcmp(w->name, worker) == 0) {
+            _add_io_proc(w->procs, w->num_procs, proc);
             return;
         }
     }
 
-    if (_num_io_procs < LINUX_SCHEDULER_MAX_IO_PROCS) {
-        _io_proc[_num_io_procs] = proc;
-        _num_io_procs++;
-    } else {
-        hal.console->printf("Out of IO processes\n");
-    }
+    /* no worker of that name, run it with the other IO processes */
+    register_io_process(proc);
 }
 
 void Scheduler::register_timer_failsafe(AP_HAL::Proc failsafe, uint32_t period_us)
@@ -297,6 +441,8 @@ void Scheduler::_timer_task()
     }
     _in_timer_proc = true;
 
+    hal.util->perf_begin(_perf_timers);
+
     if (!_timer_semaphore.take(0)) {
         printf("Failed to take timer semaphore in %s\n", __PRETTY_FUNCTION__);
     }
@@ -335,6 +481,8 @@ void Scheduler::_timer_task()
         _failsafe();
     }
 
+    hal.util->perf_end(_perf_timers);
+
     _in_timer_proc = false;
 
 #if HAL_LINUX_UARTS_ON_TIMER_THREAD
@@ -354,6 +502,8 @@ void Scheduler::_run_io(void)
         return;
     }
 
+    hal.util->perf_begin(_perf_io_timers);
+
     // now call the IO based drivers
     for (int i = 0; i < _num_io_procs; i++) {
         if (_io_proc[i]) {
@@ -361,6 +511,8 @@ void Scheduler::_run_io(void)
         }
     }
 
+    hal.util->perf_end(_perf_io_timers);
+
     _io_semaphore.give();
 }
 
@@ -447,6 +599,9 @@ void Scheduler::stop_clock(uint64_t time_usec)
     if (time_usec >= _stopped_clock_usec) {
         _stopped_clock_usec = time_usec;
         _run_io();
+        for (uint8_t i = 0; i < _num_io_workers; i++) {
+            _io_workers[i]->run();
+        }
     }
 }
 
@@ -465,6 +620,45 @@ bool Scheduler::SchedulerThread::_run()
     return PeriodicThread::_run();
 }
 
+bool Scheduler::thread_create(AP_HAL::MemberProc proc, const char *name,
+                              uint32_t stack_size, priority_base base,
+                              int8_t priority)
+{
+    int prio;
+
+    switch (base) {
+    case PRIORITY_MAIN:
+        prio = APM_LINUX_MAIN_PRIORITY;
+        break;
+    case PRIORITY_TIMER:
+        prio = APM_LINUX_TIMER_PRIORITY;
+        break;
+    case PRIORITY_UART:
+        prio = APM_LINUX_UART_PRIORITY;
+        break;
+    case PRIORITY_IO:
+    default:
+        prio = APM_LINUX_IO_PRIORITY;
+        break;
+    }
+    prio = std::max(1, std::min(prio + priority, APM_LINUX_TIMER_PRIORITY));
+
+    /* the thread lives until the process exits */
+    Thread *thread = new Thread(proc);
+    if (thread == nullptr) {
+        return false;
+    }
+    if (stack_size != 0) {
+        thread->set_stack_size(stack_size);
+    }
+    if (!thread->start(name, SCHED_FIFO, prio)) {
+        delete thread;
+        return false;
+    }
+
+    return true;
+}
+
 void Scheduler::teardown()
 {
     _timer_thread.stop();
@@ -472,10 +666,16 @@ void Scheduler::teardown()
     _rcin_thread.stop();
     _uart_thread.stop();
     _tonealarm_thread.stop();
+    for (uint8_t i = 0; i < _num_io_workers; i++) {
+        _io_workers[i]->thread.stop();
+    }
 
     _timer_thread.join();
     _io_thread.join();
     _rcin_thread.join();
     _uart_thread.join();
     _tonealarm_thread.join();
+    for (uint8_t i = 0; i < _num_io_workers; i++) {
+        _io_workers[i]->thread.join();
+    }
 }
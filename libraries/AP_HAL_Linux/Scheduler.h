@@ -9,6 +9,7 @@
 #define LINUX_SCHEDULER_MAX_TIMER_PROCS 10
 #define LINUX_SCHEDULER_MAX_TIMESLICED_PROCS 10
 #define LINUX_SCHEDULER_MAX_IO_PROCS 10
+#define LINUX_SCHEDULER_MAX_IO_WORKERS 4
 
 #define AP_LINUX_SENSORS_STACK_SIZE  256 * 1024
 #define AP_LINUX_SENSORS_SCHED_POLICY  SCHED_FIFO
@@ -33,6 +34,7 @@ public:
     void     register_timer_process(AP_HAL::MemberProc);
     bool     register_timer_process(AP_HAL::MemberProc, uint8_t);
     void     register_io_process(AP_HAL::MemberProc);
+    void     register_io_process(AP_HAL::MemberProc, const char *worker);
     void     suspend_timer_procs();
     void     resume_timer_procs();
 
@@ -52,6 +54,19 @@ public:
 
     void teardown();
 
+    bool thread_create(AP_HAL::MemberProc proc, const char *name,
+                       uint32_t stack_size, priority_base base,
+                       int8_t priority) override;
+
+    /*
+     * Add a thread running IO processes alongside the io thread. Must be
+     * called before init(). The worker is pinned to @cpu unless it's -1
+     * and @prio must be within the IO priority band. Only processes
+     * registered with the worker's name run on it, everything else
+     * stays on the io thread.
+     */
+    bool add_io_worker(const char *name, int cpu, int prio);
+
 private:
     class SchedulerThread : public PeriodicThread {
     public:
@@ -66,9 +81,37 @@ private:
         Scheduler &_sched;
     };
 
+    class IOWorker {
+    public:
+        IOWorker(Scheduler &sched, const char *name_, int cpu_, int prio_);
+
+        void run();
+
+        char name[16];
+        char thread_name[16];
+        int cpu;
+        int prio;
+
+        AP_HAL::MemberProc procs[LINUX_SCHEDULER_MAX_IO_PROCS];
+        uint8_t num_procs;
+
+        SchedulerThread thread;
+        Semaphore sem;
+        AP_HAL::Util::perf_counter_t perf;
+
+        /* fraction of time spent running procs over the last window */
+        uint64_t busy_usec;
+        uint64_t window_start_usec;
+        float utilization;
+    };
+
     void _wait_all_threads();
 
     void     _debug_stack();
+    void     _debug_workers();
+
+    bool _add_io_proc(AP_HAL::MemberProc *procs, uint8_t &num_procs,
+                      AP_HAL::MemberProc proc);
 
     AP_HAL::Proc _delay_cb;
     uint16_t _min_delay_cb_ms;
@@ -95,6 +138,9 @@ private:
     AP_HAL::MemberProc _io_proc[LINUX_SCHEDULER_MAX_IO_PROCS];
     uint8_t _num_io_procs;
 
+    IOWorker *_io_workers[LINUX_SCHEDULER_MAX_IO_WORKERS];
+    uint8_t _num_io_workers;
+
     SchedulerThread _timer_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_timer_task, void), *this};
     SchedulerThread _io_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_io_task, void), *this};
     SchedulerThread _rcin_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_rcin_task, void), *this};
@@ -113,6 +159,10 @@ private:
 
     uint64_t _stopped_clock_usec;
     uint64_t _last_stack_debug_msec;
+    uint64_t _last_workers_debug_msec;
+
+    AP_HAL::Util::perf_counter_t _perf_timers;
+    AP_HAL::Util::perf_counter_t _perf_io_timers;
 
     Semaphore _timer_semaphore;
     Semaphore _io_semaphore;
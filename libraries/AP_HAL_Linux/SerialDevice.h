@@ -2,6 +2,7 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <sys/uio.h>
 
 #include "AP_HAL_Linux.h"
 
@@ -13,6 +14,26 @@ public:
     virtual bool close() = 0;
     virtual ssize_t write(const uint8_t *buf, uint16_t n) = 0;
     virtual ssize_t read(uint8_t *buf, uint16_t n) = 0;
+
+    /*
+      write a list of buffers. Packet based devices must send them as
+      a single packet. The default writes each buffer in turn
+     */
+    virtual ssize_t writev(const struct iovec *iov, int iovcnt)
+    {
+        ssize_t total = 0;
+        for (int i = 0; i < iovcnt; i++) {
+            ssize_t ret = write((const uint8_t *)iov[i].iov_base, iov[i].iov_len);
+            if (ret <= 0) {
+                return total > 0 ? total : ret;
+            }
+            total += ret;
+            if ((size_t)ret != iov[i].iov_len) {
+                break;
+            }
+        }
+        return total;
+    }
     virtual void set_blocking(bool blocking) = 0;
     virtual void set_speed(uint32_t speed) = 0;
     virtual AP_HAL::UARTDriver::flow_control get_flow_control(void) { return AP_HAL::UARTDriver::FLOW_CONTROL_ENABLE; }
@@ -32,6 +32,14 @@ ssize_t TCPServerDevice::write(const uint8_t *buf, uint16_t n)
     return sock->send(buf, n);
 }
 
+ssize_t TCPServerDevice::writev(const struct iovec *iov, int iovcnt)
+{
+    if (sock == nullptr) {
+        return -1;
+    }
+    return sock->sendv(iov, iovcnt);
+}
+
 /*
   when we try to read we accept new connections if one isn't already
   established
@@ -184,6 +184,16 @@ bool Thread::start(const char *name, int policy, int prio)
         }
     }
 
+    if (_cpu >= 0) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(_cpu, &cpuset);
+        if ((r = pthread_attr_setaffinity_np(&attr, sizeof(cpuset), &cpuset)) != 0) {
+            AP_HAL::panic("Failed to set affinity of thread '%s' to cpu %d: %s",
+                          name, _cpu, strerror(r));
+        }
+    }
+
     r = pthread_create(&_ctx, &attr, &Thread::_run_trampoline, this);
     if (r != 0) {
         AP_HAL::panic("Failed to create thread '%s': %s",
@@ -244,6 +254,17 @@ bool Thread::set_stack_size(size_t stack_size)
     return true;
 }
 
+bool Thread::set_cpu_affinity(int cpu)
+{
+    if (_started || cpu >= CPU_SETSIZE) {
+        return false;
+    }
+
+    _cpu = cpu;
+
+    return true;
+}
+
 bool PeriodicThread::_run()
 {
     if (_period_usec == 0) {
@@ -45,6 +45,9 @@ public:
 
     bool set_stack_size(size_t stack_size);
 
+    /* pin the thread to @cpu when it's started, -1 to let it float */
+    bool set_cpu_affinity(int cpu);
+
     virtual bool stop() { return false; }
 
     bool join();
@@ -72,6 +75,7 @@ protected:
     } _stack_debug;
 
     size_t _stack_size = 0;
+    int _cpu = -1;
 };
 
 class PeriodicThread : public Thread {
@@ -18,6 +18,7 @@
 #include <unistd.h>
 
 #include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
 
 #include "ConsoleDevice.h"
 #include "TCPServerDevice.h"
@@ -282,12 +283,28 @@ int16_t UARTDriver::read()
     return byte;
 }
 
+uint32_t UARTDriver::read(uint8_t *buffer, uint32_t count)
+{
+    if (!_initialised) {
+        return 0;
+    }
+
+    return _readbuf.read(buffer, count);
+}
+
 /* Linux implementations of Print virtual methods */
 size_t UARTDriver::write(uint8_t c)
 {
     if (!_initialised) {
         return 0;
     }
+    if (_tx_reserving) {
+        if (_tx_fill(&c, 1) == 1) {
+            return 1;
+        }
+        // more than was reserved
+        end_write();
+    }
 
     while (_writebuf.space() == 0) {
         if (_nonblocking_writes) {
@@ -295,7 +312,10 @@ size_t UARTDriver::write(uint8_t c)
         }
         hal.scheduler->delay(1);
     }
-    return _writebuf.write(&c, 1);
+    size_t ret = _writebuf.write(&c, 1);
+    _tx_stats.bytes += ret;
+    _tx_stats.bytes_copied += ret;
+    return ret;
 }
 
 /*
@@ -306,11 +326,22 @@ size_t UARTDriver::write(const uint8_t *buffer, size_t size)
     if (!_initialised) {
         return 0;
     }
+    size_t ret = 0;
+    if (_tx_reserving) {
+        ret = _tx_fill(buffer, size);
+        if (ret == size) {
+            return ret;
+        }
+        // more than was reserved, so finish the reservation and
+        // write the rest normally
+        end_write();
+        buffer += ret;
+        size -= ret;
+    }
     if (!_nonblocking_writes) {
         /*
           use the per-byte delay loop in write() above for blocking writes
          */
-        size_t ret = 0;
         while (size--) {
             if (write(*buffer++) != 1) break;
             ret++;
@@ -318,7 +349,70 @@ size_t UARTDriver::write(const uint8_t *buffer, size_t size)
         return ret;
     }
 
-    return _writebuf.write(buffer, size);
+    uint32_t n = _writebuf.write(buffer, size);
+    _tx_stats.bytes += n;
+    _tx_stats.bytes_copied += n;
+    return ret + n;
+}
+
+/*
+  reserve transmit buffer space for a message of size bytes. The
+  message is filled in by write() and only becomes visible to the
+  timer thread at end_write(), so it is always sent whole
+ */
+bool UARTDriver::begin_write(uint32_t size)
+{
+    if (!_initialised || !_nonblocking_writes || _tx_reserving) {
+        return false;
+    }
+    if (size == 0 || _writebuf.space() < size) {
+        return false;
+    }
+    _tx_nvec = _writebuf.reserve(_tx_vec, size);
+    _tx_reserved = size;
+    _tx_filled = 0;
+    _tx_reserving = true;
+    return true;
+}
+
+/*
+  make a message written after begin_write() available for transmit
+ */
+void UARTDriver::end_write(void)
+{
+    if (!_tx_reserving) {
+        return;
+    }
+    _tx_reserving = false;
+    _writebuf.commit(_tx_filled);
+    _tx_stats.messages++;
+}
+
+/*
+  copy bytes into the space reserved by begin_write(), returning the
+  number of bytes that fitted
+ */
+uint32_t UARTDriver::_tx_fill(const uint8_t *buffer, uint32_t size)
+{
+    uint32_t n = MIN(size, _tx_reserved - _tx_filled);
+    uint32_t ofs = _tx_filled;
+    uint32_t done = 0;
+
+    for (uint8_t i = 0; i < _tx_nvec && done < n; i++) {
+        if (ofs >= _tx_vec[i].len) {
+            ofs -= _tx_vec[i].len;
+            continue;
+        }
+        uint32_t len = MIN(n - done, _tx_vec[i].len - ofs);
+        memcpy(_tx_vec[i].data + ofs, buffer + done, len);
+        done += len;
+        ofs = 0;
+    }
+
+    _tx_filled += done;
+    _tx_stats.bytes += done;
+    _tx_stats.bytes_copied += done;
+    return done;
 }
 
 /*
@@ -340,6 +434,27 @@ int UARTDriver::_write_fd(const uint8_t *buf, uint16_t n)
     return _device->write(buf, n);
 }
 
+/*
+  try writing a list of buffers with one call, handling an
+  unresponsive port
+ */
+int UARTDriver::_write_fdv(const ByteBuffer::IoVec *vec, uint8_t n_vec)
+{
+    if (!_connected) {
+        _connected = _device->open();
+    }
+    if (!_connected) {
+        return 0;
+    }
+
+    struct iovec iov[2];
+    for (uint8_t i = 0; i < n_vec; i++) {
+        iov[i].iov_base = vec[i].data;
+        iov[i].iov_len = vec[i].len;
+    }
+    return _device->writev(iov, n_vec);
+}
+
 /*
   try reading n bytes, handling an unresponsive port
  */
@@ -413,30 +528,16 @@ bool UARTDriver::_write_pending_bytes(void)
     }
 
     if (n > 0) {
-        int ret;
-
-        if (_packetise) {
-            // keep as a single UDP packet
-            uint8_t tmpbuf[n];
-            _writebuf.peekbytes(tmpbuf, n);
-            ret = _write_fd(tmpbuf, n);
-            if (ret > 0)
-                _writebuf.advance(ret);
-        } else {
-            ByteBuffer::IoVec vec[2];
-            const auto n_vec = _writebuf.peekiovec(vec, n);
-            for (int i = 0; i < n_vec; i++) {
-                ret = _write_fd(vec[i].data, (uint16_t)vec[i].len);
-                if (ret < 0) {
-                    break;
-                }
-                _writebuf.advance(ret);
-
-                /* We wrote less than we asked for, stop */
-                if ((unsigned)ret != vec[i].len) {
-                    break;
-                }
-            }
+        // send straight from the ring buffer, with both parts in one
+        // call if it has wrapped. Packet devices send the parts as a
+        // single UDP packet
+        ByteBuffer::IoVec vec[2];
+        const auto n_vec = _writebuf.peekiovec(vec, n);
+        int ret = _write_fdv(vec, n_vec);
+        _tx_stats.syscalls++;
+        if (ret > 0) {
+            _writebuf.advance(ret);
+            _tx_stats.bytes_sent += ret;
         }
     }
 
@@ -29,11 +29,28 @@ public:
     uint32_t available() override;
     uint32_t txspace() override;
     int16_t read() override;
+    uint32_t read(uint8_t *buffer, uint32_t count) override;
 
     /* Linux implementations of Print virtual methods */
     size_t write(uint8_t c);
     size_t write(const uint8_t *buffer, size_t size);
 
+    bool begin_write(uint32_t size) override;
+    void end_write(void) override;
+
+    /*
+      transmit counters, used to check how much copying is done
+      between the caller and the device
+     */
+    struct tx_stats {
+        uint64_t bytes;        // bytes accepted by write()
+        uint64_t bytes_copied; // bytes copied by the driver
+        uint64_t bytes_sent;   // bytes taken by the device
+        uint32_t messages;     // messages written with begin_write()
+        uint32_t syscalls;     // device write calls
+    };
+    const struct tx_stats &get_tx_stats(void) const { return _tx_stats; }
+
     void set_device_path(const char *path);
 
     bool _write_pending_bytes(void);
@@ -55,8 +72,8 @@ private:
     bool _console;
     volatile bool _in_timer;
     uint16_t _base_port;
-    char *_ip;
-    char *_flag;
+    char *_ip = nullptr;
+    char *_flag = nullptr;
     bool _connected; // true if a client has connected
     bool _packetise; // true if writes should try to be on mavlink boundaries
 
@@ -66,6 +83,17 @@ private:
     AP_HAL::OwnPtr<SerialDevice> _parseDevicePath(const char *arg);
     uint64_t _last_write_time;
 
+    // transmit buffer space reserved by begin_write()
+    ByteBuffer::IoVec _tx_vec[2];
+    uint8_t _tx_nvec = 0;
+    uint32_t _tx_reserved = 0;
+    uint32_t _tx_filled = 0;
+    bool _tx_reserving = false;
+
+    struct tx_stats _tx_stats {};
+
+    uint32_t _tx_fill(const uint8_t *buffer, uint32_t size);
+
 protected:
     const char *device_path;
     volatile bool _initialised;
@@ -76,6 +104,7 @@ protected:
     ByteBuffer _writebuf{0};
 
     virtual int _write_fd(const uint8_t *buf, uint16_t n);
+    virtual int _write_fdv(const ByteBuffer::IoVec *vec, uint8_t n_vec);
     virtual int _read_fd(uint8_t *buf, uint16_t n);
 };
 
@@ -33,6 +33,21 @@ ssize_t UDPDevice::write(const uint8_t *buf, uint16_t n)
     return socket.sendto(buf, n, _ip, _port);
 }
 
+ssize_t UDPDevice::writev(const struct iovec *iov, int iovcnt)
+{
+    if (!socket.pollout(0)) {
+        return -1;
+    }
+    if (_connected) {
+        return socket.sendv(iov, iovcnt);
+    }
+    if (_input) {
+        // can't send yet
+        return -1;
+    }
+    return socket.sendtov(iov, iovcnt, _ip, _port);
+}
+
 ssize_t UDPDevice::read(uint8_t *buf, uint16_t n)
 {
     ssize_t ret = socket.recv(buf, n, 0);
@@ -265,10 +265,10 @@ void VideoIn::shrink_8bpp(uint8_t *buffer, uint8_t *new_buffer,
 
     /* selection offset */
     block_y = top * width;
-    block_position = left + block_y;
 
     for (i = 0; i < out_height; i++) {
         block_x = left;
+        block_position = block_x + block_y;
         for (j = 0; j < out_width; j++) {
             px = 0;
 
@@ -319,6 +319,59 @@ void VideoIn::yuyv_to_grey(uint8_t *buffer, uint32_t buffer_size,
     }
 }
 
+void VideoIn::crop_shrink_grey(const uint8_t *buffer, uint8_t *new_buffer,
+                               uint32_t bytesperline, uint32_t pixel_step,
+                               uint32_t left, uint32_t selection_width,
+                               uint32_t top, uint32_t selection_height,
+                               uint32_t fx, uint32_t fy)
+{
+    const uint32_t out_width = selection_width / fx;
+    const uint32_t out_height = selection_height / fy;
+    const uint32_t fx_fy = fx * fy;
+    const uint32_t block_step = fx * pixel_step;
+    const uint8_t *line = buffer + top * bytesperline + left * pixel_step;
+
+    if (fx_fy == 1 && pixel_step == 1) {
+        /* crop only */
+        for (uint32_t i = 0; i < out_height; i++) {
+            memcpy(new_buffer, line, out_width);
+            new_buffer += out_width;
+            line += bytesperline;
+        }
+        return;
+    }
+
+    if (fx_fy == 1) {
+        /* crop and take the luma */
+        for (uint32_t i = 0; i < out_height; i++) {
+            for (uint32_t j = 0; j < out_width; j++) {
+                new_buffer[j] = line[j * pixel_step];
+            }
+            new_buffer += out_width;
+            line += bytesperline;
+        }
+        return;
+    }
+
+    for (uint32_t i = 0; i < out_height; i++) {
+        const uint8_t *block = line;
+        for (uint32_t j = 0; j < out_width; j++) {
+            uint32_t px = 0;
+            const uint8_t *block_line = block;
+            for (uint32_t k = 0; k < fy; k++) {
+                for (uint32_t kk = 0; kk < block_step; kk += pixel_step) {
+                    px += block_line[kk];
+                }
+                block_line += bytesperline;
+            }
+            new_buffer[j] = px / fx_fy;
+            block += block_step;
+        }
+        new_buffer += out_width;
+        line += fy * bytesperline;
+    }
+}
+
 uint32_t VideoIn::_timeval_to_us(struct timeval& tv)
 {
     return (1.0e6 * tv.tv_sec + tv.tv_usec);
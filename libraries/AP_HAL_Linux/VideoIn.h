@@ -66,6 +66,16 @@ public:
     static void yuyv_to_grey(uint8_t *buffer, uint32_t buffer_size,
                              uint8_t *new_buffer);
 
+    /* Crop, shrink and convert to grey in a single pass, reading only
+     * the selected area of the frame. The frame is 8bpp luma, or YUYV
+     * if pixel_step is 2, and fx x fy blocks of the selection are
+     * averaged into each pixel of new_buffer, as shrink_8bpp() does */
+    static void crop_shrink_grey(const uint8_t *buffer, uint8_t *new_buffer,
+                                 uint32_t bytesperline, uint32_t pixel_step,
+                                 uint32_t left, uint32_t selection_width,
+                                 uint32_t top, uint32_t selection_height,
+                                 uint32_t fx, uint32_t fy);
+
 private:
     void _queue_buffer(int index);
     bool _set_streaming(bool enable);
@@ -1,9 +1,127 @@
 #include <AP_gbenchmark.h>
 #include <AP_HAL/AP_HAL.h>
+#include <AP_HAL_Linux/Flow_PX4_Kernels.h>
+
+/*
+  flow blocks as laid out by Flow_PX4 with a search size of 4: 8x8
+  patterns 11 pixels apart, far enough from the edges for the search
+  and subpixel border
+ */
+#define FLOW_SEARCH_SIZE 4
+#define FLOW_BLOCK_STEP  (2 * FLOW_SEARCH_SIZE + 3)
+#define FLOW_BORDER      (FLOW_SEARCH_SIZE + 1)
+
+static uint8_t *flow_random_frame(uint32_t size)
+{
+    uint8_t *frame = (uint8_t *)malloc(size);
+    if (!frame) {
+        fprintf(stderr, "error: couldn't malloc frame\n");
+        return nullptr;
+    }
+    for (uint32_t i = 0; i < size; i++) {
+        frame[i] = rand();
+    }
+    return frame;
+}
+
+enum FlowKernel {
+    FLOW_KERNEL_DIFF,
+    FLOW_KERNEL_SAD,
+    FLOW_KERNEL_SUBPIXEL,
+};
+
+/*
+  run one kernel over every block of a frame, the SAD at every offset
+  of the search window as Flow_PX4::compute_flow() does
+ */
+static void flow_kernel_frame(benchmark::State& state, const Linux::Flow_PX4_Kernels &kernels,
+                              enum FlowKernel kernel)
+{
+    const uint32_t width = state.range_x();
+    const uint32_t height = state.range_y();
+    const int32_t search = FLOW_SEARCH_SIZE;
+    uint8_t *image1 = flow_random_frame(width * height);
+    uint8_t *image2 = flow_random_frame(width * height);
+    uint32_t acc[8];
+    uint32_t result = 0;
+
+    if (!image1 || !image2) {
+        free(image1);
+        free(image2);
+        return;
+    }
+
+    while (state.KeepRunning()) {
+        for (uint32_t y = FLOW_BORDER; y + 2 * search + FLOW_BORDER < height; y += FLOW_BLOCK_STEP) {
+            for (uint32_t x = FLOW_BORDER; x + 2 * search + FLOW_BORDER < width; x += FLOW_BLOCK_STEP) {
+                const uint8_t *p1 = &image1[y * width + x];
+                const uint8_t *p2 = &image2[y * width + x];
+                switch (kernel) {
+                case FLOW_KERNEL_DIFF:
+                    result += kernels.diff(p1 + 2 * width + 2, width, search);
+                    break;
+                case FLOW_KERNEL_SAD:
+                    for (int32_t jj = -search; jj <= search; jj++) {
+                        for (int32_t ii = -search; ii <= search; ii++) {
+                            result += kernels.sad(p1, p2 + jj * (int32_t)width + ii, width, 2 * search);
+                        }
+                    }
+                    break;
+                case FLOW_KERNEL_SUBPIXEL:
+                    kernels.subpixel(p1, p2, width, 2 * search, acc);
+                    result += acc[0];
+                    break;
+                }
+            }
+        }
+        gbenchmark_escape(&result);
+    }
+
+    free(image1);
+    free(image2);
+}
+
+static void BM_FlowDiffScalar(benchmark::State& state)
+{
+    flow_kernel_frame(state, Linux::Flow_PX4_Kernels::scalar, FLOW_KERNEL_DIFF);
+}
+
+static void BM_FlowDiff(benchmark::State& state)
+{
+    flow_kernel_frame(state, Linux::Flow_PX4_Kernels::get(), FLOW_KERNEL_DIFF);
+}
+
+static void BM_FlowSadScalar(benchmark::State& state)
+{
+    flow_kernel_frame(state, Linux::Flow_PX4_Kernels::scalar, FLOW_KERNEL_SAD);
+}
+
+static void BM_FlowSad(benchmark::State& state)
+{
+    flow_kernel_frame(state, Linux::Flow_PX4_Kernels::get(), FLOW_KERNEL_SAD);
+}
+
+static void BM_FlowSubpixelScalar(benchmark::State& state)
+{
+    flow_kernel_frame(state, Linux::Flow_PX4_Kernels::scalar, FLOW_KERNEL_SUBPIXEL);
+}
+
+static void BM_FlowSubpixel(benchmark::State& state)
+{
+    flow_kernel_frame(state, Linux::Flow_PX4_Kernels::get(), FLOW_KERNEL_SUBPIXEL);
+}
+
+BENCHMARK(BM_FlowDiffScalar)->ArgPair(64, 64)->ArgPair(240, 240)->ArgPair(640, 480);
+BENCHMARK(BM_FlowDiff)->ArgPair(64, 64)->ArgPair(240, 240)->ArgPair(640, 480);
+BENCHMARK(BM_FlowSadScalar)->ArgPair(64, 64)->ArgPair(240, 240)->ArgPair(640, 480);
+BENCHMARK(BM_FlowSad)->ArgPair(64, 64)->ArgPair(240, 240)->ArgPair(640, 480);
+BENCHMARK(BM_FlowSubpixelScalar)->ArgPair(64, 64)->ArgPair(240, 240)->ArgPair(640, 480);
+BENCHMARK(BM_FlowSubpixel)->ArgPair(64, 64)->ArgPair(240, 240)->ArgPair(640, 480);
 
 #if CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_BEBOP ||\
     CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_MINLURE
 
+#include <AP_HAL_Linux/Flow_PX4.h>
 #include <AP_HAL_Linux/VideoIn.h>
 
 static void BM_Crop8bpp(benchmark::State& state)
@@ -37,6 +155,37 @@ static void BM_Crop8bpp(benchmark::State& state)
 
 BENCHMARK(BM_Crop8bpp)->ArgPair(64, 64)->ArgPair(240, 240)->ArgPair(640, 480);
 
+static void BM_Crop8bppFused(benchmark::State& state)
+{
+    uint8_t *buffer, *new_buffer;
+    uint32_t width = 640;
+    uint32_t height = 480;
+    uint32_t left = width / 2 - state.range_x() / 2;
+    uint32_t top = height / 2 - state.range_y() / 2;
+
+    buffer = (uint8_t *)malloc(width * height);
+    if (!buffer) {
+        fprintf(stderr, "error: couldn't malloc buffer\n");
+        return;
+    }
+
+    new_buffer = (uint8_t *)malloc(state.range_x() * state.range_y());
+    if (!new_buffer) {
+        fprintf(stderr, "error: couldn't malloc new_buffer\n");
+        return;
+    }
+
+    while (state.KeepRunning()) {
+        Linux::VideoIn::crop_shrink_grey(buffer, new_buffer, width, 1,
+            left, state.range_x(), top, state.range_y(), 1, 1);
+    }
+
+    free(buffer);
+    free(new_buffer);
+}
+
+BENCHMARK(BM_Crop8bppFused)->ArgPair(64, 64)->ArgPair(240, 240)->ArgPair(640, 480);
+
 static void BM_YuyvToGrey(benchmark::State& state)
 {
     uint8_t *buffer, *new_buffer;
@@ -62,6 +211,116 @@ static void BM_YuyvToGrey(benchmark::State& state)
 }
 
 BENCHMARK(BM_YuyvToGrey)->Arg(64 * 64)->Arg(320 * 240)->Arg(640 * 480);
+
+/*
+  YUYV camera frame to the 64x64 grey frame used by the flow, shrinking
+  the largest centred square that is a multiple of 64, with separate
+  passes and in a single pass
+ */
+static void yuyv_shrink(benchmark::State& state, bool fused)
+{
+    uint8_t *buffer, *grey_buffer, *new_buffer;
+    uint32_t width = state.range_x();
+    uint32_t height = state.range_y();
+    uint32_t scale = (width < height ? width : height) / 64;
+    uint32_t selection = 64 * scale;
+    uint32_t left = (width - selection) / 2;
+    uint32_t top = (height - selection) / 2;
+
+    buffer = (uint8_t *)malloc(width * height * 2);
+    if (!buffer) {
+        fprintf(stderr, "error: couldn't malloc buffer\n");
+        return;
+    }
+
+    grey_buffer = (uint8_t *)malloc(width * height);
+    if (!grey_buffer) {
+        fprintf(stderr, "error: couldn't malloc grey_buffer\n");
+        return;
+    }
+
+    new_buffer = (uint8_t *)malloc(64 * 64);
+    if (!new_buffer) {
+        fprintf(stderr, "error: couldn't malloc new_buffer\n");
+        return;
+    }
+
+    while (state.KeepRunning()) {
+        if (fused) {
+            Linux::VideoIn::crop_shrink_grey(buffer, new_buffer, width * 2, 2,
+                left, selection, top, selection, scale, scale);
+        } else {
+            Linux::VideoIn::yuyv_to_grey(buffer, width * height * 2, grey_buffer);
+            Linux::VideoIn::shrink_8bpp(grey_buffer, new_buffer, width, height,
+                left, selection, top, selection, scale, scale);
+        }
+        gbenchmark_escape(new_buffer);
+    }
+
+    free(buffer);
+    free(grey_buffer);
+    free(new_buffer);
+}
+
+static void BM_YuyvShrink(benchmark::State& state)
+{
+    yuyv_shrink(state, false);
+}
+
+static void BM_YuyvShrinkFused(benchmark::State& state)
+{
+    yuyv_shrink(state, true);
+}
+
+BENCHMARK(BM_YuyvShrink)->ArgPair(64, 64)->ArgPair(320, 240)->ArgPair(640, 480);
+BENCHMARK(BM_YuyvShrinkFused)->ArgPair(64, 64)->ArgPair(320, 240)->ArgPair(640, 480);
+
+/*
+  whole frame flow on a textured frame moved by one pixel. Flow_PX4
+  works on a square so a 640x480 frame uses its left 480x480 pixels
+ */
+static void flow_frame(benchmark::State& state, const Linux::Flow_PX4_Kernels &kernels)
+{
+    const uint32_t width = state.range_x();
+    const uint32_t height = state.range_y();
+    uint8_t *image1 = flow_random_frame(width * height);
+    uint8_t *image2 = (uint8_t *)malloc(width * height);
+    float flow_x, flow_y;
+
+    if (!image1 || !image2) {
+        free(image1);
+        free(image2);
+        return;
+    }
+    memcpy(image2 + 1, image1, width * height - 1);
+    image2[0] = image1[0];
+
+    Linux::Flow_PX4 flow(width < height ? width : height, width, FLOW_SEARCH_SIZE,
+                         HAL_FLOW_PX4_BOTTOM_FLOW_FEATURE_THRESHOLD,
+                         HAL_FLOW_PX4_BOTTOM_FLOW_VALUE_THRESHOLD);
+    flow.set_kernels(kernels);
+
+    while (state.KeepRunning()) {
+        uint8_t quality = flow.compute_flow(image1, image2, 0, &flow_x, &flow_y);
+        gbenchmark_escape(&quality);
+    }
+
+    free(image1);
+    free(image2);
+}
+
+static void BM_FlowPX4Scalar(benchmark::State& state)
+{
+    flow_frame(state, Linux::Flow_PX4_Kernels::scalar);
+}
+
+static void BM_FlowPX4(benchmark::State& state)
+{
+    flow_frame(state, Linux::Flow_PX4_Kernels::get());
+}
+
+BENCHMARK(BM_FlowPX4Scalar)->ArgPair(64, 64)->ArgPair(240, 240)->ArgPair(640, 480);
+BENCHMARK(BM_FlowPX4)->ArgPair(64, 64)->ArgPair(240, 240)->ArgPair(640, 480);
 #endif
 
 BENCHMARK_MAIN()
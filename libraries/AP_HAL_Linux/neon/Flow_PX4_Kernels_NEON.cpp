@@ -0,0 +1,169 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  NEON block matching kernels for Flow_PX4. NEON is optional on ARMv7,
+  so this file is built on its own with NEON enabled while the rest of
+  the program keeps the board's FPU, see the linux board in boards.py.
+  Only include headers without inline code here, as the compiler may
+  use NEON in anything this file instantiates
+ */
+#include <AP_HAL_Linux/Flow_PX4_Kernels.h>
+
+#include <string.h>
+
+using namespace Linux;
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+
+#include <arm_neon.h>
+
+// 4 pixels, first one in the low byte
+static inline uint32_t load_u32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t hsum_u16(uint16x8_t v)
+{
+    const uint64x2_t s = vpaddlq_u32(vpaddlq_u16(v));
+    return vgetq_lane_u64(s, 0) + vgetq_lane_u64(s, 1);
+}
+
+static uint32_t diff_neon(const uint8_t *image, uint32_t row_size, uint8_t window_size)
+{
+    if (window_size != FLOW_DIFF_WINDOW) {
+        return Flow_PX4_Kernels::scalar.diff(image, row_size, window_size);
+    }
+
+    const uint64_t r0 = load_u32(image);
+    const uint64_t r1 = load_u32(image + row_size);
+    const uint64_t r2 = load_u32(image + 2 * row_size);
+    const uint64_t r3 = load_u32(image + 3 * row_size);
+
+    // lines 0/1 and 1/2, then 2/3 with the upper half zero in both
+    uint16x8_t sum = vabdl_u8(vcreate_u8(r0 | r1 << 32), vcreate_u8(r1 | r2 << 32));
+    sum = vabal_u8(sum, vcreate_u8(r2), vcreate_u8(r3));
+
+    // each line against itself moved one pixel left, with the last
+    // pixel of the line masked out
+    const uint32x2_t mask = vdup_n_u32(0x00FFFFFF);
+    const uint32x2_t rows01 = vcreate_u32(r0 | r1 << 32);
+    const uint32x2_t rows23 = vcreate_u32(r2 | r3 << 32);
+    sum = vabal_u8(sum, vreinterpret_u8_u32(vand_u32(rows01, mask)),
+                   vreinterpret_u8_u32(vshr_n_u32(rows01, 8)));
+    sum = vabal_u8(sum, vreinterpret_u8_u32(vand_u32(rows23, mask)),
+                   vreinterpret_u8_u32(vshr_n_u32(rows23, 8)));
+
+    return hsum_u16(sum);
+}
+
+static uint32_t sad_neon(const uint8_t *image1, const uint8_t *image2,
+                         uint32_t row_size, uint8_t window_size)
+{
+    if (window_size != FLOW_SAD_WINDOW) {
+        return Flow_PX4_Kernels::scalar.sad(image1, image2, row_size, window_size);
+    }
+
+    uint16x8_t sum = vabdl_u8(vld1_u8(image1), vld1_u8(image2));
+    for (uint8_t j = 1; j < FLOW_SAD_WINDOW; j++) {
+        sum = vabal_u8(sum, vld1_u8(image1 + j * row_size), vld1_u8(image2 + j * row_size));
+    }
+    return hsum_u16(sum);
+}
+
+// 8 pixels widened to 16 bits
+static inline uint16x8_t load_u16x8(const uint8_t *p)
+{
+    return vmovl_u8(vld1_u8(p));
+}
+
+static inline uint16x8_t mean2(uint16x8_t a, uint16x8_t b)
+{
+    return vshrq_n_u16(vaddq_u16(a, b), 1);
+}
+
+static inline uint16x8_t mean4(uint16x8_t a, uint16x8_t b, uint16x8_t c, uint16x8_t d)
+{
+    return vshrq_n_u16(vaddq_u16(vaddq_u16(a, b), vaddq_u16(c, d)), 2);
+}
+
+static void subpixel_neon(const uint8_t *image1, const uint8_t *image2,
+                          uint32_t row_size, uint8_t window_size, uint32_t acc[8])
+{
+    if (window_size != FLOW_SAD_WINDOW) {
+        Flow_PX4_Kernels::scalar.subpixel(image1, image2, row_size, window_size, acc);
+        return;
+    }
+
+    /* one line of the pattern in each vector, with l and r holding the
+     * pixels left and right of each one and u and d the lines above and
+     * below. Sums of 4 pixels fit in 16 bits, as do the totals of the
+     * absolute differences over 8 lines
+     */
+    const uint8_t *p = image2 - row_size;
+    uint16x8_t ul = load_u16x8(p - 1), uc = load_u16x8(p), ur = load_u16x8(p + 1);
+    p += row_size;
+    uint16x8_t l = load_u16x8(p - 1), c = load_u16x8(p), r = load_u16x8(p + 1);
+
+    uint16x8_t sum[8];
+    for (uint8_t k = 0; k < 8; k++) {
+        sum[k] = vdupq_n_u16(0);
+    }
+
+    for (uint8_t j = 0; j < FLOW_SAD_WINDOW; j++) {
+        p += row_size;
+        const uint16x8_t dl = load_u16x8(p - 1), dc = load_u16x8(p), dr = load_u16x8(p + 1);
+        const uint16x8_t x = load_u16x8(image1 + j * row_size);
+
+        sum[0] = vabaq_u16(sum[0], x, mean2(c, r));
+        sum[1] = vabaq_u16(sum[1], x, mean4(c, r, dc, dr));
+        sum[2] = vabaq_u16(sum[2], x, mean2(c, dr));
+        sum[3] = vabaq_u16(sum[3], x, mean4(c, l, dl, dc));
+        sum[4] = vabaq_u16(sum[4], x, mean2(c, dl));
+        sum[5] = vabaq_u16(sum[5], x, mean4(c, l, ul, uc));
+        sum[6] = vabaq_u16(sum[6], x, mean2(c, uc));
+        sum[7] = vabaq_u16(sum[7], x, mean4(c, r, uc, ur));
+
+        ul = l; uc = c; ur = r;
+        l = dl; c = dc; r = dr;
+    }
+
+    for (uint8_t k = 0; k < 8; k++) {
+        acc[k] = hsum_u16(sum[k]);
+    }
+}
+
+static const Flow_PX4_Kernels neon_kernels = {
+    "neon",
+    diff_neon,
+    sad_neon,
+    subpixel_neon,
+};
+
+const Flow_PX4_Kernels *Flow_PX4_Kernels::neon()
+{
+    return &neon_kernels;
+}
+
+#else
+
+const Flow_PX4_Kernels *Flow_PX4_Kernels::neon()
+{
+    return nullptr;
+}
+
+#endif
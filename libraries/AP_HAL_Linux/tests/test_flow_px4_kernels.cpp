@@ -0,0 +1,140 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gtest.h>
+
+#include <stdlib.h>
+#include <vector>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL_Linux/Flow_PX4_Kernels.h>
+
+using namespace Linux;
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+static const uint32_t width = 67;
+static const uint32_t height = 40;
+
+static std::vector<uint8_t> random_image(unsigned seed)
+{
+    std::vector<uint8_t> image(width * height);
+    srand(seed);
+    for (auto &p : image) {
+        p = rand();
+    }
+    return image;
+}
+
+/*
+  run every kernel at every position where the 8x8 pattern and its
+  border fit, with a search offset into the second image
+ */
+static void expect_same(const Flow_PX4_Kernels &k, const std::vector<uint8_t> &image1,
+                        const std::vector<uint8_t> &image2)
+{
+    const Flow_PX4_Kernels &ref = Flow_PX4_Kernels::scalar;
+
+    for (uint32_t y = 1; y + 9 < height; y++) {
+        for (uint32_t x = 1; x + 9 < width; x++) {
+            const uint8_t *p1 = &image1[y * width + x];
+            const uint8_t *p2 = &image2[(height - 10 - y + 1) * width + x];
+
+            EXPECT_EQ(ref.diff(p1, width, 4), k.diff(p1, width, 4));
+            EXPECT_EQ(ref.sad(p1, p2, width, 8), k.sad(p1, p2, width, 8));
+
+            uint32_t acc_ref[8], acc[8];
+            ref.subpixel(p1, p2, width, 8, acc_ref);
+            k.subpixel(p1, p2, width, 8, acc);
+            for (uint8_t i = 0; i < 8; i++) {
+                EXPECT_EQ(acc_ref[i], acc[i]) << "direction " << (int)i;
+            }
+        }
+    }
+}
+
+TEST(Flow_PX4_Kernels, SimdMatchesScalar)
+{
+    const Flow_PX4_Kernels *simd = Flow_PX4_Kernels::simd();
+    if (simd == nullptr) {
+        return;
+    }
+
+    expect_same(*simd, random_image(1), random_image(2));
+    expect_same(*simd, random_image(3), random_image(3));
+}
+
+TEST(Flow_PX4_Kernels, SimdMatchesScalarExtremes)
+{
+    const Flow_PX4_Kernels *simd = Flow_PX4_Kernels::simd();
+    if (simd == nullptr) {
+        return;
+    }
+
+    // largest possible differences in every kernel
+    std::vector<uint8_t> checker(width * height), inverse(width * height);
+    for (uint32_t i = 0; i < width * height; i++) {
+        checker[i] = ((i % width + i / width) & 1) ? 255 : 0;
+        inverse[i] = 255 - checker[i];
+    }
+    expect_same(*simd, checker, inverse);
+    expect_same(*simd, checker, checker);
+}
+
+TEST(Flow_PX4_Kernels, OtherWindowSizes)
+{
+    const Flow_PX4_Kernels &k = Flow_PX4_Kernels::get();
+    const Flow_PX4_Kernels &ref = Flow_PX4_Kernels::scalar;
+    const std::vector<uint8_t> image1 = random_image(4);
+    const std::vector<uint8_t> image2 = random_image(5);
+    const uint8_t *p1 = &image1[3 * width + 3];
+    const uint8_t *p2 = &image2[5 * width + 4];
+
+    EXPECT_EQ(ref.diff(p1, width, 3), k.diff(p1, width, 3));
+    EXPECT_EQ(ref.sad(p1, p2, width, 6), k.sad(p1, p2, width, 6));
+
+    uint32_t acc_ref[8], acc[8];
+    ref.subpixel(p1, p2, width, 6, acc_ref);
+    k.subpixel(p1, p2, width, 6, acc);
+    for (uint8_t i = 0; i < 8; i++) {
+        EXPECT_EQ(acc_ref[i], acc[i]);
+    }
+}
+
+TEST(Flow_PX4_Kernels, ScalarReference)
+{
+    const Flow_PX4_Kernels &ref = Flow_PX4_Kernels::scalar;
+
+    // horizontal ramp, each pixel 2 brighter than the one on its left
+    std::vector<uint8_t> ramp(width * height);
+    for (uint32_t i = 0; i < width * height; i++) {
+        ramp[i] = 2 * (i % width);
+    }
+    const uint8_t *p = &ramp[2 * width + 2];
+
+    // 3 steps on each of 4 lines, nothing vertically
+    EXPECT_EQ(2U * 3 * 4, ref.diff(p, width, 4));
+    EXPECT_EQ(0U, ref.sad(p, p, width, 8));
+    EXPECT_EQ(2U * 8 * 8, ref.sad(p, p + 1, width, 8));
+
+    // every subpixel but 6, straight up, mixes in a pixel from the
+    // next column and costs 1 per pixel
+    uint32_t acc[8];
+    ref.subpixel(p, p, width, 8, acc);
+    for (uint8_t i = 0; i < 8; i++) {
+        EXPECT_EQ(i == 6 ? 0U : 8U * 8, acc[i]) << "direction " << (int)i;
+    }
+}
+
+AP_GTEST_MAIN()
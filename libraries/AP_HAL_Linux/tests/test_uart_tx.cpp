@@ -0,0 +1,221 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gtest.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL_Linux/UARTDriver.h>
+
+using namespace Linux;
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+/*
+ * UDP socket on a loopback port picked by the kernel, so tests don't
+ * depend on a fixed port being free
+ */
+class UDPReceiver
+{
+public:
+    UDPReceiver()
+    {
+        _fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    }
+
+    ~UDPReceiver()
+    {
+        if (_fd != -1) {
+            close(_fd);
+        }
+    }
+
+    /* bind to a free port, returning the port or 0 on failure */
+    uint16_t bind_any()
+    {
+        struct sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        if (_fd == -1 || bind(_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+            return 0;
+        }
+        socklen_t len = sizeof(addr);
+        if (getsockname(_fd, (struct sockaddr *)&addr, &len) != 0) {
+            return 0;
+        }
+        return ntohs(addr.sin_port);
+    }
+
+    ssize_t recv(void *buf, size_t size, uint32_t timeout_ms)
+    {
+        struct pollfd pfd = { _fd, POLLIN, 0 };
+        if (poll(&pfd, 1, timeout_ms) != 1) {
+            return -1;
+        }
+        return ::recv(_fd, buf, size, 0);
+    }
+
+private:
+    int _fd;
+};
+
+static void open_uart(UARTDriver &uart, uint16_t port)
+{
+    char path[32];
+    snprintf(path, sizeof(path), "udp:127.0.0.1:%u", (unsigned)port);
+    uart.set_device_path(path);
+    uart.begin(0);
+    uart.set_blocking_writes(false);
+}
+
+// a MAVLink2 packet with a 28 byte payload is 40 bytes long
+#define MSG_LEN 40
+
+static void make_message(uint8_t msg[MSG_LEN], uint8_t seq)
+{
+    memset(msg, seq, MSG_LEN);
+    msg[0] = 0xFD;
+    msg[1] = MSG_LEN - 12;
+    msg[2] = 0;
+    msg[4] = seq;
+}
+
+/*
+ * Write messages the way the MAVLink helpers do, as header, payload
+ * and checksum between begin_write() and end_write(). Enough messages
+ * are sent to wrap the transmit ring buffer, and each one must arrive
+ * as a whole UDP packet from a single device write
+ */
+TEST(LinuxUARTDriver, reserved_writes)
+{
+    UDPReceiver rx;
+    const uint16_t port = rx.bind_any();
+    ASSERT_NE(0, port);
+
+    UARTDriver uart(false);
+    open_uart(uart, port);
+
+    const uint32_t count = 1000;
+    for (uint32_t i = 0; i < count; i++) {
+        uint8_t msg[MSG_LEN];
+        make_message(msg, i);
+
+        EXPECT_TRUE(uart.begin_write(MSG_LEN));
+        EXPECT_EQ(10U, uart.write(msg, 10));
+        EXPECT_EQ(MSG_LEN - 12U, uart.write(&msg[10], MSG_LEN - 12));
+        EXPECT_EQ(2U, uart.write(&msg[MSG_LEN - 2], 2));
+        uart.end_write();
+
+        uart._timer_tick();
+
+        uint8_t pkt[256];
+        ASSERT_EQ(MSG_LEN, rx.recv(pkt, sizeof(pkt), 100));
+        EXPECT_EQ(0, memcmp(msg, pkt, MSG_LEN));
+    }
+
+    const UARTDriver::tx_stats &stats = uart.get_tx_stats();
+    EXPECT_EQ(count, stats.messages);
+    EXPECT_EQ(count * MSG_LEN, stats.bytes_sent);
+    EXPECT_EQ(count, stats.syscalls);
+
+    uart.end();
+}
+
+/*
+ * Messages queued between timer ticks, including ones that wrap the
+ * ring buffer, still go out as one packet per message with one
+ * device write each
+ */
+TEST(LinuxUARTDriver, queued_writes)
+{
+    UDPReceiver rx;
+    const uint16_t port = rx.bind_any();
+    ASSERT_NE(0, port);
+
+    UARTDriver uart(false);
+    open_uart(uart, port);
+
+    const uint8_t batch = 5;
+    uint32_t seq = 0;
+    for (uint32_t n = 0; n < 200; n++) {
+        const uint32_t syscalls = uart.get_tx_stats().syscalls;
+        uint8_t msg[batch][MSG_LEN];
+        for (uint8_t i = 0; i < batch; i++) {
+            make_message(msg[i], seq++);
+            ASSERT_TRUE(uart.begin_write(MSG_LEN));
+            EXPECT_EQ((size_t)MSG_LEN, uart.write(msg[i], MSG_LEN));
+            uart.end_write();
+        }
+
+        uart._timer_tick();
+        EXPECT_EQ(syscalls + batch, uart.get_tx_stats().syscalls);
+
+        for (uint8_t i = 0; i < batch; i++) {
+            uint8_t pkt[256];
+            ASSERT_EQ(MSG_LEN, rx.recv(pkt, sizeof(pkt), 100));
+            EXPECT_EQ(0, memcmp(msg[i], pkt, MSG_LEN));
+        }
+    }
+
+    // nothing else was sent
+    uint8_t pkt[256];
+    EXPECT_EQ(-1, rx.recv(pkt, sizeof(pkt), 10));
+
+    uart.end();
+}
+
+/*
+ * Writing more than was reserved finishes the reservation and writes
+ * the rest normally
+ */
+TEST(LinuxUARTDriver, reserved_write_overflow)
+{
+    UDPReceiver rx;
+    const uint16_t port = rx.bind_any();
+    ASSERT_NE(0, port);
+
+    UARTDriver uart(false);
+    open_uart(uart, port);
+
+    uint8_t msg[MSG_LEN];
+    make_message(msg, 7);
+
+    EXPECT_TRUE(uart.begin_write(10));
+    EXPECT_EQ((size_t)MSG_LEN, uart.write(msg, MSG_LEN));
+    uart.end_write();
+
+    // nothing to finish, and no nesting while reserving
+    uart.end_write();
+    EXPECT_TRUE(uart.begin_write(4));
+    EXPECT_FALSE(uart.begin_write(4));
+    uart.end_write();
+
+    uart._timer_tick();
+
+    uint8_t pkt[256];
+    ASSERT_EQ(MSG_LEN, rx.recv(pkt, sizeof(pkt), 100));
+    EXPECT_EQ(0, memcmp(msg, pkt, MSG_LEN));
+
+    uart.end();
+}
+
+AP_GTEST_MAIN()
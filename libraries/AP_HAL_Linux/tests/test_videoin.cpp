@@ -0,0 +1,104 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gtest.h>
+
+#include <AP_HAL/AP_HAL.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+#if CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_BEBOP ||\
+    CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_MINLURE ||\
+    CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_BBBMINI
+
+#include <stdlib.h>
+#include <vector>
+
+#include <AP_HAL_Linux/VideoIn.h>
+
+using namespace Linux;
+
+static std::vector<uint8_t> random_frame(uint32_t size)
+{
+    std::vector<uint8_t> frame(size);
+    for (auto &p : frame) {
+        p = rand();
+    }
+    return frame;
+}
+
+TEST(VideoIn, CropShrinkGreyYuyv)
+{
+    const uint32_t width = 320, height = 240, scale = 3;
+    const uint32_t out = 64, selection = out * scale;
+    const uint32_t left = (width - selection) / 2, top = (height - selection) / 2;
+    std::vector<uint8_t> yuyv = random_frame(width * height * 2);
+    std::vector<uint8_t> grey(width * height);
+    std::vector<uint8_t> expected(out * out), fused(out * out);
+
+    VideoIn::yuyv_to_grey(yuyv.data(), yuyv.size(), grey.data());
+    VideoIn::shrink_8bpp(grey.data(), expected.data(), width, height,
+                         left, selection, top, selection, scale, scale);
+    VideoIn::crop_shrink_grey(yuyv.data(), fused.data(), width * 2, 2,
+                              left, selection, top, selection, scale, scale);
+
+    EXPECT_EQ(expected, fused);
+}
+
+TEST(VideoIn, CropShrinkGreyCrop)
+{
+    const uint32_t width = 320, height = 240, out = 64;
+    const uint32_t left = width / 2 - out / 2, top = height / 2 - out / 2;
+    std::vector<uint8_t> yuyv = random_frame(width * height * 2);
+    std::vector<uint8_t> grey(width * height);
+    std::vector<uint8_t> expected(out * out), fused(out * out);
+
+    VideoIn::yuyv_to_grey(yuyv.data(), yuyv.size(), grey.data());
+    VideoIn::crop_8bpp(grey.data(), expected.data(), width, left, out, top, out);
+
+    VideoIn::crop_shrink_grey(grey.data(), fused.data(), width, 1,
+                              left, out, top, out, 1, 1);
+    EXPECT_EQ(expected, fused);
+
+    VideoIn::crop_shrink_grey(yuyv.data(), fused.data(), width * 2, 2,
+                              left, out, top, out, 1, 1);
+    EXPECT_EQ(expected, fused);
+}
+
+TEST(VideoIn, CropShrinkGreyPadding)
+{
+    const uint32_t width = 200, height = 100, padding = 56, scale = 2;
+    const uint32_t out = 32, selection = out * scale;
+    std::vector<uint8_t> packed = random_frame(width * height);
+    std::vector<uint8_t> padded(height * (width + padding), 0xff);
+    std::vector<uint8_t> expected(out * out), fused(out * out);
+
+    for (uint32_t i = 0; i < height; i++) {
+        std::copy(&packed[i * width], &packed[(i + 1) * width],
+                  &padded[i * (width + padding)]);
+    }
+
+    VideoIn::shrink_8bpp(packed.data(), expected.data(), width, height,
+                         width - selection, selection, height - selection, selection,
+                         scale, scale);
+    VideoIn::crop_shrink_grey(padded.data(), fused.data(), width + padding, 1,
+                              width - selection, selection, height - selection, selection,
+                              scale, scale);
+
+    EXPECT_EQ(expected, fused);
+}
+
+#endif
+
+AP_GTEST_MAIN()
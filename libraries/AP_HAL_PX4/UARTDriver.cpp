@@ -255,6 +255,22 @@ int16_t PX4UARTDriver::read()
     return byte;
 }
 
+/*
+  read up to count bytes from the read buffer
+ */
+uint32_t PX4UARTDriver::read(uint8_t *buffer, uint32_t count)
+{
+    if (_uart_owner_pid != getpid()){
+        return 0;
+    }
+    if (!_initialised) {
+        try_initialise();
+        return 0;
+    }
+
+    return _readbuf.read(buffer, count);
+}
+
 /*
    write one byte to the buffer
  */
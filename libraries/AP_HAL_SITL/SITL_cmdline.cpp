@@ -50,6 +50,7 @@ void SITL_State::_usage(void)
            "\t--console          use console instead of TCP ports\n"
            "\t--instance N       set instance of SITL (adds 10*instance to all port numbers)\n"
            "\t--speedup SPEEDUP  set simulation speedup\n"
+           "\t--lockstep         run as fast as possible, ignoring speedup\n"
            "\t--gimbal           enable simulated MAVLink gimbal\n"
            "\t--autotest-dir DIR set directory for additional files\n"
            "\t--uartA device     set device string for UARTA\n"
@@ -116,6 +117,7 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
     const char *model_str = nullptr;
     char *autotest_dir = nullptr;
     float speedup = 1.0f;
+    bool lockstep = false;
 
     if (asprintf(&autotest_dir, SKETCHBOOK "/Tools/autotest") <= 0) {
         AP_HAL::panic("out of memory");
@@ -148,7 +150,8 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
         CMDLINE_UARTF,
         CMDLINE_RTSCTS,
         CMDLINE_FGVIEW,
-        CMDLINE_DEFAULTS
+        CMDLINE_DEFAULTS,
+        CMDLINE_LOCKSTEP
     };
 
     const struct GetOptLong::option options[] = {
@@ -174,6 +177,7 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
         {"defaults",        true,   0, CMDLINE_DEFAULTS},
         {"rtscts",          false,  0, CMDLINE_RTSCTS},
         {"disable-fgview",  false,  0, CMDLINE_FGVIEW},
+        {"lockstep",        false,  0, CMDLINE_LOCKSTEP},
         {0, false, 0, 0}
     };
 
@@ -248,6 +252,9 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
         case CMDLINE_FGVIEW:
             _use_fg_view = false;
             break;
+        case CMDLINE_LOCKSTEP:
+            lockstep = true;
+            break;
         default:
             _usage();
             exit(1);
@@ -263,10 +270,15 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
         if (strncasecmp(model_constructors[i].name, model_str, strlen(model_constructors[i].name)) == 0) {
             sitl_model = model_constructors[i].constructor(home_str, model_str);
             sitl_model->set_speedup(speedup);
+            sitl_model->set_lockstep(lockstep);
             sitl_model->set_instance(_instance);
             sitl_model->set_autotest_dir(autotest_dir);
             _synthetic_clock_mode = true;
-            printf("Started model %s at %s at speed %.1f\n", model_str, home_str, speedup);
+            if (lockstep) {
+                printf("Started model %s at %s in lockstep\n", model_str, home_str);
+            } else {
+                printf("Started model %s at %s at speed %.1f\n", model_str, home_str, speedup);
+            }
             break;
         }
     }
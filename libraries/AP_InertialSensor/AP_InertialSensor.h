@@ -22,6 +22,7 @@
 #include <AP_HAL/AP_HAL.h>
 #include <AP_Math/AP_Math.h>
 #include <Filter/LowPassFilter2p.h>
+#include <Filter/BiquadFilterBank.h>
 #include <Filter/LowPassFilter.h>
 
 class AP_InertialSensor_Backend;
@@ -299,9 +300,10 @@ private:
     // time accumulator for delta velocity accumulator
     float _delta_velocity_acc_dt[INS_MAX_INSTANCES];
 
-    // Low Pass filters for gyro and accel
-    LowPassFilter2pVector3f _accel_filter[INS_MAX_INSTANCES];
-    LowPassFilter2pVector3f _gyro_filter[INS_MAX_INSTANCES];
+    // Low Pass filters for gyro and accel. The axes of each instance
+    // are three consecutive lanes starting at instance*3
+    BiquadFilterBank<INS_MAX_INSTANCES*3, 1> _accel_filter;
+    BiquadFilterBank<INS_MAX_INSTANCES*3, 1> _gyro_filter;
     Vector3f _accel_filtered[INS_MAX_INSTANCES];
     Vector3f _gyro_filtered[INS_MAX_INSTANCES];
     bool _new_accel_data[INS_MAX_INSTANCES];
@@ -105,9 +105,9 @@ void AP_InertialSensor_Backend::_notify_new_gyro_raw_sample(uint8_t instance,
         _imu._last_delta_angle[instance] = delta_angle;
         _imu._last_raw_gyro[instance] = gyro;
 
-        _imu._gyro_filtered[instance] = _imu._gyro_filter[instance].apply(gyro);
+        _imu._gyro_filtered[instance] = _imu._gyro_filter.apply(instance*3, gyro);
         if (_imu._gyro_filtered[instance].is_nan() || _imu._gyro_filtered[instance].is_inf()) {
-            _imu._gyro_filter[instance].reset();
+            _imu._gyro_filter.reset(instance*3, 3);
         }
         _imu._new_gyro_data[instance] = true;
         _sem->give();
@@ -188,9 +188,9 @@ void AP_InertialSensor_Backend::_notify_new_accel_raw_sample(uint8_t instance,
         _imu._delta_velocity_acc[instance] += accel * dt;
         _imu._delta_velocity_acc_dt[instance] += dt;
 
-        _imu._accel_filtered[instance] = _imu._accel_filter[instance].apply(accel);
+        _imu._accel_filtered[instance] = _imu._accel_filter.apply(instance*3, accel);
         if (_imu._accel_filtered[instance].is_nan() || _imu._accel_filtered[instance].is_inf()) {
-            _imu._accel_filter[instance].reset();
+            _imu._accel_filter.reset(instance*3, 3);
         }
 
         _imu.set_accel_peak_hold(instance, _imu._accel_filtered[instance]);
@@ -280,7 +280,7 @@ void AP_InertialSensor_Backend::update_gyro(uint8_t instance)
 
     // possibly update filter frequency
     if (_last_gyro_filter_hz[instance] != _gyro_filter_cutoff()) {
-        _imu._gyro_filter[instance].set_cutoff_frequency(_gyro_raw_sample_rate(instance), _gyro_filter_cutoff());
+        _imu._gyro_filter.set_lowpass(0, instance*3, 3, _gyro_raw_sample_rate(instance), _gyro_filter_cutoff());
         _last_gyro_filter_hz[instance] = _gyro_filter_cutoff();
     }
 
@@ -303,7 +303,7 @@ void AP_InertialSensor_Backend::update_accel(uint8_t instance)
     
     // possibly update filter frequency
     if (_last_accel_filter_hz[instance] != _accel_filter_cutoff()) {
-        _imu._accel_filter[instance].set_cutoff_frequency(_accel_raw_sample_rate(instance), _accel_filter_cutoff());
+        _imu._accel_filter.set_lowpass(0, instance*3, 3, _accel_raw_sample_rate(instance), _accel_filter_cutoff());
         _last_accel_filter_hz[instance] = _accel_filter_cutoff();
     }
 
@@ -0,0 +1,168 @@
+#include "AP_InertialSensor_FIFOBurst.h"
+
+#include <string.h>
+
+#include <AP_Math/AP_Math.h>
+
+extern const AP_HAL::HAL& hal;
+
+#define FIFO_BURST_READ_FLAG     0x80
+
+// the buffer holds the count segment (register plus two bytes) followed
+// by the data segment (register plus samples)
+#define FIFO_BURST_COUNT_OFS     0
+#define FIFO_BURST_COUNT_LEN     3
+#define FIFO_BURST_DATA_OFS      (FIFO_BURST_COUNT_OFS + FIFO_BURST_COUNT_LEN)
+
+// fraction of the nominal sample rate assumed when predicting
+// arrivals, covering the tolerance of the sensor's internal clock
+#define FIFO_BURST_RATE_NUM      15
+#define FIFO_BURST_RATE_DEN      16
+
+// maximum time samples may wait in the FIFO before being drained
+#define FIFO_BURST_MAX_LATENCY_US 500
+
+AP_InertialSensor_FIFOBurst::AP_InertialSensor_FIFOBurst(uint8_t count_reg, uint8_t data_reg,
+                                                         uint8_t sample_size, uint8_t max_samples)
+    : _count_reg(count_reg)
+    , _data_reg(data_reg)
+    , _sample_size(sample_size)
+    , _max_samples(max_samples)
+    , _dev(nullptr)
+    , _buffer(nullptr)
+    , _sample_rate_hz(0)
+    , _pending(0)
+    , _last_read_us(0)
+    , _stats{}
+    , _stats_start_us(0)
+    , _stats_transfers(0)
+    , _stats_samples(0)
+{
+}
+
+AP_InertialSensor_FIFOBurst::~AP_InertialSensor_FIFOBurst()
+{
+    if (_buffer != nullptr) {
+        hal.util->dma_free(_buffer, FIFO_BURST_DATA_OFS + 1 + _max_samples * _sample_size);
+    }
+}
+
+bool AP_InertialSensor_FIFOBurst::init(AP_HAL::Device *dev, uint16_t sample_rate_hz)
+{
+    if (dev == nullptr || dev->bus_type() != AP_HAL::Device::BUS_TYPE_SPI || sample_rate_hz == 0) {
+        return false;
+    }
+
+    uint8_t *buffer = (uint8_t *)hal.util->dma_allocate(FIFO_BURST_DATA_OFS + 1 + _max_samples * _sample_size);
+    if (buffer == nullptr) {
+        return false;
+    }
+
+    // a count only read tells us whether the HAL supports segments
+    AP_HAL::Device::TransferSegment seg { buffer, buffer, FIFO_BURST_COUNT_LEN, false };
+    memset(buffer, 0, FIFO_BURST_COUNT_LEN);
+    buffer[0] = _count_reg | FIFO_BURST_READ_FLAG;
+    if (!dev->transfer_segments(&seg, 1)) {
+        hal.util->dma_free(buffer, FIFO_BURST_DATA_OFS + 1 + _max_samples * _sample_size);
+        return false;
+    }
+
+    _dev = dev;
+    _buffer = buffer;
+    _sample_rate_hz = sample_rate_hz;
+    reset();
+    return true;
+}
+
+void AP_InertialSensor_FIFOBurst::reset()
+{
+    _pending = 0;
+    _last_read_us = 0;
+}
+
+uint8_t AP_InertialSensor_FIFOBurst::_predict_samples() const
+{
+    uint32_t expected = _pending;
+    if (_last_read_us != 0) {
+        // _last_read_us is taken after the previous count was read and
+        // this is called before the next, so the interval is never
+        // longer than the time the sensor had to add samples
+        const uint32_t dt = AP_HAL::micros() - _last_read_us;
+        expected += (uint64_t)dt * _sample_rate_hz * FIFO_BURST_RATE_NUM / (FIFO_BURST_RATE_DEN * 1000000ULL);
+    }
+    return MIN(expected, (uint32_t)_max_samples);
+}
+
+bool AP_InertialSensor_FIFOBurst::read(uint16_t &fifo_samples, uint8_t *&data, uint8_t &n_samples, bool &overread)
+{
+    n_samples = 0;
+    overread = false;
+
+    const uint8_t predicted = _predict_samples();
+
+    AP_HAL::Device::TransferSegment segs[2];
+    uint8_t nsegs = 0;
+
+    uint8_t *count_buf = &_buffer[FIFO_BURST_COUNT_OFS];
+    memset(count_buf, 0, FIFO_BURST_COUNT_LEN);
+    count_buf[0] = _count_reg | FIFO_BURST_READ_FLAG;
+    segs[nsegs++] = { count_buf, count_buf, FIFO_BURST_COUNT_LEN, true };
+
+    uint8_t *data_buf = &_buffer[FIFO_BURST_DATA_OFS];
+    if (predicted > 0) {
+        const uint32_t len = 1 + predicted * _sample_size;
+        memset(data_buf, 0, len);
+        data_buf[0] = _data_reg | FIFO_BURST_READ_FLAG;
+        segs[nsegs++] = { data_buf, data_buf, len, false };
+    }
+
+    if (!_dev->transfer_segments(segs, nsegs)) {
+        reset();
+        return false;
+    }
+    _last_read_us = AP_HAL::micros();
+
+    fifo_samples = (((uint16_t)count_buf[1] << 8) | count_buf[2]) / _sample_size;
+    data = &data_buf[1];
+
+    if (fifo_samples < predicted) {
+        // the data read went past the end of the FIFO and may have
+        // taken part of a sample which arrived during the transfer
+        n_samples = fifo_samples;
+        overread = true;
+        _stats.overreads++;
+        reset();
+    } else {
+        n_samples = predicted;
+        _pending = fifo_samples - predicted;
+    }
+
+    _update_stats(n_samples);
+    return true;
+}
+
+bool AP_InertialSensor_FIFOBurst::drain_needed() const
+{
+    return _pending > 0 &&
+        (uint32_t)_pending * 1000000UL > (uint32_t)_sample_rate_hz * FIFO_BURST_MAX_LATENCY_US;
+}
+
+void AP_InertialSensor_FIFOBurst::_update_stats(uint8_t n_samples)
+{
+    _stats_transfers++;
+    _stats_samples += n_samples;
+
+    const uint32_t now = AP_HAL::micros();
+    if (_stats_start_us == 0) {
+        _stats_start_us = now;
+        return;
+    }
+    const uint32_t dt = now - _stats_start_us;
+    if (dt >= 1000000UL) {
+        _stats.samples_per_transfer = (float)_stats_samples / _stats_transfers;
+        _stats.transfers_per_second = _stats_transfers * 1.0e6f / dt;
+        _stats_transfers = 0;
+        _stats_samples = 0;
+        _stats_start_us = now;
+    }
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <AP_HAL/AP_HAL.h>
+
+/*
+  Adaptive FIFO burst reads for InvenSense sensors on SPI.
+
+  Polling the FIFO normally takes one transfer to read FIFO_COUNT and
+  another to read the samples. Here both are done in one segmented
+  transfer: the count is read first, then a predicted number of samples
+  which is known to be in the FIFO from the samples left behind by the
+  last read plus those which must have arrived since. The prediction
+  is conservative so the data read never goes past what the count
+  reports; samples which arrive beyond the prediction are left for the
+  next read.
+
+  The caller can drain the remaining samples immediately when leaving
+  them would add too much latency, so at low sample rates this behaves
+  like the two transfer read, while at 8kHz most polls take a single
+  transfer.
+ */
+class AP_InertialSensor_FIFOBurst {
+public:
+    struct Stats {
+        // averaged over the last second
+        float samples_per_transfer;
+        float transfers_per_second;
+        // reads which returned fewer samples than predicted
+        uint32_t overreads;
+    };
+
+    AP_InertialSensor_FIFOBurst(uint8_t count_reg, uint8_t data_reg,
+                                uint8_t sample_size, uint8_t max_samples);
+    ~AP_InertialSensor_FIFOBurst();
+
+    /* Do not allow copies */
+    AP_InertialSensor_FIFOBurst(const AP_InertialSensor_FIFOBurst &other) = delete;
+    AP_InertialSensor_FIFOBurst &operator=(const AP_InertialSensor_FIFOBurst&) = delete;
+
+    /*
+      allocate the transfer buffer and check that the device supports
+      segmented transfers. Must be called with the bus semaphore held.
+      Returns false if burst reads can't be used, in which case the
+      driver should keep its normal FIFO read
+     */
+    bool init(AP_HAL::Device *dev, uint16_t sample_rate_hz);
+
+    bool enabled() const { return _buffer != nullptr; }
+
+    /*
+      read the FIFO count and the predicted samples in one transfer.
+      fifo_samples is the number of samples the FIFO held when the count
+      was read, and n_samples valid samples are returned in data.
+      If overread is set the FIFO is no longer aligned to a sample
+      boundary and must be reset. Returns false on a bus error
+     */
+    bool read(uint16_t &fifo_samples, uint8_t *&data, uint8_t &n_samples, bool &overread);
+
+    /*
+      true if the samples known to be left in the FIFO should be read
+      now rather than in the next poll
+     */
+    bool drain_needed() const;
+
+    // forget the FIFO level, called whenever the FIFO is reset
+    void reset();
+
+    const Stats &get_stats() const { return _stats; }
+
+private:
+    // samples which are certain to be in the FIFO
+    uint8_t _predict_samples() const;
+
+    void _update_stats(uint8_t n_samples);
+
+    const uint8_t _count_reg;
+    const uint8_t _data_reg;
+    const uint8_t _sample_size;
+    const uint8_t _max_samples;
+
+    AP_HAL::Device *_dev;
+    uint8_t *_buffer;
+    uint16_t _sample_rate_hz;
+
+    // samples left in the FIFO by the last read, and when it completed
+    uint16_t _pending;
+    uint32_t _last_read_us;
+
+    Stats _stats;
+    uint32_t _stats_start_us;
+    uint32_t _stats_transfers;
+    uint32_t _stats_samples;
+};
@@ -254,6 +254,7 @@ AP_InertialSensor_MPU6000::AP_InertialSensor_MPU6000(AP_InertialSensor &imu,
                                                      enum Rotation rotation)
     : AP_InertialSensor_Backend(imu)
     , _temp_filter(1000, 1)
+    , _burst(MPUREG_FIFO_COUNTH, MPUREG_FIFO_R_W, MPU_SAMPLE_SIZE, MPU_FIFO_BUFFER_LEN)
     , _dev(std::move(dev))
     , _rotation(rotation)
 {
@@ -333,6 +334,7 @@ void AP_InertialSensor_MPU6000::_fifo_reset()
     hal.scheduler->delay_microseconds(1);
     _dev->set_speed(AP_HAL::Device::SPEED_HIGH);
     _last_stat_user_ctrl = user_ctrl | BIT_USER_CTRL_FIFO_EN;
+    _burst.reset();
 }
 
 bool AP_InertialSensor_MPU6000::_has_auxiliary_bus()
@@ -408,6 +410,9 @@ void AP_InertialSensor_MPU6000::start()
     // now that we have initialised, we set the bus speed to high
     _dev->set_speed(AP_HAL::Device::SPEED_HIGH);
 
+    // read the FIFO count and samples in one transfer where the bus allows
+    _burst.init(_dev.get(), _fast_sampling ? 8000 : 1000);
+
     _dev->get_semaphore()->give();
 
     // setup sensor rotations from probe()
@@ -602,6 +607,40 @@ bool AP_InertialSensor_MPU6000::_accumulate_fast_sampling(uint8_t *samples, uint
     return ret;
 }
 
+/*
+  read the FIFO with segmented transfers, see AP_InertialSensor_FIFOBurst
+ */
+void AP_InertialSensor_MPU6000::_read_fifo_burst()
+{
+    do {
+        uint16_t fifo_samples;
+        uint8_t *rx;
+        uint8_t n;
+        bool overread;
+
+        if (!_burst.read(fifo_samples, rx, n, overread)) {
+            return;
+        }
+
+        if (n > 0) {
+            bool ok = _fast_sampling ? _accumulate_fast_sampling(rx, n) : _accumulate(rx, n);
+            if (!ok) {
+                // the FIFO has already been reset
+                return;
+            }
+        }
+
+        /*
+          an overread has lost sample alignment, and as with the
+          normal read anything past the first 32 samples may be corrupt
+         */
+        if (overread || fifo_samples > 32) {
+            _fifo_reset();
+            return;
+        }
+    } while (_burst.drain_needed());
+}
+
 void AP_InertialSensor_MPU6000::_read_fifo()
 {
     uint8_t n_samples;
@@ -609,6 +648,11 @@ void AP_InertialSensor_MPU6000::_read_fifo()
     uint8_t *rx = _fifo_buffer;
     bool need_reset = false;
 
+    if (_burst.enabled()) {
+        _read_fifo_burst();
+        goto check_registers;
+    }
+
     if (!_block_read(MPUREG_FIFO_COUNTH, rx, 2)) {
         goto check_registers;
     }
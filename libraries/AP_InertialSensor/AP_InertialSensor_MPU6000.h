@@ -13,6 +13,7 @@
 
 #include "AP_InertialSensor.h"
 #include "AP_InertialSensor_Backend.h"
+#include "AP_InertialSensor_FIFOBurst.h"
 #include "AuxiliaryBus.h"
 
 class AP_MPU6000_AuxiliaryBus;
@@ -47,6 +48,14 @@ public:
      */
     AuxiliaryBus *get_auxiliary_bus() override;
 
+    /*
+     * Transfer counters for FIFO burst reads, all zero if the bus doesn't
+     * support them. On Linux each transfer is one SPI_IOC_MESSAGE ioctl
+     */
+    const AP_InertialSensor_FIFOBurst::Stats &get_fifo_stats() const {
+        return _burst.get_stats();
+    }
+
     void start() override;
 
 private:
@@ -81,6 +90,9 @@ private:
     bool _accumulate(uint8_t *samples, uint8_t n_samples);
     bool _accumulate_fast_sampling(uint8_t *samples, uint8_t n_samples);
 
+    /* Read samples from FIFO with segmented transfers */
+    void _read_fifo_burst();
+
     bool _check_raw_temp(int16_t t2);
 
     int16_t _raw_temp;
@@ -95,6 +107,9 @@ private:
     float _accel_scale;
     LowPassFilter2pFloat _temp_filter;
 
+    // FIFO reads coalescing the count and samples into one transfer
+    AP_InertialSensor_FIFOBurst _burst;
+
     enum Rotation _rotation;
 
     AP_HAL::DigitalSource *_drdy_pin;
@@ -213,6 +213,7 @@ AP_InertialSensor_MPU9250::AP_InertialSensor_MPU9250(AP_InertialSensor &imu,
                                                      enum Rotation rotation)
     : AP_InertialSensor_Backend(imu)
     , _temp_filter(1000, 1)
+    , _burst(MPUREG_FIFO_COUNTH, MPUREG_FIFO_R_W, MPU_SAMPLE_SIZE, MPU_FIFO_BUFFER_LEN)
     , _rotation(rotation)
     , _dev(std::move(dev))
 {
@@ -286,6 +287,7 @@ void AP_InertialSensor_MPU9250::_fifo_reset()
     hal.scheduler->delay_microseconds(1);
     _dev->set_speed(AP_HAL::Device::SPEED_HIGH);
     _last_stat_user_ctrl = user_ctrl | BIT_USER_CTRL_FIFO_EN;
+    _burst.reset();
 }
 
 bool AP_InertialSensor_MPU9250::_has_auxiliary_bus()
@@ -356,6 +358,11 @@ void AP_InertialSensor_MPU9250::start()
     // now that we have initialised, we set the bus speed to high
     _dev->set_speed(AP_HAL::Device::SPEED_HIGH);
 
+    // read the FIFO count and samples in one transfer where the bus allows
+    if (_burst.init(_dev.get(), _fast_sampling ? 8000 : 1000)) {
+        hal.console->printf("MPU9250: using FIFO burst reads\n");
+    }
+
     _dev->get_semaphore()->give();
 
     set_gyro_orientation(_gyro_instance, _rotation);
@@ -552,6 +559,41 @@ bool AP_InertialSensor_MPU9250::_check_raw_temp(int16_t t2)
 }
 
 
+/*
+  read the FIFO with segmented transfers, see AP_InertialSensor_FIFOBurst
+ */
+void AP_InertialSensor_MPU9250::_read_fifo_burst()
+{
+    do {
+        uint16_t fifo_samples;
+        uint8_t *rx;
+        uint8_t n;
+        bool overread;
+
+        if (!_burst.read(fifo_samples, rx, n, overread)) {
+            return;
+        }
+
+        if (n > 0) {
+            bool ok = _fast_sampling ? _accumulate_fast_sampling(rx, n) : _accumulate(rx, n);
+            if (!ok) {
+                // the FIFO has already been reset
+                return;
+            }
+        }
+
+        /*
+          an overread has lost sample alignment, and as with the
+          normal read anything past the first 32 samples may be corrupt
+         */
+        if (overread || fifo_samples > 32) {
+            _fifo_reset();
+            return;
+        }
+    } while (_burst.drain_needed());
+}
+
+
 /*
  * read from the data registers and update filtered data
  */
@@ -561,6 +603,11 @@ bool AP_InertialSensor_MPU9250::_read_sample()
     uint16_t bytes_read;
     uint8_t *rx = _fifo_buffer;
     bool need_reset = false;
+
+    if (_burst.enabled()) {
+        _read_fifo_burst();
+        goto check_registers;
+    }
     
     if (!_block_read(MPUREG_FIFO_COUNTH, rx, 2)) {
         goto check_registers;
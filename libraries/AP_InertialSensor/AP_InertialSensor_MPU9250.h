@@ -10,6 +10,7 @@
 #include <Filter/LowPassFilter2p.h>
 
 #include "AP_InertialSensor_Backend.h"
+#include "AP_InertialSensor_FIFOBurst.h"
 #include "AP_InertialSensor.h"
 #include "AuxiliaryBus.h"
 
@@ -45,6 +46,14 @@ public:
      */
     AuxiliaryBus *get_auxiliary_bus() override;
 
+    /*
+     * Transfer counters for FIFO burst reads, all zero if the bus doesn't
+     * support them. On Linux each transfer is one SPI_IOC_MESSAGE ioctl
+     */
+    const AP_InertialSensor_FIFOBurst::Stats &get_fifo_stats() const {
+        return _burst.get_stats();
+    }
+
     void start() override;
 
 private:
@@ -76,6 +85,9 @@ private:
     bool _accumulate(uint8_t *samples, uint8_t n_samples);
     bool _accumulate_fast_sampling(uint8_t *samples, uint8_t n_samples);
 
+    /* Read samples from FIFO with segmented transfers */
+    void _read_fifo_burst();
+
     bool _check_raw_temp(int16_t t2);
     
     // instance numbers of accel and gyro data
@@ -84,6 +96,9 @@ private:
 
     float _temp_filtered;
     LowPassFilter2pFloat _temp_filter;
+
+    // FIFO reads coalescing the count and samples into one transfer
+    AP_InertialSensor_FIFOBurst _burst;
     
     AP_HAL::OwnPtr<AP_HAL::Device> _dev;
     AP_MPU9250_AuxiliaryBus *_auxiliary_bus;
@@ -0,0 +1,217 @@
+#include <AP_gtest.h>
+
+#include <string.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_InertialSensor/AP_InertialSensor_FIFOBurst.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+#define COUNT_REG    0x72
+#define DATA_REG     0x74
+#define SAMPLE_SIZE  14
+#define MAX_SAMPLES  24
+
+/*
+ * An InvenSense style FIFO filling at rate_hz from when it is
+ * created. The first byte of each sample holds its sequence number.
+ * Like the HAL devices it must be allocated with new, which zeroes
+ * the Device members
+ */
+class MockFIFODevice : public AP_HAL::Device {
+public:
+    MockFIFODevice(enum BusType type, uint16_t rate_hz)
+        : AP_HAL::Device(type)
+        , _rate_hz(rate_hz)
+        , _start_us(AP_HAL::micros())
+        , _consumed(0)
+    {
+    }
+
+    bool set_speed(Speed speed) override { return true; }
+
+    bool transfer(const uint8_t *send, uint32_t send_len,
+                  uint8_t *recv, uint32_t recv_len) override
+    {
+        return false;
+    }
+
+    bool transfer_segments(const TransferSegment *segments, uint8_t count) override
+    {
+        if (!segments_supported) {
+            return false;
+        }
+        transfers++;
+        last_data_len = 0;
+        for (uint8_t i = 0; i < count; i++) {
+            const TransferSegment &seg = segments[i];
+            EXPECT_EQ(seg.send, seg.recv);
+            const uint8_t reg = seg.send[0] & 0x7F;
+            if (reg == COUNT_REG) {
+                EXPECT_EQ(3U, seg.len);
+                const uint16_t bytes = available() * SAMPLE_SIZE;
+                seg.recv[1] = bytes >> 8;
+                seg.recv[2] = bytes & 0xFF;
+            } else if (reg == DATA_REG) {
+                last_data_len = seg.len;
+                const uint32_t n = (seg.len - 1) / SAMPLE_SIZE;
+                for (uint32_t s = 0; s < n; s++) {
+                    // reading past the end of the FIFO gives zeros
+                    seg.recv[1 + s * SAMPLE_SIZE] = s < available() ? (uint8_t)(_consumed + s) : 0;
+                }
+                _consumed += MIN(n, available());
+            } else {
+                ADD_FAILURE() << "unexpected register " << (int)reg;
+            }
+        }
+        return true;
+    }
+
+    AP_HAL::Semaphore *get_semaphore() override { return nullptr; }
+
+    PeriodicHandle register_periodic_callback(uint32_t period_usec, PeriodicCb) override
+    {
+        return nullptr;
+    }
+
+    bool adjust_periodic_callback(PeriodicHandle h, uint32_t period_usec) override
+    {
+        return false;
+    }
+
+    // samples in the FIFO now
+    uint32_t available() const
+    {
+        const uint64_t arrived = (uint64_t)(AP_HAL::micros() - _start_us) * _rate_hz / 1000000ULL;
+        return MIN(arrived - _consumed, (uint64_t)MAX_SAMPLES);
+    }
+
+    uint32_t consumed() const { return _consumed; }
+
+    bool segments_supported = true;
+    uint32_t transfers = 0;
+    uint32_t last_data_len = 0;
+
+private:
+    const uint16_t _rate_hz;
+    const uint32_t _start_us;
+    uint64_t _consumed;
+};
+
+TEST(FIFOBurst, InitNeedsSegmentedSPI)
+{
+    AP_InertialSensor_FIFOBurst burst(COUNT_REG, DATA_REG, SAMPLE_SIZE, MAX_SAMPLES);
+
+    EXPECT_FALSE(burst.init(nullptr, 1000));
+
+    MockFIFODevice *i2c = new MockFIFODevice(AP_HAL::Device::BUS_TYPE_I2C, 1000);
+    EXPECT_FALSE(burst.init(i2c, 1000));
+    delete i2c;
+
+    MockFIFODevice *spi = new MockFIFODevice(AP_HAL::Device::BUS_TYPE_SPI, 1000);
+    spi->segments_supported = false;
+    EXPECT_FALSE(burst.init(spi, 1000));
+    EXPECT_FALSE(burst.enabled());
+
+    spi->segments_supported = true;
+    EXPECT_TRUE(burst.init(spi, 1000));
+    EXPECT_TRUE(burst.enabled());
+    delete spi;
+}
+
+TEST(FIFOBurst, PredictsPendingSamples)
+{
+    MockFIFODevice *dev = new MockFIFODevice(AP_HAL::Device::BUS_TYPE_SPI, 1000);
+    AP_InertialSensor_FIFOBurst burst(COUNT_REG, DATA_REG, SAMPLE_SIZE, MAX_SAMPLES);
+    hal.scheduler->delay_microseconds(5000);
+    ASSERT_TRUE(burst.init(dev, 1000));
+
+    uint16_t fifo_samples;
+    uint8_t *data;
+    uint8_t n_samples;
+    bool overread;
+
+    // nothing is known about the FIFO yet, so only the count is read
+    ASSERT_TRUE(burst.read(fifo_samples, data, n_samples, overread));
+    EXPECT_FALSE(overread);
+    EXPECT_EQ(0, n_samples);
+    EXPECT_EQ(0U, dev->last_data_len);
+    EXPECT_GE(fifo_samples, 4);
+
+    // the samples seen by the count read are fetched by the next read,
+    // along with any which have certainly arrived since
+    ASSERT_TRUE(burst.read(fifo_samples, data, n_samples, overread));
+    EXPECT_FALSE(overread);
+    EXPECT_GE(n_samples, 4);
+    EXPECT_LE(n_samples, fifo_samples);
+    EXPECT_EQ(1U + n_samples * SAMPLE_SIZE, dev->last_data_len);
+    for (uint8_t i = 0; i < n_samples; i++) {
+        EXPECT_EQ(i, data[i * SAMPLE_SIZE]);
+    }
+    delete dev;
+}
+
+TEST(FIFOBurst, NeverOverreadsAtNominalRate)
+{
+    MockFIFODevice *dev = new MockFIFODevice(AP_HAL::Device::BUS_TYPE_SPI, 1000);
+    AP_InertialSensor_FIFOBurst burst(COUNT_REG, DATA_REG, SAMPLE_SIZE, MAX_SAMPLES);
+    ASSERT_TRUE(burst.init(dev, 1000));
+
+    uint16_t fifo_samples;
+    uint8_t *data;
+    uint8_t n_samples;
+    bool overread;
+    uint32_t received = 0;
+
+    for (uint16_t i = 0; i < 200; i++) {
+        hal.scheduler->delay_microseconds(500 + (i * 397) % 3000);
+        ASSERT_TRUE(burst.read(fifo_samples, data, n_samples, overread));
+        ASSERT_FALSE(overread);
+        for (uint8_t s = 0; s < n_samples; s++) {
+            ASSERT_EQ((uint8_t)(received + s), data[s * SAMPLE_SIZE]);
+        }
+        received += n_samples;
+    }
+
+    EXPECT_EQ(0U, burst.get_stats().overreads);
+    EXPECT_EQ(dev->consumed(), received);
+    // the reads kept up with the FIFO rather than only reading counts
+    EXPECT_GT(received, 200U);
+    delete dev;
+}
+
+TEST(FIFOBurst, OverreadResetsPrediction)
+{
+    // a sensor clock far slower than nominal makes the prediction
+    // run ahead of the FIFO
+    MockFIFODevice *dev = new MockFIFODevice(AP_HAL::Device::BUS_TYPE_SPI, 250);
+    AP_InertialSensor_FIFOBurst burst(COUNT_REG, DATA_REG, SAMPLE_SIZE, MAX_SAMPLES);
+    ASSERT_TRUE(burst.init(dev, 1000));
+
+    uint16_t fifo_samples;
+    uint8_t *data;
+    uint8_t n_samples;
+    bool overread = false;
+
+    ASSERT_TRUE(burst.read(fifo_samples, data, n_samples, overread));
+    for (uint8_t i = 0; i < 10 && !overread; i++) {
+        hal.scheduler->delay_microseconds(10000);
+        ASSERT_TRUE(burst.read(fifo_samples, data, n_samples, overread));
+    }
+    ASSERT_TRUE(overread);
+
+    // only the samples the count saw are returned
+    EXPECT_EQ(fifo_samples, n_samples);
+    EXPECT_EQ(1U, burst.get_stats().overreads);
+    EXPECT_FALSE(burst.drain_needed());
+
+    // after the FIFO is reset the next read only fetches the count
+    ASSERT_TRUE(burst.read(fifo_samples, data, n_samples, overread));
+    EXPECT_FALSE(overread);
+    EXPECT_EQ(0, n_samples);
+    EXPECT_EQ(0U, dev->last_data_len);
+    delete dev;
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,339 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdlib.h>
+
+#include "AP_PolygonGrid.h"
+
+/*
+  build the grid over a polygon
+ */
+bool AP_PolygonGrid::build(const Vector2f *points, uint16_t num_points)
+{
+    clear();
+
+    if (points == nullptr || num_points < 3 || num_points > AP_POLYGON_GRID_MAX_POINTS) {
+        return false;
+    }
+
+    Vector2f pmin = points[0];
+    Vector2f pmax = points[0];
+    for (uint16_t i = 1; i < num_points; i++) {
+        if (points[i].is_nan() || points[i].is_inf()) {
+            return false;
+        }
+        pmin.x = MIN(pmin.x, points[i].x);
+        pmin.y = MIN(pmin.y, points[i].y);
+        pmax.x = MAX(pmax.x, points[i].x);
+        pmax.y = MAX(pmax.y, points[i].y);
+    }
+    if (points[0].is_nan() || points[0].is_inf()) {
+        return false;
+    }
+
+    // pad the bounding box so anything above, below or right of the
+    // grid is well clear of every edge and can be reported as outside
+    // directly
+    _origin = pmin - Vector2f(2 * AP_POLYGON_GRID_MARGIN, 2 * AP_POLYGON_GRID_MARGIN);
+    const float width = (pmax.x - pmin.x) + 4 * AP_POLYGON_GRID_MARGIN;
+    const float height = (pmax.y - pmin.y) + 4 * AP_POLYGON_GRID_MARGIN;
+
+    // aim for a few cells per edge with roughly square cells
+    const uint16_t target_cells = constrain_int16(num_points * 4, 16, AP_POLYGON_GRID_MAX_CELLS);
+    _cell_size = sqrtf(width * height / target_cells);
+    _cell_size = MAX(_cell_size, MAX(width, height) / AP_POLYGON_GRID_MAX_DIM);
+    while (true) {
+        _cells_x = constrain_int16(ceilf(width / _cell_size), 1, AP_POLYGON_GRID_MAX_DIM);
+        _cells_y = constrain_int16(ceilf(height / _cell_size), 1, AP_POLYGON_GRID_MAX_DIM);
+        if (_cells_x * _cells_y <= AP_POLYGON_GRID_MAX_CELLS &&
+            _cells_x * _cell_size >= width &&
+            _cells_y * _cell_size >= height) {
+            break;
+        }
+        _cell_size *= 1.05f;
+    }
+    const uint16_t num_cells = _cells_x * _cells_y;
+
+    _points = points;
+    _num_points = num_points;
+
+    _cell_state = (uint8_t *)calloc(num_cells, sizeof(uint8_t));
+    _cell_start = (uint16_t *)calloc(num_cells + 1, sizeof(uint16_t));
+    _row_start = (uint16_t *)calloc(_cells_y + 1, sizeof(uint16_t));
+    if (_cell_state == nullptr || _cell_start == nullptr || _row_start == nullptr) {
+        clear();
+        return false;
+    }
+
+    // count the entries in each list, then sum the counts into start
+    // offsets
+    add_edges(false);
+    uint32_t total = 0;
+    for (uint16_t c = 0; c <= num_cells; c++) {
+        total += _cell_start[c];
+        _cell_start[c] = total;
+        if (total > UINT16_MAX) {
+            clear();
+            return false;
+        }
+    }
+    _cell_edges = (uint8_t *)calloc(MAX(total, 1U), sizeof(uint8_t));
+    total = 0;
+    for (uint8_t r = 0; r <= _cells_y; r++) {
+        total += _row_start[r];
+        _row_start[r] = total;
+        if (total > UINT16_MAX) {
+            clear();
+            return false;
+        }
+    }
+    _row_edges = (uint8_t *)calloc(MAX(total, 1U), sizeof(uint8_t));
+    if (_cell_edges == nullptr || _row_edges == nullptr) {
+        clear();
+        return false;
+    }
+
+    add_edges(true);
+
+    // cells with no edges nearby are entirely inside or outside, so
+    // their centre decides them
+    for (uint8_t cy = 0; cy < _cells_y; cy++) {
+        for (uint8_t cx = 0; cx < _cells_x; cx++) {
+            const uint16_t c = cy * _cells_x + cx;
+            if (_cell_start[c + 1] != _cell_start[c]) {
+                _cell_state[c] = CELL_BOUNDARY;
+                continue;
+            }
+            const Vector2f centre = _origin + Vector2f((cx + 0.5f) * _cell_size, (cy + 0.5f) * _cell_size);
+            _cell_state[c] = row_outside(centre, cy) ? CELL_OUTSIDE : CELL_INSIDE;
+        }
+    }
+
+    return true;
+}
+
+/*
+  free the grid
+ */
+void AP_PolygonGrid::clear()
+{
+    free(_cell_state);
+    free(_cell_start);
+    free(_cell_edges);
+    free(_row_start);
+    free(_row_edges);
+    _cell_state = nullptr;
+    _cell_start = nullptr;
+    _cell_edges = nullptr;
+    _row_start = nullptr;
+    _row_edges = nullptr;
+    _points = nullptr;
+    _num_points = 0;
+}
+
+/*
+  range of cells along one axis covering [low, high]. Returns false
+  if the range misses the grid
+ */
+bool AP_PolygonGrid::cell_range(float low, float high, float origin, uint8_t count, uint8_t &first, uint8_t &last) const
+{
+    const float a = (low - origin) / _cell_size;
+    const float b = (high - origin) / _cell_size;
+    if (!(a < count) || !(b >= 0)) {
+        return false;
+    }
+    first = a < 0 ? 0 : (uint8_t)a;
+    last = b >= count ? count - 1 : MIN((uint8_t)b, (uint8_t)(count - 1));
+    return first <= last;
+}
+
+/*
+  Polygon_crosses() truncates its differences to integers, so a point
+  can be counted on the wrong side of an edge when it is close to it.
+  That error is at most a few units in x plus 4*|dx|/|dy|, and never
+  leaves the edge's x range padded by a few units. Edges with |dy| < 1
+  truncate dy to zero, which can miscount any point to their left.
+  A cell that none of these regions touches has the same answer
+  everywhere within it.
+ */
+bool AP_PolygonGrid::edge_in_cell(uint8_t edge, uint8_t cx, uint8_t cy) const
+{
+    const Vector2f &a = _points[edge == 0 ? _num_points - 1 : edge - 1];
+    const Vector2f &b = _points[edge];
+
+    const float y0 = _origin.y + cy * _cell_size;
+    const float y1 = y0 + _cell_size;
+    const float ymin = MIN(a.y, b.y);
+    const float ymax = MAX(a.y, b.y);
+    float lo = MAX(y0, ymin - AP_POLYGON_GRID_MARGIN);
+    float hi = MIN(y1, ymax + AP_POLYGON_GRID_MARGIN);
+    if (lo > hi) {
+        return false;
+    }
+
+    float xlo = MIN(a.x, b.x) - AP_POLYGON_GRID_MARGIN;
+    float xhi = MAX(a.x, b.x) + AP_POLYGON_GRID_MARGIN;
+    const float dx = fabsf(b.x - a.x);
+    const float dy = ymax - ymin;
+    if (dy >= 1) {
+        // narrow to the part of the edge spanning this cell
+        lo = constrain_float(lo, ymin, ymax);
+        hi = constrain_float(hi, ymin, ymax);
+        const float xa = a.x + (b.x - a.x) * (lo - a.y) / (b.y - a.y);
+        const float xb = a.x + (b.x - a.x) * (hi - a.y) / (b.y - a.y);
+        const float pad = 4 * dx / dy + AP_POLYGON_GRID_MARGIN;
+        xlo = MAX(xlo, MIN(xa, xb) - pad);
+        xhi = MIN(xhi, MAX(xa, xb) + pad);
+    } else {
+        xlo = _origin.x;
+    }
+
+    const float x0 = _origin.x + cx * _cell_size;
+    const float x1 = x0 + _cell_size;
+    return xlo <= x1 && xhi >= x0;
+}
+
+/*
+  add every edge to the cells it touches and the rows it spans. With
+  fill false the entries are only counted, into the slot after their
+  list so the counts can be turned into start offsets in place
+ */
+void AP_PolygonGrid::add_edges(bool fill)
+{
+    for (uint16_t e = 0; e < _num_points; e++) {
+        const Vector2f &a = _points[e == 0 ? _num_points - 1 : e - 1];
+        const Vector2f &b = _points[e];
+
+        uint8_t x0, x1, y0, y1;
+        if (!cell_range(MIN(a.y, b.y) - AP_POLYGON_GRID_MARGIN, MAX(a.y, b.y) + AP_POLYGON_GRID_MARGIN,
+                        _origin.y, _cells_y, y0, y1)) {
+            continue;
+        }
+        for (uint8_t cy = y0; cy <= y1; cy++) {
+            if (fill) {
+                _row_edges[_row_start[cy]++] = e;
+            } else {
+                _row_start[cy + 1]++;
+            }
+        }
+
+        const float xlo = fabsf(b.y - a.y) < 1 ? _origin.x : MIN(a.x, b.x) - AP_POLYGON_GRID_MARGIN;
+        if (!cell_range(xlo, MAX(a.x, b.x) + AP_POLYGON_GRID_MARGIN, _origin.x, _cells_x, x0, x1)) {
+            continue;
+        }
+        for (uint8_t cy = y0; cy <= y1; cy++) {
+            for (uint8_t cx = x0; cx <= x1; cx++) {
+                if (!edge_in_cell(e, cx, cy)) {
+                    continue;
+                }
+                const uint16_t c = cy * _cells_x + cx;
+                if (fill) {
+                    _cell_edges[_cell_start[c]++] = e;
+                } else {
+                    _cell_start[c + 1]++;
+                }
+            }
+        }
+    }
+
+    if (fill) {
+        // filling advanced each start to the start of the next list
+        const uint16_t num_cells = _cells_x * _cells_y;
+        for (uint16_t c = num_cells; c > 0; c--) {
+            _cell_start[c] = _cell_start[c - 1];
+        }
+        _cell_start[0] = 0;
+        for (uint8_t r = _cells_y; r > 0; r--) {
+            _row_start[r] = _row_start[r - 1];
+        }
+        _row_start[0] = 0;
+    }
+}
+
+/*
+  test for a point in the polygon
+ */
+bool AP_PolygonGrid::outside(const Vector2f &P) const
+{
+    if (!valid()) {
+        return true;
+    }
+
+    const float x = (P.x - _origin.x) / _cell_size;
+    const float y = (P.y - _origin.y) / _cell_size;
+    if (isnan(x) || !(y >= 0 && x < _cells_x && y < _cells_y)) {
+        return true;
+    }
+    // edges with |dy| < 1 can affect points anywhere to their left, so
+    // points left of the grid take the state of the first column
+    const uint8_t cx = x < 0 ? 0 : MIN((uint8_t)x, (uint8_t)(_cells_x - 1));
+    const uint8_t cy = MIN((uint8_t)y, (uint8_t)(_cells_y - 1));
+
+    switch (_cell_state[cy * _cells_x + cx]) {
+    case CELL_INSIDE:
+        return false;
+    case CELL_OUTSIDE:
+        return true;
+    default:
+        break;
+    }
+
+    return row_outside(P, cy);
+}
+
+/*
+  test a point in row cy against the edges spanning that row. Only
+  those edges can cross a ray from P
+ */
+bool AP_PolygonGrid::row_outside(const Vector2f &P, uint8_t cy) const
+{
+    bool outside = true;
+    for (uint16_t k = _row_start[cy]; k < _row_start[cy + 1]; k++) {
+        const uint8_t e = _row_edges[k];
+        const Vector2f &Vj = _points[e == 0 ? _num_points - 1 : e - 1];
+        if (Polygon_crosses(P, _points[e], Vj)) {
+            outside = !outside;
+        }
+    }
+    return outside;
+}
+
+/*
+  find the edges which could be within radius of P
+ */
+bool AP_PolygonGrid::edges_near(const Vector2f &P, float radius, EdgeSet &edges) const
+{
+    edges.clear();
+    if (!valid() || P.is_nan() || P.is_inf() || !isfinite(radius)) {
+        return false;
+    }
+
+    // every edge lies within the grid, so a window missing it has no edges
+    radius = fabsf(radius) + AP_POLYGON_GRID_MARGIN;
+    uint8_t x0, x1, y0, y1;
+    if (!cell_range(P.x - radius, P.x + radius, _origin.x, _cells_x, x0, x1) ||
+        !cell_range(P.y - radius, P.y + radius, _origin.y, _cells_y, y0, y1)) {
+        return true;
+    }
+
+    for (uint8_t cy = y0; cy <= y1; cy++) {
+        for (uint8_t cx = x0; cx <= x1; cx++) {
+            const uint16_t c = cy * _cells_x + cx;
+            for (uint16_t k = _cell_start[c]; k < _cell_start[c + 1]; k++) {
+                edges.set(_cell_edges[k]);
+            }
+        }
+    }
+    return true;
+}
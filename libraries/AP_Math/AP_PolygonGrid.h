@@ -0,0 +1,117 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "AP_Math.h"
+
+#define AP_POLYGON_GRID_MAX_POINTS  256     // edges are stored as uint8_t indexes
+#define AP_POLYGON_GRID_MAX_DIM     64      // maximum number of cells along each axis
+#define AP_POLYGON_GRID_MAX_CELLS   1024    // maximum total number of cells
+#define AP_POLYGON_GRID_MARGIN      3.0f    // cell padding covering Polygon_crosses() integer truncation
+
+/*
+ * AP_PolygonGrid is a uniform grid laid over a polygon to make
+ * point-in-polygon and nearby edge queries sublinear in the number of
+ * vertices.
+ *
+ * Each cell is classified when the grid is built as inside, outside or
+ * boundary. Inside and outside cells answer outside() directly. For
+ * boundary cells only the edges spanning the cell's row are tested,
+ * using the same Polygon_crosses() step as Polygon_outside(), so the
+ * result is identical to a full scan.
+ *
+ * Edge i runs from V[i-1] to V[i], with edge 0 closing the polygon from
+ * V[n-1] to V[0]. The grid keeps a pointer to the points, so it must be
+ * rebuilt (or cleared) whenever they change.
+ */
+class AP_PolygonGrid
+{
+public:
+    // set of edge indexes returned by edges_near()
+    class EdgeSet {
+    public:
+        void clear() { memset(_bits, 0, sizeof(_bits)); }
+        void set(uint8_t edge) { _bits[edge / 32] |= (1U << (edge % 32)); }
+        bool get(uint8_t edge) const { return (_bits[edge / 32] & (1U << (edge % 32))) != 0; }
+    private:
+        uint32_t _bits[AP_POLYGON_GRID_MAX_POINTS / 32];
+    };
+
+    AP_PolygonGrid() {}
+    ~AP_PolygonGrid() { clear(); }
+
+    /* Do not allow copies */
+    AP_PolygonGrid(const AP_PolygonGrid &other) = delete;
+    AP_PolygonGrid &operator=(const AP_PolygonGrid&) = delete;
+
+    // build the grid over num_points vertices. Returns false if the
+    // polygon is too large or memory could not be allocated, in which
+    // case callers should fall back to Polygon_outside()
+    bool build(const Vector2f *points, uint16_t num_points);
+
+    // free the grid
+    void clear();
+
+    // true if the grid has been built
+    bool valid() const { return _cell_state != nullptr; }
+
+    // points and count the grid was built over
+    const Vector2f *points() const { return _points; }
+    uint16_t num_points() const { return _num_points; }
+
+    // returns the same result as Polygon_outside(P, points, num_points)
+    bool outside(const Vector2f &P) const;
+
+    // fill edges with every edge which could be within radius of P.
+    // The set may contain more distant edges too. Returns false if
+    // the query could not be answered
+    bool edges_near(const Vector2f &P, float radius, EdgeSet &edges) const;
+
+private:
+    enum CellState : uint8_t {
+        CELL_OUTSIDE = 0,
+        CELL_INSIDE,
+        CELL_BOUNDARY
+    };
+
+    // true if edge could affect Polygon_crosses() for a point in the cell
+    bool edge_in_cell(uint8_t edge, uint8_t cx, uint8_t cy) const;
+
+    // range of cells along one axis covering [low, high]
+    bool cell_range(float low, float high, float origin, uint8_t count, uint8_t &first, uint8_t &last) const;
+
+    // fill the cell and row edge lists. With fill false only count entries
+    void add_edges(bool fill);
+
+    // Polygon_outside() using only the edges spanning row cy
+    bool row_outside(const Vector2f &P, uint8_t cy) const;
+
+    const Vector2f *_points = nullptr;
+    uint16_t _num_points = 0;
+
+    Vector2f _origin;
+    float _cell_size;
+    uint8_t _cells_x;
+    uint8_t _cells_y;
+
+    // per cell state, plus edges touching each boundary cell
+    uint8_t *_cell_state = nullptr;
+    uint16_t *_cell_start = nullptr;
+    uint8_t *_cell_edges = nullptr;
+
+    // edges spanning each row of cells
+    uint16_t *_row_start = nullptr;
+    uint8_t *_row_edges = nullptr;
+};
@@ -0,0 +1,113 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/AP_PolygonGrid.h>
+
+#define TEST_POINTS 1024
+
+/*
+ * A fence shaped like a survey area: a 2km x 1km rectangle in cm with
+ * wobbly sides, closed by repeating the first point
+ */
+static uint16_t survey_fence(Vector2f *points, uint16_t num_points)
+{
+    const uint16_t n = num_points - 1;
+    for (uint16_t i = 0; i < n; i++) {
+        const float t = 4.0f * i / n;
+        const float wobble = 500 * sinf(i * 1.7f);
+        if (t < 1) {
+            points[i] = Vector2f(200000 * t, wobble);
+        } else if (t < 2) {
+            points[i] = Vector2f(200000 + wobble, 100000 * (t - 1));
+        } else if (t < 3) {
+            points[i] = Vector2f(200000 * (3 - t), 100000 + wobble);
+        } else {
+            points[i] = Vector2f(wobble, 100000 * (4 - t));
+        }
+    }
+    points[n] = points[0];
+    return num_points;
+}
+
+// positions spread over the fence and a margin around it
+static void test_points(Vector2f *points)
+{
+    uint32_t state = 1;
+    for (uint16_t i = 0; i < TEST_POINTS; i++) {
+        state = state * 1103515245U + 12345U;
+        const float x = -20000 + 240000 * ((state >> 8) & 0xFFFF) / 65535.0f;
+        state = state * 1103515245U + 12345U;
+        const float y = -20000 + 140000 * ((state >> 8) & 0xFFFF) / 65535.0f;
+        points[i] = Vector2f(x, y);
+    }
+}
+
+static void BM_PolygonOutside(benchmark::State& state)
+{
+    Vector2f fence[AP_POLYGON_GRID_MAX_POINTS];
+    Vector2f positions[TEST_POINTS];
+    const uint16_t num_points = survey_fence(fence, state.range_x());
+    test_points(positions);
+    uint16_t i = 0;
+
+    while (state.KeepRunning()) {
+        bool outside = Polygon_outside(positions[i++ % TEST_POINTS], fence, num_points);
+        gbenchmark_escape(&outside);
+    }
+}
+
+BENCHMARK(BM_PolygonOutside)->Arg(16)->Arg(64)->Arg(255);
+
+static void BM_PolygonGridOutside(benchmark::State& state)
+{
+    Vector2f fence[AP_POLYGON_GRID_MAX_POINTS];
+    Vector2f positions[TEST_POINTS];
+    const uint16_t num_points = survey_fence(fence, state.range_x());
+    test_points(positions);
+    AP_PolygonGrid grid;
+    grid.build(fence, num_points);
+    uint16_t i = 0;
+
+    while (state.KeepRunning()) {
+        bool outside = grid.outside(positions[i++ % TEST_POINTS]);
+        gbenchmark_escape(&outside);
+    }
+}
+
+BENCHMARK(BM_PolygonGridOutside)->Arg(16)->Arg(64)->Arg(255);
+
+// nearby edges for a 10m/s vehicle stopping at 1m/s/s, as used by AC_Avoid
+static void BM_PolygonGridEdgesNear(benchmark::State& state)
+{
+    Vector2f fence[AP_POLYGON_GRID_MAX_POINTS];
+    Vector2f positions[TEST_POINTS];
+    const uint16_t num_points = survey_fence(fence, state.range_x());
+    test_points(positions);
+    AP_PolygonGrid grid;
+    grid.build(fence, num_points);
+    AP_PolygonGrid::EdgeSet edges;
+    uint16_t i = 0;
+
+    while (state.KeepRunning()) {
+        grid.edges_near(positions[i++ % TEST_POINTS], 5200, edges);
+        gbenchmark_escape(&edges);
+    }
+}
+
+BENCHMARK(BM_PolygonGridEdgesNear)->Arg(16)->Arg(64)->Arg(255);
+
+static void BM_PolygonGridBuild(benchmark::State& state)
+{
+    Vector2f fence[AP_POLYGON_GRID_MAX_POINTS];
+    const uint16_t num_points = survey_fence(fence, state.range_x());
+    AP_PolygonGrid grid;
+
+    while (state.KeepRunning()) {
+        grid.build(fence, num_points);
+        gbenchmark_escape(&grid);
+    }
+}
+
+BENCHMARK(BM_PolygonGridBuild)->Arg(16)->Arg(64)->Arg(255);
+
+BENCHMARK_MAIN()
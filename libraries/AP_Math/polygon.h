@@ -24,3 +24,41 @@ bool        Polygon_outside(const Vector2<T> &P, const Vector2<T> *V, unsigned n
 template <typename T>
 bool        Polygon_complete(const Vector2<T> *V, unsigned n);
 
+/*
+ *  Polygon_crosses(): test if a ray cast from P in the +x direction
+ *  crosses the polygon edge from Vj to Vi. This is the per-edge step
+ *  of Polygon_outside(), exposed so that callers which already know
+ *  which edges can be relevant (see AP_PolygonGrid) get exactly the
+ *  same answer as a full scan.
+ */
+template <typename T>
+inline bool Polygon_crosses(const Vector2<T> &P, const Vector2<T> &Vi, const Vector2<T> &Vj)
+{
+    if ((Vi.y > P.y) == (Vj.y > P.y)) {
+        return false;
+    }
+    int32_t dx1, dx2, dy1, dy2;
+    dx1 = P.x - Vi.x;
+    dx2 = Vj.x - Vi.x;
+    dy1 = P.y - Vi.y;
+    dy2 = Vj.y - Vi.y;
+    int8_t m1, m2;
+    m1 = (dx1 < 0 ? -1 : 1) * (dy2 < 0 ? -1 : 1);
+    m2 = (dx2 < 0 ? -1 : 1) * (dy1 < 0 ? -1 : 1);
+    // we avoid the 64 bit multiplies if we can based on sign checks.
+    if (dy2 < 0) {
+        if (m1 > m2) {
+            return true;
+        } else if (m1 < m2) {
+            return false;
+        }
+        return dx1 * (int64_t)dy2 > dx2 * (int64_t)dy1;
+    }
+    if (m1 < m2) {
+        return true;
+    } else if (m1 > m2) {
+        return false;
+    }
+    return dx1 * (int64_t)dy2 < dx2 * (int64_t)dy1;
+}
+
@@ -0,0 +1,119 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/AP_PolygonGrid.h>
+
+// simple deterministic generator so failures are reproducible
+static uint32_t rand_state = 1;
+static float rand_float(float low, float high)
+{
+    rand_state = rand_state * 1103515245U + 12345U;
+    return low + (high - low) * ((rand_state >> 8) & 0xFFFF) / 65535.0f;
+}
+
+// irregular star shaped polygon with the last point equal to the first
+static uint16_t make_polygon(Vector2f *points, uint16_t num_points, const Vector2f &centre, float radius)
+{
+    for (uint16_t i = 0; i < num_points - 1; i++) {
+        const float angle = M_2PI * i / (num_points - 1);
+        const float r = radius * rand_float(0.3f, 1.0f);
+        points[i] = centre + Vector2f(r * cosf(angle), r * sinf(angle));
+    }
+    points[num_points - 1] = points[0];
+    return num_points;
+}
+
+static void check_outside(const Vector2f *points, uint16_t num_points, const Vector2f &centre, float radius)
+{
+    AP_PolygonGrid grid;
+    ASSERT_TRUE(grid.build(points, num_points));
+
+    for (uint16_t i = 0; i < 5000; i++) {
+        Vector2f P;
+        if (i % 2) {
+            // close to an edge, where integer truncation matters
+            const uint16_t e = i % num_points;
+            const Vector2f &a = points[e == 0 ? num_points - 1 : e - 1];
+            P = a + (points[e] - a) * rand_float(0, 1) + Vector2f(rand_float(-4, 4), rand_float(-4, 4));
+        } else {
+            P = centre + Vector2f(rand_float(-1.5f, 1.5f) * radius, rand_float(-1.5f, 1.5f) * radius);
+        }
+        EXPECT_EQ(Polygon_outside(P, points, num_points), grid.outside(P));
+    }
+}
+
+TEST(PolygonGridTest, MatchesPolygonOutside)
+{
+    Vector2f points[AP_POLYGON_GRID_MAX_POINTS];
+
+    for (uint16_t num_points = 4; num_points <= AP_POLYGON_GRID_MAX_POINTS; num_points += 36) {
+        const Vector2f centre(rand_float(-1e6f, 1e6f), rand_float(-1e6f, 1e6f));
+        const float radius = rand_float(10, 1e5f);
+        make_polygon(points, num_points, centre, radius);
+        check_outside(points, num_points, centre, radius);
+    }
+}
+
+TEST(PolygonGridTest, FlatEdges)
+{
+    // edges with |dy| < 1 are truncated to horizontal by
+    // Polygon_crosses(), which affects every point to their left
+    const Vector2f points[] = {
+        {1000, 0}, {2000, 0.5f}, {2000, 1000}, {1500, 1000.7f}, {1000, 1000}, {1000, 0}
+    };
+    const uint16_t num_points = ARRAY_SIZE(points);
+    AP_PolygonGrid grid;
+    ASSERT_TRUE(grid.build(points, num_points));
+    for (float x = -500; x < 2500; x += 7.3f) {
+        for (float y = -5; y < 1010; y += 0.25f) {
+            const Vector2f P(x, y);
+            EXPECT_EQ(Polygon_outside(P, points, num_points), grid.outside(P));
+        }
+    }
+}
+
+TEST(PolygonGridTest, EdgesNear)
+{
+    Vector2f points[120];
+    const Vector2f centre(5000, -3000);
+    const float radius = 20000;
+    const uint16_t num_points = make_polygon(points, ARRAY_SIZE(points), centre, radius);
+
+    AP_PolygonGrid grid;
+    ASSERT_TRUE(grid.build(points, num_points));
+
+    for (uint16_t i = 0; i < 500; i++) {
+        const Vector2f P = centre + Vector2f(rand_float(-1.2f, 1.2f) * radius, rand_float(-1.2f, 1.2f) * radius);
+        const float r = rand_float(0, radius * 0.5f);
+        AP_PolygonGrid::EdgeSet edges;
+        ASSERT_TRUE(grid.edges_near(P, r, edges));
+        for (uint16_t e = 0; e < num_points; e++) {
+            const Vector2f &a = points[e == 0 ? num_points - 1 : e - 1];
+            const float distance = (Vector2f::closest_point(P, a, points[e]) - P).length();
+            if (distance <= r) {
+                EXPECT_TRUE(edges.get(e));
+            }
+        }
+    }
+}
+
+TEST(PolygonGridTest, Limits)
+{
+    Vector2f points[AP_POLYGON_GRID_MAX_POINTS + 1];
+    AP_PolygonGrid grid;
+
+    EXPECT_FALSE(grid.build(nullptr, 10));
+    EXPECT_FALSE(grid.build(points, 2));
+    EXPECT_FALSE(grid.valid());
+
+    make_polygon(points, ARRAY_SIZE(points), Vector2f(), 1000);
+    EXPECT_FALSE(grid.build(points, ARRAY_SIZE(points)));
+    EXPECT_TRUE(grid.build(points, AP_POLYGON_GRID_MAX_POINTS));
+    EXPECT_TRUE(grid.valid());
+
+    grid.clear();
+    EXPECT_FALSE(grid.valid());
+    EXPECT_TRUE(grid.outside(Vector2f()));
+}
+
+AP_GTEST_MAIN()
@@ -3,6 +3,9 @@
 // this buffer model is to be used for observation buffers,
 // the data is pushed into buffer like any standard ring buffer
 // return is based on the sample time provided
+// a copy of each element's time stamp is kept in a separate array so
+// that recall() can binary search the time stamps without touching
+// the (much larger) elements
 template <typename element_type>
 class obs_ring_buffer_t
 {
@@ -19,7 +22,15 @@ public:
         {
             return false;
         }
+        _time_ms = new uint32_t[size];
+        if(_time_ms == nullptr)
+        {
+            delete[] buffer;
+            buffer = nullptr;
+            return false;
+        }
         memset(buffer,0,size*sizeof(element_t));
+        memset(_time_ms,0,size*sizeof(uint32_t));
         _size = size;
         _head = 0;
         _tail = 0;
@@ -32,6 +43,10 @@ public:
      * time specified by sample_time_ms
      * Zeros old data so it cannot not be used again
      * Returns false if no data can be found that is less than 100msec old
+     * Data is pushed in time order, so the newest element that is not newer than
+     * sample_time is found with a binary search over the time stamps between the
+     * tail and the head. Time stamps of zero mark unused data and are only found
+     * at the oldest end of that range
     */
 
     bool recall(element_type &element,uint32_t sample_time)
@@ -39,44 +54,48 @@ public:
         if(!_new_data) {
             return false;
         }
-        bool success = false;
-        uint8_t tail = _tail, bestIndex;
-
-        if(_head == tail) {
-            if (buffer[tail].element.time_ms != 0 && buffer[tail].element.time_ms <= sample_time) {
-                // if head is equal to tail just check if the data is unused and within time horizon window
-                if (((sample_time - buffer[tail].element.time_ms) < 100)) {
-                    bestIndex = tail;
-                    success = true;
-                    _new_data = false;
-                }
-            }
+        uint8_t bestIndex;
+
+        if(_head == _tail) {
+            // if head is equal to tail just check the newest data
+            bestIndex = _tail;
         } else {
-            while(_head != tail) {
-                // find a measurement older than the fusion time horizon that we haven't checked before
-                if (buffer[tail].element.time_ms != 0 && buffer[tail].element.time_ms <= sample_time) {
-                    // Find the most recent non-stale measurement that meets the time horizon criteria
-                    if (((sample_time - buffer[tail].element.time_ms) < 100)) {
-                        bestIndex = tail;
-                        success = true;
-                    }
-                } else if(buffer[tail].element.time_ms > sample_time){
-                    break;
+            // number of elements that have not been checked before, excluding the head
+            uint8_t count = (_head + _size - _tail) % _size;
+
+            // find the number of elements that are not newer than the fusion time horizon
+            uint8_t low = 0;
+            while (count > 0) {
+                const uint8_t half = count / 2;
+                if (_time_ms[(_tail + low + half) % _size] <= sample_time) {
+                    low += half + 1;
+                    count -= half + 1;
+                } else {
+                    count = half;
                 }
-                tail = (tail+1)%_size;
             }
+            if (low == 0) {
+                return false;
+            }
+            bestIndex = (_tail + low - 1) % _size;
         }
 
-        if (success) {
-            element = buffer[bestIndex].element;
-            _tail = (bestIndex+1)%_size;
-            //make time zero to stop using it again, 
-            //resolves corner case of reusing the element when head == tail
-            buffer[bestIndex].element.time_ms = 0;
-            return true;
-        } else {
+        // use the most recent measurement if it is not stale
+        const uint32_t time_ms = _time_ms[bestIndex];
+        if (time_ms == 0 || time_ms > sample_time || (sample_time - time_ms) >= 100) {
             return false;
         }
+
+        element = buffer[bestIndex].element;
+        if (_head == _tail) {
+            _new_data = false;
+        }
+        _tail = (bestIndex+1)%_size;
+        //make time zero to stop using it again, 
+        //resolves corner case of reusing the element when head == tail
+        buffer[bestIndex].element.time_ms = 0;
+        _time_ms[bestIndex] = 0;
+        return true;
     }
 
     /*
@@ -89,12 +108,14 @@ public:
         _head = (_head+1)%_size;
         // New data is written at the head
         buffer[_head].element = element;
+        _time_ms[_head] = element.time_ms;
         _new_data = true;
     }
     // writes the same data to all elements in the ring buffer
     inline void reset_history(element_type element, uint32_t sample_time) {
         for (uint8_t index=0; index<_size; index++) {
             buffer[index].element = element;
+            _time_ms[index] = element.time_ms;
         }
     }
 
@@ -104,9 +125,16 @@ public:
         _tail = 0;
         _new_data = false;
         memset(buffer,0,_size*sizeof(element_t));
+        memset(_time_ms,0,_size*sizeof(uint32_t));
+    }
+
+    // returns the number of elements the buffer can hold
+    inline uint8_t get_size() const {
+        return _size;
     }
 
 private:
+    uint32_t *_time_ms;
     uint8_t _size,_head,_tail,_new_data;
 };
 
@@ -68,22 +68,36 @@ bool NavEKF2_core::setup_core(NavEKF2 *_frontend, uint8_t _imu_index, uint8_t _c
         // maximum 260 msec delay at 100 Hz fusion rate
         imu_buffer_length = 26;
     }
-    if(!storedGPS.init(OBS_BUFFER_LENGTH)) {
+
+    /*
+      the observation buffers need to hold the measurements received
+      during the longest sensor delay at the maximum rate at which
+      measurements are accepted. They cannot usefully be longer than
+      the IMU buffer as only one measurement of each type is fused per
+      prediction cycle.
+     */
+    uint16_t maxTimeDelay_ms = MAX((uint16_t)frontend->_gpsDelay_ms,
+                                   MAX((uint16_t)frontend->_hgtDelay_ms,
+                                       MAX((uint16_t)frontend->_flowDelay_ms,
+                                           MAX(frontend->magDelay_ms, frontend->tasDelay_ms))));
+    obs_buffer_length = (maxTimeDelay_ms / frontend->sensorIntervalMin_ms) + 1;
+    obs_buffer_length = MIN(obs_buffer_length, imu_buffer_length);
+    if(!storedGPS.init(obs_buffer_length)) {
         return false;
     }
-    if(!storedMag.init(OBS_BUFFER_LENGTH)) {
+    if(!storedMag.init(obs_buffer_length)) {
         return false;
     }
-    if(!storedBaro.init(OBS_BUFFER_LENGTH)) {
+    if(!storedBaro.init(obs_buffer_length)) {
         return false;
     } 
-    if(!storedTAS.init(OBS_BUFFER_LENGTH)) {
+    if(!storedTAS.init(obs_buffer_length)) {
         return false;
     }
-    if(!storedOF.init(OBS_BUFFER_LENGTH)) {
+    if(!storedOF.init(obs_buffer_length)) {
         return false;
     }
-    if(!storedRange.init(2*OBS_BUFFER_LENGTH)) {
+    if(!storedRange.init(2*obs_buffer_length)) {
         return false;
     }
     if(!storedIMU.init(imu_buffer_length)) {
@@ -876,6 +890,69 @@ void NavEKF2_core::CovariancePrediction()
         zeroCols(P,22,23);
     }
 
+    // predict the covariance F*P*F' + Q, computing the upper diagonal only
+    const Vector3f dAngNoise(daxNoise, dayNoise, dazNoise);
+    const Vector3f dVelNoise(dvxNoise, dvyNoise, dvzNoise);
+#if EK2_SPARSE_COV_PREDICT
+    CovariancePredictionSparse(q0, q1, q2, q3, dAngNoise, dVelNoise);
+#else
+    CovariancePredictionGenerated(q0, q1, q2, q3, dAngNoise, dVelNoise);
+#endif
+
+    // Copy upper diagonal to lower diagonal taking advantage of symmetry
+    for (uint8_t colIndex=0; colIndex<=stateIndexLim; colIndex++)
+    {
+        for (uint8_t rowIndex=0; rowIndex<colIndex; rowIndex++)
+        {
+            nextP[colIndex][rowIndex] = nextP[rowIndex][colIndex];
+        }
+    }
+
+    // add the general state process noise variances
+    for (uint8_t i=0; i<=stateIndexLim; i++)
+    {
+        nextP[i][i] = nextP[i][i] + processNoise[i];
+    }
+
+    // if the total position variance exceeds 1e4 (100m), then stop covariance
+    // growth by setting the predicted to the previous values
+    // This prevent an ill conditioned matrix from occurring for long periods
+    // without GPS
+    if ((P[6][6] + P[7][7]) > 1e4f)
+    {
+        for (uint8_t i=6; i<=7; i++)
+        {
+            for (uint8_t j=0; j<=stateIndexLim; j++)
+            {
+                nextP[i][j] = P[i][j];
+                nextP[j][i] = P[j][i];
+            }
+        }
+    }
+
+    // copy covariances to output
+    CopyCovariances();
+
+    // constrain diagonals to prevent ill-conditioning
+    ConstrainVariances();
+
+    hal.util->perf_end(_perf_CovariancePrediction);
+}
+
+/*
+ * Calculate the upper diagonal of the predicted covariance matrix using the expressions generated with the
+ * Matlab symbolic toolbox. Inputs are the intermediate variables SF, SG, SQ and SPP calculated by CovariancePrediction()
+*/
+void NavEKF2_core::CovariancePredictionGenerated(ftype q0, ftype q1, ftype q2, ftype q3, const Vector3f &dAngNoise, const Vector3f &dVelNoise)
+{
+    const float daxNoise = dAngNoise.x;
+    const float dayNoise = dAngNoise.y;
+    const float dazNoise = dAngNoise.z;
+    const float dvxNoise = dVelNoise.x;
+    const float dvyNoise = dVelNoise.y;
+    const float dvzNoise = dVelNoise.z;
+
+
     nextP[0][0] = daxNoise*SQ[3] + SPP[5]*(P[0][0]*SPP[5] - P[1][0]*SPP[4] + P[9][0]*SPP[22] + P[12][0]*SPP[18] + P[2][0]*(2*q1*SF[3] - 2*q2*SF[4] - 2*q3*SF[5] + 2*q0*SF[9])) - SPP[4]*(P[0][1]*SPP[5] - P[1][1]*SPP[4] + P[9][1]*SPP[22] + P[12][1]*SPP[18] + P[2][1]*(2*q1*SF[3] - 2*q2*SF[4] - 2*q3*SF[5] + 2*q0*SF[9])) + SPP[8]*(P[0][2]*SPP[5] + P[2][2]*SPP[8] + P[9][2]*SPP[22] + P[12][2]*SPP[18] - P[1][2]*(2*q0*SF[6] - 2*q3*SF[7] - 2*q1*SF[10] + 2*q2*SF[12])) + SPP[22]*(P[0][9]*SPP[5] - P[1][9]*SPP[4] + P[9][9]*SPP[22] + P[12][9]*SPP[18] + P[2][9]*(2*q1*SF[3] - 2*q2*SF[4] - 2*q3*SF[5] + 2*q0*SF[9])) + SPP[18]*(P[0][12]*SPP[5] - P[1][12]*SPP[4] + P[9][12]*SPP[22] + P[12][12]*SPP[18] + P[2][12]*(2*q1*SF[3] - 2*q2*SF[4] - 2*q3*SF[5] + 2*q0*SF[9]));
     nextP[0][1] = SPP[6]*(P[0][1]*SPP[5] - P[1][1]*SPP[4] + P[2][1]*SPP[8] + P[9][1]*SPP[22] + P[12][1]*SPP[18]) - SPP[2]*(P[0][0]*SPP[5] - P[1][0]*SPP[4] + P[2][0]*SPP[8] + P[9][0]*SPP[22] + P[12][0]*SPP[18]) + SPP[22]*(P[0][10]*SPP[5] - P[1][10]*SPP[4] + P[2][10]*SPP[8] + P[9][10]*SPP[22] + P[12][10]*SPP[18]) + SPP[17]*(P[0][13]*SPP[5] - P[1][13]*SPP[4] + P[2][13]*SPP[8] + P[9][13]*SPP[22] + P[12][13]*SPP[18]) - (2*q0*SF[5] - 2*q1*SF[4] - 2*q2*SF[3] + 2*q3*SF[9])*(P[0][2]*SPP[5] - P[1][2]*SPP[4] + P[2][2]*SPP[8] + P[9][2]*SPP[22] + P[12][2]*SPP[18]);
     nextP[1][1] = dayNoise*SQ[3] - SPP[2]*(P[1][0]*SPP[6] - P[0][0]*SPP[2] - P[2][0]*SPP[9] + P[10][0]*SPP[22] + P[13][0]*SPP[17]) + SPP[6]*(P[1][1]*SPP[6] - P[0][1]*SPP[2] - P[2][1]*SPP[9] + P[10][1]*SPP[22] + P[13][1]*SPP[17]) - SPP[9]*(P[1][2]*SPP[6] - P[0][2]*SPP[2] - P[2][2]*SPP[9] + P[10][2]*SPP[22] + P[13][2]*SPP[17]) + SPP[22]*(P[1][10]*SPP[6] - P[0][10]*SPP[2] - P[2][10]*SPP[9] + P[10][10]*SPP[22] + P[13][10]*SPP[17]) + SPP[17]*(P[1][13]*SPP[6] - P[0][13]*SPP[2] - P[2][13]*SPP[9] + P[10][13]*SPP[22] + P[13][13]*SPP[17]);
@@ -1182,45 +1259,92 @@ void NavEKF2_core::CovariancePrediction()
             nextP[23][23] = P[23][23];
         }
     }
+}
 
-    // Copy upper diagonal to lower diagonal taking advantage of symmetry
-    for (uint8_t colIndex=0; colIndex<=stateIndexLim; colIndex++)
-    {
-        for (uint8_t rowIndex=0; rowIndex<colIndex; rowIndex++)
-        {
-            nextP[colIndex][rowIndex] = nextP[rowIndex][colIndex];
+/*
+ * Calculate the upper diagonal of the predicted covariance matrix as F*P*F' + Q, exploiting the sparsity of the
+ * state transition matrix F. Rows 9 to 23 of F are the identity, rows 0 to 5 have five non-zero terms and rows
+ * 6 to 8 have two, so F*P is formed for those nine rows only using contiguous row operations that the compiler
+ * can vectorise. The product with F' is then formed from the stored rows without recalculating common terms.
+ * The result matches CovariancePredictionGenerated() to within rounding error.
+*/
+void NavEKF2_core::CovariancePredictionSparse(ftype q0, ftype q1, ftype q2, ftype q3, const Vector3f &dAngNoise, const Vector3f &dVelNoise)
+{
+    const uint8_t numStates = stateIndexLim + 1;
+
+    // column index and value of the non-zero elements in rows 0 to 5 of the state transition matrix
+    static const uint8_t colIndex[6][5] = {
+        { 0,  1,  2,  9, 12},
+        { 0,  1,  2, 10, 13},
+        { 0,  1,  2, 11, 14},
+        { 3,  0,  1,  2, 15},
+        { 4,  0,  1,  2, 15},
+        { 5,  0,  1,  2, 15}
+    };
+    const ftype F[6][5] = {
+        { SPP[5],  -SPP[4],  SPP[8],  SPP[22],  SPP[18]},
+        {-SPP[2],   SPP[6], -SPP[9],  SPP[22],  SPP[17]},
+        { SPP[14], -SPP[3],  SPP[13], SPP[22],  SPP[16]},
+        { 1.0f,     SPP[1],  SPP[19], SPP[15], -SPP[21]},
+        { 1.0f,     SPP[20], SPP[12], SPP[11],  SF[22]},
+        { 1.0f,    -SPP[7],  SPP[10], SPP[0],   SF[20]}
+    };
+
+    // rows 0 to 8 of F*P. Rows 9 to 23 are the same as P
+    ftype FP[9][24] __attribute__((aligned(16)));
+    for (uint8_t row=0; row<6; row++) {
+        const ftype *f = F[row];
+        const ftype *p0 = &P[colIndex[row][0]][0];
+        const ftype *p1 = &P[colIndex[row][1]][0];
+        const ftype *p2 = &P[colIndex[row][2]][0];
+        const ftype *p3 = &P[colIndex[row][3]][0];
+        const ftype *p4 = &P[colIndex[row][4]][0];
+        for (uint8_t col=0; col<24; col++) {
+            FP[row][col] = f[0]*p0[col] + f[1]*p1[col] + f[2]*p2[col] + f[3]*p3[col] + f[4]*p4[col];
         }
     }
-
-    // add the general state process noise variances
-    for (uint8_t i=0; i<=stateIndexLim; i++)
-    {
-        nextP[i][i] = nextP[i][i] + processNoise[i];
+    // position rows are the position plus dt times the velocity
+    for (uint8_t row=6; row<9; row++) {
+        const ftype *pos = &P[row][0];
+        const ftype *vel = &P[row-3][0];
+        for (uint8_t col=0; col<24; col++) {
+            FP[row][col] = pos[col] + dt*vel[col];
+        }
     }
 
-    // if the total position variance exceeds 1e4 (100m), then stop covariance
-    // growth by setting the predicted to the previous values
-    // This prevent an ill conditioned matrix from occurring for long periods
-    // without GPS
-    if ((P[6][6] + P[7][7]) > 1e4f)
-    {
-        for (uint8_t i=6; i<=7; i++)
-        {
-            for (uint8_t j=0; j<=stateIndexLim; j++)
-            {
-                nextP[i][j] = P[i][j];
-                nextP[j][i] = P[j][i];
-            }
+    // upper diagonal of F*P*F'. Columns 9 to 23 of F' are the identity
+    for (uint8_t col=0; col<6; col++) {
+        const uint8_t *c = colIndex[col];
+        const ftype *f = F[col];
+        for (uint8_t row=0; row<=col; row++) {
+            const ftype *fp = FP[row];
+            nextP[row][col] = f[0]*fp[c[0]] + f[1]*fp[c[1]] + f[2]*fp[c[2]] + f[3]*fp[c[3]] + f[4]*fp[c[4]];
+        }
+    }
+    for (uint8_t col=6; col<9; col++) {
+        for (uint8_t row=0; row<=col; row++) {
+            nextP[row][col] = FP[row][col] + dt*FP[row][col-3];
+        }
+    }
+    for (uint8_t col=9; col<numStates; col++) {
+        for (uint8_t row=0; row<9; row++) {
+            nextP[row][col] = FP[row][col];
+        }
+        for (uint8_t row=9; row<=col; row++) {
+            nextP[row][col] = P[row][col];
         }
     }
 
-    // copy covariances to output
-    CopyCovariances();
-
-    // constrain diagonals to prevent ill-conditioning
-    ConstrainVariances();
-
-    hal.util->perf_end(_perf_CovariancePrediction);
+    // add the IMU noise contributions, which only affect the attitude and velocity states
+    nextP[0][0] += dAngNoise.x*SQ[3];
+    nextP[1][1] += dAngNoise.y*SQ[3];
+    nextP[2][2] += dAngNoise.z*SQ[3];
+    nextP[3][3] += dVelNoise.y*sq(SQ[6] - 2*q0*q3) + dVelNoise.z*sq(SQ[5] + 2*q0*q2) + dVelNoise.x*sq(SG[1] + SG[2] - SG[3] - SQ[7]);
+    nextP[3][4] += SQ[2];
+    nextP[3][5] += SQ[1];
+    nextP[4][4] += dVelNoise.x*sq(SQ[6] + 2*q0*q3) + dVelNoise.z*sq(SQ[4] - 2*q0*q1) + dVelNoise.y*sq(SG[1] - SG[2] + SG[3] - SQ[7]);
+    nextP[4][5] += SQ[0];
+    nextP[5][5] += dVelNoise.x*sq(SQ[5] - 2*q0*q2) + dVelNoise.y*sq(SQ[4] + 2*q0*q1) + dVelNoise.z*sq(SG[1] - SG[2] - SG[3] + SQ[7]);
 }
 
 // zero specified range of rows in the state covariance matrix
@@ -29,6 +29,17 @@
 #include <AP_Math/vectorN.h>
 #include <AP_NavEKF2/AP_NavEKF2_Buffer.h>
 
+/*
+  select the covariance prediction engine. When enabled the prediction
+  uses the sparse structure of the state transition matrix instead of
+  the generated expressions. Both give the same result to within
+  rounding error. Disabled by default, the generated expressions are
+  the flight tested reference
+ */
+#ifndef EK2_SPARSE_COV_PREDICT
+#define EK2_SPARSE_COV_PREDICT 0
+#endif
+
 // GPS pre-flight check bit locations
 #define MASK_GPS_NSATS      (1<<0)
 #define MASK_GPS_HDOP       (1<<1)
@@ -48,6 +59,8 @@ class AP_AHRS;
 
 class NavEKF2_core
 {
+    friend class NavEKF2_core_Bench;
+
 public:
     // Constructor
     NavEKF2_core(void);
@@ -289,6 +302,7 @@ private:
     uint8_t imu_index;
     uint8_t core_index;
     uint8_t imu_buffer_length;
+    uint8_t obs_buffer_length;
 
     typedef float ftype;
 #if MATH_CHECK_INDEXES
@@ -419,6 +433,12 @@ private:
     // calculate the predicted state covariance matrix
     void CovariancePrediction();
 
+    // calculate the upper diagonal of the predicted covariance matrix using the generated expressions
+    void CovariancePredictionGenerated(ftype q0, ftype q1, ftype q2, ftype q3, const Vector3f &dAngNoise, const Vector3f &dVelNoise);
+
+    // calculate the upper diagonal of the predicted covariance matrix using the sparse state transition matrix
+    void CovariancePredictionSparse(ftype q0, ftype q1, ftype q2, ftype q3, const Vector3f &dAngNoise, const Vector3f &dVelNoise);
+
     // force symmetry on the state covariance matrix
     void ForceSymmetry();
 
@@ -663,10 +683,6 @@ private:
     // effective value of MAG_CAL
     uint8_t effective_magCal(void) const;
     
-    // Length of FIFO buffers used for non-IMU sensor data.
-    // Must be larger than the time period defined by IMU_BUFFER_LENGTH
-    static const uint32_t OBS_BUFFER_LENGTH = 5;
-
     // Variables
     bool statesInitialised;         // boolean true when filter states have been initialised
     bool velHealth;                 // boolean true if velocity measurements have passed innovation consistency check
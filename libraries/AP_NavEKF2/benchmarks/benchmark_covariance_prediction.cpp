@@ -0,0 +1,93 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+
+#if HAL_CPU_CLASS >= HAL_CPU_CLASS_150
+
+#include <AP_NavEKF2/AP_NavEKF2_core.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+/*
+ * Compare the generated and sparse covariance prediction engines on the
+ * same covariance matrix and intermediate variables
+ */
+class NavEKF2_core_Bench
+{
+public:
+    NavEKF2_core_Bench(uint8_t stateIndexLim)
+    {
+        core.stateIndexLim = stateIndexLim;
+        core.dt = 0.0025f;
+
+        for (uint8_t i = 0; i < 24; i++) {
+            for (uint8_t j = 0; j <= i; j++) {
+                float v = (i == j) ? 1.0f + 0.1f * i : 0.01f * (i - j);
+                core.P[i][j] = v;
+                core.P[j][i] = v;
+            }
+        }
+        for (uint8_t i = 0; i < 25; i++) {
+            core.SF[i] = 0.01f * (i + 1);
+        }
+        for (uint8_t i = 0; i < 5; i++) {
+            core.SG[i] = 0.1f * (i + 1);
+        }
+        for (uint8_t i = 0; i < 8; i++) {
+            core.SQ[i] = 0.001f * (i + 1);
+        }
+        for (uint8_t i = 0; i < 23; i++) {
+            core.SPP[i] = 0.02f * (i + 1);
+        }
+    }
+
+    void generated()
+    {
+        core.CovariancePredictionGenerated(q[0], q[1], q[2], q[3], dAngNoise, dVelNoise);
+    }
+
+    void sparse()
+    {
+        core.CovariancePredictionSparse(q[0], q[1], q[2], q[3], dAngNoise, dVelNoise);
+    }
+
+    float *nextP() { return &core.nextP[0][0]; }
+
+private:
+    NavEKF2_core core;
+    const float q[4] = {0.9f, 0.1f, 0.2f, 0.3f};
+    const Vector3f dAngNoise{1.0e-7f, 1.0e-7f, 1.0e-7f};
+    const Vector3f dVelNoise{1.0e-4f, 1.0e-4f, 1.0e-4f};
+};
+
+static void BM_CovariancePredictionGenerated(benchmark::State& state)
+{
+    NavEKF2_core_Bench *bench = new NavEKF2_core_Bench(state.range_x());
+
+    while (state.KeepRunning()) {
+        bench->generated();
+        gbenchmark_escape(bench->nextP());
+    }
+
+    delete bench;
+}
+
+BENCHMARK(BM_CovariancePredictionGenerated)->Arg(15)->Arg(21)->Arg(23);
+
+static void BM_CovariancePredictionSparse(benchmark::State& state)
+{
+    NavEKF2_core_Bench *bench = new NavEKF2_core_Bench(state.range_x());
+
+    while (state.KeepRunning()) {
+        bench->sparse();
+        gbenchmark_escape(bench->nextP());
+    }
+
+    delete bench;
+}
+
+BENCHMARK(BM_CovariancePredictionSparse)->Arg(15)->Arg(21)->Arg(23);
+
+#endif
+
+BENCHMARK_MAIN()
@@ -65,6 +65,28 @@ uint16_t AP_Param::_parameter_count;
 // storage and naming information about all types that can be saved
 const AP_Param::Info *AP_Param::_var_info;
 
+// lookup index for find(), find_object() and find_by_index()
+struct AP_Param::name_index_entry *AP_Param::_name_index;
+uint16_t AP_Param::_name_index_count;
+struct AP_Param::scalar_index_entry *AP_Param::_scalar_index;
+bool AP_Param::_index_alloc_failed;
+uint16_t AP_Param::_index_generation;
+
+// map of variable offsets in storage, built by load_all()
+struct AP_Param::storage_map_entry *AP_Param::_storage_map;
+uint16_t AP_Param::_storage_map_count;
+uint16_t AP_Param::_storage_map_size;
+uint16_t AP_Param::_sentinal_ofs;
+
+// storage writes queued by save()
+struct AP_Param::pending_write AP_Param::_write_queue[AP_Param::_write_queue_len];
+uint8_t AP_Param::_write_queue_count;
+AP_HAL::Semaphore *AP_Param::_write_sem;
+bool AP_Param::_write_handler_registered;
+
+// object used to register the IO process that writes the queue
+static AP_Param save_dummy;
+
 struct AP_Param::param_override *AP_Param::param_overrides = nullptr;
 uint16_t AP_Param::num_param_overrides = 0;
 
@@ -87,7 +109,7 @@ void AP_Param::write_sentinal(uint16_t ofs)
     phdr.type = _sentinal_type;
     set_key(phdr, _sentinal_key);
     phdr.group_element = _sentinal_group;
-    eeprom_write_check(&phdr, ofs, sizeof(phdr));
+    queue_write(ofs, &phdr, sizeof(phdr));
 }
 
 // erase all EEPROM variables by re-writing the header and adding
@@ -96,6 +118,12 @@ void AP_Param::erase_all(void)
 {
     struct EEPROM_header hdr;
 
+    // discard any queued writes, they are for the old layout
+    if (_write_sem != nullptr && _write_sem->take(HAL_SEMAPHORE_BLOCK_FOREVER)) {
+        _write_queue_count = 0;
+        _write_sem->give();
+    }
+
     // write the header
     hdr.magic[0] = k_EEPROM_magic0;
     hdr.magic[1] = k_EEPROM_magic1;
@@ -105,6 +133,12 @@ void AP_Param::erase_all(void)
 
     // add a sentinal directly after the header
     write_sentinal(sizeof(struct EEPROM_header));
+    flush();
+
+    if (_storage_map != nullptr) {
+        _storage_map_count = 0;
+        _sentinal_ofs = sizeof(struct EEPROM_header);
+    }
 }
 
 /* the 'group_id' of a element of a group is the 18 bit identifier
@@ -242,6 +276,11 @@ bool AP_Param::setup(void)
 {
     struct EEPROM_header hdr;
 
+    if (_write_sem == nullptr) {
+        // without a semaphore save() writes to storage directly
+        _write_sem = hal.util->new_semaphore();
+    }
+
     // check the header
     _storage.read_block(&hdr, 0, sizeof(hdr));
     if (hdr.magic[0] != k_EEPROM_magic0 ||
@@ -589,6 +628,17 @@ bool AP_Param::is_sentinal(const Param_header &phdr)
 // if the sentinal isn't found either, the offset is set to 0xFFFF
 bool AP_Param::scan(const AP_Param::Param_header *target, uint16_t *pofs)
 {
+    if (_storage_map != nullptr) {
+        if (storage_map_find(*target, *pofs)) {
+            return true;
+        }
+        *pofs = _sentinal_ofs;
+        return false;
+    }
+
+    // the scan needs to see the headers of queued new variables
+    flush();
+
     struct Param_header phdr;
     uint16_t ofs = sizeof(AP_Param::EEPROM_header);
     while (ofs < _storage.size()) {
@@ -740,6 +790,10 @@ AP_Param::find_group(const char *name, uint16_t vindex, ptrdiff_t group_offset,
 AP_Param *
 AP_Param::find(const char *name, enum ap_var_type *ptype)
 {
+    AP_Param *ap = find_in_index(name, ptype, false);
+    if (ap != nullptr) {
+        return ap;
+    }
     for (uint16_t i=0; i<_num_vars; i++) {
         uint8_t type = _var_info[i].type;
         if (type == AP_PARAM_GROUP) {
@@ -748,8 +802,14 @@ AP_Param::find(const char *name, enum ap_var_type *ptype)
                 continue;
             }
             const struct GroupInfo *group_info = _var_info[i].group_info;
-            AP_Param *ap = find_group(name + len, i, 0, group_info, ptype);
+            ap = find_group(name + len, i, 0, group_info, ptype);
             if (ap != nullptr) {
+                // the index misses names that only match without
+                // regard to case, and pointer groups allocated since
+                // it was built. Only the latter need a rebuild
+                if (ap->in_pointer_group()) {
+                    invalidate_index();
+                }
                 return ap;
             }
             // we continue looking as we want to allow top level
@@ -767,6 +827,30 @@ AP_Param::find(const char *name, enum ap_var_type *ptype)
     return nullptr;
 }
 
+/*
+  return true if the variable is in a group reached through a pointer
+*/
+bool AP_Param::in_pointer_group(void) const
+{
+    uint32_t group_element;
+    const struct GroupInfo *ginfo;
+    struct GroupNesting group_nesting {};
+    uint8_t idx;
+    const struct Info *info = find_var_info(&group_element, ginfo, group_nesting, &idx);
+    if (info == nullptr) {
+        return false;
+    }
+    if (info->flags & AP_PARAM_FLAG_POINTER) {
+        return true;
+    }
+    for (uint8_t i=0; i<group_nesting.level; i++) {
+        if (group_nesting.group_ret[i]->flags & AP_PARAM_FLAG_POINTER) {
+            return true;
+        }
+    }
+    return false;
+}
+
 /*
   find the def_value for a variable by name
 */
@@ -792,11 +876,29 @@ AP_Param::find_def_value_ptr(const char *name)
     return &info->def_value;
 }
 
-// Find a variable by index. Note that this is quite slow.
+// Find a variable by index. Uses the scalar index when available,
+// otherwise walks the tree which is quite slow.
 //
 AP_Param *
 AP_Param::find_by_index(uint16_t idx, enum ap_var_type *ptype, ParamToken *token)
 {
+    if (_scalar_index != nullptr || build_scalar_index()) {
+        if (idx >= _parameter_count) {
+            return nullptr;
+        }
+        const struct scalar_index_entry &e = _scalar_index[idx];
+        AP_Param *ap = find_by_token(e.token, (enum ap_var_type)e.type);
+        if (ap != nullptr) {
+            *token = e.token;
+            if (ptype != nullptr) {
+                *ptype = (enum ap_var_type)e.type;
+            }
+            return ap;
+        }
+        // the object behind a pointer group has gone away
+        invalidate_index();
+    }
+
     AP_Param *ap;
     uint16_t count=0;
     for (ap=AP_Param::first(token, ptype);
@@ -872,6 +974,10 @@ bool AP_Param::find_key_by_pointer(const void *ptr, uint16_t &key)
 AP_Param *
 AP_Param::find_object(const char *name)
 {
+    AP_Param *ap = find_in_index(name, nullptr, true);
+    if (ap != nullptr) {
+        return ap;
+    }
     for (uint16_t i=0; i<_num_vars; i++) {
         if (strcasecmp(name, _var_info[i].name) == 0) {
             ptrdiff_t base;
@@ -884,6 +990,450 @@ AP_Param::find_object(const char *name)
     return nullptr;
 }
 
+/*
+  in-place heap sort of index entries, using T::before()
+ */
+template <typename T>
+static void index_sort_sift(T *a, uint16_t root, uint16_t n)
+{
+    for (uint16_t child; (child = 2*root + 1) < n; root = child) {
+        if (child + 1 < n && a[child].before(a[child+1])) {
+            child++;
+        }
+        if (!a[root].before(a[child])) {
+            return;
+        }
+        T tmp = a[root];
+        a[root] = a[child];
+        a[child] = tmp;
+    }
+}
+
+template <typename T>
+static void index_sort(T *a, uint16_t n)
+{
+    for (uint16_t i=n/2; i > 0; i--) {
+        index_sort_sift(a, i-1, n);
+    }
+    for (uint16_t end=n; end > 1; end--) {
+        T tmp = a[0];
+        a[0] = a[end-1];
+        a[end-1] = tmp;
+        index_sort_sift(a, 0, end-1);
+    }
+}
+
+/*
+  case insensitive FNV-1a hash of a parameter name
+ */
+uint32_t AP_Param::name_hash(const char *name)
+{
+    uint32_t hash = 2166136261U;
+    for (uint8_t i=0; i<AP_MAX_NAME_SIZE && name[i]; i++) {
+        char c = name[i];
+        if (c >= 'a' && c <= 'z') {
+            c -= 'a' - 'A';
+        }
+        hash = (hash ^ (uint8_t)c) * 16777619U;
+    }
+    return hash;
+}
+
+/*
+  return the variable a token from next() refers to, using the
+  current value of any group pointers
+ */
+AP_Param *AP_Param::find_by_token(const ParamToken &token, enum ap_var_type type)
+{
+    if (token.key >= _num_vars) {
+        return nullptr;
+    }
+    const struct Info &info = _var_info[token.key];
+    ptrdiff_t base;
+    if (info.type == AP_PARAM_GROUP) {
+        struct Param_header phdr {};
+        void *ptr = nullptr;
+        // elements of a vector are found via the vector itself
+        phdr.type = token.idx != 0 ? AP_PARAM_VECTOR3F : type;
+        phdr.group_element = token.group_element;
+        if (find_by_header_group(phdr, &ptr, token.key, info.group_info, 0, 0, 0) == nullptr) {
+            return nullptr;
+        }
+        base = (ptrdiff_t)ptr;
+    } else if (!get_base(info, base)) {
+        return nullptr;
+    }
+    if (token.idx != 0) {
+        base += (token.idx - 1u) * sizeof(float);
+    }
+    return (AP_Param *)base;
+}
+
+/*
+  build the name index. This holds every variable reachable with
+  next(), including the elements of vectors in groups, plus an entry
+  for each top level group for find_object()
+ */
+bool AP_Param::build_name_index(void)
+{
+    if (!AP_PARAM_INDEX_ENABLED || _num_vars == 0 || _index_alloc_failed) {
+        return false;
+    }
+
+    ParamToken token;
+    enum ap_var_type type;
+    uint16_t count = _num_vars;
+    for (AP_Param *ap = first(&token, &type); ap != nullptr; ap = next(&token, &type)) {
+        count++;
+    }
+
+    _name_index = (struct name_index_entry *)calloc(count, sizeof(_name_index[0]));
+    if (_name_index == nullptr) {
+        _index_alloc_failed = true;
+        return false;
+    }
+
+    uint16_t n = 0;
+    for (uint16_t i=0; i<_num_vars; i++) {
+        if (_var_info[i].type != AP_PARAM_GROUP) {
+            // top level scalars are added by the walk below
+            continue;
+        }
+        struct name_index_entry &e = _name_index[n];
+        e.hash = name_hash(_var_info[i].name);
+        e.key = i;
+        e.type = AP_PARAM_GROUP;
+        e.order = n++;
+    }
+
+    for (AP_Param *ap = first(&token, &type); ap != nullptr && n < count; ap = next(&token, &type)) {
+        if (token.idx != 0 && _var_info[token.key].type != AP_PARAM_GROUP) {
+            // find() doesn't accept suffixes on top level vectors
+            continue;
+        }
+        char name[AP_MAX_NAME_SIZE+1];
+        ap->copy_name_token(token, name, sizeof(name), token.idx != 0);
+        name[AP_MAX_NAME_SIZE] = 0;
+        struct name_index_entry &e = _name_index[n];
+        e.hash = name_hash(name);
+        e.key = token.key;
+        e.type = type;
+        e.order = n++;
+    }
+    _name_index_count = n;
+
+    // sorting on (hash, order) means the first match for a name is
+    // the one the linear search in find() would have returned
+    index_sort(_name_index, _name_index_count);
+    return true;
+}
+
+/*
+  build the scalar index, giving the token for each parameter index
+  in the order used by first() and next_scalar()
+ */
+bool AP_Param::build_scalar_index(void)
+{
+    if (!AP_PARAM_INDEX_ENABLED || _num_vars == 0 || _index_alloc_failed) {
+        return false;
+    }
+
+    ParamToken token;
+    enum ap_var_type type;
+    uint16_t count = 0;
+    for (AP_Param *ap = first(&token, &type); ap != nullptr; ap = next_scalar(&token, &type)) {
+        count++;
+    }
+
+    _scalar_index = (struct scalar_index_entry *)calloc(count, sizeof(_scalar_index[0]));
+    if (_scalar_index == nullptr) {
+        _index_alloc_failed = true;
+        return false;
+    }
+
+    uint16_t n = 0;
+    for (AP_Param *ap = first(&token, &type); ap != nullptr && n < count; ap = next_scalar(&token, &type)) {
+        _scalar_index[n].token = token;
+        _scalar_index[n].type = type;
+        n++;
+    }
+    _parameter_count = n;
+    return true;
+}
+
+/*
+  find a variable or top level object by name using the name index
+ */
+AP_Param *AP_Param::find_in_index(const char *name, enum ap_var_type *ptype, bool object)
+{
+    if (_name_index == nullptr && !build_name_index()) {
+        return nullptr;
+    }
+
+    const uint32_t hash = name_hash(name);
+
+    // find the first entry with this hash
+    uint16_t lo = 0, hi = _name_index_count;
+    while (lo < hi) {
+        uint16_t mid = (lo + hi) / 2;
+        if (_name_index[mid].hash < hash) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    for (; lo < _name_index_count && _name_index[lo].hash == hash; lo++) {
+        const struct name_index_entry &e = _name_index[lo];
+        const struct Info &info = _var_info[e.key];
+        if (object) {
+            // top level groups and top level scalars
+            if (e.type != AP_PARAM_GROUP && info.type == AP_PARAM_GROUP) {
+                continue;
+            }
+            if (strcasecmp(name, info.name) != 0) {
+                continue;
+            }
+            ptrdiff_t base;
+            if (!get_base(info, base)) {
+                return nullptr;
+            }
+            return (AP_Param *)base;
+        }
+        if (e.type == AP_PARAM_GROUP) {
+            continue;
+        }
+        // match within the one top level variable the same way as
+        // the linear search, which also rejects hash collisions
+        if (info.type == AP_PARAM_GROUP) {
+            uint8_t len = strnlen(info.name, AP_MAX_NAME_SIZE);
+            if (strncmp(name, info.name, len) != 0) {
+                continue;
+            }
+            AP_Param *ap = find_group(name + len, e.key, 0, info.group_info, ptype);
+            if (ap != nullptr) {
+                return ap;
+            }
+        } else if (strcasecmp(name, info.name) == 0) {
+            ptrdiff_t base;
+            if (!get_base(info, base)) {
+                return nullptr;
+            }
+            *ptype = (enum ap_var_type)info.type;
+            return (AP_Param *)base;
+        }
+    }
+    return nullptr;
+}
+
+/*
+  discard the lookup index and cached parameter count
+ */
+void AP_Param::invalidate_index(void)
+{
+    free(_name_index);
+    _name_index = nullptr;
+    _name_index_count = 0;
+    free(_scalar_index);
+    _scalar_index = nullptr;
+    _parameter_count = 0;
+    _index_generation++;
+}
+
+/*
+  return the bits of a header, used as the storage map key
+ */
+uint32_t AP_Param::header_bits(const Param_header &phdr)
+{
+    uint32_t bits;
+    memcpy(&bits, &phdr, sizeof(bits));
+    return bits;
+}
+
+/*
+  find the storage offset of a variable in the storage map
+ */
+bool AP_Param::storage_map_find(const Param_header &phdr, uint16_t &ofs)
+{
+    const uint32_t header = header_bits(phdr);
+    uint16_t lo = 0, hi = _storage_map_count;
+    while (lo < hi) {
+        uint16_t mid = (lo + hi) / 2;
+        if (_storage_map[mid].header < header) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo < _storage_map_count && _storage_map[lo].header == header) {
+        ofs = _storage_map[lo].ofs;
+        return true;
+    }
+    return false;
+}
+
+/*
+  add a variable to the storage map. If the header is already in the
+  map the first copy is kept, as that is the one scan() would find
+ */
+void AP_Param::storage_map_add(const Param_header &phdr, uint16_t ofs)
+{
+    if (_storage_map == nullptr) {
+        return;
+    }
+    const uint32_t header = header_bits(phdr);
+    uint16_t lo = 0, hi = _storage_map_count;
+    while (lo < hi) {
+        uint16_t mid = (lo + hi) / 2;
+        if (_storage_map[mid].header < header) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo < _storage_map_count && _storage_map[lo].header == header) {
+        return;
+    }
+    if (_storage_map_count == _storage_map_size) {
+        struct storage_map_entry *new_map =
+            (struct storage_map_entry *)calloc(_storage_map_size * 2, sizeof(_storage_map[0]));
+        if (new_map == nullptr) {
+            // fall back to scanning storage
+            storage_map_free();
+            return;
+        }
+        memcpy(new_map, _storage_map, _storage_map_count * sizeof(_storage_map[0]));
+        free(_storage_map);
+        _storage_map = new_map;
+        _storage_map_size *= 2;
+    }
+    memmove(&_storage_map[lo+1], &_storage_map[lo], (_storage_map_count - lo) * sizeof(_storage_map[0]));
+    _storage_map[lo].header = header;
+    _storage_map[lo].ofs = ofs;
+    _storage_map_count++;
+}
+
+void AP_Param::storage_map_free(void)
+{
+    free(_storage_map);
+    _storage_map = nullptr;
+    _storage_map_count = 0;
+    _storage_map_size = 0;
+    _sentinal_ofs = 0;
+}
+
+/*
+  queue a write to storage. A write inside a region that is already
+  queued updates that region, so repeated saves of a variable only
+  write it once. Without a semaphore the write is done immediately
+ */
+void AP_Param::queue_write(uint16_t ofs, const void *data, uint8_t len)
+{
+    if (_write_sem == nullptr || len > sizeof(_write_queue[0].data)) {
+        eeprom_write_check(data, ofs, len);
+        return;
+    }
+    if (!_write_sem->take(HAL_SEMAPHORE_BLOCK_FOREVER)) {
+        eeprom_write_check(data, ofs, len);
+        return;
+    }
+
+    const uint16_t end = ofs + len;
+    uint8_t i = 0;
+    while (i < _write_queue_count) {
+        struct pending_write &w = _write_queue[i];
+        const uint16_t w_end = w.ofs + w.len;
+        if (ofs >= w.ofs && end <= w_end) {
+            // update the queued region in place
+            memcpy(&w.data[ofs - w.ofs], data, len);
+            _write_sem->give();
+            return;
+        }
+        if (w.ofs >= ofs && w_end <= end) {
+            // the queued region is completely overwritten
+            _write_queue[i] = _write_queue[--_write_queue_count];
+            continue;
+        }
+        if (w.ofs < end && ofs < w_end) {
+            // partial overlap, write out the queue first
+            flush_queue();
+            break;
+        }
+        i++;
+    }
+
+    if (_write_queue_count == _write_queue_len) {
+        flush_queue();
+    }
+    struct pending_write &w = _write_queue[_write_queue_count++];
+    w.ofs = ofs;
+    w.len = len;
+    memcpy(w.data, data, len);
+    _write_sem->give();
+
+    if (!_write_handler_registered) {
+        _write_handler_registered = true;
+        hal.scheduler->register_io_process(FUNCTOR_BIND((&save_dummy), &AP_Param::write_io_handler, void));
+    }
+}
+
+/*
+  write the queue to storage, merging adjacent regions into a single
+  write. Must be called with _write_sem held.
+
+  Regions are written from the end of storage backwards, so when new
+  variables are added the sentinal after them is written before their
+  headers
+ */
+void AP_Param::flush_queue(void)
+{
+    if (_write_queue_count == 0) {
+        return;
+    }
+    index_sort(_write_queue, _write_queue_count);
+
+    uint8_t buf[64];
+    int16_t i = _write_queue_count - 1;
+    while (i >= 0) {
+        uint16_t start = _write_queue[i].ofs;
+        const uint16_t end = start + _write_queue[i].len;
+        int16_t j = i;
+        while (j > 0 &&
+               _write_queue[j-1].ofs + _write_queue[j-1].len == start &&
+               (uint16_t)(end - _write_queue[j-1].ofs) <= sizeof(buf)) {
+            j--;
+            start = _write_queue[j].ofs;
+        }
+        for (int16_t k=j; k<=i; k++) {
+            memcpy(&buf[_write_queue[k].ofs - start], _write_queue[k].data, _write_queue[k].len);
+        }
+        eeprom_write_check(buf, start, end - start);
+        i = j - 1;
+    }
+    _write_queue_count = 0;
+}
+
+/*
+  write any queued saves to storage
+ */
+void AP_Param::flush(void)
+{
+    if (_write_sem == nullptr || _write_queue_count == 0) {
+        return;
+    }
+    if (!_write_sem->take(HAL_SEMAPHORE_BLOCK_FOREVER)) {
+        return;
+    }
+    flush_queue();
+    _write_sem->give();
+}
+
+// IO process that writes queued saves
+void AP_Param::write_io_handler(void)
+{
+    flush();
+}
+
 // notify GCS of current value of parameter
 void AP_Param::notify() const {
     uint32_t group_element = 0;
@@ -948,8 +1498,9 @@ bool AP_Param::save(bool force_save)
     }
 
     if (phdr.type == AP_PARAM_INT8 && ginfo != nullptr && (ginfo->flags & AP_PARAM_FLAG_ENABLE)) {
-        // clear cached parameter count
-        _parameter_count = 0;
+        // clear cached parameter count and index, as the set of
+        // visible parameters may have changed
+        invalidate_index();
     }
     
     char name[AP_MAX_NAME_SIZE+1];
@@ -959,7 +1510,7 @@ bool AP_Param::save(bool force_save)
     uint16_t ofs;
     if (scan(&phdr, &ofs)) {
         // found an existing copy of the variable
-        eeprom_write_check(ap, ofs+sizeof(phdr), type_size((enum ap_var_type)phdr.type));
+        queue_write(ofs+sizeof(phdr), ap, type_size((enum ap_var_type)phdr.type));
         send_parameter(name, (enum ap_var_type)phdr.type, idx);
         return true;
     }
@@ -996,10 +1547,19 @@ bool AP_Param::save(bool force_save)
         return false;
     }
 
-    // write a new sentinal, then the data, then the header
-    write_sentinal(ofs + sizeof(phdr) + type_size((enum ap_var_type)phdr.type));
-    eeprom_write_check(ap, ofs+sizeof(phdr), type_size((enum ap_var_type)phdr.type));
-    eeprom_write_check(&phdr, ofs, sizeof(phdr));
+    // write a new sentinal, then the header and data. The queue
+    // writes the sentinal out before the header
+    const uint8_t size = type_size((enum ap_var_type)phdr.type);
+    uint8_t buf[sizeof(phdr) + 3*sizeof(float)];
+    memcpy(buf, &phdr, sizeof(phdr));
+    memcpy(&buf[sizeof(phdr)], ap, size);
+    write_sentinal(ofs + sizeof(phdr) + size);
+    queue_write(ofs, buf, sizeof(phdr) + size);
+
+    if (_storage_map != nullptr) {
+        storage_map_add(phdr, ofs);
+        _sentinal_ofs = ofs + sizeof(phdr) + size;
+    }
 
     send_parameter(name, (enum ap_var_type)phdr.type, idx);
     return true;
@@ -1066,6 +1626,7 @@ bool AP_Param::load(void)
     }
 
     // found it
+    flush();
     _storage.read_block(ap, ofs+sizeof(phdr), type_size((enum ap_var_type)phdr.type));
     return true;
 }
@@ -1229,15 +1790,25 @@ bool AP_Param::load_all(void)
     }
 #endif
 
+    flush();
+
+    // rebuild the storage map as we go
+    storage_map_free();
+    _storage_map_size = 64;
+    _storage_map = (struct storage_map_entry *)calloc(_storage_map_size, sizeof(_storage_map[0]));
+
     while (ofs < _storage.size()) {
         _storage.read_block(&phdr, ofs, sizeof(phdr));
         // note that this is an || not an && for robustness
         // against power off while adding a variable
         if (is_sentinal(phdr)) {
             // we've reached the sentinal
+            _sentinal_ofs = ofs;
             return true;
         }
 
+        storage_map_add(phdr, ofs);
+
         const struct AP_Param::Info *info;
         void *ptr;
 
@@ -1250,6 +1821,7 @@ bool AP_Param::load_all(void)
     }
 
     // we didn't find the sentinal
+    storage_map_free();
     Debug("no sentinal in load_all");
     return false;
 }
@@ -1269,6 +1841,8 @@ void AP_Param::load_object_from_eeprom(const void *object_pointer, const struct
         hal.console->printf("ERROR: Unable to find param pointer\n");
         return;
     }
+
+    flush();
     
     for (uint8_t i=0; group_info[i].type != AP_PARAM_NONE; i++) {
         if (group_info[i].type == AP_PARAM_GROUP) {
@@ -1565,6 +2139,10 @@ void AP_Param::show_all(AP_HAL::BetterStream *port, bool showKeyValues)
 // convert one old vehicle parameter to new object parameter
 void AP_Param::convert_old_parameter(const struct ConversionInfo *info, float scaler)
 {
+    // the old value may still be in the write queue. scan() won't
+    // flush it when the storage map is in use
+    flush();
+
     // find the old value in EEPROM.
     uint16_t pofs;
     AP_Param::Param_header header;
@@ -1837,7 +2415,7 @@ void AP_Param::send_parameter(const char *name, enum ap_var_type var_type, uint8
 uint16_t AP_Param::count_parameters(void)
 {
     // if we haven't cached the parameter count yet...
-    if (0 == _parameter_count) {
+    if (0 == _parameter_count && !build_scalar_index()) {
         AP_Param  *vp;
         AP_Param::ParamToken token;
 
@@ -31,6 +31,13 @@
 
 #define AP_MAX_NAME_SIZE 16
 
+// index parameter names and parameter numbers for fast lookups. The
+// index takes about 20 bytes per parameter, so smaller boards use
+// the linear search
+#ifndef AP_PARAM_INDEX_ENABLED
+#define AP_PARAM_INDEX_ENABLED (HAL_CPU_CLASS >= HAL_CPU_CLASS_1000)
+#endif
+
 /*
   flags for variables in var_info and group tables
  */
@@ -93,6 +100,8 @@ enum ap_var_type {
 ///
 class AP_Param
 {
+    friend class AP_Param_Test;
+
 public:
     // the Info and GroupInfo structures are passed by the main
     // program in setup() to give information on how variables are
@@ -265,6 +274,13 @@ public:
     static bool load_all(void);
 
     static void load_object_from_eeprom(const void *object_pointer, const struct GroupInfo *group_info);
+
+    /// Write any saves still queued for storage
+    ///
+    /// save() queues its storage writes, which are written from
+    /// the IO thread. This writes them immediately.
+    ///
+    static void flush(void);
     
     // set a AP_Param variable to a specified value
     static void         set_value(enum ap_var_type type, void *ptr, float def_value);
@@ -346,7 +362,17 @@ public:
     // count of parameters in tree
     static uint16_t count_parameters(void);
 
-    static void set_hide_disabled_groups(bool value) { _hide_disabled_groups = value; }
+    static void set_hide_disabled_groups(bool value) {
+        _hide_disabled_groups = value;
+        invalidate_index();
+    }
+
+    // discard the lookup index, it is rebuilt on the next lookup
+    static void invalidate_index(void);
+
+    // changes whenever the index is discarded, so users that cache
+    // the parameter list can tell when it may have changed
+    static uint16_t index_generation(void) { return _index_generation; }
 
 private:
     /// EEPROM header
@@ -435,6 +461,24 @@ private:
                                     ptrdiff_t group_offset,
                                     const struct GroupInfo *group_info,
                                     enum ap_var_type *ptype);
+    static AP_Param *           find_by_token(
+                                    const ParamToken &token,
+                                    enum ap_var_type type);
+    bool                        in_pointer_group(void) const;
+    static uint32_t             name_hash(const char *name);
+    static bool                 build_name_index(void);
+    static bool                 build_scalar_index(void);
+    static uint32_t             header_bits(const Param_header &phdr);
+    static bool                 storage_map_find(const Param_header &phdr, uint16_t &ofs);
+    static void                 storage_map_add(const Param_header &phdr, uint16_t ofs);
+    static void                 storage_map_free(void);
+    static void                 queue_write(uint16_t ofs, const void *data, uint8_t len);
+    static void                 flush_queue(void);
+    void                        write_io_handler(void);
+    static AP_Param *           find_in_index(
+                                    const char *name,
+                                    enum ap_var_type *ptype,
+                                    bool object);
     static void                 write_sentinal(uint16_t ofs);
     static uint16_t             get_key(const Param_header &phdr);
     static void                 set_key(Param_header &phdr, uint16_t key);
@@ -497,6 +541,69 @@ private:
     static const uint8_t        k_EEPROM_revision    = 6; ///< current format revision
 
     static bool _hide_disabled_groups;
+
+    /*
+      lookup index, built on first use if AP_PARAM_INDEX_ENABLED. The
+      name index holds every name reachable with next() plus the top
+      level objects, sorted by name hash. The scalar index maps a
+      parameter index (as seen by the GCS) to its token. Only keys
+      and tokens are stored, pointers are resolved on each lookup so
+      pointer groups stay correct
+     */
+    struct name_index_entry {
+        uint32_t hash;
+        uint16_t key;
+        uint16_t order;
+        uint8_t type;
+
+        bool before(const name_index_entry &e) const {
+            return hash < e.hash || (hash == e.hash && order < e.order);
+        }
+    };
+    struct scalar_index_entry {
+        ParamToken token;
+        uint8_t type;
+    };
+    static struct name_index_entry *_name_index;
+    static uint16_t _name_index_count;
+    static struct scalar_index_entry *_scalar_index;
+    static bool _index_alloc_failed;
+    static uint16_t _index_generation;
+
+    /*
+      map from header to storage offset for every variable in
+      storage, sorted by header. It is built by load_all() and kept
+      up to date by save(), so save() and load() don't need to scan
+      storage. _storage_map is nullptr when there is no map
+     */
+    struct storage_map_entry {
+        uint32_t header;
+        uint16_t ofs;
+    };
+    static struct storage_map_entry *_storage_map;
+    static uint16_t _storage_map_count;
+    static uint16_t _storage_map_size;
+    static uint16_t _sentinal_ofs;
+
+    /*
+      queue of storage writes from save(). Writes to the same
+      variable are merged, and the queue is written as contiguous
+      blocks from the IO thread
+     */
+    struct pending_write {
+        uint16_t ofs;
+        uint8_t len;
+        uint8_t data[sizeof(Param_header) + 3*sizeof(float)];
+
+        bool before(const pending_write &w) const {
+            return ofs < w.ofs;
+        }
+    };
+    static const uint8_t _write_queue_len = 32;
+    static struct pending_write _write_queue[_write_queue_len];
+    static uint8_t _write_queue_count;
+    static AP_HAL::Semaphore *_write_sem;
+    static bool _write_handler_registered;
 };
 
 /// Template class for scalar variables.
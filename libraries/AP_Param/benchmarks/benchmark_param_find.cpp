@@ -0,0 +1,208 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_Param/AP_Param.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+/*
+ * A parameter tree the size of the ArduCopter one: 32 top level
+ * objects with about 32 scalars each, including an enable flag, a
+ * vector and a nested subgroup
+ */
+class BenchSubGroup
+{
+public:
+    static const struct AP_Param::GroupInfo var_info[];
+    AP_Float a;
+    AP_Float b;
+    AP_Int16 c;
+    AP_Int32 d;
+};
+
+const AP_Param::GroupInfo BenchSubGroup::var_info[] = {
+    AP_GROUPINFO("A", 0, BenchSubGroup, a, 0),
+    AP_GROUPINFO("B", 1, BenchSubGroup, b, 0),
+    AP_GROUPINFO("C", 2, BenchSubGroup, c, 0),
+    AP_GROUPINFO("D", 3, BenchSubGroup, d, 0),
+    AP_GROUPEND
+};
+
+class BenchGroup
+{
+public:
+    static const struct AP_Param::GroupInfo var_info[];
+    AP_Int8 enable;
+    AP_Float p[24];
+    AP_Vector3f offsets;
+    BenchSubGroup sub;
+};
+
+const AP_Param::GroupInfo BenchGroup::var_info[] = {
+    AP_GROUPINFO_FLAGS("ENABLE", 0, BenchGroup, enable, 1, AP_PARAM_FLAG_ENABLE),
+    AP_GROUPINFO("PARAM_00", 1, BenchGroup, p[0], 0),
+    AP_GROUPINFO("PARAM_01", 2, BenchGroup, p[1], 0),
+    AP_GROUPINFO("PARAM_02", 3, BenchGroup, p[2], 0),
+    AP_GROUPINFO("PARAM_03", 4, BenchGroup, p[3], 0),
+    AP_GROUPINFO("PARAM_04", 5, BenchGroup, p[4], 0),
+    AP_GROUPINFO("PARAM_05", 6, BenchGroup, p[5], 0),
+    AP_GROUPINFO("PARAM_06", 7, BenchGroup, p[6], 0),
+    AP_GROUPINFO("PARAM_07", 8, BenchGroup, p[7], 0),
+    AP_GROUPINFO("PARAM_08", 9, BenchGroup, p[8], 0),
+    AP_GROUPINFO("PARAM_09", 10, BenchGroup, p[9], 0),
+    AP_GROUPINFO("PARAM_10", 11, BenchGroup, p[10], 0),
+    AP_GROUPINFO("PARAM_11", 12, BenchGroup, p[11], 0),
+    AP_GROUPINFO("PARAM_12", 13, BenchGroup, p[12], 0),
+    AP_GROUPINFO("PARAM_13", 14, BenchGroup, p[13], 0),
+    AP_GROUPINFO("PARAM_14", 15, BenchGroup, p[14], 0),
+    AP_GROUPINFO("PARAM_15", 16, BenchGroup, p[15], 0),
+    AP_GROUPINFO("PARAM_16", 17, BenchGroup, p[16], 0),
+    AP_GROUPINFO("PARAM_17", 18, BenchGroup, p[17], 0),
+    AP_GROUPINFO("PARAM_18", 19, BenchGroup, p[18], 0),
+    AP_GROUPINFO("PARAM_19", 20, BenchGroup, p[19], 0),
+    AP_GROUPINFO("PARAM_20", 21, BenchGroup, p[20], 0),
+    AP_GROUPINFO("PARAM_21", 22, BenchGroup, p[21], 0),
+    AP_GROUPINFO("PARAM_22", 23, BenchGroup, p[22], 0),
+    AP_GROUPINFO("PARAM_23", 24, BenchGroup, p[23], 0),
+    AP_GROUPINFO("OFS", 25, BenchGroup, offsets, 0),
+    AP_SUBGROUPINFO(sub, "SUB_", 26, BenchGroup, BenchSubGroup),
+    AP_GROUPEND
+};
+
+static AP_Int8 format_version;
+static BenchGroup groups[32];
+
+#define BENCH_GROUP(n) { AP_PARAM_GROUP, "G" #n "_", n + 1, &groups[n], { group_info : BenchGroup::var_info }, 0 }
+
+static const AP_Param::Info var_info[] = {
+    { AP_PARAM_INT8, "FORMAT_VERSION", 0, &format_version, { def_value : 0 }, 0 },
+    BENCH_GROUP(0),
+    BENCH_GROUP(1),
+    BENCH_GROUP(2),
+    BENCH_GROUP(3),
+    BENCH_GROUP(4),
+    BENCH_GROUP(5),
+    BENCH_GROUP(6),
+    BENCH_GROUP(7),
+    BENCH_GROUP(8),
+    BENCH_GROUP(9),
+    BENCH_GROUP(10),
+    BENCH_GROUP(11),
+    BENCH_GROUP(12),
+    BENCH_GROUP(13),
+    BENCH_GROUP(14),
+    BENCH_GROUP(15),
+    BENCH_GROUP(16),
+    BENCH_GROUP(17),
+    BENCH_GROUP(18),
+    BENCH_GROUP(19),
+    BENCH_GROUP(20),
+    BENCH_GROUP(21),
+    BENCH_GROUP(22),
+    BENCH_GROUP(23),
+    BENCH_GROUP(24),
+    BENCH_GROUP(25),
+    BENCH_GROUP(26),
+    BENCH_GROUP(27),
+    BENCH_GROUP(28),
+    BENCH_GROUP(29),
+    BENCH_GROUP(30),
+    BENCH_GROUP(31),
+    AP_VAREND
+};
+
+static AP_Param param_loader(var_info);
+
+static const uint16_t max_names = 1200;
+static char names[max_names][AP_MAX_NAME_SIZE+1];
+static uint16_t num_names;
+
+/*
+ * collect the name of every scalar, in the order the GCS requests them
+ */
+static void collect_names()
+{
+    if (num_names != 0) {
+        return;
+    }
+    for (uint8_t i = 0; i < ARRAY_SIZE(groups); i++) {
+        groups[i].enable.set(1);
+    }
+    AP_Param::ParamToken token;
+    for (AP_Param *ap = AP_Param::first(&token, nullptr);
+         ap != nullptr && num_names < max_names;
+         ap = AP_Param::next_scalar(&token, nullptr)) {
+        ap->copy_name_token(token, names[num_names], sizeof(names[0]), true);
+        num_names++;
+    }
+}
+
+static void BM_ParamFind(benchmark::State& state)
+{
+    collect_names();
+    uint16_t i = 0;
+    while (state.KeepRunning()) {
+        enum ap_var_type ptype;
+        AP_Param *ap = AP_Param::find(names[i], &ptype);
+        gbenchmark_escape(ap);
+        i = (i + 1) % num_names;
+    }
+}
+
+static void BM_ParamFindByIndex(benchmark::State& state)
+{
+    collect_names();
+    uint16_t i = 0;
+    while (state.KeepRunning()) {
+        enum ap_var_type ptype;
+        AP_Param::ParamToken token;
+        AP_Param *ap = AP_Param::find_by_index(i, &ptype, &token);
+        gbenchmark_escape(ap);
+        i = (i + 1) % num_names;
+    }
+}
+
+/*
+ * the cost of finding a parameter by index without the index, as
+ * find_by_index() used to do
+ */
+static void BM_ParamWalkToIndex(benchmark::State& state)
+{
+    collect_names();
+    uint16_t i = 0;
+    while (state.KeepRunning()) {
+        AP_Param::ParamToken token;
+        AP_Param *ap = AP_Param::first(&token, nullptr);
+        for (uint16_t count = 0; ap != nullptr && count < i; count++) {
+            ap = AP_Param::next_scalar(&token, nullptr);
+        }
+        gbenchmark_escape(ap);
+        i = (i + 1) % num_names;
+    }
+}
+
+/*
+ * the one-off cost of building the index, paid on the first lookup
+ * and whenever an enable parameter changes
+ */
+static void BM_ParamIndexBuild(benchmark::State& state)
+{
+    collect_names();
+    while (state.KeepRunning()) {
+        AP_Param::invalidate_index();
+        enum ap_var_type ptype;
+        AP_Param *ap = AP_Param::find(names[0], &ptype);
+        gbenchmark_escape(ap);
+        uint16_t count = AP_Param::count_parameters();
+        gbenchmark_escape(&count);
+    }
+}
+
+BENCHMARK(BM_ParamFind);
+BENCHMARK(BM_ParamFindByIndex);
+BENCHMARK(BM_ParamWalkToIndex);
+BENCHMARK(BM_ParamIndexBuild);
+
+BENCHMARK_MAIN()
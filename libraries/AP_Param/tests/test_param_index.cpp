@@ -0,0 +1,247 @@
+#include <AP_gtest.h>
+
+#include <string>
+#include <vector>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_Param/AP_Param.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+class AP_Param_Test
+{
+public:
+    /* with the index disabled every lookup uses the linear search */
+    static void set_index_enabled(bool enabled)
+    {
+        AP_Param::_index_alloc_failed = !enabled;
+        AP_Param::invalidate_index();
+    }
+};
+
+class TestSubGroup
+{
+public:
+    static const struct AP_Param::GroupInfo var_info[];
+    AP_Float a;
+    AP_Int16 b;
+};
+
+const AP_Param::GroupInfo TestSubGroup::var_info[] = {
+    AP_GROUPINFO("A", 0, TestSubGroup, a, 0),
+    AP_GROUPINFO("B", 1, TestSubGroup, b, 0),
+    AP_GROUPEND
+};
+
+class TestGroup
+{
+public:
+    static const struct AP_Param::GroupInfo var_info[];
+    AP_Int8 enable;
+    AP_Float p[4];
+    AP_Int32 count;
+    AP_Vector3f offsets;
+    TestSubGroup sub;
+    TestSubGroup *ptr;
+};
+
+const AP_Param::GroupInfo TestGroup::var_info[] = {
+    AP_GROUPINFO_FLAGS("ENABLE", 0, TestGroup, enable, 1, AP_PARAM_FLAG_ENABLE),
+    AP_GROUPINFO("P0", 1, TestGroup, p[0], 0),
+    AP_GROUPINFO("P1", 2, TestGroup, p[1], 0),
+    AP_GROUPINFO("P2", 3, TestGroup, p[2], 0),
+    AP_GROUPINFO("P3", 4, TestGroup, p[3], 0),
+    AP_GROUPINFO("COUNT", 5, TestGroup, count, 0),
+    AP_GROUPINFO("OFS", 6, TestGroup, offsets, 0),
+    AP_SUBGROUPINFO(sub, "SUB_", 7, TestGroup, TestSubGroup),
+    AP_SUBGROUPPTR(ptr, "PTR_", 8, TestGroup, TestSubGroup),
+    AP_GROUPEND
+};
+
+static AP_Int8 format_version;
+static AP_Float g0_p0_alias;
+static AP_Vector3f trim;
+static TestGroup groups[6];
+static TestSubGroup ptr_sub;
+
+#define TEST_GROUP(n) { AP_PARAM_GROUP, "G" #n "_", n + 1, &groups[n], { group_info : TestGroup::var_info }, 0 }
+
+static const AP_Param::Info var_info[] = {
+    { AP_PARAM_INT8, "FORMAT_VERSION", 0, &format_version, { def_value : 0 }, 0 },
+    TEST_GROUP(0),
+    TEST_GROUP(1),
+    TEST_GROUP(2),
+    TEST_GROUP(3),
+    TEST_GROUP(4),
+    TEST_GROUP(5),
+    // a top level scalar with the prefix of a group
+    { AP_PARAM_FLOAT, "G0_P0X", 10, &g0_p0_alias, { def_value : 0 }, 0 },
+    { AP_PARAM_VECTOR3F, "TRIM", 11, &trim, { def_value : 0 }, 0 },
+    AP_VAREND
+};
+
+static AP_Param param_loader(var_info);
+
+struct lookup_result {
+    AP_Param *ap;
+    enum ap_var_type type;
+};
+
+static lookup_result lookup(const char *name)
+{
+    lookup_result r { nullptr, AP_PARAM_NONE };
+    r.ap = AP_Param::find(name, &r.type);
+    return r;
+}
+
+struct scalar_result {
+    AP_Param *ap;
+    enum ap_var_type type;
+    AP_Param::ParamToken token;
+};
+
+/*
+ * every name reachable with next() and next_scalar(), plus names
+ * that must not be found
+ */
+static std::vector<std::string> collect_names()
+{
+    std::vector<std::string> names;
+    AP_Param::ParamToken token;
+    enum ap_var_type type;
+    char name[AP_MAX_NAME_SIZE+1];
+    for (AP_Param *ap = AP_Param::first(&token, &type);
+         ap != nullptr;
+         ap = AP_Param::next(&token, &type)) {
+        ap->copy_name_token(token, name, sizeof(name), false);
+        name[AP_MAX_NAME_SIZE] = 0;
+        names.push_back(name);
+    }
+    for (AP_Param *ap = AP_Param::first(&token, &type);
+         ap != nullptr;
+         ap = AP_Param::next_scalar(&token, &type)) {
+        ap->copy_name_token(token, name, sizeof(name), true);
+        name[AP_MAX_NAME_SIZE] = 0;
+        names.push_back(name);
+    }
+    for (uint8_t i = 0; i < ARRAY_SIZE(var_info) - 1; i++) {
+        names.push_back(var_info[i].name);
+    }
+
+    // hidden, lower case and unknown names
+    names.push_back("G1_P0");
+    names.push_back("g0_p0");
+    names.push_back("G0_");
+    names.push_back("G0_P9");
+    names.push_back("G0_SUB_C");
+    names.push_back("TRIM_X");
+    names.push_back("NOT_A_PARAM");
+    names.push_back("");
+    return names;
+}
+
+static void check_index_matches_linear()
+{
+    const std::vector<std::string> names = collect_names();
+
+    AP_Param_Test::set_index_enabled(false);
+    const uint16_t linear_count = AP_Param::count_parameters();
+    std::vector<lookup_result> linear_find;
+    std::vector<AP_Param *> linear_object;
+    for (const std::string &name : names) {
+        linear_find.push_back(lookup(name.c_str()));
+        linear_object.push_back(AP_Param::find_object(name.c_str()));
+    }
+    std::vector<scalar_result> linear_scalar;
+    for (uint16_t i = 0; i <= linear_count; i++) {
+        scalar_result r { nullptr, AP_PARAM_NONE, {} };
+        r.ap = AP_Param::find_by_index(i, &r.type, &r.token);
+        linear_scalar.push_back(r);
+    }
+
+    AP_Param_Test::set_index_enabled(true);
+    EXPECT_EQ(linear_count, AP_Param::count_parameters());
+    for (uint16_t i = 0; i < names.size(); i++) {
+        const lookup_result r = lookup(names[i].c_str());
+        EXPECT_EQ(linear_find[i].ap, r.ap) << "find " << names[i];
+        if (r.ap != nullptr) {
+            EXPECT_EQ(linear_find[i].type, r.type) << "find " << names[i];
+        }
+        EXPECT_EQ(linear_object[i], AP_Param::find_object(names[i].c_str())) << "find_object " << names[i];
+    }
+    for (uint16_t i = 0; i <= linear_count; i++) {
+        scalar_result r { nullptr, AP_PARAM_NONE, {} };
+        r.ap = AP_Param::find_by_index(i, &r.type, &r.token);
+        EXPECT_EQ(linear_scalar[i].ap, r.ap) << "index " << i;
+        if (r.ap == nullptr) {
+            continue;
+        }
+        EXPECT_EQ(linear_scalar[i].type, r.type) << "index " << i;
+        EXPECT_EQ(linear_scalar[i].token.key, r.token.key) << "index " << i;
+        EXPECT_EQ(linear_scalar[i].token.group_element, r.token.group_element) << "index " << i;
+        EXPECT_EQ(linear_scalar[i].token.idx, r.token.idx) << "index " << i;
+    }
+}
+
+TEST(AP_Param, index_matches_linear_lookup)
+{
+    for (uint8_t i = 0; i < ARRAY_SIZE(groups); i++) {
+        groups[i].enable.set(i != 1);
+    }
+    groups[2].ptr = &ptr_sub;
+    check_index_matches_linear();
+
+    // the same with disabled groups visible
+    AP_Param::set_hide_disabled_groups(false);
+    check_index_matches_linear();
+    AP_Param::set_hide_disabled_groups(true);
+
+    groups[2].ptr = nullptr;
+    AP_Param::invalidate_index();
+}
+
+TEST(AP_Param, index_finds_pointer_group_allocated_later)
+{
+    for (uint8_t i = 0; i < ARRAY_SIZE(groups); i++) {
+        groups[i].enable.set(1);
+    }
+    AP_Param_Test::set_index_enabled(true);
+
+    const uint16_t count = AP_Param::count_parameters();
+    enum ap_var_type type;
+    EXPECT_TRUE(AP_Param::find("G3_PTR_A", &type) == nullptr);
+
+    groups[3].ptr = &ptr_sub;
+    EXPECT_EQ((AP_Param *)&ptr_sub.a, AP_Param::find("G3_PTR_A", &type));
+    EXPECT_EQ(AP_PARAM_FLOAT, type);
+    EXPECT_EQ(count + 2, AP_Param::count_parameters());
+
+    groups[3].ptr = nullptr;
+    AP_Param::invalidate_index();
+    EXPECT_EQ(count, AP_Param::count_parameters());
+}
+
+TEST(AP_Param, lookups_keep_index)
+{
+    for (uint8_t i = 0; i < ARRAY_SIZE(groups); i++) {
+        groups[i].enable.set(i != 1);
+    }
+    AP_Param_Test::set_index_enabled(true);
+
+    // a parameter under a disabled group, and names that only match
+    // without regard to case
+    const char *names[] = { "G1_P0", "G1_SUB_A", "G0_p0", "G0_ofs", "G0_SUB_a" };
+    enum ap_var_type type;
+    EXPECT_TRUE(AP_Param::find("G0_P0", &type) != nullptr);
+    for (const char *name : names) {
+        const uint16_t generation = AP_Param::index_generation();
+        AP_Param *ap = AP_Param::find(name, &type);
+        EXPECT_TRUE(ap != nullptr) << name;
+        EXPECT_EQ(ap, AP_Param::find(name, &type)) << name;
+        EXPECT_EQ(generation, AP_Param::index_generation()) << name;
+    }
+}
+
+AP_GTEST_MAIN()
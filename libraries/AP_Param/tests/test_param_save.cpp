@@ -0,0 +1,232 @@
+#include <AP_gtest.h>
+
+#include <vector>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_Param/AP_Param.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+class AP_Param_Test
+{
+public:
+    /*
+     * write saves straight to storage without the storage map, as
+     * save() did before writes were queued
+     */
+    static void set_direct_writes(bool direct)
+    {
+        if (direct) {
+            if (AP_Param::_write_sem != nullptr) {
+                _sem = AP_Param::_write_sem;
+            }
+            AP_Param::_write_sem = nullptr;
+        } else if (AP_Param::_write_sem == nullptr) {
+            if (_sem == nullptr) {
+                _sem = hal.util->new_semaphore();
+            }
+            AP_Param::_write_sem = _sem;
+        }
+    }
+
+    static void free_storage_map()
+    {
+        AP_Param::storage_map_free();
+    }
+
+    static uint8_t queued_writes()
+    {
+        return AP_Param::_write_queue_count;
+    }
+
+    static uint16_t storage_size()
+    {
+        return AP_Param::_storage.size();
+    }
+
+    static void read_storage(uint8_t *buf, uint16_t len)
+    {
+        AP_Param::_storage.read_block(buf, 0, len);
+    }
+
+private:
+    static AP_HAL::Semaphore *_sem;
+};
+
+AP_HAL::Semaphore *AP_Param_Test::_sem;
+
+class TestGroup
+{
+public:
+    static const struct AP_Param::GroupInfo var_info[];
+    AP_Int8 i8;
+    AP_Int16 i16;
+    AP_Int32 i32;
+    AP_Float f[8];
+    AP_Vector3f v;
+};
+
+const AP_Param::GroupInfo TestGroup::var_info[] = {
+    AP_GROUPINFO("I8", 0, TestGroup, i8, 1),
+    AP_GROUPINFO("I16", 1, TestGroup, i16, 0),
+    AP_GROUPINFO("I32", 2, TestGroup, i32, 100),
+    AP_GROUPINFO("F0", 3, TestGroup, f[0], 0.5f),
+    AP_GROUPINFO("F1", 4, TestGroup, f[1], 0),
+    AP_GROUPINFO("F2", 5, TestGroup, f[2], 0),
+    AP_GROUPINFO("F3", 6, TestGroup, f[3], 0),
+    AP_GROUPINFO("F4", 7, TestGroup, f[4], 0),
+    AP_GROUPINFO("F5", 8, TestGroup, f[5], 0),
+    AP_GROUPINFO("F6", 9, TestGroup, f[6], 0),
+    AP_GROUPINFO("F7", 10, TestGroup, f[7], 0),
+    AP_GROUPINFO("V", 11, TestGroup, v, 0),
+    AP_GROUPEND
+};
+
+static AP_Int8 format_version;
+static AP_Float old_value;
+static AP_Float new_value;
+static TestGroup groups[4];
+
+#define TEST_GROUP(n) { AP_PARAM_GROUP, "G" #n "_", n + 1, &groups[n], { group_info : TestGroup::var_info }, 0 }
+
+static const AP_Param::Info var_info[] = {
+    { AP_PARAM_INT8, "FORMAT_VERSION", 0, &format_version, { def_value : 0 }, 0 },
+    TEST_GROUP(0),
+    TEST_GROUP(1),
+    TEST_GROUP(2),
+    TEST_GROUP(3),
+    { AP_PARAM_FLOAT, "OLD_VALUE", 10, &old_value, { def_value : 0 }, 0 },
+    { AP_PARAM_FLOAT, "NEW_VALUE", 11, &new_value, { def_value : 0 }, 0 },
+    AP_VAREND
+};
+
+static AP_Param param_loader(var_info);
+
+static const uint16_t num_saves = 3000;
+
+/* values include the defaults, which save() doesn't store */
+static const float save_values[] = { 0, 1, -1, 0.5f, 2.25f, 100, -7, 31 };
+
+/* the same pseudo random sequence on every run */
+static uint32_t next_random(uint32_t &state)
+{
+    state = state * 1103515245U + 12345U;
+    return state >> 16;
+}
+
+static void reset_defaults()
+{
+    AP_Param::setup_sketch_defaults();
+    for (uint8_t i = 0; i < ARRAY_SIZE(groups); i++) {
+        AP_Param::setup_object_defaults(&groups[i], TestGroup::var_info);
+        groups[i].v.set(Vector3f());
+    }
+}
+
+/*
+ * start from empty storage and save random parameters, then return
+ * the storage image
+ */
+static std::vector<uint8_t> run_saves(uint32_t seed, bool direct)
+{
+    reset_defaults();
+    AP_Param_Test::set_direct_writes(direct);
+    AP_Param::erase_all();
+    AP_Param::load_all();
+    if (direct) {
+        AP_Param_Test::free_storage_map();
+    }
+
+    const uint16_t count = AP_Param::count_parameters();
+    EXPECT_GT(count, 0);
+
+    uint32_t state = seed;
+    for (uint16_t i = 0; i < num_saves; i++) {
+        enum ap_var_type type;
+        AP_Param::ParamToken token;
+        AP_Param *vp = AP_Param::find_by_index(next_random(state) % count, &type, &token);
+        if (vp == nullptr) {
+            ADD_FAILURE() << "no parameter at index";
+            break;
+        }
+        AP_Param::set_value(type, vp, save_values[next_random(state) % ARRAY_SIZE(save_values)]);
+        EXPECT_TRUE(vp->save());
+
+        switch (next_random(state) % 64) {
+        case 0:
+            AP_Param::flush();
+            break;
+        case 1: {
+            // read the value back, which has to see queued writes
+            const float value = vp->cast_to_float(type);
+            AP_Param::set_value(type, vp, 99);
+            vp->load();
+            EXPECT_FLOAT_EQ(value, vp->cast_to_float(type));
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    AP_Param::flush();
+    EXPECT_EQ(0, AP_Param_Test::queued_writes());
+
+    std::vector<uint8_t> image(AP_Param_Test::storage_size());
+    AP_Param_Test::read_storage(image.data(), image.size());
+    return image;
+}
+
+TEST(AP_Param, queued_saves_match_direct_writes)
+{
+    for (uint32_t seed = 1; seed <= 4; seed++) {
+        const std::vector<uint8_t> direct = run_saves(seed, true);
+        const std::vector<uint8_t> queued = run_saves(seed, false);
+        ASSERT_EQ(direct.size(), queued.size());
+        EXPECT_EQ(0, memcmp(direct.data(), queued.data(), direct.size())) << "seed " << seed;
+    }
+}
+
+TEST(AP_Param, queued_saves_load_back)
+{
+    run_saves(5, false);
+
+    std::vector<float> values;
+    enum ap_var_type type;
+    AP_Param::ParamToken token;
+    for (AP_Param *vp = AP_Param::first(&token, &type);
+         vp != nullptr;
+         vp = AP_Param::next_scalar(&token, &type)) {
+        values.push_back(vp->cast_to_float(type));
+    }
+
+    reset_defaults();
+    AP_Param_Test::set_direct_writes(false);
+    EXPECT_TRUE(AP_Param::load_all());
+
+    uint16_t i = 0;
+    for (AP_Param *vp = AP_Param::first(&token, &type);
+         vp != nullptr && i < values.size();
+         vp = AP_Param::next_scalar(&token, &type), i++) {
+        EXPECT_FLOAT_EQ(values[i], vp->cast_to_float(type)) << "index " << i;
+    }
+    EXPECT_EQ(values.size(), i);
+}
+
+TEST(AP_Param, convert_queued_old_parameter)
+{
+    reset_defaults();
+    AP_Param_Test::set_direct_writes(false);
+    AP_Param::erase_all();
+    AP_Param::load_all();
+
+    old_value.set_and_save(3.5f);
+    ASSERT_GT(AP_Param_Test::queued_writes(), 0);
+
+    const AP_Param::ConversionInfo info = { 10, 0, AP_PARAM_FLOAT, "NEW_VALUE" };
+    AP_Param::convert_old_parameter(&info, 1.0f);
+    EXPECT_FLOAT_EQ(3.5f, new_value.get());
+}
+
+AP_GTEST_MAIN()
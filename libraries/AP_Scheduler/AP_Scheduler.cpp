@@ -21,6 +21,7 @@
 #include "AP_Scheduler.h"
 
 #include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
 #include <AP_Param/AP_Param.h>
 #include <AP_Vehicle/AP_Vehicle.h>
 #include <stdio.h>
@@ -51,6 +52,13 @@ const AP_Param::GroupInfo AP_Scheduler::var_info[] = {
     // @User: Advanced
     AP_GROUPINFO("LOOP_RATE",  1, AP_Scheduler, _loop_rate_hz, SCHEDULER_DEFAULT_LOOP_RATE),
 
+    // @Param: EDF
+    // @DisplayName: Earliest deadline first scheduling
+    // @Description: When enabled the scheduler runs due tasks in order of their deadline instead of scanning the whole task table each tick. A task that doesn't fit in the remaining time is kept at the front for the next tick while later tasks that do fit still run.
+    // @Values: 0:Disabled,1:Enabled
+    // @User: Advanced
+    AP_GROUPINFO("EDF",  2, AP_Scheduler, _edf, 0),
+
     AP_GROUPEND
 };
 
@@ -76,6 +84,23 @@ void AP_Scheduler::init(const AP_Scheduler::Task *tasks, uint8_t num_tasks)
     _last_run = new uint16_t[_num_tasks];
     memset(_last_run, 0, sizeof(_last_run[0]) * _num_tasks);
     _tick_counter = 0;
+
+    _interval_ticks = new uint16_t[_num_tasks];
+    for (uint8_t i=0; i<_num_tasks; i++) {
+        uint16_t interval_ticks = _loop_rate_hz / _tasks[i].rate_hz;
+        if (interval_ticks < 1) {
+            interval_ticks = 1;
+        }
+        _interval_ticks[i] = interval_ticks;
+    }
+
+    _task_stats = new struct task_stats[_num_tasks];
+    reset_task_stats();
+
+    _edf_heap = new uint8_t[_num_tasks];
+    _edf_deferred = new uint8_t[_num_tasks];
+    _edf_heap_size = 0;
+    _edf_active = false;
 }
 
 // one tick has passed
@@ -84,15 +109,17 @@ void AP_Scheduler::tick(void)
     _tick_counter++;
 }
 
+void AP_Scheduler::reset_task_stats(void)
+{
+    memset(_task_stats, 0, sizeof(_task_stats[0]) * _num_tasks);
+}
+
 /*
   run one tick
   this will run as many scheduler tasks as we can in the specified time
  */
 void AP_Scheduler::run(uint32_t time_available)
 {
-    uint32_t run_started_usec = AP_HAL::micros();
-    uint32_t now = run_started_usec;
-
     if (_debug > 3 && _perf_counters == nullptr) {
         _perf_counters = new AP_HAL::Util::perf_counter_t[_num_tasks];
         if (_perf_counters != nullptr) {
@@ -101,64 +128,43 @@ void AP_Scheduler::run(uint32_t time_available)
             }
         }
     }
-    
+
+    if (_edf) {
+        if (!_edf_active) {
+            // the heap is not maintained by the linear scan
+            edf_rebuild();
+            _edf_active = true;
+        }
+        run_edf(time_available);
+    } else {
+        _edf_active = false;
+        run_linear(time_available);
+    }
+}
+
+/*
+  scan the whole task table, running each task that is due and fits
+ */
+void AP_Scheduler::run_linear(uint32_t time_available)
+{
+    uint32_t now = AP_HAL::micros();
+
     for (uint8_t i=0; i<_num_tasks; i++) {
         uint16_t dt = _tick_counter - _last_run[i];
-        uint16_t interval_ticks = _loop_rate_hz / _tasks[i].rate_hz;
-        if (interval_ticks < 1) {
-            interval_ticks = 1;
-        }
-        if (dt >= interval_ticks) {
+        if (dt >= _interval_ticks[i]) {
             // this task is due to run. Do we have enough time to run it?
             _task_time_allowed = _tasks[i].max_time_micros;
 
-            if (dt >= interval_ticks*2) {
-                // we've slipped a whole run of this task!
-                if (_debug > 1) {
-                    ::printf("Scheduler slip task[%u-%s] (%u/%u/%u)\n",
-                             (unsigned)i,
-                             _tasks[i].name,
-                             (unsigned)dt,
-                             (unsigned)interval_ticks,
-                             (unsigned)_task_time_allowed);
-                }
-            }
+            check_slip(i, dt);
 
             if (_task_time_allowed <= time_available) {
-                // run it
-                _task_time_started = now;
-                current_task = i;
-                if (_debug > 3 && _perf_counters && _perf_counters[i]) {
-                    hal.util->perf_begin(_perf_counters[i]);
-                }
-                _tasks[i].function();
-                if (_debug > 3 && _perf_counters && _perf_counters[i]) {
-                    hal.util->perf_end(_perf_counters[i]);
-                }
-                current_task = -1;
-
-                // record the tick counter when we ran. This drives
-                // when we next run the event
-                _last_run[i] = _tick_counter;
-
-                // work out how long the event actually took
-                now = AP_HAL::micros();
-                uint32_t time_taken = now - _task_time_started;
-
-                if (time_taken > _task_time_allowed) {
-                    // the event overran!
-                    if (_debug > 4) {
-                        ::printf("Scheduler overrun task[%u-%s] (%u/%u)\n",
-                                 (unsigned)i,
-                                 _tasks[i].name,
-                                 (unsigned)time_taken,
-                                 (unsigned)_task_time_allowed);
-                    }
-                }
+                uint32_t time_taken = run_task(i, now);
                 if (time_taken >= time_available) {
                     goto update_spare_ticks;
                 }
                 time_available -= time_taken;
+            } else {
+                _task_stats[i].skips++;
             }
         }
     }
@@ -174,6 +180,179 @@ update_spare_ticks:
     }
 }
 
+/*
+  run due tasks in order of their deadline. Only the tasks that are due
+  are visited. A task which does not fit in the remaining time keeps its
+  deadline so it is first in line on the next tick
+ */
+void AP_Scheduler::run_edf(uint32_t time_available)
+{
+    uint32_t now = AP_HAL::micros();
+    uint8_t num_deferred = 0;
+    bool out_of_time = false;
+
+    while (_edf_heap_size > 0) {
+        const uint8_t i = _edf_heap[0];
+        const uint16_t dt = _tick_counter - _last_run[i];
+        if (dt < _interval_ticks[i]) {
+            // nothing else is due this tick
+            break;
+        }
+        edf_pop();
+
+        _task_time_allowed = _tasks[i].max_time_micros;
+
+        check_slip(i, dt);
+
+        if (_task_time_allowed > time_available) {
+            _task_stats[i].skips++;
+            _edf_deferred[num_deferred++] = i;
+            continue;
+        }
+
+        uint32_t time_taken = run_task(i, now);
+        edf_push(i);
+        if (time_taken >= time_available) {
+            out_of_time = true;
+            break;
+        }
+        time_available -= time_taken;
+    }
+
+    for (uint8_t n=0; n<num_deferred; n++) {
+        edf_push(_edf_deferred[n]);
+    }
+
+    if (!out_of_time) {
+        // update number of spare microseconds
+        _spare_micros += time_available;
+    }
+
+    _spare_ticks++;
+    if (_spare_ticks == 32) {
+        _spare_ticks /= 2;
+        _spare_micros /= 2;
+    }
+}
+
+void AP_Scheduler::check_slip(uint8_t i, uint16_t dt)
+{
+    if (dt >= _interval_ticks[i]*2) {
+        // we've slipped a whole run of this task!
+        _task_stats[i].slips++;
+        if (_debug > 1) {
+            ::printf("Scheduler slip task[%u-%s] (%u/%u/%u)\n",
+                     (unsigned)i,
+                     _tasks[i].name,
+                     (unsigned)dt,
+                     (unsigned)_interval_ticks[i],
+                     (unsigned)_task_time_allowed);
+        }
+    }
+}
+
+uint32_t AP_Scheduler::run_task(uint8_t i, uint32_t &now)
+{
+    // run it
+    _task_time_started = now;
+    current_task = i;
+    if (_debug > 3 && _perf_counters && _perf_counters[i]) {
+        hal.util->perf_begin(_perf_counters[i]);
+    }
+    _tasks[i].function();
+    if (_debug > 3 && _perf_counters && _perf_counters[i]) {
+        hal.util->perf_end(_perf_counters[i]);
+    }
+    current_task = -1;
+
+    // record the tick counter when we ran. This drives
+    // when we next run the event
+    _last_run[i] = _tick_counter;
+
+    // work out how long the event actually took
+    now = AP_HAL::micros();
+    uint32_t time_taken = now - _task_time_started;
+
+    struct task_stats &stats = _task_stats[i];
+    stats.runs++;
+    stats.total_time_us += time_taken;
+    if (time_taken > stats.max_time_us) {
+        stats.max_time_us = MIN(time_taken, (uint32_t)UINT16_MAX);
+    }
+
+    if (time_taken > _task_time_allowed) {
+        // the event overran!
+        stats.overruns++;
+        if (_debug > 4) {
+            ::printf("Scheduler overrun task[%u-%s] (%u/%u)\n",
+                     (unsigned)i,
+                     _tasks[i].name,
+                     (unsigned)time_taken,
+                     (unsigned)_task_time_allowed);
+        }
+    }
+
+    return time_taken;
+}
+
+/*
+  return true if task a should run before task b. Deadlines are
+  compared as a signed difference so wrap of the tick counter is handled
+ */
+bool AP_Scheduler::edf_before(uint8_t a, uint8_t b) const
+{
+    const int16_t diff = (int16_t)(next_due(a) - next_due(b));
+    if (diff != 0) {
+        return diff < 0;
+    }
+    return a < b;
+}
+
+void AP_Scheduler::edf_push(uint8_t i)
+{
+    uint8_t pos = _edf_heap_size++;
+    while (pos > 0) {
+        const uint8_t parent = (pos - 1) / 2;
+        if (!edf_before(i, _edf_heap[parent])) {
+            break;
+        }
+        _edf_heap[pos] = _edf_heap[parent];
+        pos = parent;
+    }
+    _edf_heap[pos] = i;
+}
+
+uint8_t AP_Scheduler::edf_pop(void)
+{
+    const uint8_t ret = _edf_heap[0];
+    const uint8_t last = _edf_heap[--_edf_heap_size];
+    uint8_t pos = 0;
+    while (true) {
+        uint8_t child = 2*pos + 1;
+        if (child >= _edf_heap_size) {
+            break;
+        }
+        if (child+1 < _edf_heap_size && edf_before(_edf_heap[child+1], _edf_heap[child])) {
+            child++;
+        }
+        if (!edf_before(_edf_heap[child], last)) {
+            break;
+        }
+        _edf_heap[pos] = _edf_heap[child];
+        pos = child;
+    }
+    _edf_heap[pos] = last;
+    return ret;
+}
+
+void AP_Scheduler::edf_rebuild(void)
+{
+    _edf_heap_size = 0;
+    for (uint8_t i=0; i<_num_tasks; i++) {
+        edf_push(i);
+    }
+}
+
 /*
   return number of micros until the current task reaches its deadline
  */
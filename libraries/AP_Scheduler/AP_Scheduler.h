@@ -89,6 +89,24 @@ public:
     uint16_t get_loop_rate_hz(void) const {
         return _loop_rate_hz;
     }
+
+    /*
+      per-task statistics, accumulated since the last call to
+      reset_task_stats()
+     */
+    struct task_stats {
+        uint16_t runs;          // number of times the task ran
+        uint16_t overruns;      // runs that took longer than max_time_micros
+        uint16_t slips;         // ticks the task was a whole run late
+        uint16_t skips;         // ticks the task was due but didn't fit
+        uint16_t max_time_us;   // longest run
+        uint32_t total_time_us; // sum of all runs
+    };
+
+    uint8_t get_num_tasks(void) const { return _num_tasks; }
+    const char *get_task_name(uint8_t i) const { return _tasks[i].name; }
+    const struct task_stats &get_task_stats(uint8_t i) const { return _task_stats[i]; }
+    void reset_task_stats(void);
     
     static const struct AP_Param::GroupInfo var_info[];
 
@@ -101,6 +119,9 @@ private:
 
     // overall scheduling rate in Hz
     AP_Int16 _loop_rate_hz;  // The value of this variable can be changed with the non-initialization. (Ex. Tuning by GDB)
+
+    // use earliest-deadline-first ordering of tasks
+    AP_Int8 _edf;
     
     // progmem list of tasks to run
     const struct Task *_tasks;
@@ -115,6 +136,23 @@ private:
     // tick counter at the time we last ran each task
     uint16_t *_last_run;
 
+    // number of ticks between runs of each task
+    uint16_t *_interval_ticks;
+
+    // statistics for each task
+    struct task_stats *_task_stats;
+
+    /*
+      binary min-heap of task indexes ordered by the tick each task is
+      next due, with ties broken by position in the task table
+     */
+    uint8_t *_edf_heap;
+    uint8_t _edf_heap_size;
+    bool _edf_active;
+
+    // tasks that were due but did not fit in the current run
+    uint8_t *_edf_deferred;
+
     // number of microseconds allowed for the current task
     uint32_t _task_time_allowed;
 
@@ -129,4 +167,21 @@ private:
 
     // performance counters
     AP_HAL::Util::perf_counter_t *_perf_counters;
+
+    void run_linear(uint32_t time_available);
+    void run_edf(uint32_t time_available);
+
+    // run one task, returning the time it took in microseconds
+    uint32_t run_task(uint8_t i, uint32_t &now);
+
+    // check if a due task has slipped a whole run
+    void check_slip(uint8_t i, uint16_t dt);
+
+    uint16_t next_due(uint8_t i) const {
+        return _last_run[i] + _interval_ticks[i];
+    }
+    bool edf_before(uint8_t a, uint8_t b) const;
+    void edf_push(uint8_t i);
+    uint8_t edf_pop(void);
+    void edf_rebuild(void);
 };
@@ -44,12 +44,30 @@ const AP_Param::GroupInfo AP_Terrain::var_info[] = {
 
     // @Param: SPACING
     // @DisplayName: Terrain grid spacing
-    // @Description: Distance between terrain grid points in meters. This controls the horizontal resolution of the terrain data that is stored on te SD card and requested from the ground station. If your GCS is using the worldwide SRTM database then a resolution of 100 meters is appropriate. Some parts of the world may have higher resolution data available, such as 30 meter data available in the SRTM database in the USA. The grid spacing also controls how much data is kept in memory during flight. A larger grid spacing will allow for a larger amount of data in memory. A grid spacing of 100 meters results in the vehicle keeping 12 grid squares in memory with each grid square having a size of 2.7 kilometers by 3.2 kilometers. Any additional grid squares are stored on the SD once they are fetched from the GCS and will be demand loaded as needed.
+    // @Description: Distance between terrain grid points in meters. This controls the horizontal resolution of the terrain data that is stored on te SD card and requested from the ground station. If your GCS is using the worldwide SRTM database then a resolution of 100 meters is appropriate. Some parts of the world may have higher resolution data available, such as 30 meter data available in the SRTM database in the USA. The grid spacing also controls how much data is kept in memory during flight. A larger grid spacing will allow for a larger amount of data in memory. With a grid spacing of 100 meters each grid square held in memory has a size of 2.7 kilometers by 3.2 kilometers. The number of grid squares kept in memory is set by TERRAIN_CACHE_SZ. Any additional grid squares are stored on the SD once they are fetched from the GCS and will be demand loaded as needed.
     // @Units: meters
     // @Increment: 1
     // @User: Advanced
     AP_GROUPINFO("SPACING",   1, AP_Terrain, grid_spacing, 100),
 
+    // @Param: CACHE_SZ
+    // @DisplayName: Terrain cache size
+    // @Description: Number of terrain grid blocks kept in memory. Each block uses a little over 2 kilobytes of memory and covers 28 by 32 grid points. A larger cache reduces the number of reads from the SD card while flying. Changes take effect on the next reboot.
+    // @Range: 4 2048
+    // @Increment: 1
+    // @RebootRequired: True
+    // @User: Advanced
+    AP_GROUPINFO("CACHE_SZ",  2, AP_Terrain, cache_blocks, TERRAIN_GRID_BLOCK_CACHE_SIZE),
+
+    // @Param: PREFETCH
+    // @DisplayName: Terrain prefetch time
+    // @Description: Number of seconds of flight ahead of the vehicle for which terrain data is loaded into memory. Data is loaded along the velocity vector and along the current mission legs. A value of zero disables prefetching. Each pass replaces at most a quarter of TERRAIN_CACHE_SZ, so prefetching is off by default on boards with a small cache.
+    // @Units: seconds
+    // @Range: 0 120
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("PREFETCH",  3, AP_Terrain, prefetch_time, TERRAIN_PREFETCH_DEFAULT),
+
     AP_GROUPEND
 };
 
@@ -73,6 +91,9 @@ AP_Terrain::AP_Terrain(AP_AHRS &_ahrs, const AP_Mission &_mission, const AP_Rall
     memset(&home_loc, 0, sizeof(home_loc));
     memset(&disk_block, 0, sizeof(disk_block));
     memset(last_request_time_ms, 0, sizeof(last_request_time_ms));
+    memset(&stats, 0, sizeof(stats));
+    memset(&next_wp, 0, sizeof(next_wp));
+    next_wp.nav_index = AP_MISSION_CMD_INDEX_NONE;
 }
 
 /*
@@ -106,7 +127,13 @@ bool AP_Terrain::height_amsl(const Location &loc, float &height, bool corrected)
     calculate_grid_info(loc, info);
 
     // find the grid
-    const struct grid_block &grid = find_grid_cache(info).grid;
+    const struct grid_cache &gcache = find_grid_cache(info);
+    const struct grid_block &grid = gcache.grid;
+
+    if (gcache.state == GRID_CACHE_DISKWAIT) {
+        // the block is still being read from disk
+        stats.stalls++;
+    }
 
     /*
       note that we rely on the one square overlap to ensure these
@@ -157,6 +184,160 @@ bool AP_Terrain::height_amsl(const Location &loc, float &height, bool corrected)
 }
 
 
+/*
+  find the terrain heights in meters above sea level for an array of
+  locations
+
+  The grid lookup is shared between consecutive locations in the same
+  grid block, and the interpolation is done on TERRAIN_BATCH_SIZE
+  locations at a time from flat arrays so the compiler can vectorise
+  it
+ */
+uint16_t AP_Terrain::height_amsl_batch(const Location *locs, uint16_t count,
+                                       float *heights, bool *valid, bool corrected)
+{
+    if (!enable || !allocate()) {
+        memset(valid, 0, count * sizeof(valid[0]));
+        return 0;
+    }
+
+    // heights of the 4 surrounding grid points and the fractions
+    // within the grid square for each location in a batch
+    float h00[TERRAIN_BATCH_SIZE], h01[TERRAIN_BATCH_SIZE];
+    float h10[TERRAIN_BATCH_SIZE], h11[TERRAIN_BATCH_SIZE];
+    float frac_x[TERRAIN_BATCH_SIZE], frac_y[TERRAIN_BATCH_SIZE];
+
+    const struct grid_cache *gcache = nullptr;
+    struct grid_info info, last_info {};
+    uint16_t num_valid = 0;
+
+    for (uint16_t base=0; base<count; base += TERRAIN_BATCH_SIZE) {
+        uint8_t n = MIN(count - base, TERRAIN_BATCH_SIZE);
+
+        // gather the grid points for this batch
+        for (uint8_t i=0; i<n; i++) {
+            const Location &loc = locs[base+i];
+            bool &ok = valid[base+i];
+
+            if ((loc.lat == home_loc.lat && loc.lng == home_loc.lng) ||
+                (loc.lat == ahrs.get_home().lat && loc.lng == ahrs.get_home().lng)) {
+                // home is handled by height_amsl(), which also keeps
+                // home_height up to date. The result is passed
+                // through the interpolation unchanged
+                float height = 0;
+                ok = height_amsl(loc, height, false);
+                h00[i] = h01[i] = h10[i] = h11[i] = height;
+                frac_x[i] = frac_y[i] = 0;
+                gcache = nullptr;
+                continue;
+            }
+
+            calculate_grid_index(loc, info);
+            if (gcache == nullptr ||
+                info.lat_degrees != last_info.lat_degrees ||
+                info.lon_degrees != last_info.lon_degrees ||
+                info.grid_idx_x != last_info.grid_idx_x ||
+                info.grid_idx_y != last_info.grid_idx_y) {
+                calculate_grid_corner(info);
+                gcache = &find_grid_cache(info);
+                if (gcache->state == GRID_CACHE_DISKWAIT) {
+                    stats.stalls++;
+                }
+                last_info = info;
+            }
+            const struct grid_block &grid = gcache->grid;
+
+            ok = check_bitmap(grid, info.idx_x,   info.idx_y) &&
+                 check_bitmap(grid, info.idx_x,   info.idx_y+1) &&
+                 check_bitmap(grid, info.idx_x+1, info.idx_y) &&
+                 check_bitmap(grid, info.idx_x+1, info.idx_y+1);
+            if (!ok) {
+                h00[i] = h01[i] = h10[i] = h11[i] = 0;
+                frac_x[i] = frac_y[i] = 0;
+                continue;
+            }
+            h00[i] = grid.height[info.idx_x+0][info.idx_y+0];
+            h01[i] = grid.height[info.idx_x+0][info.idx_y+1];
+            h10[i] = grid.height[info.idx_x+1][info.idx_y+0];
+            h11[i] = grid.height[info.idx_x+1][info.idx_y+1];
+            frac_x[i] = info.frac_x;
+            frac_y[i] = info.frac_y;
+        }
+
+        // dual linear interpolation, the same as height_amsl()
+        float *out = &heights[base];
+        for (uint8_t i=0; i<n; i++) {
+            float avg1 = (1.0f-frac_x[i]) * h00[i] + frac_x[i] * h10[i];
+            float avg2 = (1.0f-frac_x[i]) * h01[i] + frac_x[i] * h11[i];
+            out[i]     = (1.0f-frac_y[i]) * avg1   + frac_y[i] * avg2;
+        }
+
+        for (uint8_t i=0; i<n; i++) {
+            if (valid[base+i]) {
+                num_valid++;
+            }
+        }
+    }
+
+    // apply correction which assumes home altitude is at terrain altitude
+    if (corrected) {
+        float correction = (ahrs.get_home().alt * 0.01f) - home_height;
+        for (uint16_t i=0; i<count; i++) {
+            heights[i] += correction;
+        }
+    }
+
+    return num_valid;
+}
+
+/*
+  find the terrain heights in meters above sea level every spacing
+  meters along a polyline
+ */
+uint16_t AP_Terrain::height_amsl_polyline(const Location *vertices, uint8_t num_vertices, float spacing,
+                                          float *heights, bool *valid, uint16_t max_points, bool corrected)
+{
+    if (num_vertices == 0 || max_points == 0 || spacing <= 0) {
+        return 0;
+    }
+
+    Location locs[TERRAIN_BATCH_SIZE];
+    uint8_t n = 0;
+    uint16_t num_points = 0;
+
+    // distance along the current leg of the next sample
+    float next_dist = 0;
+
+    for (uint8_t v=0; v+1<num_vertices && num_points+n < max_points; v++) {
+        const Location &from = vertices[v];
+        Vector2f leg = location_diff(from, vertices[v+1]);
+        float leg_length = leg.length();
+        for (; next_dist < leg_length && num_points+n < max_points; next_dist += spacing) {
+            Location &loc = locs[n++];
+            loc = from;
+            location_offset(loc, leg.x * next_dist / leg_length, leg.y * next_dist / leg_length);
+            if (n == TERRAIN_BATCH_SIZE) {
+                height_amsl_batch(locs, n, &heights[num_points], &valid[num_points], corrected);
+                num_points += n;
+                n = 0;
+            }
+        }
+        next_dist -= leg_length;
+    }
+
+    // always finish on the last vertex
+    if (num_points+n < max_points) {
+        locs[n++] = vertices[num_vertices-1];
+    }
+    if (n > 0) {
+        height_amsl_batch(locs, n, &heights[num_points], &valid[num_points], corrected);
+        num_points += n;
+    }
+
+    return num_points;
+}
+
+
 /* 
    find difference between home terrain height and the terrain
    height at the current location in meters. A positive result
@@ -281,16 +462,25 @@ float AP_Terrain::lookahead(float bearing, float distance, float climb_ratio)
     float climb = 0;
     float lookahead_estimate = 0;
 
-    // check for terrain at grid spacing intervals
+    // check for terrain at grid spacing intervals, a batch at a time
+    Location locs[TERRAIN_BATCH_SIZE];
+    float heights[TERRAIN_BATCH_SIZE];
+    bool valid[TERRAIN_BATCH_SIZE];
     while (distance > 0) {
-        location_update(loc, bearing, grid_spacing);
-        climb += climb_ratio * grid_spacing;
-        distance -= grid_spacing;
-        float height;
-        if (height_amsl(loc, height, false)) {
-            float rise = (height - base_height) - climb;
-            if (rise > lookahead_estimate) {
-                lookahead_estimate = rise;
+        uint8_t n = 0;
+        while (distance > 0 && n < TERRAIN_BATCH_SIZE) {
+            location_update(loc, bearing, grid_spacing);
+            distance -= grid_spacing;
+            locs[n++] = loc;
+        }
+        height_amsl_batch(locs, n, heights, valid, false);
+        for (uint8_t i=0; i<n; i++) {
+            climb += climb_ratio * grid_spacing;
+            if (valid[i]) {
+                float rise = (heights[i] - base_height) - climb;
+                if (rise > lookahead_estimate) {
+                    lookahead_estimate = rise;
+                }
             }
         }
     }
@@ -328,6 +518,9 @@ void AP_Terrain::update(void)
     // check for pending rally data
     update_rally_data();
 
+    // load grids ahead of the vehicle
+    update_prefetch();
+
     // update capabilities and status
     if (enable) {
         hal.util->set_capabilities(MAV_PROTOCOL_CAPABILITY_TERRAIN);
@@ -381,6 +574,19 @@ void AP_Terrain::log_terrain_data(DataFlash_Class &dataflash)
         loaded         : loaded
     };
     dataflash.WriteBlock(&pkt, sizeof(pkt));
+
+    struct log_TERRAIN_CACHE pkt2 = {
+        LOG_PACKET_HEADER_INIT(LOG_TERRAIN_CACHE_MSG),
+        time_us        : AP_HAL::micros64(),
+        size           : cache_size,
+        hits           : stats.hits,
+        misses         : stats.misses,
+        stalls         : stats.stalls,
+        prefetches     : stats.prefetches,
+        reads          : stats.reads,
+        writes         : stats.writes
+    };
+    dataflash.WriteBlock(&pkt2, sizeof(pkt2));
 }
 
 /*
@@ -395,13 +601,29 @@ bool AP_Terrain::allocate(void)
     if (cache != nullptr) {
         return true;
     }
-    cache = (struct grid_cache *)calloc(TERRAIN_GRID_BLOCK_CACHE_SIZE, sizeof(cache[0]));
-    if (cache == nullptr) {
+    uint16_t num_blocks = constrain_int16(cache_blocks, TERRAIN_GRID_BLOCK_CACHE_MIN, TERRAIN_GRID_BLOCK_CACHE_MAX);
+
+    // the hash index is kept at most half full to keep probe
+    // sequences short
+    uint16_t index_size = 1;
+    while (index_size < 2*num_blocks) {
+        index_size <<= 1;
+    }
+
+    cache = (struct grid_cache *)calloc(num_blocks, sizeof(cache[0]));
+    cache_index = (uint16_t *)malloc(index_size * sizeof(cache_index[0]));
+    if (cache == nullptr || cache_index == nullptr) {
+        free(cache);
+        free(cache_index);
+        cache = nullptr;
+        cache_index = nullptr;
         enable.set(0);
         GCS_MAVLINK::send_statustext_all(MAV_SEVERITY_CRITICAL, "Terrain: Allocation failed");
         return false;
     }
-    cache_size = TERRAIN_GRID_BLOCK_CACHE_SIZE;
+    memset(cache_index, 0xFF, index_size * sizeof(cache_index[0]));
+    cache_index_mask = index_size - 1;
+    cache_size = num_blocks;
     return true;
 }
 
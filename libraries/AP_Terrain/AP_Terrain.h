@@ -52,12 +52,52 @@
 #define TERRAIN_GRID_BLOCK_SIZE_X (TERRAIN_GRID_MAVLINK_SIZE*TERRAIN_GRID_BLOCK_MUL_X)
 #define TERRAIN_GRID_BLOCK_SIZE_Y (TERRAIN_GRID_MAVLINK_SIZE*TERRAIN_GRID_BLOCK_MUL_Y)
 
-// number of grid_blocks in the LRU memory cache
+// default number of grid_blocks in the LRU memory cache. Boards with
+// megabytes of memory keep a much larger cache, so that a whole flight
+// area can stay in memory
+#if HAL_CPU_CLASS >= HAL_CPU_CLASS_1000
+#define TERRAIN_GRID_BLOCK_CACHE_SIZE 256
+#else
 #define TERRAIN_GRID_BLOCK_CACHE_SIZE 12
+#endif
+
+// default TERRAIN_PREFETCH time. A 12 block cache only just covers the
+// area around the vehicle, so prefetching is opt-in on smaller boards
+#if HAL_CPU_CLASS >= HAL_CPU_CLASS_1000
+#define TERRAIN_PREFETCH_DEFAULT 30
+#else
+#define TERRAIN_PREFETCH_DEFAULT 0
+#endif
+
+// number of mission commands after the current nav command searched
+// for the next waypoint, and how many of those are read from storage
+// in one prefetch pass
+#define TERRAIN_PREFETCH_CMD_SEARCH 5
+#define TERRAIN_PREFETCH_CMD_READS  2
+
+// limits on the TERRAIN_CACHE_SZ parameter
+#define TERRAIN_GRID_BLOCK_CACHE_MIN 4
+#define TERRAIN_GRID_BLOCK_CACHE_MAX 2048
+
+// marker for an empty slot in the cache hash index
+#define TERRAIN_CACHE_INDEX_EMPTY 0xFFFF
+
+// on Linux the degree files are memory mapped for reading, which
+// replaces the seek/read per block with a copy from the page
+// cache. Blocks are written with pwrite() and synced when the file is
+// switched
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL
+#define TERRAIN_USE_MMAP 1
+#else
+#define TERRAIN_USE_MMAP 0
+#endif
 
 // format of grid on disk
 #define TERRAIN_GRID_FORMAT_VERSION 1
 
+// number of locations interpolated together by height_amsl_batch()
+#define TERRAIN_BATCH_SIZE 16
+
 #if TERRAIN_DEBUG
 #define ASSERT_RANGE(v,minv,maxv) assert((v)<=(maxv)&&(v)>=(minv))
 #else
@@ -76,6 +116,8 @@
 
 class AP_Terrain
 {
+    friend class AP_Terrain_Bench;
+
 public:
     AP_Terrain(AP_AHRS &_ahrs, const AP_Mission &_mission, const AP_Rally &_rally);
 
@@ -113,6 +155,28 @@ public:
      */
     bool height_amsl(const Location &loc, float &height, bool corrected);
 
+    /*
+      find the terrain heights in meters above sea level for an array
+      of locations. valid[i] is set to show if heights[i] is
+      available. Neighbouring locations that fall in the same grid
+      block share one grid lookup, so this is much cheaper than
+      calling height_amsl() for each location
+
+      returns the number of valid heights
+     */
+    uint16_t height_amsl_batch(const Location *locs, uint16_t count,
+                               float *heights, bool *valid, bool corrected);
+
+    /*
+      find the terrain heights in meters above sea level every spacing
+      meters along a polyline, starting at the first vertex and ending
+      at the last one. At most max_points heights are filled in
+
+      returns the number of points sampled
+     */
+    uint16_t height_amsl_polyline(const Location *vertices, uint8_t num_vertices, float spacing,
+                                  float *heights, bool *valid, uint16_t max_points, bool corrected);
+
     /* 
        find difference between home terrain height and the terrain
        height at the current location in meters. A positive result
@@ -174,6 +238,19 @@ public:
      */
     void get_statistics(uint16_t &pending, uint16_t &loaded);
 
+    /*
+      grid cache performance counters, since boot
+     */
+    struct cache_stats {
+        uint32_t hits;       // lookups satisfied from the cache
+        uint32_t misses;     // lookups that needed a new cache block
+        uint32_t stalls;     // height lookups blocked on a disk read
+        uint32_t prefetches; // blocks loaded ahead of the vehicle
+        uint32_t reads;      // completed disk reads
+        uint32_t writes;     // completed disk writes
+    };
+    const struct cache_stats &get_cache_stats(void) const { return stats; }
+
 private:
     // allocate the terrain subsystem data
     bool allocate(void);
@@ -272,11 +349,29 @@ private:
     // given a location, fill a grid_info structure
     void calculate_grid_info(const Location &loc, struct grid_info &info) const;
 
+    // the two halves of calculate_grid_info(). The grid SW corner
+    // only needs calculating when the grid indices change
+    void calculate_grid_index(const Location &loc, struct grid_info &info) const;
+    void calculate_grid_corner(struct grid_info &info) const;
+
     /*
       find a grid structure given a grid_info
     */
     struct grid_cache &find_grid_cache(const struct grid_info &info);
 
+    /*
+      replace the least recently used cache block with the grid in info
+     */
+    struct grid_cache &load_grid_cache(const struct grid_info &info);
+
+    /*
+      hash index over the cache, keyed by grid SW corner
+     */
+    uint16_t cache_index_hash(int32_t lat, int32_t lon) const;
+    int16_t cache_index_find(int32_t lat, int32_t lon, uint16_t spacing) const;
+    void cache_index_insert(uint16_t cache_idx);
+    void cache_index_remove(uint16_t cache_idx);
+
     /*
       calculate bit number in grid_block bitmap. This corresponds to a
       bit representing a 4x4 mavlink transmitted block
@@ -314,9 +409,14 @@ private:
     void check_disk_write(void);
     void io_timer(void);
     void open_file(void);
+    uint32_t block_file_offset(void);
     void seek_offset(void);
     void write_block(void);
     void read_block(void);
+#if TERRAIN_USE_MMAP
+    void unmap_file(void);
+    bool map_file(void);
+#endif
 
     /*
       check for missing mission terrain data
@@ -328,10 +428,21 @@ private:
      */
     void update_rally_data(void);
 
+    /*
+      load grids ahead of the vehicle along its velocity vector and
+      the current mission legs
+     */
+    void update_prefetch(void);
+    void prefetch_location(const Location &loc, uint16_t &budget);
+    void prefetch_leg(const Location &from, const Location &to, float &distance, uint16_t &budget);
+    bool prefetch_next_waypoint(Location &loc);
+
 
     // parameters
     AP_Int8  enable;
     AP_Int16 grid_spacing; // meters between grid points
+    AP_Int16 cache_blocks; // number of grid blocks to keep in memory
+    AP_Int8  prefetch_time; // seconds of flight to load ahead
 
     // reference to AHRS, so we can ask for our position,
     // heading and speed
@@ -346,9 +457,27 @@ private:
     const AP_Rally &rally;
 
     // cache of grids in memory, LRU
-    uint8_t cache_size = 0;
+    uint16_t cache_size = 0;
     struct grid_cache *cache = nullptr;
 
+    // open addressed hash index of cache blocks, with linear
+    // probing. The size is a power of 2 at least twice cache_size
+    uint16_t *cache_index = nullptr;
+    uint16_t cache_index_mask = 0;
+
+    struct cache_stats stats;
+
+    // search for the waypoint after the current nav command, spread
+    // over several prefetch passes to limit mission storage reads
+    struct {
+        uint16_t nav_index;
+        uint16_t cmd_index;
+        uint32_t mission_change_ms;
+        Location loc;
+        bool found:1;
+        bool done:1;
+    } next_wp;
+
     // a grid_cache block waiting for disk IO
     enum DiskIoState {
         DiskIoIdle      = 0,
@@ -368,6 +497,15 @@ private:
     // open file handle on degree file
     int fd;
 
+#if TERRAIN_USE_MMAP
+    // read only mapping of the open degree file, owned by the IO
+    // thread. file_size is kept up to date as blocks are written
+    uint8_t *file_map = nullptr;
+    uint32_t file_map_size = 0;
+    uint32_t file_size = 0;
+    bool file_map_failed = false;
+#endif
+
     // has the timer been setup?
     bool timer_setup;
 
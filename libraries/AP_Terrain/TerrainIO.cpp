@@ -32,6 +32,9 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <errno.h>
+#if TERRAIN_USE_MMAP
+#include <sys/mman.h>
+#endif
 
 extern const AP_HAL::HAL& hal;
 
@@ -74,17 +77,12 @@ void AP_Terrain::schedule_disk_io(void)
 
     if (!timer_setup) {
         timer_setup = true;
-        hal.scheduler->register_io_process(FUNCTOR_BIND_MEMBER(&AP_Terrain::io_timer, void));
+        hal.scheduler->register_io_process(FUNCTOR_BIND_MEMBER(&AP_Terrain::io_timer, void), "terrain");
     }
 
     switch (disk_io_state) {
     case DiskIoIdle:
-        // look for a block that needs reading or writing
-        check_disk_read();
-        if (disk_io_state == DiskIoIdle) {
-            // still idle, check for writes
-            check_disk_write();            
-        }
+        // look for new IO below
         break;
         
     case DiskIoDoneRead: {
@@ -98,6 +96,7 @@ void AP_Terrain::schedule_disk_io(void)
             cache[cache_idx].state = GRID_CACHE_VALID;
             cache[cache_idx].last_access_ms = AP_HAL::millis();
         }
+        stats.reads++;
         disk_io_state = DiskIoIdle;
         break;
     }
@@ -111,6 +110,7 @@ void AP_Terrain::schedule_disk_io(void)
                 cache[cache_idx].state = GRID_CACHE_VALID;
             }
         }
+        stats.writes++;
         disk_io_state = DiskIoIdle;
         break;
     }
@@ -120,6 +120,17 @@ void AP_Terrain::schedule_disk_io(void)
         // waiting for io_timer()
         break;
     }
+
+    if (disk_io_state == DiskIoIdle) {
+        // look for a block that needs reading or writing. This is
+        // done straight after completing an IO so the IO thread gets
+        // the next block without waiting for another call
+        check_disk_read();
+        if (disk_io_state == DiskIoIdle) {
+            // still idle, check for writes
+            check_disk_write();            
+        }
+    }
 }
 
 
@@ -183,6 +194,13 @@ void AP_Terrain::open_file(void)
         *p = '/';
     }
 
+#if TERRAIN_USE_MMAP
+    unmap_file();
+    if (fd != -1) {
+        // blocks are not synced as they are written
+        ::fsync(fd);
+    }
+#endif
     if (fd != -1) {
         ::close(fd);
     }
@@ -195,15 +213,23 @@ void AP_Terrain::open_file(void)
         io_failure = true;
         return;
     }
+#if TERRAIN_USE_MMAP
+    struct stat st;
+    if (::fstat(fd, &st) == 0) {
+        file_size = st.st_size;
+    } else {
+        file_map_failed = true;
+    }
+#endif
 
     file_lat_degrees = block.lat_degrees;
     file_lon_degrees = block.lon_degrees;
 }
 
 /*
-  seek to the right offset for disk_block
+  get the offset of disk_block within its degree file
  */
-void AP_Terrain::seek_offset(void)
+uint32_t AP_Terrain::block_file_offset(void)
 {
     struct grid_block &block = disk_block.block;
     // work out how many longitude blocks there are at this latitude
@@ -218,8 +244,67 @@ void AP_Terrain::seek_offset(void)
     Vector2f offset = location_diff(loc1, loc2);
     uint16_t east_blocks = offset.y / (grid_spacing*TERRAIN_GRID_BLOCK_SIZE_Y);
 
-    uint32_t file_offset = (east_blocks * block.grid_idx_x + 
-                            block.grid_idx_y) * sizeof(union grid_io_block);
+    return (east_blocks * block.grid_idx_x + 
+            block.grid_idx_y) * sizeof(union grid_io_block);
+}
+
+#if TERRAIN_USE_MMAP
+/*
+  drop the mapping of the current degree file
+ */
+void AP_Terrain::unmap_file(void)
+{
+    if (file_map != nullptr) {
+        ::munmap(file_map, file_map_size);
+        file_map = nullptr;
+    }
+    file_map_size = 0;
+    file_size = 0;
+    file_map_failed = false;
+}
+
+/*
+  map the current degree file for reading, remapping it if blocks
+  have been written past the end of the mapping. On failure we fall
+  back to normal file IO for this file
+ */
+bool AP_Terrain::map_file(void)
+{
+    if (file_map_failed) {
+        return false;
+    }
+    if (file_map != nullptr && file_map_size == file_size) {
+        return true;
+    }
+    if (file_map != nullptr) {
+        ::munmap(file_map, file_map_size);
+        file_map = nullptr;
+        file_map_size = 0;
+    }
+    if (file_size == 0) {
+        // nothing on disk yet
+        return false;
+    }
+    void *p = ::mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+#if TERRAIN_DEBUG
+        hal.console->printf("mmap %s failed - %s\n", file_path, strerror(errno));
+#endif
+        file_map_failed = true;
+        return false;
+    }
+    file_map = (uint8_t *)p;
+    file_map_size = file_size;
+    return true;
+}
+#endif // TERRAIN_USE_MMAP
+
+/*
+  seek to the right offset for disk_block
+ */
+void AP_Terrain::seek_offset(void)
+{
+    uint32_t file_offset = block_file_offset();
     if (::lseek(fd, file_offset, SEEK_SET) != (off_t)file_offset) {
 #if TERRAIN_DEBUG
         hal.console->printf("Seek %lu failed - %s\n",
@@ -236,13 +321,32 @@ void AP_Terrain::seek_offset(void)
  */
 void AP_Terrain::write_block(void)
 {
+    disk_block.block.crc = get_block_crc(disk_block.block);
+
+#if TERRAIN_USE_MMAP
+    /*
+      write through the file rather than the mapping, so a full or
+      failing card gives an IO failure rather than a SIGBUS. The page
+      cache keeps the mapping up to date
+     */
+    uint32_t file_offset = block_file_offset();
+    if (::pwrite(fd, &disk_block, sizeof(disk_block), file_offset) != sizeof(disk_block)) {
+#if TERRAIN_DEBUG
+        hal.console->printf("write failed - %s\n", strerror(errno));
+#endif
+        unmap_file();
+        ::close(fd);
+        fd = -1;
+        io_failure = true;
+    } else {
+        file_size = MAX(file_size, file_offset + sizeof(disk_block));
+    }
+#else
     seek_offset();
     if (io_failure) {
         return;
     }
 
-    disk_block.block.crc = get_block_crc(disk_block.block);
-
     ssize_t ret = ::write(fd, &disk_block, sizeof(disk_block));
     if (ret  != sizeof(disk_block)) {
 #if TERRAIN_DEBUG
@@ -261,6 +365,7 @@ void AP_Terrain::write_block(void)
                (unsigned long long)disk_block.block.bitmap);
 #endif
     }
+#endif // TERRAIN_USE_MMAP
     disk_io_state = DiskIoDoneWrite;
 }
 
@@ -269,14 +374,33 @@ void AP_Terrain::write_block(void)
  */
 void AP_Terrain::read_block(void)
 {
-    seek_offset();
-    if (io_failure) {
-        return;
-    }
     int32_t lat = disk_block.block.lat;
     int32_t lon = disk_block.block.lon;
+    ssize_t ret;
+
+#if TERRAIN_USE_MMAP
+    uint32_t file_offset = block_file_offset();
+    if (file_offset + sizeof(disk_block) > file_size && !file_map_failed) {
+        // past the end of the file, so not on disk yet
+        ret = 0;
+    } else if (map_file()) {
+        if (file_offset + sizeof(disk_block) <= file_map_size) {
+            memcpy(&disk_block, &file_map[file_offset], sizeof(disk_block));
+            ret = sizeof(disk_block);
+        } else {
+            // past the end of the file, so not on disk yet
+            ret = 0;
+        }
+    } else
+#endif
+    {
+        seek_offset();
+        if (io_failure) {
+            return;
+        }
+        ret = ::read(fd, &disk_block, sizeof(disk_block));
+    }
 
-    ssize_t ret = ::read(fd, &disk_block, sizeof(disk_block));
     if (ret != sizeof(disk_block) || 
         disk_block.block.lat != lat || 
         disk_block.block.lon != lon ||
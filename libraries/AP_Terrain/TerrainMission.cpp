@@ -157,4 +157,159 @@ void AP_Terrain::update_rally_data(void)
     }
 }
 
+/*
+  make sure the grid holding a location is in the cache, loading it if
+  we have some budget left. Grids already in the cache are marked as
+  recently used so the LRU keeps them
+ */
+void AP_Terrain::prefetch_location(const Location &loc, uint16_t &budget)
+{
+    struct grid_info info;
+    calculate_grid_info(loc, info);
+
+    int16_t i = cache_index_find(info.grid_lat, info.grid_lon, grid_spacing);
+    if (i != -1) {
+        cache[i].last_access_ms = AP_HAL::millis();
+        return;
+    }
+    if (budget == 0) {
+        return;
+    }
+    budget--;
+    stats.prefetches++;
+    load_grid_cache(info);
+}
+
+/*
+  prefetch grids along a path leg, using up to distance meters of the
+  lookahead
+ */
+void AP_Terrain::prefetch_leg(const Location &from, const Location &to, float &distance, uint16_t &budget)
+{
+    // step at half the smaller side of a grid block, so no block
+    // along the leg is skipped
+    const float step = 0.5f * TERRAIN_GRID_BLOCK_SPACING_X * grid_spacing;
+    float leg_length = get_distance(from, to);
+    if (leg_length < step) {
+        prefetch_location(to, budget);
+        distance -= leg_length;
+        return;
+    }
+    float bearing = get_bearing_cd(from, to) * 0.01f;
+    Location loc = from;
+    for (float d = step; d < leg_length && distance > 0; d += step) {
+        location_update(loc, bearing, step);
+        distance -= step;
+        prefetch_location(loc, budget);
+    }
+    if (distance > 0) {
+        prefetch_location(to, budget);
+    }
+}
+
+/*
+  find the waypoint after the current nav command. At most
+  TERRAIN_PREFETCH_CMD_READS commands are read from storage per call,
+  and the result is kept until the nav command or the mission changes
+ */
+bool AP_Terrain::prefetch_next_waypoint(Location &loc)
+{
+    const uint16_t nav_index = mission.get_current_nav_index();
+    if (nav_index == AP_MISSION_CMD_INDEX_NONE) {
+        return false;
+    }
+    if (nav_index != next_wp.nav_index ||
+        mission.last_change_time_ms() != next_wp.mission_change_ms) {
+        next_wp.nav_index = nav_index;
+        next_wp.cmd_index = nav_index;
+        next_wp.mission_change_ms = mission.last_change_time_ms();
+        next_wp.found = false;
+        next_wp.done = false;
+    }
+
+    for (uint8_t i=0; i<TERRAIN_PREFETCH_CMD_READS && !next_wp.done; i++) {
+        AP_Mission::Mission_Command cmd;
+        next_wp.cmd_index++;
+        if (next_wp.cmd_index - nav_index > TERRAIN_PREFETCH_CMD_SEARCH ||
+            !mission.read_cmd_from_storage(next_wp.cmd_index, cmd)) {
+            next_wp.done = true;
+            break;
+        }
+        if ((cmd.id == MAV_CMD_NAV_WAYPOINT ||
+             cmd.id == MAV_CMD_NAV_SPLINE_WAYPOINT) &&
+            (cmd.content.location.lat != 0 || cmd.content.location.lng != 0)) {
+            next_wp.loc = cmd.content.location;
+            next_wp.found = true;
+            next_wp.done = true;
+        }
+    }
+
+    if (next_wp.found) {
+        loc = next_wp.loc;
+    }
+    return next_wp.found;
+}
+
+/*
+  load grids the vehicle is about to fly over. Disk reads for these
+  are scheduled straight away, and missing data is requested from the
+  GCS by send_request() once the disk read has completed
+ */
+void AP_Terrain::update_prefetch(void)
+{
+    if (prefetch_time <= 0 || grid_spacing <= 0 || !allocate()) {
+        return;
+    }
+
+    Location loc;
+    if (!ahrs.get_position(loc)) {
+        return;
+    }
+
+    Vector3f vel;
+    float speed = 0;
+    if (ahrs.get_velocity_NED(vel)) {
+        speed = norm(vel.x, vel.y);
+    }
+
+    // don't let the prefetch push out more than a quarter of the
+    // cache in one pass, so the blocks around the vehicle survive
+    const uint16_t max_budget = MAX(cache_size / 4, 1);
+    uint16_t budget = max_budget;
+
+    // look at least one grid block ahead, even when hovering
+    float min_lookahead = TERRAIN_GRID_BLOCK_SPACING_X * grid_spacing;
+    float lookahead = MAX(speed * prefetch_time, min_lookahead);
+
+    // the current and next mission legs come first, as that is
+    // where we are going
+    if (mission.state() == AP_Mission::MISSION_RUNNING) {
+        float distance = lookahead;
+        const AP_Mission::Mission_Command &nav_cmd = mission.get_current_nav_cmd();
+        const Location &to = nav_cmd.content.location;
+        if (to.lat != 0 || to.lng != 0) {
+            prefetch_leg(loc, to, distance, budget);
+            Location next;
+            if (distance > 0 && prefetch_next_waypoint(next)) {
+                prefetch_leg(to, next, distance, budget);
+            }
+        }
+    }
+
+    // then along the velocity vector
+    if (speed > 1) {
+        const float step = 0.5f * TERRAIN_GRID_BLOCK_SPACING_X * grid_spacing;
+        for (float d = step; d <= lookahead; d += step) {
+            Location loc2 = loc;
+            location_offset(loc2, vel.x * d / speed, vel.y * d / speed);
+            prefetch_location(loc2, budget);
+        }
+    }
+
+    if (budget != max_budget) {
+        // new blocks to read
+        schedule_disk_io();
+    }
+}
+
 #endif // AP_TERRAIN_AVAILABLE
@@ -65,6 +65,16 @@ bool AP_Terrain::check_bitmap(const struct grid_block &grid, uint8_t idx_x, uint
   grid indices
 */
 void AP_Terrain::calculate_grid_info(const Location &loc, struct grid_info &info) const
+{
+    calculate_grid_index(loc, info);
+    calculate_grid_corner(info);
+}
+
+/*
+  given a location, calculate the grid indices and fractions. This
+  leaves grid_lat and grid_lon unset
+*/
+void AP_Terrain::calculate_grid_index(const Location &loc, struct grid_info &info) const
 {
     // grids start on integer degrees. This makes storing terrain data
     // on the SD card a bit easier
@@ -97,43 +107,141 @@ void AP_Terrain::calculate_grid_info(const Location &loc, struct grid_info &info
     info.frac_x = (offset.x - idx_x * grid_spacing) / grid_spacing;
     info.frac_y = (offset.y - idx_y * grid_spacing) / grid_spacing;
 
-    // calculate lat/lon of SW corner of 32*28 grid_block
+    ASSERT_RANGE(info.idx_x,0,TERRAIN_GRID_BLOCK_SPACING_X-1);
+    ASSERT_RANGE(info.idx_y,0,TERRAIN_GRID_BLOCK_SPACING_Y-1);
+    ASSERT_RANGE(info.frac_x,0,1);
+    ASSERT_RANGE(info.frac_y,0,1);
+}
+
+/*
+  calculate the lat/lon of the SW corner of the 32*28 grid_block
+  given by the degree and grid indices in info
+*/
+void AP_Terrain::calculate_grid_corner(struct grid_info &info) const
+{
+    Location ref;
+    ref.lat = info.lat_degrees*10*1000*1000L;
+    ref.lng = info.lon_degrees*10*1000*1000L;
+
     location_offset(ref, 
                     info.grid_idx_x * TERRAIN_GRID_BLOCK_SPACING_X * (float)grid_spacing,
                     info.grid_idx_y * TERRAIN_GRID_BLOCK_SPACING_Y * (float)grid_spacing);
     info.grid_lat = ref.lat;
     info.grid_lon = ref.lng;
+}
 
-    ASSERT_RANGE(info.idx_x,0,TERRAIN_GRID_BLOCK_SPACING_X-1);
-    ASSERT_RANGE(info.idx_y,0,TERRAIN_GRID_BLOCK_SPACING_Y-1);
-    ASSERT_RANGE(info.frac_x,0,1);
-    ASSERT_RANGE(info.frac_y,0,1);
+
+/*
+  hash a grid SW corner into the cache index
+ */
+uint16_t AP_Terrain::cache_index_hash(int32_t lat, int32_t lon) const
+{
+    uint32_t h = ((uint32_t)lat * 73856093U) ^ ((uint32_t)lon * 19349663U);
+    return (h ^ (h >> 16)) & cache_index_mask;
+}
+
+/*
+  find the cache block for a grid SW corner and spacing, returning -1
+  if it is not in the cache
+ */
+int16_t AP_Terrain::cache_index_find(int32_t lat, int32_t lon, uint16_t spacing) const
+{
+    for (uint16_t slot = cache_index_hash(lat, lon);
+         cache_index[slot] != TERRAIN_CACHE_INDEX_EMPTY;
+         slot = (slot+1) & cache_index_mask) {
+        const struct grid_block &grid = cache[cache_index[slot]].grid;
+        if (grid.lat == lat && grid.lon == lon && grid.spacing == spacing) {
+            return cache_index[slot];
+        }
+    }
+    return -1;
+}
+
+/*
+  add a cache block to the hash index
+ */
+void AP_Terrain::cache_index_insert(uint16_t cache_idx)
+{
+    uint16_t slot = cache_index_hash(cache[cache_idx].grid.lat, cache[cache_idx].grid.lon);
+    while (cache_index[slot] != TERRAIN_CACHE_INDEX_EMPTY) {
+        slot = (slot+1) & cache_index_mask;
+    }
+    cache_index[slot] = cache_idx;
 }
 
+/*
+  remove a cache block from the hash index. Later entries in the probe
+  sequence are shifted back so that lookups never need tombstones
+ */
+void AP_Terrain::cache_index_remove(uint16_t cache_idx)
+{
+    uint16_t slot = cache_index_hash(cache[cache_idx].grid.lat, cache[cache_idx].grid.lon);
+    while (cache_index[slot] != cache_idx) {
+        if (cache_index[slot] == TERRAIN_CACHE_INDEX_EMPTY) {
+            // not in the index
+            return;
+        }
+        slot = (slot+1) & cache_index_mask;
+    }
+
+    uint16_t next = slot;
+    while (true) {
+        next = (next+1) & cache_index_mask;
+        if (cache_index[next] == TERRAIN_CACHE_INDEX_EMPTY) {
+            break;
+        }
+        const struct grid_block &grid = cache[cache_index[next]].grid;
+        uint16_t home = cache_index_hash(grid.lat, grid.lon);
+        // distance from the home slot, allowing for wrap around
+        if (((next - home) & cache_index_mask) >= ((next - slot) & cache_index_mask)) {
+            cache_index[slot] = cache_index[next];
+            slot = next;
+        }
+    }
+    cache_index[slot] = TERRAIN_CACHE_INDEX_EMPTY;
+}
 
 /*
   find a grid structure given a grid_info
  */
 AP_Terrain::grid_cache &AP_Terrain::find_grid_cache(const struct grid_info &info)
 {
-    uint16_t oldest_i = 0;
-
     // see if we have that grid
-    for (uint16_t i=0; i<cache_size; i++) {
-        if (cache[i].grid.lat == info.grid_lat && 
-            cache[i].grid.lon == info.grid_lon &&
-            cache[i].grid.spacing == grid_spacing) {
-            cache[i].last_access_ms = AP_HAL::millis();
-            return cache[i];
-        }
+    int16_t i = cache_index_find(info.grid_lat, info.grid_lon, grid_spacing);
+    if (i != -1) {
+        stats.hits++;
+        cache[i].last_access_ms = AP_HAL::millis();
+        return cache[i];
+    }
+
+    stats.misses++;
+    struct grid_cache &grid = load_grid_cache(info);
+
+    // start the disk read now rather than waiting for the next
+    // update() or send_request()
+    schedule_disk_io();
+
+    return grid;
+}
+
+/*
+  replace the least recently used cache block with the grid in info,
+  initially unpopulated and waiting for a disk read
+ */
+AP_Terrain::grid_cache &AP_Terrain::load_grid_cache(const struct grid_info &info)
+{
+    uint16_t oldest_i = 0;
+    for (uint16_t i=1; i<cache_size; i++) {
         if (cache[i].last_access_ms < cache[oldest_i].last_access_ms) {
             oldest_i = i;
         }
     }
 
-    // Not found. Use the oldest grid and make it this grid,
-    // initially unpopulated
     struct grid_cache &grid = cache[oldest_i];
+    if (grid.grid.spacing != 0) {
+        // block was in use
+        cache_index_remove(oldest_i);
+    }
     memset(&grid, 0, sizeof(grid));
 
     grid.grid.lat = info.grid_lat;
@@ -149,6 +257,8 @@ AP_Terrain::grid_cache &AP_Terrain::find_grid_cache(const struct grid_info &info
     // mark as waiting for disk read
     grid.state = GRID_CACHE_DISKWAIT;
 
+    cache_index_insert(oldest_i);
+
     return grid;
 }
 
@@ -157,22 +267,24 @@ AP_Terrain::grid_cache &AP_Terrain::find_grid_cache(const struct grid_info &info
  */
 int16_t AP_Terrain::find_io_idx(enum GridCacheState state)
 {
-    // try first with given state
-    for (uint16_t i=0; i<cache_size; i++) {
-        if (disk_block.block.lat == cache[i].grid.lat &&
-            disk_block.block.lon == cache[i].grid.lon && 
-            cache[i].state == state) {
-            return i;
-        }
-    }    
-    // then any state
-    for (uint16_t i=0; i<cache_size; i++) {
+    // all blocks with the same SW corner share a probe sequence. Try
+    // first with given state, then any state
+    int16_t ret = -1;
+    for (uint16_t slot = cache_index_hash(disk_block.block.lat, disk_block.block.lon);
+         cache_index[slot] != TERRAIN_CACHE_INDEX_EMPTY;
+         slot = (slot+1) & cache_index_mask) {
+        uint16_t i = cache_index[slot];
         if (disk_block.block.lat == cache[i].grid.lat &&
             disk_block.block.lon == cache[i].grid.lon) {
-            return i;
+            if (cache[i].state == state) {
+                return i;
+            }
+            if (ret == -1) {
+                ret = i;
+            }
         }
-    }    
-    return -1;
+    }
+    return ret;
 }
 
 /*
@@ -0,0 +1,143 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_Terrain/AP_Terrain.h>
+
+#if AP_TERRAIN_AVAILABLE
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+#define BENCH_MAX_POINTS 512
+
+/*
+ * A terrain cache filled with a 4x4 patch of synthetic grid blocks,
+ * and a 6km path across it. No disk or GCS IO is done
+ */
+class AP_Terrain_Bench
+{
+public:
+    AP_Terrain_Bench()
+    {
+        // keep the IO thread out of the way
+        terrain.timer_setup = true;
+        terrain.allocate();
+
+        Location origin {};
+        origin.lat = -353632620;
+        origin.lng = 1491652370;
+
+        const float spacing = terrain.grid_spacing;
+        for (uint8_t x = 0; x < 4; x++) {
+            for (uint8_t y = 0; y < 4; y++) {
+                Location loc = origin;
+                location_offset(loc,
+                                x * TERRAIN_GRID_BLOCK_SPACING_X * spacing,
+                                y * TERRAIN_GRID_BLOCK_SPACING_Y * spacing);
+                AP_Terrain::grid_info info;
+                terrain.calculate_grid_info(loc, info);
+                AP_Terrain::grid_cache &gcache = terrain.load_grid_cache(info);
+                for (uint8_t i = 0; i < TERRAIN_GRID_BLOCK_SIZE_X; i++) {
+                    for (uint8_t j = 0; j < TERRAIN_GRID_BLOCK_SIZE_Y; j++) {
+                        gcache.grid.height[i][j] = 500 + (i * 7 + j * 13 + x * 29 + y * 31) % 97;
+                    }
+                }
+                gcache.grid.bitmap = AP_Terrain::bitmap_mask;
+                gcache.state = AP_Terrain::GRID_CACHE_VALID;
+            }
+        }
+
+        start = origin;
+        location_offset(start, 2 * spacing, 2 * spacing);
+        end = start;
+        location_update(end, 45, 6000);
+    }
+
+    // fill locs with count points evenly spaced along the path
+    void make_path(uint16_t count)
+    {
+        Vector2f diff = location_diff(start, end);
+        for (uint16_t i = 0; i < count; i++) {
+            locs[i] = start;
+            location_offset(locs[i], diff.x * i / count, diff.y * i / count);
+        }
+    }
+
+    AP_InertialSensor ins;
+    AP_Baro baro;
+    AP_GPS gps;
+    AP_AHRS_DCM ahrs{ins, baro, gps};
+    AP_Mission mission{ahrs,
+            FUNCTOR_BIND_MEMBER(&AP_Terrain_Bench::mission_cmd, bool, const AP_Mission::Mission_Command &),
+            FUNCTOR_BIND_MEMBER(&AP_Terrain_Bench::mission_cmd, bool, const AP_Mission::Mission_Command &),
+            FUNCTOR_BIND_MEMBER(&AP_Terrain_Bench::mission_complete, void)};
+    AP_Rally rally{ahrs};
+    AP_Terrain terrain{ahrs, mission, rally};
+
+    Location start;
+    Location end;
+    Location locs[BENCH_MAX_POINTS];
+    float heights[BENCH_MAX_POINTS];
+    bool valid[BENCH_MAX_POINTS];
+
+private:
+    bool mission_cmd(const AP_Mission::Mission_Command &) { return true; }
+    void mission_complete() {}
+};
+
+static void BM_HeightAmslSingle(benchmark::State& state)
+{
+    AP_Terrain_Bench *bench = new AP_Terrain_Bench();
+    uint16_t count = state.range_x();
+    bench->make_path(count);
+
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < count; i++) {
+            bench->valid[i] = bench->terrain.height_amsl(bench->locs[i], bench->heights[i], false);
+        }
+        gbenchmark_escape(bench->heights);
+    }
+
+    delete bench;
+}
+
+BENCHMARK(BM_HeightAmslSingle)->Arg(8)->Arg(32)->Arg(128)->Arg(512);
+
+static void BM_HeightAmslBatch(benchmark::State& state)
+{
+    AP_Terrain_Bench *bench = new AP_Terrain_Bench();
+    uint16_t count = state.range_x();
+    bench->make_path(count);
+
+    while (state.KeepRunning()) {
+        bench->terrain.height_amsl_batch(bench->locs, count, bench->heights, bench->valid, false);
+        gbenchmark_escape(bench->heights);
+    }
+
+    delete bench;
+}
+
+BENCHMARK(BM_HeightAmslBatch)->Arg(8)->Arg(32)->Arg(128)->Arg(512);
+
+static void BM_HeightAmslPolyline(benchmark::State& state)
+{
+    AP_Terrain_Bench *bench = new AP_Terrain_Bench();
+    uint16_t count = state.range_x();
+    const Location vertices[2] = { bench->start, bench->end };
+    float spacing = get_distance(bench->start, bench->end) / (count - 1);
+
+    while (state.KeepRunning()) {
+        bench->terrain.height_amsl_polyline(vertices, 2, spacing, bench->heights, bench->valid,
+                                            BENCH_MAX_POINTS, false);
+        gbenchmark_escape(bench->heights);
+    }
+
+    delete bench;
+}
+
+BENCHMARK(BM_HeightAmslPolyline)->Arg(8)->Arg(32)->Arg(128)->Arg(512);
+
+#endif // AP_TERRAIN_AVAILABLE
+
+BENCHMARK_MAIN()
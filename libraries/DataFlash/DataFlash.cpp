@@ -207,6 +207,7 @@ void DataFlash_Class::remote_log_block_status_msg(mavlink_channel_t chan,
 
 void DataFlash_Class::periodic_tasks() {
      FOR_EACH_BACKEND(periodic_tasks());
+     Log_Write_Perf();
 }
 
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
@@ -40,6 +40,7 @@ enum DataFlash_Backend_Type {
 // fwd declarations to avoid include errors
 class AC_AttitudeControl;
 class AC_PosControl;
+class AP_Scheduler;
 
 class DataFlash_Class
 {
@@ -149,6 +150,8 @@ public:
                         const AC_AttitudeControl &attitude_control,
                         const AC_PosControl &pos_control);
     void Log_Write_Rally(const AP_Rally &rally);
+    void Log_Write_Perf(void);
+    void Log_Write_Scheduler(const AP_Scheduler &scheduler);
 
     void Log_Write(const char *name, const char *labels, const char *fmt, ...);
 
@@ -224,6 +227,11 @@ private:
 
     void internal_error() const;
 
+    // sequence number of the last perf counter statistics logged, and
+    // the next counter to log from that set
+    uint32_t _last_perf_seq;
+    uint16_t _perf_log_idx;
+
     /*
      * support for dynamic Log_Write; user-supplies name, format,
      * labels and values in a single function call.
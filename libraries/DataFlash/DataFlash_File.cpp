@@ -29,6 +29,9 @@
 #include <stdio.h>
 #include <time.h>
 #include <dirent.h>
+#if DATAFLASH_FILE_WRITER_THREAD
+#include <sys/uio.h>
+#endif
 #if defined(__APPLE__) && defined(__MACH__)
 #include <sys/param.h>
 #include <sys/mount.h>
@@ -40,6 +43,9 @@ extern const AP_HAL::HAL& hal;
 #define MAX_LOG_FILES 500U
 #define DATAFLASH_PAGE_SIZE 1024UL
 
+// longest the writer thread sleeps before checking for a partial extent
+#define DATAFLASH_FILE_WRITER_WAIT_MS 100
+
 /*
   constructor
  */
@@ -76,11 +82,33 @@ DataFlash_File::DataFlash_File(DataFlash_Class &front,
     _writebuf_chunk(4096),
 #endif
     _last_write_time(0),
+#if DATAFLASH_FILE_WRITER_THREAD
+    _writer_started(false),
+    _writer_fd(-1),
+    _writer_close(false),
+    _extent_min(0),
+    _last_fsync_time(0),
+    _bytes_since_fsync(0),
+    _bytes_uncounted(0),
+    _flush_requested(false),
+#endif
     _perf_write(hal.util->perf_alloc(AP_HAL::Util::PC_ELAPSED, "DF_write")),
     _perf_fsync(hal.util->perf_alloc(AP_HAL::Util::PC_ELAPSED, "DF_fsync")),
     _perf_errors(hal.util->perf_alloc(AP_HAL::Util::PC_COUNT, "DF_errors")),
     _perf_overruns(hal.util->perf_alloc(AP_HAL::Util::PC_COUNT, "DF_overruns"))
-{}
+#if DATAFLASH_FILE_WRITER_THREAD
+    ,_perf_kbytes(hal.util->perf_alloc(AP_HAL::Util::PC_COUNT, "DF_kbytes"))
+#endif
+{
+#if DATAFLASH_FILE_WRITER_THREAD
+    pthread_mutex_init(&_write_mutex, nullptr);
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&_write_cond, &attr);
+    pthread_condattr_destroy(&attr);
+#endif
+}
 
 
 void DataFlash_File::Init()
@@ -148,7 +176,17 @@ void DataFlash_File::Init()
     hal.console->printf("DataFlash_File: buffer size=%u\n", (unsigned)bufsize);
 
     _initialised = true;
-    hal.scheduler->register_io_process(FUNCTOR_BIND_MEMBER(&DataFlash_File::_io_timer, void));
+#if DATAFLASH_FILE_WRITER_THREAD
+    // batch writes into extents of at least a quarter of the buffer
+    _extent_min = constrain_int32(_writebuf.get_size() / 4, _writebuf_chunk, _extent_max);
+    if (hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&DataFlash_File::_writer_loop, void),
+                                     "log_writer", 0, AP_HAL::Scheduler::PRIORITY_IO, 0)) {
+        _writer_started = true;
+        return;
+    }
+    hal.console->printf("DataFlash_File: failed to start writer thread\n");
+#endif
+    hal.scheduler->register_io_process(FUNCTOR_BIND_MEMBER(&DataFlash_File::_io_timer, void), "log");
 }
 
 bool DataFlash_File::file_exists(const char *filename) const
@@ -505,6 +543,11 @@ bool DataFlash_File::WritePrioritisedBlock(const void *pBuffer, uint16_t size, b
 
     _writebuf.write((uint8_t*)pBuffer, size);
     semaphore->give();
+#if DATAFLASH_FILE_WRITER_THREAD
+    if (_writer_started && _writebuf.available() >= _extent_min) {
+        pthread_cond_signal(&_write_cond);
+    }
+#endif
     return true;
 }
 
@@ -757,12 +800,37 @@ uint16_t DataFlash_File::get_num_logs()
  */
 void DataFlash_File::stop_logging(void)
 {
+    _write_lock();
     if (_write_fd != -1) {
         int fd = _write_fd;
         _write_fd = -1;
         log_write_started = false;
-        ::close(fd);
+#if DATAFLASH_FILE_WRITER_THREAD
+        if (fd == _writer_fd) {
+            // the writer thread closes it when its write completes
+            _writer_close = true;
+            fd = -1;
+        }
+#endif
+        if (fd != -1) {
+            ::close(fd);
+        }
     }
+    _write_unlock();
+}
+
+void DataFlash_File::_write_lock(void)
+{
+#if DATAFLASH_FILE_WRITER_THREAD
+    pthread_mutex_lock(&_write_mutex);
+#endif
+}
+
+void DataFlash_File::_write_unlock(void)
+{
+#if DATAFLASH_FILE_WRITER_THREAD
+    pthread_mutex_unlock(&_write_mutex);
+#endif
 }
 
 
@@ -804,10 +872,10 @@ uint16_t DataFlash_File::start_new_log(void)
     if (fname == nullptr) {
         return 0xFFFF;
     }
-    _write_fd = ::open(fname, O_WRONLY|O_CREAT|O_TRUNC|O_CLOEXEC, 0666);
+    const int write_fd = ::open(fname, O_WRONLY|O_CREAT|O_TRUNC|O_CLOEXEC, 0666);
     _cached_oldest_log = 0;
 
-    if (_write_fd == -1) {
+    if (write_fd == -1) {
         _initialised = false;
         _open_error = true;
         int saved_errno = errno;
@@ -819,8 +887,12 @@ uint16_t DataFlash_File::start_new_log(void)
         return 0xFFFF;
     }
     free(fname);
+    // hand the new file to the writer with an empty buffer
+    _write_lock();
+    _write_fd = write_fd;
     _write_offset = 0;
     _writebuf.clear();
+    _write_unlock();
     log_write_started = true;
 
     // now update lastlog.txt with the new log number
@@ -998,6 +1070,18 @@ void DataFlash_File::ListAvailableLogs(AP_HAL::BetterStream *port)
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
 void DataFlash_File::flush(void)
 {
+#if DATAFLASH_FILE_WRITER_THREAD
+    if (_writer_started) {
+        // the writer thread owns the file; wait for it to empty the buffer
+        _flush_requested = true;
+        pthread_cond_signal(&_write_cond);
+        while (_write_fd != -1 && _initialised && !_open_error && _writebuf.available()) {
+            hal.scheduler->delay_microseconds(1000);
+        }
+        _flush_requested = false;
+        return;
+    }
+#endif
     uint32_t tnow = AP_HAL::micros();
     hal.scheduler->suspend_timer_procs();
     while (_write_fd != -1 && _initialised && !_open_error && _writebuf.available()) {
@@ -1015,6 +1099,24 @@ void DataFlash_File::flush(void)
 }
 #endif
 
+/*
+  check free space at most once per _free_space_check_interval, stopping
+  logging if the disk is full. Returns false if logging was stopped
+ */
+bool DataFlash_File::_check_free_space(uint32_t tnow)
+{
+    if (tnow - _free_space_last_check_time > _free_space_check_interval) {
+        _free_space_last_check_time = tnow;
+        if (disk_space_avail() < _free_space_min_avail) {
+            hal.console->printf("Out of space for logging\n");
+            stop_logging();
+            _open_error = true; // prevent logging starting again
+            return false;
+        }
+    }
+    return true;
+}
+
 void DataFlash_File::_io_timer(void)
 {
     if (_write_fd == -1 || !_initialised || _open_error) {
@@ -1032,14 +1134,8 @@ void DataFlash_File::_io_timer(void)
         // least once per 2 seconds if data is available
         return;
     }
-    if (tnow - _free_space_last_check_time > _free_space_check_interval) {
-        _free_space_last_check_time = tnow;
-        if (disk_space_avail() < _free_space_min_avail) {
-            hal.console->printf("Out of space for logging\n");
-            stop_logging();
-            _open_error = true; // prevent logging starting again
-            return;
-        }
+    if (!_check_free_space(tnow)) {
+        return;
     }
 
     hal.util->perf_begin(_perf_write);
@@ -1084,6 +1180,142 @@ void DataFlash_File::_io_timer(void)
     hal.util->perf_end(_perf_write);
 }
 
+#if DATAFLASH_FILE_WRITER_THREAD
+/*
+  main loop of the writer thread
+ */
+void DataFlash_File::_writer_loop(void)
+{
+    pthread_mutex_lock(&_write_mutex);
+    while (true) {
+        if (_write_extent()) {
+            continue;
+        }
+        // sleep until WritePrioritisedBlock() or flush() signal a full
+        // extent, waking up regularly for the partial write timeout
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        ts.tv_nsec += DATAFLASH_FILE_WRITER_WAIT_MS * 1000000L;
+        if (ts.tv_nsec >= 1000000000L) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&_write_cond, &_write_mutex, &ts);
+    }
+}
+
+/*
+  write out as much of the buffer as possible, up to _extent_max bytes,
+  with a single vectored write covering both parts of the ring buffer
+  when it has wrapped. Called with _write_mutex held. The lock is
+  dropped for the free space check and the disk IO, so the main
+  thread never waits on the disk. Returns true if data was written
+ */
+bool DataFlash_File::_write_extent(void)
+{
+    const int fd = _write_fd;
+    if (fd == -1 || !_initialised || _open_error) {
+        return false;
+    }
+
+    uint32_t nbytes = _writebuf.available();
+    if (nbytes == 0) {
+        return false;
+    }
+    uint32_t tnow = AP_HAL::micros();
+    if (nbytes < _extent_min && !_flush_requested &&
+        tnow - _last_write_time < 2000000UL) {
+        // write in large extents, but always write at least once per
+        // 2 seconds if data is available
+        return false;
+    }
+
+    hal.util->perf_begin(_perf_write);
+
+    _last_write_time = tnow;
+    nbytes = MIN(nbytes, _extent_max);
+
+    // try to align writes on a 512 byte boundary to avoid filesystem reads
+    if ((nbytes + _write_offset) % 512 != 0) {
+        uint32_t ofs = (nbytes + _write_offset) % 512;
+        if (ofs < nbytes) {
+            nbytes -= ofs;
+        }
+    }
+
+    ByteBuffer::IoVec vec[2];
+    struct iovec iov[2];
+    const uint8_t n_vec = _writebuf.peekiovec(vec, nbytes);
+    for (uint8_t i = 0; i < n_vec; i++) {
+        iov[i].iov_base = vec[i].data;
+        iov[i].iov_len = vec[i].len;
+    }
+
+    /*
+      stop_logging() leaves fd open while we write to it, so its
+      number can't be reused by a new log. If start_new_log() clears
+      the buffer meanwhile the extent is dropped below
+     */
+    const uint32_t write_offset = _write_offset;
+    _writer_fd = fd;
+    _write_unlock();
+
+    ssize_t nwritten = 0;
+    if (_check_free_space(tnow)) {
+        nwritten = ::pwritev(fd, iov, n_vec, write_offset);
+    }
+    if (nwritten > 0) {
+        /*
+          fsync to keep the directory entry up to date, but only after
+          enough data or time has passed to avoid stalling on every write
+         */
+        _bytes_since_fsync += nwritten;
+        if (_bytes_since_fsync >= _fsync_bytes ||
+            tnow - _last_fsync_time >= _fsync_interval_us) {
+#if CONFIG_HAL_BOARD != HAL_BOARD_SITL && CONFIG_HAL_BOARD_SUBTYPE != HAL_BOARD_SUBTYPE_LINUX_NONE && CONFIG_HAL_BOARD != HAL_BOARD_QURT
+            hal.util->perf_begin(_perf_fsync);
+            ::fsync(fd);
+            hal.util->perf_end(_perf_fsync);
+#endif
+            _bytes_since_fsync = 0;
+            _last_fsync_time = tnow;
+        }
+    }
+
+    _write_lock();
+    _writer_fd = -1;
+    if (_writer_close) {
+        _writer_close = false;
+        ::close(fd);
+    }
+    if (fd != _write_fd) {
+        // the log was closed or replaced while we wrote
+        hal.util->perf_end(_perf_write);
+        return false;
+    }
+    if (nwritten <= 0) {
+        hal.util->perf_end(_perf_write);
+        hal.util->perf_count(_perf_errors);
+        close(fd);
+        _write_fd = -1;
+        _initialised = false;
+        return false;
+    }
+
+    _write_offset += nwritten;
+    _writebuf.advance(nwritten);
+
+    _bytes_uncounted += nwritten;
+    while (_bytes_uncounted >= 1024) {
+        hal.util->perf_count(_perf_kbytes);
+        _bytes_uncounted -= 1024;
+    }
+
+    hal.util->perf_end(_perf_write);
+    return true;
+}
+#endif // DATAFLASH_FILE_WRITER_THREAD
+
 // this sensor is enabled if we should be logging at the moment
 bool DataFlash_File::logging_enabled() const
 {
@@ -23,6 +23,19 @@
 #define DATAFLASH_FILE_MINIMAL 0
 #endif
 
+/*
+  on Linux the log is written by a dedicated thread in large batched
+  extents with vectored writes, rather than in small chunks from the
+  shared IO thread. fsync is limited by time and by bytes written
+ */
+#ifndef DATAFLASH_FILE_WRITER_THREAD
+#define DATAFLASH_FILE_WRITER_THREAD (CONFIG_HAL_BOARD == HAL_BOARD_LINUX)
+#endif
+
+#if DATAFLASH_FILE_WRITER_THREAD
+#include <pthread.h>
+#endif
+
 class DataFlash_File : public DataFlash_Backend
 {
 public:
@@ -120,6 +133,48 @@ private:
 
     void _io_timer(void);
 
+    // check there is enough free space to keep logging
+    bool _check_free_space(uint32_t tnow);
+
+    // guard the write fd, offset and read side of _writebuf against
+    // the writer thread
+    void _write_lock(void);
+    void _write_unlock(void);
+
+#if DATAFLASH_FILE_WRITER_THREAD
+    bool _writer_started;
+    void _writer_loop(void);
+    bool _write_extent(void);
+
+    // protects the log file and the read side of _writebuf. Taken by
+    // the main thread while it opens or closes the log, and by the
+    // writer thread except while it is doing disk IO. The writer
+    // sleeps on _write_cond until there is an extent to write
+    pthread_mutex_t _write_mutex;
+    pthread_cond_t _write_cond;
+
+    // file the writer thread is writing to without the lock, and
+    // whether stop_logging() has left it for the writer to close
+    int _writer_fd;
+    bool _writer_close;
+
+    // minimum and maximum number of bytes written at once by the writer thread
+    uint32_t _extent_min;
+    const uint32_t _extent_max = 65536;
+
+    // fsync at least this often, and after this many bytes
+    const uint32_t _fsync_interval_us = 1000000UL;
+    const uint32_t _fsync_bytes = 262144;
+    uint32_t _last_fsync_time;
+    uint32_t _bytes_since_fsync;
+
+    // bytes written not yet counted in _perf_kbytes
+    uint32_t _bytes_uncounted;
+
+    // set by flush() to have partial extents written out immediately
+    volatile bool _flush_requested;
+#endif
+
     uint32_t critical_message_reserved_space() const {
         // possibly make this a proportional to buffer size?
         uint32_t ret = 1024;
@@ -155,6 +210,9 @@ private:
     AP_HAL::Util::perf_counter_t  _perf_fsync;
     AP_HAL::Util::perf_counter_t  _perf_errors;
     AP_HAL::Util::perf_counter_t  _perf_overruns;
+#if DATAFLASH_FILE_WRITER_THREAD
+    AP_HAL::Util::perf_counter_t  _perf_kbytes;
+#endif
 };
 
 #endif // HAL_OS_POSIX_IO
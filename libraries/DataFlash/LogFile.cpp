@@ -8,6 +8,7 @@
 #include <AP_Math/AP_Math.h>
 #include <AP_Param/AP_Param.h>
 #include <AP_Motors/AP_Motors.h>
+#include <AP_Scheduler/AP_Scheduler.h>
 #include <AC_AttitudeControl/AC_AttitudeControl.h>
 #include <AC_AttitudeControl/AC_PosControl.h>
 
@@ -18,8 +19,15 @@
 #include "DataFlash_MAVLink.h"
 #include "DFMessageWriter.h"
 
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#include <AP_HAL_Linux/Perf.h>
+#endif
+
 extern const AP_HAL::HAL& hal;
 
+// most PERF messages written by one call of Log_Write_Perf()
+#define DATAFLASH_PERF_MSGS_PER_CALL 4
+
 void DataFlash_Class::Init(const struct LogStructure *structures, uint8_t num_types)
 {
     if (_next_backend == DATAFLASH_MAX_BACKENDS) {
@@ -725,7 +733,7 @@ void DataFlash_Class::Log_Write_GPS(const AP_GPS &gps, uint8_t i, uint64_t time_
         ground_speed  : gps.ground_speed(i),
         ground_course : gps.ground_course(i),
         vel_z         : gps.velocity(i).z,
-        used          : (uint8_t)(gps.primary_sensor() == i)
+        used          : (uint8_t)(gps.primary_sensor() == i || gps.get_blend_weight(i) > 0)
     };
     WriteBlock(&pkt, sizeof(pkt));
 
@@ -1903,3 +1911,76 @@ void DataFlash_Class::Log_Write_Rally(const AP_Rally &rally)
         }
     }
 }
+
+// Write perf counter statistics each time new ones have been
+// aggregated. A set is spread over several calls so a board with many
+// counters doesn't fill the log buffer in one go
+void DataFlash_Class::Log_Write_Perf(void)
+{
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+    Linux::Perf *perf = Linux::Perf::get_instance();
+    if (_perf_log_idx == 0) {
+        const uint32_t seq = perf->get_stats_seq();
+        if (seq == _last_perf_seq) {
+            return;
+        }
+        _last_perf_seq = seq;
+    }
+
+    const uint64_t time_us = AP_HAL::micros64();
+    Linux::Perf_Stats stats;
+    uint8_t written = 0;
+    while (written < DATAFLASH_PERF_MSGS_PER_CALL) {
+        if (!perf->get_stats(_perf_log_idx, stats)) {
+            // the whole set has been logged
+            _perf_log_idx = 0;
+            return;
+        }
+        _perf_log_idx++;
+        if (stats.count == 0) {
+            continue;
+        }
+        struct log_Perf pkt = {
+            LOG_PACKET_HEADER_INIT(LOG_PERF_MSG),
+            time_us : time_us,
+            name    : {},
+            count   : (uint32_t)stats.count,
+            avg     : stats.total * 1.0e-3f / stats.count,
+            p50     : stats.p50 * 1.0e-3f,
+            p99     : stats.p99 * 1.0e-3f,
+            p999    : stats.p999 * 1.0e-3f,
+            max     : stats.max * 1.0e-3f
+        };
+        strncpy(pkt.name, stats.name, sizeof(pkt.name));
+        WriteBlock(&pkt, sizeof(pkt));
+        written++;
+    }
+#endif
+}
+
+// Write scheduler statistics for each task that was due since the
+// statistics were last reset
+void DataFlash_Class::Log_Write_Scheduler(const AP_Scheduler &scheduler)
+{
+    const uint64_t time_us = AP_HAL::micros64();
+    for (uint8_t i=0; i<scheduler.get_num_tasks(); i++) {
+        const AP_Scheduler::task_stats &stats = scheduler.get_task_stats(i);
+        if (stats.runs == 0 && stats.skips == 0) {
+            continue;
+        }
+        struct log_Scheduler pkt = {
+            LOG_PACKET_HEADER_INIT(LOG_SCHED_MSG),
+            time_us  : time_us,
+            task     : i,
+            name     : {},
+            runs     : stats.runs,
+            overruns : stats.overruns,
+            slips    : stats.slips,
+            skips    : stats.skips,
+            avg_time : (uint16_t)(stats.runs ? MIN(stats.total_time_us / stats.runs, (uint32_t)UINT16_MAX) : 0),
+            max_time : stats.max_time_us
+        };
+        strncpy(pkt.name, scheduler.get_task_name(i), sizeof(pkt.name));
+        WriteBlock(&pkt, sizeof(pkt));
+    }
+}
@@ -69,6 +69,27 @@ struct PACKED log_GPA {
     uint32_t sample_ms;
 };
 
+/*
+  blended solution of the GPS receivers, and the weight of each
+ */
+struct PACKED log_GPS_Blend {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t  status;
+    uint8_t  num_sats;
+    int32_t  latitude;
+    int32_t  longitude;
+    int32_t  altitude;
+    float    ground_speed;
+    float    ground_course;
+    float    vel_z;
+    float    weight1;
+    float    weight2;
+    uint16_t shift1_ms;
+    uint16_t shift2_ms;
+    uint8_t  active;
+};
+
 struct PACKED log_Message {
     LOG_PACKET_HEADER;
     uint64_t time_us;
@@ -495,6 +516,21 @@ struct PACKED log_TERRAIN {
     uint16_t loaded;
 };
 
+/*
+  terrain cache log structure
+ */
+struct PACKED log_TERRAIN_CACHE {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint16_t size;
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t stalls;
+    uint32_t prefetches;
+    uint32_t reads;
+    uint32_t writes;
+};
+
 /*
   UBlox logging
  */
@@ -713,6 +749,31 @@ struct PACKED log_Rally {
     int16_t altitude;
 };
 
+struct PACKED log_Perf {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    char name[16];
+    uint32_t count;
+    float avg;
+    float p50;
+    float p99;
+    float p999;
+    float max;
+};
+
+struct PACKED log_Scheduler {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t task;
+    char name[16];
+    uint16_t runs;
+    uint16_t overruns;
+    uint16_t slips;
+    uint16_t skips;
+    uint16_t avg_time;
+    uint16_t max_time;
+};
+
 // #endif // SBP_HW_LOGGING
 
 /*
@@ -752,6 +813,8 @@ Format characters in the format string for binary log messages
       "GPA",  "QCCCCBI", "TimeUS,VDop,HAcc,VAcc,SAcc,VV,SMS" }, \
     { LOG_GPA2_MSG, sizeof(log_GPA), \
       "GPA2", "QCCCCBI", "TimeUS,VDop,HAcc,VAcc,SAcc,VV,SMS" }, \
+    { LOG_GPS_BLEND_MSG, sizeof(log_GPS_Blend), \
+      "GPSB", "QBBLLefffffHHB", "TimeUS,Status,NSats,Lat,Lng,Alt,Spd,GCrs,VZ,W1,W2,Sh1,Sh2,Act" }, \
     { LOG_IMU_MSG, sizeof(log_IMU), \
       "IMU",  "QffffffIIfBB",     "TimeUS,GyrX,GyrY,GyrZ,AccX,AccY,AccZ,ErrG,ErrA,Temp,GyHlt,AcHlt" }, \
     { LOG_MESSAGE_MSG, sizeof(log_Message), \
@@ -833,6 +896,8 @@ Format characters in the format string for binary log messages
       "NKF9","QcccccfbbHBHHb","TimeUS,SV,SP,SH,SM,SVT,errRP,OFN,OFE,FS,TS,SS,GPS,PI" }, \
     { LOG_TERRAIN_MSG, sizeof(log_TERRAIN), \
       "TERR","QBLLHffHH","TimeUS,Status,Lat,Lng,Spacing,TerrH,CHeight,Pending,Loaded" }, \
+    { LOG_TERRAIN_CACHE_MSG, sizeof(log_TERRAIN_CACHE), \
+      "TERC","QHIIIIII","TimeUS,Size,Hit,Miss,Stall,Pref,Rd,Wr" }, \
     { LOG_GPS_UBX1_MSG, sizeof(log_Ubx1), \
       "UBX1", "QBHBBH",  "TimeUS,Instance,noisePerMS,jamInd,aPower,agcCnt" }, \
     { LOG_GPS_UBX2_MSG, sizeof(log_Ubx2), \
@@ -916,7 +981,11 @@ Format characters in the format string for binary log messages
     { LOG_RATE_MSG, sizeof(log_Rate), \
       "RATE", "Qffffffffffff",  "TimeUS,RDes,R,ROut,PDes,P,POut,YDes,Y,YOut,ADes,A,AOut" }, \
     { LOG_RALLY_MSG, sizeof(log_Rally), \
-      "RALY", "QBBLLh", "TimeUS,Tot,Seq,Lat,Lng,Alt" }
+      "RALY", "QBBLLh", "TimeUS,Tot,Seq,Lat,Lng,Alt" }, \
+    { LOG_PERF_MSG, sizeof(log_Perf), \
+      "PERF", "QNIfffff", "TimeUS,Name,Count,Avg,P50,P99,P999,Max" }, \
+    { LOG_SCHED_MSG, sizeof(log_Scheduler), \
+      "SCHD", "QBNHHHHHH", "TimeUS,Task,Name,Runs,Ovr,Slip,Skip,AvgT,MaxT" }
 
 // #if SBP_HW_LOGGING
 #define LOG_SBP_STRUCTURES \
@@ -1032,6 +1101,10 @@ enum LogMessages {
     LOG_GIMBAL3_MSG,
     LOG_RATE_MSG,
     LOG_RALLY_MSG,
+    LOG_PERF_MSG,
+    LOG_SCHED_MSG,
+    LOG_TERRAIN_CACHE_MSG,
+    LOG_GPS_BLEND_MSG,
 };
 
 enum LogOriginType {
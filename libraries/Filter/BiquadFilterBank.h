@@ -0,0 +1,224 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file   BiquadFilterBank.h
+/// @brief  A bank of cascaded biquad filters over many lanes, such as
+///         every axis of every IMU instance.
+///
+///         State and coefficients are stored as arrays indexed by lane,
+///         so each stage is one loop over contiguous floats which the
+///         compiler can vectorise. Each lane has its own coefficients,
+///         allowing instances with different sample rates to share a
+///         bank. A stage is either a low pass filter matching
+///         LowPassFilter2p, a notch, or a passthrough.
+#pragma once
+
+#include <AP_Math/AP_Math.h>
+#include "LowPassFilter2p.h"
+
+// coefficients of a normalised direct form II biquad
+struct BiquadCoefficients {
+    float b0;
+    float b1;
+    float b2;
+    float a1;
+    float a2;
+
+    // second order low pass, identical to DigitalBiquadFilter. A zero
+    // cutoff gives a passthrough, as LowPassFilter2p does
+    static BiquadCoefficients lowpass(float sample_freq, float cutoff_freq);
+
+    // notch at center_freq_hz, bandwidth_hz wide, attenuating by
+    // attenuation_dB. Invalid parameters give a passthrough
+    static BiquadCoefficients notch(float sample_freq, float center_freq_hz, float bandwidth_hz, float attenuation_dB);
+
+    static BiquadCoefficients passthrough() { return BiquadCoefficients{1, 0, 0, 0, 0}; }
+
+    bool is_passthrough() const {
+        return b0 == 1 && b1 == 0 && b2 == 0 && a1 == 0 && a2 == 0;
+    }
+};
+
+inline BiquadCoefficients BiquadCoefficients::lowpass(float sample_freq, float cutoff_freq)
+{
+    if (is_zero(cutoff_freq) || is_zero(sample_freq)) {
+        return passthrough();
+    }
+    DigitalBiquadFilter<float>::biquad_params params;
+    DigitalBiquadFilter<float>::compute_params(sample_freq, cutoff_freq, params);
+    return BiquadCoefficients{params.b0, params.b1, params.b2, params.a1, params.a2};
+}
+
+inline BiquadCoefficients BiquadCoefficients::notch(float sample_freq, float center_freq_hz, float bandwidth_hz, float attenuation_dB)
+{
+    if (center_freq_hz <= 0 || bandwidth_hz <= 0 || bandwidth_hz >= 2 * center_freq_hz ||
+        center_freq_hz >= 0.5f * sample_freq || attenuation_dB <= 0) {
+        return passthrough();
+    }
+    const float omega = M_2PI * center_freq_hz / sample_freq;
+    const float octaves = log2f(center_freq_hz / (center_freq_hz - bandwidth_hz / 2)) * 2;
+    const float Q = sqrtf(powf(2, octaves)) / (powf(2, octaves) - 1);
+    const float A = powf(10, -attenuation_dB / 40);
+    const float alpha = sinf(omega) / (2 * Q / A);
+    const float a0_inv = 1.0f / (1.0f + alpha);
+    const float b1 = -2.0f * cosf(omega) * a0_inv;
+    return BiquadCoefficients{(1.0f + alpha * A * A) * a0_inv,
+                              b1,
+                              (1.0f - alpha * A * A) * a0_inv,
+                              b1,
+                              (1.0f - alpha) * a0_inv};
+}
+
+template <uint8_t LANES, uint8_t STAGES>
+class BiquadFilterBank {
+public:
+    BiquadFilterBank();
+
+    // set the coefficients of one stage for count lanes starting at lane
+    void set_stage(uint8_t stage, uint8_t lane, uint8_t count, const BiquadCoefficients &coeffs);
+
+    // convenience for low pass stages
+    void set_lowpass(uint8_t stage, uint8_t lane, uint8_t count, float sample_freq, float cutoff_freq) {
+        set_stage(stage, lane, count, BiquadCoefficients::lowpass(sample_freq, cutoff_freq));
+    }
+
+    // convenience for notch stages
+    void set_notch(uint8_t stage, uint8_t lane, uint8_t count, float sample_freq,
+                   float center_freq_hz, float bandwidth_hz, float attenuation_dB) {
+        set_stage(stage, lane, count, BiquadCoefficients::notch(sample_freq, center_freq_hz, bandwidth_hz, attenuation_dB));
+    }
+
+    // run count lanes starting at lane through every stage
+    void apply(uint8_t lane, uint8_t count, const float *in, float *out);
+
+    // run every lane through every stage
+    void apply(const float *in, float *out) { apply(0, LANES, in, out); }
+
+    // run three consecutive lanes, such as the axes of one sensor
+    Vector3f apply(uint8_t lane, const Vector3f &sample) {
+        Vector3f ret;
+        apply(lane, 3, &sample.x, &ret.x);
+        return ret;
+    }
+
+    // clear the state of count lanes starting at lane
+    void reset(uint8_t lane, uint8_t count);
+
+    // clear the state of all lanes
+    void reset() { reset(0, LANES); }
+
+    static_assert(LANES > 0 && STAGES > 0, "bank must have lanes and stages");
+
+private:
+    // number of leading stages which have been configured
+    uint8_t _stages_used;
+
+    float _b0[STAGES][LANES];
+    float _b1[STAGES][LANES];
+    float _b2[STAGES][LANES];
+    float _a1[STAGES][LANES];
+    float _a2[STAGES][LANES];
+
+    // lanes which a stage passes through unchanged, leaving their
+    // state untouched as LowPassFilter2p does
+    bool _passthrough[STAGES][LANES];
+
+    float _delay_element_1[STAGES][LANES];
+    float _delay_element_2[STAGES][LANES];
+};
+
+template <uint8_t LANES, uint8_t STAGES>
+BiquadFilterBank<LANES, STAGES>::BiquadFilterBank() :
+    _stages_used(0)
+{
+    for (uint8_t s = 0; s < STAGES; s++) {
+        for (uint8_t l = 0; l < LANES; l++) {
+            _b0[s][l] = 1;
+            _b1[s][l] = _b2[s][l] = 0;
+            _a1[s][l] = _a2[s][l] = 0;
+            _passthrough[s][l] = true;
+        }
+    }
+    reset();
+}
+
+template <uint8_t LANES, uint8_t STAGES>
+void BiquadFilterBank<LANES, STAGES>::set_stage(uint8_t stage, uint8_t lane, uint8_t count, const BiquadCoefficients &coeffs)
+{
+    if (stage >= STAGES || lane >= LANES) {
+        return;
+    }
+    count = MIN(count, (uint8_t)(LANES - lane));
+    const bool passthrough = coeffs.is_passthrough();
+    for (uint8_t l = lane; l < lane + count; l++) {
+        _passthrough[stage][l] = passthrough;
+        _b0[stage][l] = coeffs.b0;
+        _b1[stage][l] = coeffs.b1;
+        _b2[stage][l] = coeffs.b2;
+        _a1[stage][l] = coeffs.a1;
+        _a2[stage][l] = coeffs.a2;
+    }
+    _stages_used = MAX(_stages_used, (uint8_t)(stage + 1));
+}
+
+template <uint8_t LANES, uint8_t STAGES>
+void BiquadFilterBank<LANES, STAGES>::apply(uint8_t lane, uint8_t count, const float *in, float *out)
+{
+    if (lane >= LANES) {
+        return;
+    }
+    count = MIN(count, (uint8_t)(LANES - lane));
+
+    for (uint8_t l = 0; l < count; l++) {
+        out[l] = in[l];
+    }
+
+    // each stage is the same update as DigitalBiquadFilter::apply(),
+    // run across all lanes before moving to the next stage
+    for (uint8_t s = 0; s < _stages_used; s++) {
+        const float *b0 = &_b0[s][lane];
+        const float *b1 = &_b1[s][lane];
+        const float *b2 = &_b2[s][lane];
+        const float *a1 = &_a1[s][lane];
+        const float *a2 = &_a2[s][lane];
+        const bool *passthrough = &_passthrough[s][lane];
+        float *d1 = &_delay_element_1[s][lane];
+        float *d2 = &_delay_element_2[s][lane];
+        for (uint8_t l = 0; l < count; l++) {
+            if (passthrough[l]) {
+                continue;
+            }
+            const float d0 = out[l] - d1[l] * a1[l] - d2[l] * a2[l];
+            out[l] = d0 * b0[l] + d1[l] * b1[l] + d2[l] * b2[l];
+            d2[l] = d1[l];
+            d1[l] = d0;
+        }
+    }
+}
+
+template <uint8_t LANES, uint8_t STAGES>
+void BiquadFilterBank<LANES, STAGES>::reset(uint8_t lane, uint8_t count)
+{
+    if (lane >= LANES) {
+        return;
+    }
+    count = MIN(count, (uint8_t)(LANES - lane));
+    for (uint8_t s = 0; s < STAGES; s++) {
+        for (uint8_t l = lane; l < lane + count; l++) {
+            _delay_element_1[s][l] = 0;
+            _delay_element_2[s][l] = 0;
+        }
+    }
+}
@@ -0,0 +1,166 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <Filter/LowPassFilter2p.h>
+#include <Filter/BiquadFilterBank.h>
+
+/*
+ * Filtering for three IMUs at 1kHz, comparing LowPassFilter2pVector3f
+ * objects per sensor against one bank over every axis. Items processed
+ * are IMU samples (one accel and one gyro vector).
+ */
+
+#define IMUS            3
+#define LANES           (IMUS * 2 * 3)
+#define SAMPLE_RATE     1000
+#define INPUT_SAMPLES   256
+
+static Vector3f input[INPUT_SAMPLES];
+
+static void setup_input()
+{
+    for (uint16_t i = 0; i < INPUT_SAMPLES; i++) {
+        const float t = i / (float)SAMPLE_RATE;
+        input[i] = Vector3f(sinf(M_2PI * 3 * t) + 0.2f * sinf(M_2PI * 170 * t),
+                            cosf(M_2PI * 5 * t) + 0.1f * sinf(M_2PI * 240 * t),
+                            9.8f + 0.3f * sinf(M_2PI * 80 * t));
+    }
+}
+
+static void BM_LowPassFilter2pObjects(benchmark::State& state)
+{
+    LowPassFilter2pVector3f accel_filter[IMUS];
+    LowPassFilter2pVector3f gyro_filter[IMUS];
+    Vector3f accel_filtered[IMUS];
+    Vector3f gyro_filtered[IMUS];
+    setup_input();
+    for (uint8_t i = 0; i < IMUS; i++) {
+        accel_filter[i].set_cutoff_frequency(SAMPLE_RATE, 20);
+        gyro_filter[i].set_cutoff_frequency(SAMPLE_RATE, 20);
+    }
+    uint16_t n = 0;
+
+    while (state.KeepRunning()) {
+        const Vector3f &sample = input[n++ % INPUT_SAMPLES];
+        for (uint8_t i = 0; i < IMUS; i++) {
+            accel_filtered[i] = accel_filter[i].apply(sample);
+            gyro_filtered[i] = gyro_filter[i].apply(sample);
+        }
+        gbenchmark_escape(accel_filtered);
+        gbenchmark_escape(gyro_filtered);
+    }
+    state.SetItemsProcessed(state.iterations() * IMUS);
+}
+
+BENCHMARK(BM_LowPassFilter2pObjects);
+
+static void BM_BiquadBankLowPass(benchmark::State& state)
+{
+    BiquadFilterBank<LANES, 1> bank;
+    float samples[LANES];
+    float filtered[LANES];
+    setup_input();
+    bank.set_lowpass(0, 0, LANES, SAMPLE_RATE, 20);
+    uint16_t n = 0;
+
+    while (state.KeepRunning()) {
+        const Vector3f &sample = input[n++ % INPUT_SAMPLES];
+        for (uint8_t l = 0; l < LANES; l += 3) {
+            samples[l] = sample.x;
+            samples[l + 1] = sample.y;
+            samples[l + 2] = sample.z;
+        }
+        bank.apply(samples, filtered);
+        gbenchmark_escape(filtered);
+    }
+    state.SetItemsProcessed(state.iterations() * IMUS);
+}
+
+BENCHMARK(BM_BiquadBankLowPass);
+
+// low pass plus two stacked notches, one object per stage per sensor
+static void BM_DigitalBiquadCascade(benchmark::State& state)
+{
+    DigitalBiquadFilter<Vector3f> filters[IMUS * 2][3];
+    DigitalBiquadFilter<Vector3f>::biquad_params params[3];
+    const BiquadCoefficients coeffs[3] = {
+        BiquadCoefficients::lowpass(SAMPLE_RATE, 80),
+        BiquadCoefficients::notch(SAMPLE_RATE, 170, 40, 20),
+        BiquadCoefficients::notch(SAMPLE_RATE, 240, 40, 20),
+    };
+    for (uint8_t s = 0; s < 3; s++) {
+        params[s] = { 1, SAMPLE_RATE, coeffs[s].a1, coeffs[s].a2, coeffs[s].b0, coeffs[s].b1, coeffs[s].b2 };
+    }
+    Vector3f filtered[IMUS * 2];
+    setup_input();
+    uint16_t n = 0;
+
+    while (state.KeepRunning()) {
+        const Vector3f &sample = input[n++ % INPUT_SAMPLES];
+        for (uint8_t i = 0; i < IMUS * 2; i++) {
+            Vector3f v = sample;
+            for (uint8_t s = 0; s < 3; s++) {
+                v = filters[i][s].apply(v, params[s]);
+            }
+            filtered[i] = v;
+        }
+        gbenchmark_escape(filtered);
+    }
+    state.SetItemsProcessed(state.iterations() * IMUS);
+}
+
+BENCHMARK(BM_DigitalBiquadCascade);
+
+static void BM_BiquadBankCascade(benchmark::State& state)
+{
+    BiquadFilterBank<LANES, 3> bank;
+    float samples[LANES];
+    float filtered[LANES];
+    setup_input();
+    bank.set_lowpass(0, 0, LANES, SAMPLE_RATE, 80);
+    bank.set_notch(1, 0, LANES, SAMPLE_RATE, 170, 40, 20);
+    bank.set_notch(2, 0, LANES, SAMPLE_RATE, 240, 40, 20);
+    uint16_t n = 0;
+
+    while (state.KeepRunning()) {
+        const Vector3f &sample = input[n++ % INPUT_SAMPLES];
+        for (uint8_t l = 0; l < LANES; l += 3) {
+            samples[l] = sample.x;
+            samples[l + 1] = sample.y;
+            samples[l + 2] = sample.z;
+        }
+        bank.apply(samples, filtered);
+        gbenchmark_escape(filtered);
+    }
+    state.SetItemsProcessed(state.iterations() * IMUS);
+}
+
+BENCHMARK(BM_BiquadBankCascade);
+
+// one instance at a time, as AP_InertialSensor_Backend feeds the bank
+static void BM_BiquadBankPerInstance(benchmark::State& state)
+{
+    BiquadFilterBank<IMUS * 3, 1> accel_bank;
+    BiquadFilterBank<IMUS * 3, 1> gyro_bank;
+    Vector3f accel_filtered[IMUS];
+    Vector3f gyro_filtered[IMUS];
+    setup_input();
+    accel_bank.set_lowpass(0, 0, IMUS * 3, SAMPLE_RATE, 20);
+    gyro_bank.set_lowpass(0, 0, IMUS * 3, SAMPLE_RATE, 20);
+    uint16_t n = 0;
+
+    while (state.KeepRunning()) {
+        const Vector3f &sample = input[n++ % INPUT_SAMPLES];
+        for (uint8_t i = 0; i < IMUS; i++) {
+            accel_filtered[i] = accel_bank.apply(i * 3, sample);
+            gyro_filtered[i] = gyro_bank.apply(i * 3, sample);
+        }
+        gbenchmark_escape(accel_filtered);
+        gbenchmark_escape(gyro_filtered);
+    }
+    state.SetItemsProcessed(state.iterations() * IMUS);
+}
+
+BENCHMARK(BM_BiquadBankPerInstance);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,92 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+#include <Filter/BiquadFilterBank.h>
+#include <Filter/LowPassFilter2p.h>
+
+// simple deterministic generator so failures are reproducible
+static uint32_t rand_state = 1;
+static float rand_float(float low, float high)
+{
+    rand_state = rand_state * 1103515245U + 12345U;
+    return low + (high - low) * ((rand_state >> 8) & 0xFFFF) / 65535.0f;
+}
+
+static Vector3f rand_sample()
+{
+    return Vector3f(rand_float(-20, 20), rand_float(-20, 20), rand_float(-20, 20));
+}
+
+// the bank has to give exactly what LowPassFilter2p gives
+#define EXPECT_SAME_VECTOR(a, b) do {                           \
+        EXPECT_EQ(0, memcmp(&(a), &(b), sizeof(Vector3f)))      \
+            << (a).x << "," << (a).y << "," << (a).z << " vs "  \
+            << (b).x << "," << (b).y << "," << (b).z;           \
+    } while (0)
+
+TEST(BiquadFilterBank, matches_lowpass2p)
+{
+    // instances at different rates and cutoffs, as the INS has
+    const float rates[] = { 1000, 8000, 800 };
+    const float cutoffs[] = { 20, 98, 0 };
+    const uint8_t num = ARRAY_SIZE(rates);
+
+    BiquadFilterBank<9, 1> bank;
+    LowPassFilter2pVector3f lp[num];
+    for (uint8_t i = 0; i < num; i++) {
+        bank.set_lowpass(0, i*3, 3, rates[i], cutoffs[i]);
+        lp[i].set_cutoff_frequency(rates[i], cutoffs[i]);
+    }
+
+    for (uint16_t n = 0; n < 2000; n++) {
+        for (uint8_t i = 0; i < num; i++) {
+            const Vector3f sample = rand_sample();
+            const Vector3f expected = lp[i].apply(sample);
+            const Vector3f got = bank.apply(i*3, sample);
+            EXPECT_SAME_VECTOR(expected, got);
+        }
+        if (n == 1000) {
+            // change the cutoffs part way through, including turning
+            // a filter off and another one on
+            const float new_cutoffs[] = { 0, 40, 15 };
+            for (uint8_t i = 0; i < num; i++) {
+                bank.set_lowpass(0, i*3, 3, rates[i], new_cutoffs[i]);
+                lp[i].set_cutoff_frequency(rates[i], new_cutoffs[i]);
+            }
+        }
+    }
+}
+
+TEST(BiquadFilterBank, passthrough_returns_input)
+{
+    BiquadFilterBank<3, 2> bank;
+    LowPassFilter2pVector3f lp;
+    bank.set_lowpass(0, 0, 3, 1000, 0);
+    lp.set_cutoff_frequency(1000, 0);
+
+    const float inf = INFINITY;
+    const Vector3f samples[] = {
+        Vector3f(1, 2, 3),
+        Vector3f(inf, -inf, 0),
+        Vector3f(4, 5, 6),
+    };
+    for (const Vector3f &sample : samples) {
+        const Vector3f expected = lp.apply(sample);
+        const Vector3f got = bank.apply(0, sample);
+        EXPECT_SAME_VECTOR(sample, got);
+        EXPECT_SAME_VECTOR(expected, got);
+    }
+
+    // turning the filter on afterwards starts from clean state
+    bank.set_lowpass(0, 0, 3, 1000, 20);
+    lp.set_cutoff_frequency(1000, 20);
+    for (uint8_t n = 0; n < 10; n++) {
+        const Vector3f sample = rand_sample();
+        const Vector3f expected = lp.apply(sample);
+        const Vector3f got = bank.apply(0, sample);
+        EXPECT_FALSE(got.is_nan());
+        EXPECT_SAME_VECTOR(expected, got);
+    }
+}
+
+AP_GTEST_MAIN()
@@ -28,6 +28,14 @@
     #define GCS_MAVLINK_PAYLOAD_STATUS_CAPACITY          30
 #endif
 
+// keep a snapshot of the parameter names for fast parameter downloads
+#ifndef GCS_PARAM_SNAPSHOT_ENABLED
+#define GCS_PARAM_SNAPSHOT_ENABLED (HAL_CPU_CLASS >= HAL_CPU_CLASS_1000)
+#endif
+
+// upper limit on the adaptive parameter download rate, in bytes/s
+#define GCS_PARAM_MAX_RATE 1000000U
+
 //  GCS Message ID's
 /// NOTE: to ensure we never block on sending MAVLink messages
 /// please keep each MSG_ to a single MAVLink message. If need be
@@ -206,6 +214,15 @@ public:
      */
     static bool find_by_mavtype(uint8_t mav_type, uint8_t &sysid, uint8_t &compid, mavlink_channel_t &channel) { return routing.find_by_mavtype(mav_type, sysid, compid, channel); }
 
+    /*
+      set the size of the routing table. Must be called before any
+      routes are learned, otherwise MAVLINK_MAX_ROUTES is used
+     */
+    static bool init_routing(uint16_t max_routes) { return routing.init(max_routes); }
+
+    // routing table counters
+    static const MAVLink_routing::routing_stats &get_routing_stats(void) { return routing.get_stats(); }
+
     /*
       set a dataflash pointer for logging
      */
@@ -304,6 +321,47 @@ private:
                                                          // queued send
     uint32_t                    _queued_parameter_send_time_ms;
 
+    // parameter download pacing. The rate starts from the link
+    // baudrate and adapts to how fast the link drains on links with
+    // flow control
+    uint32_t                    _link_baudrate;
+    uint32_t                    _param_send_rate;       ///< bytes per second
+    uint16_t                    _param_txspace_max;
+    uint16_t param_bytes_allowed(uint32_t dt_ms, uint16_t txspace);
+
+    /*
+      snapshot of the parameter list shared by all channels, so a
+      download doesn't need to build each name from the var_info
+      tree. Entries are in parameter index order. The value is the
+      last one reported to a GCS and is used to find changed
+      parameters and to form the _HASH_CHECK CRC. resend_mask holds
+      the channels that have the list but missed the last change, and
+      change_ms is when a changed value was last sent
+     */
+    struct param_snapshot_entry {
+        char name[AP_MAX_NAME_SIZE+1];
+        uint8_t type;
+        uint8_t resend_mask;
+        float value;
+        uint32_t change_ms;
+    };
+    static struct param_snapshot_entry *_param_snapshot;
+    static uint16_t _param_snapshot_count;
+    static uint16_t _param_snapshot_generation;
+    static bool _param_snapshot_failed;
+    static uint8_t _param_snapshot_sent_mask;   ///< channels that completed a download
+
+    // position of this channel's scan for changed parameters
+    uint16_t _param_scan_index;
+    uint32_t _param_scan_ms;
+
+    static bool param_snapshot_update(void);
+    static uint32_t param_hash_check_value(void);
+    static void param_snapshot_reported(const char *param_name, float value, uint8_t sent_mask);
+    void param_snapshot_sent(uint16_t idx, float value);
+    void param_snapshot_scan(void);
+    void send_param_hash_check(void);
+
     /// Count the number of reportable parameters.
     ///
     /// Not all parameters can be reported via MAVlink.  We count the number
@@ -55,6 +55,9 @@ GCS_MAVLINK::init(AP_HAL::UARTDriver *port, mavlink_channel_t mav_chan)
     mavlink_comm_port[chan] = _port;
     initialised = true;
     _queued_parameter = nullptr;
+    _param_send_rate = 0;
+    _param_txspace_max = 0;
+    _param_scan_index = 0;
     reset_cli_timeout();
 }
 
@@ -105,7 +108,8 @@ GCS_MAVLINK::setup_uart(const AP_SerialManager& serial_manager, AP_SerialManager
     uart->set_flow_control(old_flow_control);
 
     // now change back to desired baudrate
-    uart->begin(serial_manager.find_baudrate(protocol, instance));
+    _link_baudrate = serial_manager.find_baudrate(protocol, instance);
+    uart->begin(_link_baudrate);
 
     // and init the gcs instance
     init(uart, mav_chan);
@@ -150,16 +154,29 @@ GCS_MAVLINK::queued_param_send()
     }
 
     uint16_t bytes_allowed;
-    uint8_t count;
+    uint16_t count;
     uint32_t tnow = AP_HAL::millis();
+    const uint16_t txspace = comm_get_txspace(chan);
+    const uint16_t msg_len = MAVLINK_MSG_ID_PARAM_VALUE_LEN + packet_overhead();
 
-    // use at most 30% of bandwidth on parameters. The constant 26 is
-    // 1/(1000 * 1/8 * 0.001 * 0.3)
-    bytes_allowed = 57 * (tnow - _queued_parameter_send_time_ms) * 26;
-    if (bytes_allowed > comm_get_txspace(chan)) {
-        bytes_allowed = comm_get_txspace(chan);
+    // unused credit carries over between calls, up to a second of it
+    if ((int32_t)(tnow - _queued_parameter_send_time_ms) < 0) {
+        // still paying for a message sent ahead of the budget
+        return;
+    }
+    if (tnow - _queued_parameter_send_time_ms > 1000) {
+        _queued_parameter_send_time_ms = tnow - 1000;
+    }
+
+    // pace the download to the link, see param_bytes_allowed()
+    bytes_allowed = param_bytes_allowed(tnow - _queued_parameter_send_time_ms, txspace);
+    count = bytes_allowed / msg_len;
+
+    // on slow links the budget may not yet cover a whole message,
+    // send one anyway and pay for it from the following calls
+    if (count == 0 && txspace >= msg_len) {
+        count = 1;
     }
-    count = bytes_allowed / (MAVLINK_MSG_ID_PARAM_VALUE_LEN + packet_overhead());
 
     // when we don't have flow control we really need to keep the
     // param download very slow, or it tends to stall
@@ -167,6 +184,11 @@ GCS_MAVLINK::queued_param_send()
         count = 5;
     }
 
+    // names come from the snapshot when it matches this download
+    const bool use_snapshot = param_snapshot_update() &&
+        _param_snapshot_count == _queued_parameter_count;
+
+    uint32_t sent = 0;
     while (_queued_parameter != nullptr && count--) {
         AP_Param      *vp;
         float value;
@@ -177,8 +199,14 @@ GCS_MAVLINK::queued_param_send()
         // if the parameter can be cast to float, report it here and break out of the loop
         value = vp->cast_to_float(_queued_parameter_type);
 
-        char param_name[AP_MAX_NAME_SIZE];
-        vp->copy_name_token(_queued_parameter_token, param_name, sizeof(param_name), true);
+        const char *param_name;
+        char name_buf[AP_MAX_NAME_SIZE];
+        if (use_snapshot && _queued_parameter_index < _param_snapshot_count) {
+            param_name = _param_snapshot[_queued_parameter_index].name;
+        } else {
+            vp->copy_name_token(_queued_parameter_token, name_buf, sizeof(name_buf), true);
+            param_name = name_buf;
+        }
 
         mavlink_msg_param_value_send(
             chan,
@@ -188,10 +216,22 @@ GCS_MAVLINK::queued_param_send()
             _queued_parameter_count,
             _queued_parameter_index);
 
+        if (use_snapshot) {
+            param_snapshot_sent(_queued_parameter_index, value);
+        }
+
         _queued_parameter = AP_Param::next_scalar(&_queued_parameter_token, &_queued_parameter_type);
         _queued_parameter_index++;
+        sent++;
     }
-    _queued_parameter_send_time_ms = tnow;
+    if (_queued_parameter == nullptr && use_snapshot) {
+        // this GCS now has the full list, keep it up to date
+        _param_snapshot_sent_mask |= 1U<<(chan-MAVLINK_COMM_0);
+    }
+
+    // only advance the send time by the bytes actually used, so unused
+    // budget is kept for the next call
+    _queued_parameter_send_time_ms += (sent * msg_len * 1000U + _param_send_rate - 1) / _param_send_rate;
 }
 
 /**
@@ -588,6 +628,14 @@ void GCS_MAVLINK::handle_param_request_read(mavlink_message_t *msg)
     mavlink_param_request_read_t packet;
     mavlink_msg_param_request_read_decode(msg, &packet);
 
+    if (packet.param_index == -1 &&
+        strncmp(packet.param_id, "_HASH_CHECK", sizeof(packet.param_id)) == 0) {
+        if (HAVE_PAYLOAD_SPACE(chan, PARAM_VALUE)) {
+            send_param_hash_check();
+        }
+        return;
+    }
+
     /*
       we reserve some space for sending parameters if the client ever
       fails to get a parameter due to lack of space
@@ -1025,6 +1073,9 @@ GCS_MAVLINK::update(run_cli_fn run_cli)
         }
     }
 
+    // send parameters changed since they were downloaded
+    param_snapshot_scan();
+
     if (!waypoint_receiving) {
         return;
     }
@@ -1423,6 +1474,7 @@ void GCS_MAVLINK::service_statustext(void)
  */
 void GCS_MAVLINK::send_parameter_value_all(const char *param_name, ap_var_type param_type, float param_value)
 {
+    uint8_t sent_mask = 0;
     for (uint8_t i=0; i<MAVLINK_COMM_NUM_BUFFERS; i++) {
         if ((1U<<i) & mavlink_active) {
             mavlink_channel_t chan = (mavlink_channel_t)(MAVLINK_COMM_0+i);
@@ -1434,9 +1486,13 @@ void GCS_MAVLINK::send_parameter_value_all(const char *param_name, ap_var_type p
                     mav_var_type(param_type),
                     AP_Param::count_parameters(),
                     -1);
+                sent_mask |= 1U<<i;
             }
         }
     }
+    // channels that missed it get it from their parameter scan
+    param_snapshot_reported(param_name, param_value, sent_mask);
+
     // also log to DataFlash
     DataFlash_Class *dataflash = DataFlash_Class::instance();
     if (dataflash != nullptr) {
@@ -1795,6 +1851,9 @@ uint8_t GCS_MAVLINK::handle_preflight_reboot(const mavlink_command_long_t &packe
         // force safety on 
         hal.rcout->force_safety_on();
         hal.rcout->force_safety_no_wait();
+
+        // write out any queued parameter saves
+        AP_Param::flush();
         hal.scheduler->delay(200);
 
         // when packet.param1 == 3 we reboot to hold in bootloader
@@ -149,6 +149,28 @@ void comm_send_buffer(mavlink_channel_t chan, const uint8_t *buf, uint8_t len)
     mavlink_comm_port[chan]->write(buf, len);
 }
 
+/*
+  start sending a message of size bytes out a MAVLink channel
+ */
+void comm_send_begin(mavlink_channel_t chan, uint16_t size)
+{
+    if (!valid_channel(chan)) {
+        return;
+    }
+    mavlink_comm_port[chan]->begin_write(size);
+}
+
+/*
+  finish sending a message out a MAVLink channel
+ */
+void comm_send_end(mavlink_channel_t chan)
+{
+    if (!valid_channel(chan)) {
+        return;
+    }
+    mavlink_comm_port[chan]->end_write();
+}
+
 extern const AP_HAL::HAL& hal;
 
 /*
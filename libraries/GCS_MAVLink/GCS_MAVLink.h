@@ -12,6 +12,11 @@
 
 #define MAVLINK_SEND_UART_BYTES(chan, buf, len) comm_send_buffer(chan, buf, len)
 
+// bracket each message so the UART can serialise it straight into
+// reserved transmit buffer space
+#define MAVLINK_START_UART_SEND(chan, size) comm_send_begin(chan, size)
+#define MAVLINK_END_UART_SEND(chan, size) comm_send_end(chan)
+
 // allow five telemetry ports
 #define MAVLINK_COMM_NUM_BUFFERS 5
 
@@ -60,6 +65,10 @@ static inline void comm_send_ch(mavlink_channel_t chan, uint8_t ch)
 
 void comm_send_buffer(mavlink_channel_t chan, const uint8_t *buf, uint8_t len);
 
+/// Start and finish sending a message of size bytes on a MAVLink channel
+void comm_send_begin(mavlink_channel_t chan, uint16_t size);
+void comm_send_end(mavlink_channel_t chan);
+
 /// Read a byte from the nominated MAVLink channel
 ///
 /// @param chan		Channel to receive on
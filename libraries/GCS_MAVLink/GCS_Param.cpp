@@ -0,0 +1,310 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  parameter download support: the shared parameter snapshot,
+  download pacing and the _HASH_CHECK parameter
+ */
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
+#include "GCS.h"
+
+extern const AP_HAL::HAL& hal;
+
+// number of parameters checked for changes on each scan
+#define PARAM_SCAN_COUNT 32
+
+// interval between scans for changed parameters
+#define PARAM_SCAN_INTERVAL_MS 100
+
+// minimum time between sends of a parameter that keeps changing
+#define PARAM_CHANGE_INTERVAL_MS 5000
+
+struct GCS_MAVLINK::param_snapshot_entry *GCS_MAVLINK::_param_snapshot;
+uint16_t GCS_MAVLINK::_param_snapshot_count;
+uint16_t GCS_MAVLINK::_param_snapshot_generation;
+bool GCS_MAVLINK::_param_snapshot_failed;
+uint8_t GCS_MAVLINK::_param_snapshot_sent_mask;
+
+/*
+  make sure the parameter snapshot matches the current parameter
+  list, rebuilding it if the list has changed. Returns false if
+  there is no snapshot available
+ */
+bool GCS_MAVLINK::param_snapshot_update(void)
+{
+#if GCS_PARAM_SNAPSHOT_ENABLED
+    if (_param_snapshot != nullptr &&
+        _param_snapshot_generation == AP_Param::index_generation()) {
+        return true;
+    }
+    if (_param_snapshot_failed) {
+        return false;
+    }
+
+    const uint16_t count = AP_Param::count_parameters();
+    const uint16_t generation = AP_Param::index_generation();
+    if (count == 0) {
+        return false;
+    }
+    struct param_snapshot_entry *snapshot = (struct param_snapshot_entry *)calloc(count, sizeof(snapshot[0]));
+    if (snapshot == nullptr) {
+        free(_param_snapshot);
+        _param_snapshot = nullptr;
+        _param_snapshot_count = 0;
+        _param_snapshot_sent_mask = 0;
+        _param_snapshot_failed = true;
+        return false;
+    }
+
+    AP_Param::ParamToken token;
+    enum ap_var_type type;
+    uint16_t i = 0;
+    for (AP_Param *vp = AP_Param::first(&token, &type);
+         vp != nullptr && i < count;
+         vp = AP_Param::next_scalar(&token, &type), i++) {
+        struct param_snapshot_entry &e = snapshot[i];
+        vp->copy_name_token(token, e.name, AP_MAX_NAME_SIZE, true);
+        e.name[AP_MAX_NAME_SIZE] = 0;
+        e.type = type;
+        e.value = vp->cast_to_float(type);
+    }
+
+    /*
+      the index is rebuilt for reasons that don't change the
+      list. When the names are the same the channels keep their
+      downloaded list, and the last sent values are kept so the scan
+      still sends changes made before the rebuild
+     */
+    bool same_list = (_param_snapshot != nullptr && _param_snapshot_count == i);
+    for (uint16_t j=0; same_list && j<i; j++) {
+        same_list = (snapshot[j].type == _param_snapshot[j].type &&
+                     strncmp(snapshot[j].name, _param_snapshot[j].name, AP_MAX_NAME_SIZE) == 0);
+    }
+    if (same_list) {
+        free(snapshot);
+        _param_snapshot_generation = generation;
+        return true;
+    }
+
+    free(_param_snapshot);
+    _param_snapshot_sent_mask = 0;
+    _param_snapshot = snapshot;
+    _param_snapshot_count = i;
+    _param_snapshot_generation = generation;
+    return true;
+#else
+    return false;
+#endif
+}
+
+/*
+  record that this channel has sent a parameter value. Other channels
+  that already have the list are marked to get the new value from
+  their own scan
+ */
+void GCS_MAVLINK::param_snapshot_sent(uint16_t idx, float value)
+{
+    if (_param_snapshot == nullptr || idx >= _param_snapshot_count) {
+        return;
+    }
+    const uint8_t chan_mask = 1U<<(chan-MAVLINK_COMM_0);
+    struct param_snapshot_entry &e = _param_snapshot[idx];
+    if (memcmp(&value, &e.value, sizeof(value)) != 0) {
+        e.value = value;
+        e.resend_mask = _param_snapshot_sent_mask;
+        e.change_ms = AP_HAL::millis();
+    }
+    e.resend_mask &= ~chan_mask;
+}
+
+/*
+  record a value sent by send_parameter_value_all(), such as the
+  reply to a PARAM_SET, so the scan doesn't send it again. sent_mask
+  is the channels it went out on
+ */
+void GCS_MAVLINK::param_snapshot_reported(const char *param_name, float value, uint8_t sent_mask)
+{
+    if (_param_snapshot == nullptr ||
+        _param_snapshot_generation != AP_Param::index_generation()) {
+        return;
+    }
+    for (uint16_t i=0; i<_param_snapshot_count; i++) {
+        struct param_snapshot_entry &e = _param_snapshot[i];
+        if (strncmp(param_name, e.name, AP_MAX_NAME_SIZE) != 0) {
+            continue;
+        }
+        if (memcmp(&value, &e.value, sizeof(value)) != 0) {
+            e.value = value;
+            e.resend_mask = _param_snapshot_sent_mask;
+        }
+        e.resend_mask &= ~sent_mask;
+        return;
+    }
+}
+
+/*
+  once this channel has downloaded the parameters, check a few of
+  them on each call for values changed by the vehicle itself and send
+  just those, so a GCS that keeps its parameter list stays in
+  sync. The snapshot is only updated once the value has been sent
+ */
+void GCS_MAVLINK::param_snapshot_scan(void)
+{
+    const uint8_t chan_mask = 1U<<(chan-MAVLINK_COMM_0);
+    if (!(_param_snapshot_sent_mask & chan_mask)) {
+        return;
+    }
+    const uint32_t now = AP_HAL::millis();
+    if (now - _param_scan_ms < PARAM_SCAN_INTERVAL_MS) {
+        return;
+    }
+    _param_scan_ms = now;
+    if (!param_snapshot_update() || !(_param_snapshot_sent_mask & chan_mask)) {
+        return;
+    }
+
+    for (uint8_t n=0; n<PARAM_SCAN_COUNT; n++) {
+        if (_param_scan_index >= _param_snapshot_count) {
+            _param_scan_index = 0;
+        }
+        enum ap_var_type type;
+        AP_Param::ParamToken token;
+        AP_Param *vp = AP_Param::find_by_index(_param_scan_index, &type, &token);
+        if (vp == nullptr) {
+            _param_scan_index = 0;
+            break;
+        }
+        const struct param_snapshot_entry &e = _param_snapshot[_param_scan_index];
+        const float value = vp->cast_to_float(type);
+        // a parameter the vehicle keeps updating, such as a learned
+        // offset, is only sent every PARAM_CHANGE_INTERVAL_MS
+        const bool changed = memcmp(&value, &e.value, sizeof(value)) != 0 &&
+            now - e.change_ms >= PARAM_CHANGE_INTERVAL_MS;
+        if (changed || (e.resend_mask & chan_mask)) {
+            if (!HAVE_PAYLOAD_SPACE(chan, PARAM_VALUE)) {
+                // try this parameter again on the next scan
+                break;
+            }
+            mavlink_msg_param_value_send(
+                chan,
+                e.name,
+                value,
+                mav_var_type(type),
+                _param_snapshot_count,
+                _param_scan_index);
+            param_snapshot_sent(_param_scan_index, value);
+        }
+        _param_scan_index++;
+    }
+}
+
+/*
+  update a CRC32 with a block of bytes
+ */
+static uint32_t param_crc32(uint32_t crc, const void *data, uint16_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    crc = ~crc;
+    while (len--) {
+        crc ^= *p++;
+        for (uint8_t b=0; b<8; b++) {
+            crc = (crc >> 1) ^ (0xEDB88320U & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+/*
+  CRC32 over the name, type and current value of every parameter, in
+  index order. A GCS that has cached the parameter list can compare
+  this with its own to skip the download on reconnect
+ */
+uint32_t GCS_MAVLINK::param_hash_check_value(void)
+{
+    const bool have_snapshot = param_snapshot_update();
+
+    uint32_t crc = 0;
+    AP_Param::ParamToken token;
+    enum ap_var_type type;
+    uint16_t i = 0;
+    for (AP_Param *vp = AP_Param::first(&token, &type);
+         vp != nullptr;
+         vp = AP_Param::next_scalar(&token, &type), i++) {
+        char name_buf[AP_MAX_NAME_SIZE+1];
+        const char *name;
+        if (have_snapshot && i < _param_snapshot_count) {
+            name = _param_snapshot[i].name;
+        } else {
+            vp->copy_name_token(token, name_buf, AP_MAX_NAME_SIZE, true);
+            name_buf[AP_MAX_NAME_SIZE] = 0;
+            name = name_buf;
+        }
+        const uint8_t type8 = type;
+        const float value = vp->cast_to_float(type);
+        crc = param_crc32(crc, name, strlen(name));
+        crc = param_crc32(crc, &type8, sizeof(type8));
+        crc = param_crc32(crc, &value, sizeof(value));
+    }
+    return crc;
+}
+
+/*
+  reply to a PARAM_REQUEST_READ for _HASH_CHECK with the CRC of the
+  parameter list, sent as the raw bits of a uint32 parameter
+ */
+void GCS_MAVLINK::send_param_hash_check(void)
+{
+    const uint32_t crc = param_hash_check_value();
+    float value;
+    memcpy(&value, &crc, sizeof(value));
+    mavlink_msg_param_value_send(
+        chan,
+        "_HASH_CHECK",
+        value,
+        MAV_PARAM_TYPE_UINT32,
+        AP_Param::count_parameters(),
+        -1);
+}
+
+/*
+  work out how many bytes of parameters can be sent now. The rate
+  starts at half of the link baudrate. On links with flow control it
+  is raised while the transmit buffer keeps draining, and halved
+  when the buffer backs up
+ */
+uint16_t GCS_MAVLINK::param_bytes_allowed(uint32_t dt_ms, uint16_t txspace)
+{
+    // half of the link in bytes per second, with 10 bits per byte
+    const uint32_t base_rate = (_link_baudrate != 0 ? _link_baudrate : 57600) / 20;
+
+    if (txspace > _param_txspace_max) {
+        _param_txspace_max = txspace;
+    }
+    if (_param_send_rate < base_rate) {
+        _param_send_rate = base_rate;
+    }
+    if (have_flow_control()) {
+        if (txspace >= (_param_txspace_max*3)/4) {
+            _param_send_rate = MIN(_param_send_rate + _param_send_rate/4, GCS_PARAM_MAX_RATE);
+        } else if (txspace < _param_txspace_max/4) {
+            _param_send_rate = MAX(_param_send_rate/2, base_rate);
+        }
+    } else {
+        _param_send_rate = base_rate;
+    }
+
+    const uint32_t bytes = (_param_send_rate * dt_ms) / 1000;
+    return MIN(bytes, (uint32_t)txspace);
+}
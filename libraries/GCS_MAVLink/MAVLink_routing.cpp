@@ -27,7 +27,49 @@ extern const AP_HAL::HAL& hal;
 #define ROUTING_DEBUG 0
 
 // constructor
-MAVLink_routing::MAVLink_routing(void) : num_routes(0) {}
+MAVLink_routing::MAVLink_routing(void) :
+    routes(nullptr),
+    num_routes(0),
+    max_routes(0),
+    route_index(nullptr),
+    route_index_mask(0),
+    all_chan_mask(0),
+    no_route_mask(0)
+{
+    memset(sysid_chan_mask, 0, sizeof(sysid_chan_mask));
+    memset(&stats, 0, sizeof(stats));
+}
+
+/*
+  allocate the routing table and its hash index. The index has at
+  least twice as many slots as there are routes to keep probe
+  sequences short
+ */
+bool MAVLink_routing::init(uint16_t _max_routes)
+{
+    if (routes != nullptr || _max_routes == 0 || _max_routes > 0x4000) {
+        return false;
+    }
+    uint16_t index_size = 1;
+    while (index_size < 2*_max_routes) {
+        index_size <<= 1;
+    }
+    routes = (struct route *)calloc(_max_routes, sizeof(routes[0]));
+    route_index = (uint16_t *)calloc(index_size, sizeof(route_index[0]));
+    if (routes == nullptr || route_index == nullptr) {
+        free(routes);
+        free(route_index);
+        routes = nullptr;
+        route_index = nullptr;
+        return false;
+    }
+    for (uint16_t i=0; i<index_size; i++) {
+        route_index[i] = MAVLINK_ROUTE_INDEX_EMPTY;
+    }
+    route_index_mask = index_size - 1;
+    max_routes = _max_routes;
+    return true;
+}
 
 /*
   forward a MAVLink message to the right port. This also
@@ -135,35 +177,24 @@ bool MAVLink_routing::check_and_forward(mavlink_channel_t in_channel, const mavl
     }
 
     // forward on any channels matching the targets
-    bool forwarded = false;
-    bool sent_to_chan[MAVLINK_COMM_NUM_BUFFERS];
-    memset(sent_to_chan, 0, sizeof(sent_to_chan));
-    for (uint8_t i=0; i<num_routes; i++) {
-        if (broadcast_system || (target_system == routes[i].sysid &&
-                                 (broadcast_component || 
-                                  target_component == routes[i].compid ||
-                                  !match_system))) {
-            if (in_channel != routes[i].channel && !sent_to_chan[routes[i].channel]) {
-                if (comm_get_txspace(routes[i].channel) >= ((uint16_t)msg->len) +
-                    GCS_MAVLINK::packet_overhead_chan(routes[i].channel)) {
-#if ROUTING_DEBUG
-                    ::printf("fwd msg %u from chan %u on chan %u sysid=%d compid=%d\n",
-                             msg->msgid,
-                             (unsigned)in_channel,
-                             (unsigned)routes[i].channel,
-                             (int)target_system,
-                             (int)target_component);
-#endif
-                    _mavlink_resend_uart(routes[i].channel, msg);
-                }
-                sent_to_chan[routes[i].channel] = true;
-                forwarded = true;
-            }
-        }
+    uint8_t mask;
+    if (broadcast_system) {
+        mask = all_chan_mask;
+    } else if (broadcast_component || !match_system) {
+        mask = sysid_chan_mask[target_system];
+    } else {
+        int16_t idx = route_find(target_system, target_component);
+        mask = (idx == -1) ? 0 : routes[idx].chan_mask;
     }
+    mask &= ~(1U<<(in_channel-MAVLINK_COMM_0));
+
+    bool forwarded = forward_on_mask(mask, in_channel, msg);
     if (!forwarded && match_system) {
         process_locally = true;
     }
+    if (!forwarded && !broadcast_system && !process_locally) {
+        stats.unknown++;
+    }
 
     return process_locally;
 }
@@ -175,26 +206,55 @@ bool MAVLink_routing::check_and_forward(mavlink_channel_t in_channel, const mavl
 */
 void MAVLink_routing::send_to_components(const mavlink_message_t* msg)
 {
-    bool sent_to_chan[MAVLINK_COMM_NUM_BUFFERS];
-    memset(sent_to_chan, 0, sizeof(sent_to_chan));
-
     // check learned routes
-    for (uint8_t i=0; i<num_routes; i++) {
-        if ((routes[i].sysid == mavlink_system.sysid) && !sent_to_chan[routes[i].channel]) {
-            if (comm_get_txspace(routes[i].channel) >= ((uint16_t)msg->len) +
-                GCS_MAVLINK::packet_overhead_chan(routes[i].channel)) {
+    uint8_t mask = sysid_chan_mask[mavlink_system.sysid];
+    for (uint8_t i=0; i<MAVLINK_COMM_NUM_BUFFERS; i++) {
+        if (!(mask & (1U<<i))) {
+            continue;
+        }
+        mavlink_channel_t channel = (mavlink_channel_t)(MAVLINK_COMM_0 + i);
+        if (comm_get_txspace(channel) >= ((uint16_t)msg->len) +
+            GCS_MAVLINK::packet_overhead_chan(channel)) {
 #if ROUTING_DEBUG
-                ::printf("send msg %u on chan %u sysid=%u compid=%u\n",
-                         msg->msgid,
-                         (unsigned)routes[i].channel,
-                         (unsigned)routes[i].sysid,
-                         (unsigned)routes[i].compid);
+            ::printf("send msg %u on chan %u sysid=%u\n",
+                     msg->msgid,
+                     (unsigned)channel,
+                     (unsigned)mavlink_system.sysid);
 #endif
-                _mavlink_resend_uart(routes[i].channel, msg);
-                sent_to_chan[routes[i].channel] = true;
-            }
+            _mavlink_resend_uart(channel, msg);
+        }
+    }
+}
+
+/*
+  send a message on each channel in a mask, counting forwarded and
+  dropped packets. Returns true if there were any channels to send on
+ */
+bool MAVLink_routing::forward_on_mask(uint8_t mask, mavlink_channel_t in_channel, const mavlink_message_t* msg)
+{
+    if (mask == 0) {
+        return false;
+    }
+    for (uint8_t i=0; i<MAVLINK_COMM_NUM_BUFFERS; i++) {
+        if (!(mask & (1U<<i))) {
+            continue;
+        }
+        mavlink_channel_t channel = (mavlink_channel_t)(MAVLINK_COMM_0 + i);
+        if (comm_get_txspace(channel) >= ((uint16_t)msg->len) +
+            GCS_MAVLINK::packet_overhead_chan(channel)) {
+#if ROUTING_DEBUG
+            ::printf("fwd msg %u from chan %u on chan %u\n",
+                     msg->msgid,
+                     (unsigned)in_channel,
+                     (unsigned)channel);
+#endif
+            _mavlink_resend_uart(channel, msg);
+            stats.forwarded++;
+        } else {
+            stats.dropped++;
         }
     }
+    return true;
 }
 
 /*
@@ -204,11 +264,17 @@ void MAVLink_routing::send_to_components(const mavlink_message_t* msg)
 bool MAVLink_routing::find_by_mavtype(uint8_t mavtype, uint8_t &sysid, uint8_t &compid, mavlink_channel_t &channel)
 {
     // check learned routes
-    for (uint8_t i=0; i<num_routes; i++) {
+    for (uint16_t i=0; i<num_routes; i++) {
         if (routes[i].mavtype == mavtype) {
             sysid = routes[i].sysid;
             compid = routes[i].compid;
-            channel = routes[i].channel;
+            // use the lowest channel the component has been heard on
+            for (uint8_t c=0; c<MAVLINK_COMM_NUM_BUFFERS; c++) {
+                if (routes[i].chan_mask & (1U<<c)) {
+                    channel = (mavlink_channel_t)(MAVLINK_COMM_0 + c);
+                    break;
+                }
+            }
             return true;
         }
     }
@@ -217,35 +283,164 @@ bool MAVLink_routing::find_by_mavtype(uint8_t mavtype, uint8_t &sysid, uint8_t &
     return false;
 }
 
+/*
+  hash a sysid/compid pair to a slot in the route index
+ */
+uint16_t MAVLink_routing::route_hash(uint8_t sysid, uint8_t compid) const
+{
+    uint32_t h = (((uint32_t)sysid << 8) | compid) * 2654435761U;
+    return (h >> 16) & route_index_mask;
+}
+
+/*
+  find the route for a sysid/compid pair, returning -1 if it is not
+  known
+ */
+int16_t MAVLink_routing::route_find(uint8_t sysid, uint8_t compid) const
+{
+    if (route_index == nullptr) {
+        return -1;
+    }
+    for (uint16_t slot = route_hash(sysid, compid);
+         route_index[slot] != MAVLINK_ROUTE_INDEX_EMPTY;
+         slot = (slot+1) & route_index_mask) {
+        const struct route &r = routes[route_index[slot]];
+        if (r.sysid == sysid && r.compid == compid) {
+            return route_index[slot];
+        }
+    }
+    return -1;
+}
+
+/*
+  remove a sysid/compid pair from the route index. Later entries in
+  the probe sequence are shifted back so lookups never need
+  tombstones
+ */
+void MAVLink_routing::route_index_remove(uint8_t sysid, uint8_t compid)
+{
+    uint16_t slot = route_hash(sysid, compid);
+    while (route_index[slot] != MAVLINK_ROUTE_INDEX_EMPTY) {
+        const struct route &r = routes[route_index[slot]];
+        if (r.sysid == sysid && r.compid == compid) {
+            break;
+        }
+        slot = (slot+1) & route_index_mask;
+    }
+    if (route_index[slot] == MAVLINK_ROUTE_INDEX_EMPTY) {
+        return;
+    }
+    uint16_t next = (slot+1) & route_index_mask;
+    while (route_index[next] != MAVLINK_ROUTE_INDEX_EMPTY) {
+        const struct route &r = routes[route_index[next]];
+        uint16_t home = route_hash(r.sysid, r.compid);
+        // move the entry back if its home slot is not between the
+        // hole and its current slot
+        if (((next - home) & route_index_mask) >= ((next - slot) & route_index_mask)) {
+            route_index[slot] = route_index[next];
+            slot = next;
+        }
+        next = (next+1) & route_index_mask;
+    }
+    route_index[slot] = MAVLINK_ROUTE_INDEX_EMPTY;
+}
+
+/*
+  evict the least recently heard route if it has timed out. Returns
+  true if a route was removed
+ */
+bool MAVLink_routing::evict_route(void)
+{
+    if (num_routes == 0) {
+        return false;
+    }
+    uint32_t now = AP_HAL::millis();
+    uint16_t oldest = 0;
+    for (uint16_t i=1; i<num_routes; i++) {
+        if (now - routes[i].last_seen_ms > now - routes[oldest].last_seen_ms) {
+            oldest = i;
+        }
+    }
+    if (now - routes[oldest].last_seen_ms < MAVLINK_ROUTE_TIMEOUT_MS) {
+        return false;
+    }
+    uint8_t sysid = routes[oldest].sysid;
+#if ROUTING_DEBUG
+    ::printf("evicted route %u %u\n",
+             (unsigned)sysid,
+             (unsigned)routes[oldest].compid);
+#endif
+    route_index_remove(sysid, routes[oldest].compid);
+
+    // keep the route array dense by moving the last route into the hole
+    uint16_t last = num_routes - 1;
+    if (oldest != last) {
+        for (uint16_t slot = route_hash(routes[last].sysid, routes[last].compid);
+             route_index[slot] != MAVLINK_ROUTE_INDEX_EMPTY;
+             slot = (slot+1) & route_index_mask) {
+            if (route_index[slot] == last) {
+                route_index[slot] = oldest;
+                break;
+            }
+        }
+        routes[oldest] = routes[last];
+    }
+    num_routes--;
+
+    // rebuild the channel masks that the route contributed to
+    sysid_chan_mask[sysid] = 0;
+    all_chan_mask = 0;
+    for (uint16_t i=0; i<num_routes; i++) {
+        if (routes[i].sysid == sysid) {
+            sysid_chan_mask[sysid] |= routes[i].chan_mask;
+        }
+        all_chan_mask |= routes[i].chan_mask;
+    }
+    stats.evicted++;
+    return true;
+}
+
 /*
   see if the message is for a new route and learn it
 */
 void MAVLink_routing::learn_route(mavlink_channel_t in_channel, const mavlink_message_t* msg)
 {
-    uint8_t i;
     if (msg->sysid == 0 || 
         (msg->sysid == mavlink_system.sysid && 
          msg->compid == mavlink_system.compid)) {
         return;
     }
-    for (i=0; i<num_routes; i++) {
-        if (routes[i].sysid == msg->sysid && 
-            routes[i].compid == msg->compid &&
-            routes[i].channel == in_channel) {
-            if (routes[i].mavtype == 0 && msg->msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-                routes[i].mavtype = mavlink_msg_heartbeat_get_type(msg);
-            }
-            break;
-        }
+    if (routes == nullptr && !init(MAVLINK_MAX_ROUTES)) {
+        return;
     }
-    if (i == num_routes && i<MAVLINK_MAX_ROUTES) {
-        routes[i].sysid = msg->sysid;
-        routes[i].compid = msg->compid;
-        routes[i].channel = in_channel;
-        if (msg->msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-            routes[i].mavtype = mavlink_msg_heartbeat_get_type(msg);
+    const uint8_t chan_bit = 1U<<(in_channel-MAVLINK_COMM_0);
+    int16_t idx = route_find(msg->sysid, msg->compid);
+    if (idx == -1) {
+        if (num_routes == max_routes && !evict_route()) {
+            stats.overflow++;
+            return;
+        }
+        idx = num_routes++;
+        struct route &r = routes[idx];
+        r.sysid = msg->sysid;
+        r.compid = msg->compid;
+        r.chan_mask = 0;
+        r.mavtype = 0;
+        uint16_t slot = route_hash(r.sysid, r.compid);
+        while (route_index[slot] != MAVLINK_ROUTE_INDEX_EMPTY) {
+            slot = (slot+1) & route_index_mask;
         }
-        num_routes++;
+        route_index[slot] = idx;
+    }
+    struct route &r = routes[idx];
+    r.last_seen_ms = AP_HAL::millis();
+    if (r.mavtype == 0 && msg->msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+        r.mavtype = mavlink_msg_heartbeat_get_type(msg);
+    }
+    if (!(r.chan_mask & chan_bit)) {
+        r.chan_mask |= chan_bit;
+        sysid_chan_mask[r.sysid] |= chan_bit;
+        all_chan_mask |= chan_bit;
 #if ROUTING_DEBUG
         ::printf("learned route %u %u via %u\n",
                  (unsigned)msg->sysid, 
@@ -273,10 +468,9 @@ void MAVLink_routing::handle_heartbeat(mavlink_channel_t in_channel, const mavli
     mask &= ~no_route_mask;
     
     // mask out channels that are known sources for this sysid/compid
-    for (uint8_t i=0; i<num_routes; i++) {
-        if (routes[i].sysid == msg->sysid && routes[i].compid == msg->compid) {
-            mask &= ~(1U<<((unsigned)(routes[i].channel-MAVLINK_COMM_0)));
-        }
+    int16_t idx = route_find(msg->sysid, msg->compid);
+    if (idx != -1) {
+        mask &= ~routes[idx].chan_mask;
     }
 
     if (mask == 0) {
@@ -6,9 +6,21 @@
 #include <AP_Common/AP_Common.h>
 #include "GCS_MAVLink.h"
 
-// 20 routes should be enough for now. This may need to increase as
-// we make more extensive use of MAVLink forwarding
+// default number of routes. Swarms and companion computers with many
+// components can need more, which can be set with init()
+#ifndef MAVLINK_MAX_ROUTES
+#if HAL_CPU_CLASS >= HAL_CPU_CLASS_1000
+#define MAVLINK_MAX_ROUTES 64
+#else
 #define MAVLINK_MAX_ROUTES 20
+#endif
+#endif
+
+// a route that has not been heard from for this long can be evicted
+// to make room for a new one when the table is full
+#define MAVLINK_ROUTE_TIMEOUT_MS 10000
+
+#define MAVLINK_ROUTE_INDEX_EMPTY 0xFFFF
 
 /*
   object to handle MAVLink packet routing
@@ -20,6 +32,13 @@ class MAVLink_routing
 public:
     MAVLink_routing(void);
 
+    /*
+      allocate a routing table for up to max_routes routes. If this
+      is not called the table is allocated with MAVLINK_MAX_ROUTES
+      entries when the first route is learned
+     */
+    bool init(uint16_t max_routes);
+
     /*
       forward a MAVLink message to the right port. This also
       automatically learns the route for the sender if it is not
@@ -41,23 +60,60 @@ public:
      */
     bool find_by_mavtype(uint8_t mavtype, uint8_t &sysid, uint8_t &compid, mavlink_channel_t &channel);
 
+    /*
+      routing counters
+     */
+    struct routing_stats {
+        uint32_t forwarded;   // packets sent on another channel
+        uint32_t dropped;     // packets not sent due to lack of txspace
+        uint32_t unknown;     // targeted packets with no known route
+        uint32_t evicted;     // stale routes replaced by new ones
+        uint32_t overflow;    // routes not learned as the table was full
+    };
+    const struct routing_stats &get_stats(void) const { return stats; }
+
+    uint16_t get_num_routes(void) const { return num_routes; }
+    uint16_t get_max_routes(void) const { return max_routes; }
+
 private:
-    // a simple linear routing table. We don't expect to have a lot of
-    // routes, so a scalable structure isn't worthwhile yet.
-    uint8_t num_routes;
+    // routes are kept in a dense array, with an open addressed hash
+    // index from sysid/compid to the route. A route holds a mask of
+    // the channels the component has been heard on
     struct route {
         uint8_t sysid;
         uint8_t compid;
-        mavlink_channel_t channel;
+        uint8_t chan_mask;
         uint8_t mavtype;
-    } routes[MAVLINK_MAX_ROUTES];
-    
+        uint32_t last_seen_ms;
+    } *routes;
+    uint16_t num_routes;
+    uint16_t max_routes;
+
+    uint16_t *route_index;
+    uint16_t route_index_mask;
+
+    // mask of channels each sysid has been heard on, and of all
+    // channels with any route
+    uint8_t sysid_chan_mask[256];
+    uint8_t all_chan_mask;
+
+    struct routing_stats stats;
+
     // a channel mask to block routing as required
     uint8_t no_route_mask;
     
     // learn new routes
     void learn_route(mavlink_channel_t in_channel, const mavlink_message_t* msg);
 
+    // route hash index
+    uint16_t route_hash(uint8_t sysid, uint8_t compid) const;
+    int16_t route_find(uint8_t sysid, uint8_t compid) const;
+    void route_index_remove(uint8_t sysid, uint8_t compid);
+    bool evict_route(void);
+
+    // send a message on all channels in a mask, except in_channel
+    bool forward_on_mask(uint8_t mask, mavlink_channel_t in_channel, const mavlink_message_t* msg);
+
     // extract target sysid and compid from a message
     void get_targets(const mavlink_message_t* msg, int16_t &sysid, int16_t &compid);
 
@@ -148,7 +148,7 @@ void Aircraft::update_position(void)
         time_now_us += frame_time_us;
     }
     last_time_us = time_now_us;
-    if (use_time_sync) {
+    if (use_time_sync && !lockstep) {
         sync_frame_time();
     }
 
@@ -365,7 +365,7 @@ void Aircraft::fill_fdm(struct sitl_fdm &fdm)
         fdm.altitude  = smoothing.location.alt * 1.0e-2;
     }
 
-    if (last_speedup != sitl->speedup && sitl->speedup > 0) {
+    if (!lockstep && last_speedup != sitl->speedup && sitl->speedup > 0) {
         set_speedup(sitl->speedup);
         last_speedup = sitl->speedup;
     }
@@ -50,6 +50,14 @@ public:
      */
     void set_speedup(float speedup);
 
+    /*
+      run in lockstep with the vehicle code, stepping as fast as
+      possible without syncing to wall clock time
+     */
+    void set_lockstep(bool enable) {
+        lockstep = enable;
+    }
+
     /*
       set instance number
      */
@@ -155,6 +163,7 @@ protected:
     const char *autotest_dir;
     const char *frame;
     bool use_time_sync = true;
+    bool lockstep = false;
     float last_speedup = -1;
 
     enum {